@@ -39,6 +39,7 @@
 #include "dma/dma_xdmac.h"
 #include "errno.h"
 #include "irq/irq.h"
+#include "mm/cache.h"
 #include "peripherals/pmc.h"
 
 /*----------------------------------------------------------------------------
@@ -160,6 +161,70 @@ int xdmacd_configure_transfer(struct _dma_channel* channel,
 	return 0;
 }
 
+int xdmacd_configure_linked_list(struct _dma_channel* channel,
+				 struct _dma_cfg* cfg_dma,
+				 struct _dma_transfer_cfg* list,
+				 struct _xdmac_desc_view1* desc_list,
+				 uint32_t list_size)
+{
+	struct _xdmacd_cfg cfg;
+	uint32_t desc_cntrl;
+	uint32_t i;
+	bool src_is_periph = (channel->src_txif != 0xff) || (channel->src_rxif != 0xff);
+	bool dst_is_periph = (channel->dest_txif != 0xff) || (channel->dest_rxif != 0xff);
+
+	if ((list == NULL) || (desc_list == NULL) || (list_size == 0))
+		return -EINVAL;
+
+	for (i = 0; i < list_size; i++) {
+		if ((list[i].len == 0) || (list[i].len > XDMAC_MAX_BT_SIZE))
+			return -EINVAL;
+
+		desc_list[i].mbr_sa = list[i].saddr;
+		desc_list[i].mbr_da = list[i].daddr;
+		desc_list[i].mbr_ubc = XDMA_UBC_NVIEW_NDV1
+			| XDMA_UBC_NSEN_UPDATED
+			| XDMA_UBC_NDEN_UPDATED
+			| XDMA_UBC_UBLEN(list[i].len);
+
+		if (i + 1 < list_size) {
+			desc_list[i].mbr_nda = &desc_list[i + 1];
+			desc_list[i].mbr_ubc |= XDMA_UBC_NDE_FETCH_EN;
+		} else {
+			desc_list[i].mbr_nda = NULL;
+		}
+	}
+
+	/* The controller fetches the descriptors from memory */
+	cache_clean_region(desc_list, list_size * sizeof(*desc_list));
+
+	cfg.cfg = (src_is_periph || dst_is_periph) ? XDMAC_CC_TYPE_PER_TRAN : XDMAC_CC_TYPE_MEM_TRAN;
+	cfg.cfg |= src_is_periph ? XDMAC_CC_DSYNC_PER2MEM : XDMAC_CC_DSYNC_MEM2PER;
+	cfg.cfg |= XDMAC_CC_CSIZE(cfg_dma->chunk_size);
+	cfg.cfg |= XDMAC_CC_DWIDTH(cfg_dma->data_width);
+	cfg.cfg |= src_is_periph ? XDMAC_CC_SIF_AHB_IF1 : XDMAC_CC_SIF_AHB_IF0;
+	cfg.cfg |= dst_is_periph ? XDMAC_CC_DIF_AHB_IF1 : XDMAC_CC_DIF_AHB_IF0;
+	cfg.cfg |= cfg_dma->incr_saddr ? XDMAC_CC_SAM_INCREMENTED_AM : XDMAC_CC_SAM_FIXED_AM;
+	cfg.cfg |= cfg_dma->incr_daddr ? XDMAC_CC_DAM_INCREMENTED_AM : XDMAC_CC_DAM_FIXED_AM;
+	cfg.cfg |= (src_is_periph || dst_is_periph) ? 0 : XDMAC_CC_SWREQ_SWR_CONNECTED;
+	cfg.ubc = 0;
+	cfg.bc = 0;
+	cfg.ds = 0;
+	cfg.sus = 0;
+	cfg.dus = 0;
+	cfg.sa = NULL;
+	cfg.da = NULL;
+
+	desc_cntrl = XDMAC_CNDC_NDVIEW_NDV1
+		| XDMAC_CNDC_NDE_DSCR_FETCH_EN
+		| XDMAC_CNDC_NDSUP_SRC_PARAMS_UPDATED
+		| XDMAC_CNDC_NDDUP_DST_PARAMS_UPDATED;
+
+	/* Only the end of list interrupt is enabled, the whole list completes
+	 * with a single callback */
+	return xdmacd_configure_transfer(channel, &cfg, desc_cntrl, desc_list);
+}
+
 void dma_irq_handler(uint32_t source, void* user_arg)
 {
 	uint32_t chan, gis, gcs;
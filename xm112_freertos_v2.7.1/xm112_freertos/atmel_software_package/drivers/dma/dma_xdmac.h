@@ -49,6 +49,8 @@
         @{*/
 
 struct _dma_channel;
+struct _dma_cfg;
+struct _dma_transfer_cfg;
 
 struct _xdmacd_cfg {
 	uint32_t  ubc;      /**< Microblock Size */
@@ -80,6 +82,27 @@ extern int xdmacd_configure_transfer(struct _dma_channel* channel,
 				     uint32_t desc_ctrl,
 				     void* desc_addr);
 
+/**
+ * \brief Configure DMA for a scatter/gather transfer using a linked list of
+ * view 1 descriptors owned by the caller.
+ * The descriptors are linked and written back from the cache, the channel
+ * fetches them itself and only raises an interrupt at the end of the list.
+ * Unlike dma_configure_transfer(), no descriptors are taken from the shared
+ * pool, so the list can be programmed and released from interrupt context.
+ * \param channel Channel pointer
+ * \param cfg_dma DMA transfer configuration, common for all list items
+ * \param list List of transfer specific configuration
+ * \param desc_list Descriptor storage with room for list_size items, must be
+ * valid until the transfer is done
+ * \param list_size Number of items in list
+ * \return error code
+ */
+extern int xdmacd_configure_linked_list(struct _dma_channel* channel,
+					struct _dma_cfg* cfg_dma,
+					struct _dma_transfer_cfg* list,
+					struct _xdmac_desc_view1* desc_list,
+					uint32_t list_size);
+
 /**     @}*/
 
 /**@}*/
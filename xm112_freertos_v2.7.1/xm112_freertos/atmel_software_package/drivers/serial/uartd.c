@@ -55,6 +55,7 @@
 #define UARTD_ATTRIBUTE_MASK     (0)
 #define UARTD_POLLING_THRESHOLD  16
 #define UART_RX_INTERRUPTS (UART_IER_RXRDY | UART_IER_OVRE | UART_IER_FRAME | UART_IER_PARE)
+#define UART_RX_ERRORS (UART_SR_OVRE | UART_SR_FRAME | UART_SR_PARE)
 
 static struct _uart_desc *_serial[UART_IFACE_COUNT];
 
@@ -217,10 +218,22 @@ static void _uartd_handler(uint32_t source, void* user_arg)
 			mutex_unlock(&desc->tx.mutex);
 		}
 	} else if (desc->transfer_mode == UARTD_MODE_DMA) {
+		status = uart_get_status(addr);
+
+		if (status & UART_RX_ERRORS) {
+			addr->UART_CR = UART_CR_RSTSTA;
+			callback_call(&desc->error_callback, (void*)status);
+		}
+
 		/* In DMA the RXRDY bit in the status register might already been cleared by the DMA
 		 * so assume that a byte has been received.
 		 */
-		if (desc->rx.buffer.size) {
+		if (desc->rx.buffer.size && desc->rx_block_mode) {
+			/* Only the first byte of a burst interrupts, the rest is
+			 * read by the task woken by the callback */
+			uart_disable_it(addr, UART_IDR_RXRDY);
+			callback_call(&desc->rx.callback, NULL);
+		} else if (desc->rx.buffer.size) {
 			// At least one more byte received, flush DMA and check how much data we have.
 			dma_fifo_flush(desc->dma.rx.channel);
 			uint32_t transferred = dma_get_transferred_data_len(desc->dma.rx.channel,
@@ -418,3 +431,54 @@ void uartd_wait_tx_transfer(const uint8_t iface)
 	assert(iface < UART_IFACE_COUNT);
 	while (mutex_is_locked(&_serial[iface]->tx.mutex));
 }
+
+uint32_t uartd_dma_rx_read(uint8_t iface, uint8_t *data, uint32_t size)
+{
+	assert(iface < UART_IFACE_COUNT);
+	struct _uart_desc* desc = _serial[iface];
+	uint8_t *rx_buffer = (uint8_t *)desc->dma.rx.cfg.daddr;
+	uint32_t copied = 0;
+
+	if (desc->rx.buffer.size == 0)
+		return 0;
+
+	dma_fifo_flush(desc->dma.rx.channel);
+	uint32_t transferred = dma_get_transferred_data_len(desc->dma.rx.channel,
+	                                                    desc->dma.rx.cfg_dma.chunk_size, desc->dma.rx.cfg.len);
+
+	cache_invalidate_region(desc->dma.rx.cfg.daddr, desc->dma.rx.cfg.len);
+
+	if (transferred < desc->rx.transferred) {
+		/* DMA have looped since last time, first copy the last part of the buffer */
+		uint32_t length = desc->dma.rx.cfg.len - desc->rx.transferred;
+
+		if (length > size)
+			length = size;
+
+		memcpy(data, rx_buffer + desc->rx.transferred, length);
+		copied = length;
+		desc->rx.transferred += length;
+
+		if (desc->rx.transferred < desc->dma.rx.cfg.len)
+			return copied;
+
+		desc->rx.transferred = 0;
+	}
+
+	uint32_t length = transferred - desc->rx.transferred;
+
+	if (length > size - copied)
+		length = size - copied;
+
+	memcpy(data + copied, rx_buffer + desc->rx.transferred, length);
+	copied += length;
+	desc->rx.transferred += length;
+
+	return copied;
+}
+
+void uartd_dma_rx_enable_notify(uint8_t iface)
+{
+	assert(iface < UART_IFACE_COUNT);
+	uart_enable_it(_serial[iface]->addr, UART_IER_RXRDY);
+}
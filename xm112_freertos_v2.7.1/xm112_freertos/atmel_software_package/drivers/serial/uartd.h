@@ -70,6 +70,9 @@ struct _uart_desc
 	uint32_t baudrate;
 	uint8_t transfer_mode;
 	struct _callback error_callback;
+	/* In DMA mode the rx callback is called with NULL once per burst and the
+	 * data is read with uartd_dma_rx_read */
+	bool rx_block_mode;
 
 	/* implicit internal padding is mandatory here */
 	struct {
@@ -113,6 +116,8 @@ extern void uartd_wait_rx_transfer(const uint8_t iface);
 extern void uartd_finish_tx_transfer(uint8_t iface);
 extern uint32_t uartd_tx_is_busy(const uint8_t iface);
 extern void uartd_wait_tx_transfer(const uint8_t iface);
+extern uint32_t uartd_dma_rx_read(uint8_t iface, uint8_t *data, uint32_t size);
+extern void uartd_dma_rx_enable_notify(uint8_t iface);
 
 #endif /* CONFIG_HAVE_UART */
 
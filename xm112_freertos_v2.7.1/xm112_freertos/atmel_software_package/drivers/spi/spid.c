@@ -40,6 +40,7 @@
 #include "dma/dma.h"
 #include "errno.h"
 #include "irq/irq.h"
+#include "irqflags.h"
 #include "mm/cache.h"
 #include "peripherals/bus.h"
 #ifdef CONFIG_HAVE_FLEXCOM
@@ -94,6 +95,17 @@ static int _spid_dma_rx_callback(void* arg, void* arg2)
 {
 	struct _spi_desc* desc = (struct _spi_desc*)arg;
 
+#ifdef CONFIG_HAVE_XDMAC
+	if (desc->xfer.dma.linked) {
+		/* the whole list is done, continue with the last buffer */
+		desc->xfer.dma.linked = false;
+		for (; desc->xfer.current < desc->xfer.last; desc->xfer.current++) {
+			if (desc->xfer.current->attr & BUS_BUF_ATTR_RX)
+				cache_invalidate_region(desc->xfer.current->data, desc->xfer.current->size);
+		}
+	}
+#endif
+
 	if (desc->xfer.current->attr & BUS_BUF_ATTR_RX)
 		cache_invalidate_region(desc->xfer.current->data, desc->xfer.current->size);
 
@@ -114,6 +126,94 @@ static int _spid_dma_tx_callback(void* arg, void* arg2)
 	return 0;
 }
 
+static void _spid_dma_allocate_channels(struct _spi_desc* desc)
+{
+	uint32_t id = get_spi_id_from_addr(desc->addr);
+
+	if (!desc->xfer.dma.tx_channel)
+		desc->xfer.dma.tx_channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
+	if (!desc->xfer.dma.rx_channel)
+		desc->xfer.dma.rx_channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
+}
+
+#ifdef CONFIG_HAVE_XDMAC
+/**
+ * \brief Transfer all remaining buffers using one linked list per DMA channel.
+ * All buffers must have the same RX/TX attributes since the address mode is
+ * common for the whole list.
+ * \return true if the transfer was started, false if the buffers must be
+ * transferred one at a time
+ */
+static bool _spid_transfer_buffers_dma_linked(struct _spi_desc* desc)
+{
+	struct _callback _cb;
+	struct _dma_transfer_cfg rx_cfg[SPID_LINKED_LIST_SIZE];
+	struct _dma_transfer_cfg tx_cfg[SPID_LINKED_LIST_SIZE];
+	uint32_t attr = desc->xfer.current->attr & (BUS_BUF_ATTR_TX | BUS_BUF_ATTR_RX);
+	uint32_t count = desc->xfer.last - desc->xfer.current + 1;
+	struct _dma_cfg rx_cfg_dma = {
+		.incr_saddr = false,
+		.incr_daddr = (attr & BUS_BUF_ATTR_RX) != 0,
+		.loop = false,
+		.data_width = DMA_DATA_WIDTH_BYTE,
+		.chunk_size = DMA_CHUNK_SIZE_1,
+	};
+	struct _dma_cfg tx_cfg_dma = {
+		.incr_saddr = (attr & BUS_BUF_ATTR_TX) != 0,
+		.incr_daddr = false,
+		.loop = false,
+		.data_width = DMA_DATA_WIDTH_BYTE,
+		.chunk_size = DMA_CHUNK_SIZE_1,
+	};
+	uint32_t i;
+
+	if (!desc->is_master || count < 2 || count > SPID_LINKED_LIST_SIZE)
+		return false;
+
+	for (i = 0; i < count; i++) {
+		struct _buffer* buf = &desc->xfer.current[i];
+
+		if ((buf->attr & (BUS_BUF_ATTR_TX | BUS_BUF_ATTR_RX)) != attr)
+			return false;
+
+		rx_cfg[i].saddr = (void*)&desc->addr->SPI_RDR;
+		rx_cfg[i].daddr = (attr & BUS_BUF_ATTR_RX) ? buf->data : (void*)&_garbage;
+		rx_cfg[i].len = buf->size;
+
+		tx_cfg[i].saddr = (attr & BUS_BUF_ATTR_TX) ? buf->data : (void*)&_garbage;
+		tx_cfg[i].daddr = (void*)&desc->addr->SPI_TDR;
+		tx_cfg[i].len = buf->size;
+	}
+
+	_spid_dma_allocate_channels(desc);
+
+	dma_reset_channel(desc->xfer.dma.tx_channel);
+	if (xdmacd_configure_linked_list(desc->xfer.dma.tx_channel, &tx_cfg_dma, tx_cfg, desc->xfer.dma.tx_list, count) != 0)
+		return false;
+
+	dma_reset_channel(desc->xfer.dma.rx_channel);
+	if (xdmacd_configure_linked_list(desc->xfer.dma.rx_channel, &rx_cfg_dma, rx_cfg, desc->xfer.dma.rx_list, count) != 0)
+		return false;
+
+	if (attr & BUS_BUF_ATTR_TX) {
+		for (i = 0; i < count; i++)
+			cache_clean_region(desc->xfer.current[i].data, desc->xfer.current[i].size);
+	}
+
+	callback_set(&_cb, _spid_dma_tx_callback, (void*)desc);
+	dma_set_callback(desc->xfer.dma.tx_channel, &_cb);
+	callback_set(&_cb, _spid_dma_rx_callback, (void*)desc);
+	dma_set_callback(desc->xfer.dma.rx_channel, &_cb);
+
+	desc->xfer.dma.linked = true;
+
+	dma_start_transfer(desc->xfer.dma.rx_channel);
+	dma_start_transfer(desc->xfer.dma.tx_channel);
+
+	return true;
+}
+#endif /* CONFIG_HAVE_XDMAC */
+
 static void _spid_transfer_current_buffer_dma(struct _spi_desc* desc)
 {
 	uint32_t id = get_spi_id_from_addr(desc->addr);
@@ -154,10 +254,7 @@ static void _spid_transfer_current_buffer_dma(struct _spi_desc* desc)
 		rx_cfg_dma.incr_daddr = true;
 	}
 
-	if (!desc->xfer.dma.tx_channel)
-		desc->xfer.dma.tx_channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
-	if (!desc->xfer.dma.rx_channel)
-		desc->xfer.dma.rx_channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
+	_spid_dma_allocate_channels(desc);
 
 	dma_reset_channel(desc->xfer.dma.tx_channel);
 	dma_configure_transfer(desc->xfer.dma.tx_channel, &tx_cfg_dma, &tx_cfg, 1);
@@ -323,6 +420,10 @@ static void _spid_transfer_current_buffer(struct _spi_desc* desc)
 		break;
 
 	case BUS_TRANSFER_MODE_DMA:
+#ifdef CONFIG_HAVE_XDMAC
+		if (_spid_transfer_buffers_dma_linked(desc))
+			break;
+#endif
 		_spid_transfer_current_buffer_dma(desc);
 		break;
 
@@ -399,6 +500,43 @@ void spid_wait_transfer(struct _spi_desc* desc)
 	}
 }
 
+/**
+ * \brief Stop an ongoing DMA transfer without calling its callback.
+ * The DMA does not write to the buffers of the transfer once this returns.
+ * \return true if a transfer was stopped, false if none was ongoing
+ */
+bool spid_abort_transfer(struct _spi_desc* desc)
+{
+	bool aborted = false;
+
+	/* The completion interrupt must not run while the transfer is torn down */
+	arch_irq_disable();
+
+	if (mutex_is_locked(&desc->mutex) && desc->transfer_mode == BUS_TRANSFER_MODE_DMA) {
+		dma_stop_transfer(desc->xfer.dma.tx_channel);
+		dma_stop_transfer(desc->xfer.dma.rx_channel);
+		dma_reset_channel(desc->xfer.dma.tx_channel);
+		dma_reset_channel(desc->xfer.dma.rx_channel);
+#ifdef CONFIG_HAVE_XDMAC
+		desc->xfer.dma.linked = false;
+#endif
+
+		/* Disable/enable SPI to set the TDRE flag, if not done the last TX byte from the incomplete
+		   transfer will be sent out first in the next DMA transfer */
+		spi_release_cs(desc->addr);
+		spi_disable(desc->addr);
+		spi_enable(desc->addr);
+
+		desc->xfer.current = NULL;
+		mutex_unlock(&desc->mutex);
+		aborted = true;
+	}
+
+	arch_irq_enable();
+
+	return aborted;
+}
+
 int spid_configure(struct _spi_desc* desc)
 {
 	uint32_t id = get_spi_id_from_addr(desc->addr);
@@ -420,6 +558,9 @@ int spid_configure(struct _spi_desc* desc)
 	spi_disable_it(desc->addr, ~0u);
 	desc->xfer.dma.tx_channel = 0;
 	desc->xfer.dma.rx_channel = 0;
+#ifdef CONFIG_HAVE_XDMAC
+	desc->xfer.dma.linked = false;
+#endif
 
 	spi_enable(desc->addr);
 
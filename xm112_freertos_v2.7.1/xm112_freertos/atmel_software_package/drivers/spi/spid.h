@@ -42,6 +42,16 @@
 #include "io.h"
 #include "mutex.h"
 
+/*------------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of buffers a DMA transfer programs as one linked list, a
+ * transfer with more buffers is done one buffer at a time */
+#ifndef SPID_LINKED_LIST_SIZE
+#define SPID_LINKED_LIST_SIZE 8
+#endif
+
 /*------------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -90,6 +100,11 @@ struct _spi_desc {
 		struct {
 			struct _dma_channel* rx_channel;
 			struct _dma_channel* tx_channel;
+#ifdef CONFIG_HAVE_XDMAC
+			bool linked; /*< All buffers are transferred using one linked list */
+			struct _xdmac_desc_view1 rx_list[SPID_LINKED_LIST_SIZE];
+			struct _xdmac_desc_view1 tx_list[SPID_LINKED_LIST_SIZE];
+#endif
 		} dma;
 	} xfer;
 };
@@ -110,6 +125,8 @@ extern bool spid_is_busy(struct _spi_desc* desc);
 
 extern void spid_wait_transfer(struct _spi_desc* desc);
 
+extern bool spid_abort_transfer(struct _spi_desc* desc);
+
 extern void spid_configure_cs(struct _spi_desc* desc, uint8_t cs,
 		uint32_t bitrate, uint32_t delay_dlybs, uint32_t delay_dlybct,
 		enum _spid_mode mode);
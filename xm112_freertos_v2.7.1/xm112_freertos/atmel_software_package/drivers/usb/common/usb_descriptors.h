@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) Acconeer AB, 2020
+ * All rights reserved
+ * This file is subject to the terms and conditions defined in the file
+ * 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+ * of this source code package.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  \section Purpose
+ *
+ *  USB 2.0 standard descriptors, as far as they are used by the USB device
+ *  HAL (usbd_usbhs.c) and the CDC driver. Multi-byte fields are little
+ *  endian, which matches the Cortex-M byte order.
+ */
+
+#ifndef USB_DESCRIPTORS_H_
+#define USB_DESCRIPTORS_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Descriptor types */
+#define USBGenericDescriptor_DEVICE                     1
+#define USBGenericDescriptor_CONFIGURATION              2
+#define USBGenericDescriptor_STRING                     3
+#define USBGenericDescriptor_INTERFACE                  4
+#define USBGenericDescriptor_ENDPOINT                   5
+#define USBGenericDescriptor_DEVICEQUALIFIER            6
+#define USBGenericDescriptor_OTHERSPEEDCONFIGURATION    7
+#define USBGenericDescriptor_INTERFACEASSOCIATION       11
+
+/** Endpoint directions, bit 7 of bEndpointAddress */
+#define USBEndpointDescriptor_OUT                       0
+#define USBEndpointDescriptor_IN                        1
+
+/** Endpoint transfer types, bits 1..0 of bmAttributes */
+#define USBEndpointDescriptor_CONTROL                   0
+#define USBEndpointDescriptor_ISOCHRONOUS               1
+#define USBEndpointDescriptor_BULK                      2
+#define USBEndpointDescriptor_INTERRUPT                 3
+
+/** Build bEndpointAddress from direction and number */
+#define USBEndpointDescriptor_ADDRESS(direction, number) \
+	((((direction) & 0x01) << 7) | ((number) & 0x0F))
+
+/** Configuration attributes */
+#define USBConfigurationDescriptor_BUSPOWERED_NORWAKEUP 0x80
+#define USBConfigurationDescriptor_SELFPOWERED_NORWAKEUP 0xC0
+
+/** Convert mA to bMaxPower */
+#define USBConfigurationDescriptor_POWER(ma)            (((ma) & 0x3FF) >> 1)
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Header shared by all descriptors */
+typedef struct _USBGenericDescriptor {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+} __attribute__((packed)) USBGenericDescriptor;
+
+/** Device descriptor */
+typedef struct _USBDeviceDescriptor {
+	uint8_t  bLength;
+	uint8_t  bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t  bDeviceClass;
+	uint8_t  bDeviceSubClass;
+	uint8_t  bDeviceProtocol;
+	uint8_t  bMaxPacketSize0;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint16_t bcdDevice;
+	uint8_t  iManufacturer;
+	uint8_t  iProduct;
+	uint8_t  iSerialNumber;
+	uint8_t  bNumConfigurations;
+} __attribute__((packed)) USBDeviceDescriptor;
+
+/** Device qualifier descriptor, required by high-speed capable devices */
+typedef struct _USBDeviceQualifierDescriptor {
+	uint8_t  bLength;
+	uint8_t  bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t  bDeviceClass;
+	uint8_t  bDeviceSubClass;
+	uint8_t  bDeviceProtocol;
+	uint8_t  bMaxPacketSize0;
+	uint8_t  bNumConfigurations;
+	uint8_t  bReserved;
+} __attribute__((packed)) USBDeviceQualifierDescriptor;
+
+/** Configuration descriptor */
+typedef struct _USBConfigurationDescriptor {
+	uint8_t  bLength;
+	uint8_t  bDescriptorType;
+	uint16_t wTotalLength;
+	uint8_t  bNumInterfaces;
+	uint8_t  bConfigurationValue;
+	uint8_t  iConfiguration;
+	uint8_t  bmAttributes;
+	uint8_t  bMaxPower;
+} __attribute__((packed)) USBConfigurationDescriptor;
+
+/** Interface association descriptor */
+typedef struct _USBInterfaceAssociationDescriptor {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bFirstInterface;
+	uint8_t bInterfaceCount;
+	uint8_t bFunctionClass;
+	uint8_t bFunctionSubClass;
+	uint8_t bFunctionProtocol;
+	uint8_t iFunction;
+} __attribute__((packed)) USBInterfaceAssociationDescriptor;
+
+/** Interface descriptor */
+typedef struct _USBInterfaceDescriptor {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bInterfaceNumber;
+	uint8_t bAlternateSetting;
+	uint8_t bNumEndpoints;
+	uint8_t bInterfaceClass;
+	uint8_t bInterfaceSubClass;
+	uint8_t bInterfaceProtocol;
+	uint8_t iInterface;
+} __attribute__((packed)) USBInterfaceDescriptor;
+
+/** Endpoint descriptor */
+typedef struct _USBEndpointDescriptor {
+	uint8_t  bLength;
+	uint8_t  bDescriptorType;
+	uint8_t  bEndpointAddress;
+	uint8_t  bmAttributes;
+	uint16_t wMaxPacketSize;
+	uint8_t  bInterval;
+} __attribute__((packed)) USBEndpointDescriptor;
+
+/*----------------------------------------------------------------------------
+ *        Functions
+ *----------------------------------------------------------------------------*/
+
+static inline uint8_t usb_endpoint_descriptor_get_number(const USBEndpointDescriptor *endpoint)
+{
+	return endpoint->bEndpointAddress & 0x0F;
+}
+
+static inline uint8_t usb_endpoint_descriptor_get_direction(const USBEndpointDescriptor *endpoint)
+{
+	return (endpoint->bEndpointAddress & 0x80) ? USBEndpointDescriptor_IN : USBEndpointDescriptor_OUT;
+}
+
+static inline uint8_t usb_endpoint_descriptor_get_type(const USBEndpointDescriptor *endpoint)
+{
+	return endpoint->bmAttributes & 0x03;
+}
+
+static inline uint16_t usb_endpoint_descriptor_get_max_packet_size(const USBEndpointDescriptor *endpoint)
+{
+	return endpoint->wMaxPacketSize;
+}
+
+#endif /* USB_DESCRIPTORS_H_ */
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) Acconeer AB, 2020
+ * All rights reserved
+ * This file is subject to the terms and conditions defined in the file
+ * 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+ * of this source code package.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  \section Purpose
+ *
+ *  USB 2.0 SETUP request layout and the standard request codes.
+ */
+
+#ifndef USB_REQUESTS_H_
+#define USB_REQUESTS_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Standard request codes */
+#define USBGenericRequest_GETSTATUS             0
+#define USBGenericRequest_CLEARFEATURE          1
+#define USBGenericRequest_SETFEATURE            3
+#define USBGenericRequest_SETADDRESS            5
+#define USBGenericRequest_GETDESCRIPTOR         6
+#define USBGenericRequest_SETDESCRIPTOR         7
+#define USBGenericRequest_GETCONFIGURATION      8
+#define USBGenericRequest_SETCONFIGURATION      9
+#define USBGenericRequest_GETINTERFACE          10
+#define USBGenericRequest_SETINTERFACE          11
+
+/** Request types, bits 6..5 of bmRequestType */
+#define USBGenericRequest_STANDARD              0
+#define USBGenericRequest_CLASS                 1
+#define USBGenericRequest_VENDOR                2
+
+/** Recipients, bits 4..0 of bmRequestType */
+#define USBGenericRequest_DEVICE                0
+#define USBGenericRequest_INTERFACE             1
+#define USBGenericRequest_ENDPOINT              2
+
+/** Feature selectors */
+#define USBFeatureRequest_ENDPOINTHALT          0
+#define USBFeatureRequest_DEVICEREMOTEWAKEUP    1
+#define USBFeatureRequest_TESTMODE              2
+
+/** Test mode selectors, TESTSENDZLP is not defined by USB 2.0 */
+#define USBFeatureRequest_TESTJ                 1
+#define USBFeatureRequest_TESTK                 2
+#define USBFeatureRequest_TESTSE0NAK            3
+#define USBFeatureRequest_TESTPACKET            4
+#define USBFeatureRequest_TESTFORCEENABLE       5
+#define USBFeatureRequest_TESTSENDZLP           6
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** SETUP packet */
+typedef struct _USBGenericRequest {
+	uint8_t  bmRequestType;
+	uint8_t  bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} __attribute__((packed)) USBGenericRequest;
+
+/*----------------------------------------------------------------------------
+ *        Functions
+ *----------------------------------------------------------------------------*/
+
+static inline uint8_t usb_generic_request_get_type(const USBGenericRequest *request)
+{
+	return (request->bmRequestType >> 5) & 0x03;
+}
+
+static inline uint8_t usb_generic_request_get_recipient(const USBGenericRequest *request)
+{
+	return request->bmRequestType & 0x1F;
+}
+
+static inline uint8_t usb_generic_request_get_direction(const USBGenericRequest *request)
+{
+	return (request->bmRequestType & 0x80) ? 1 : 0;
+}
+
+#endif /* USB_REQUESTS_H_ */
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) Acconeer AB, 2020
+ * All rights reserved
+ * This file is subject to the terms and conditions defined in the file
+ * 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+ * of this source code package.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  \section Purpose
+ *
+ *  Interface of the USB device hardware access layer implemented by
+ *  usbd_usbhs.c. The USB device framework of the software package is not
+ *  part of this tree, so the handlers normally provided by it
+ *  (usbd_request_handler() etc.) must be implemented by the USB class
+ *  driver that is linked in.
+ */
+
+#ifndef USBD_HAL_H_
+#define USBD_HAL_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usb/common/usb_descriptors.h"
+#include "usb/common/usb_requests.h"
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Transfer status codes */
+#define USBD_STATUS_SUCCESS             0
+#define USBD_STATUS_LOCKED              1
+#define USBD_STATUS_ABORTED             2
+#define USBD_STATUS_RESET               3
+#define USBD_STATUS_PARTIAL_DONE        4
+#define USBD_STATUS_INVALID_PARAMETER   5
+#define USBD_STATUS_WRONG_STATE         6
+#define USBD_STATUS_CANCELED            7
+#define USBD_STATUS_SW_NOT_SUPPORTED    0xFE
+#define USBD_STATUS_HW_NOT_SUPPORTED    0xFF
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Transfer completion callback, called from the USBHS interrupt handler.
+ * \param arg Argument given to usbd_hal_set_transfer_callback().
+ * \param status USBD_STATUS_* code.
+ * \param transferred Number of bytes transferred.
+ * \param remaining Number of bytes not transferred.
+ */
+typedef void (*usbd_xfer_cb_t)(void *arg, uint8_t status,
+		uint32_t transferred, uint32_t remaining);
+
+/** Buffer element of a multi-buffer list transfer */
+struct _usbd_transfer_buffer {
+	uint8_t  *buffer;
+	uint32_t size;
+	uint32_t transferred;
+	uint32_t buffered;
+	uint32_t remaining;
+};
+
+/*----------------------------------------------------------------------------
+ *        Handlers implemented by the USB device stack
+ *----------------------------------------------------------------------------*/
+
+/** SETUP packet received on a control endpoint */
+extern void usbd_request_handler(uint8_t ep, USBGenericRequest *request);
+
+/** End of bus reset */
+extern void usbd_reset_handler(void);
+
+/** Bus suspended */
+extern void usbd_suspend_handler(void);
+
+/** Bus resumed */
+extern void usbd_resume_handler(void);
+
+/*----------------------------------------------------------------------------
+ *        Functions
+ *----------------------------------------------------------------------------*/
+
+extern void usbd_hal_init(void);
+
+extern void usbd_hal_connect(void);
+
+extern void usbd_hal_disconnect(void);
+
+extern void usbd_hal_remote_wakeup(void);
+
+extern void usbd_hal_set_address(uint8_t address);
+
+extern void usbd_hal_set_configuration(uint8_t cfgnum);
+
+extern uint8_t usbd_hal_configure(const USBEndpointDescriptor *descriptor);
+
+extern void usbd_hal_reset_endpoints(uint32_t endpoint_bits, uint8_t status,
+		bool keep_cfg);
+
+extern uint8_t usbd_hal_set_transfer_callback(uint8_t ep,
+		usbd_xfer_cb_t callback, void *callback_arg);
+
+extern uint8_t usbd_hal_setup_multi_transfer(uint8_t ep,
+		struct _usbd_transfer_buffer *list, uint16_t list_size,
+		uint16_t start_offset);
+
+extern uint8_t usbd_hal_write(uint8_t ep, const void *data, uint32_t data_len);
+
+extern uint8_t usbd_hal_write_with_header(uint8_t ep,
+		const void *header, uint32_t header_len,
+		const void *data, uint32_t data_len);
+
+extern uint8_t usbd_hal_read(uint8_t ep, void *data, uint32_t data_len);
+
+extern uint16_t usbd_hal_get_data_size(uint8_t ep);
+
+extern uint8_t usbd_hal_stall(uint8_t ep);
+
+extern bool usbd_hal_halt(uint8_t ep);
+
+extern void usbd_hal_unhalt(uint8_t ep);
+
+extern bool usbd_hal_is_halted(uint8_t ep);
+
+extern void usbd_hal_force_full_speed(void);
+
+extern bool usbd_hal_is_high_speed(void);
+
+extern void usbd_hal_suspend(void);
+
+extern void usbd_hal_activate(void);
+
+extern void usbd_hal_test(uint8_t index);
+
+#endif /* USBD_HAL_H_ */
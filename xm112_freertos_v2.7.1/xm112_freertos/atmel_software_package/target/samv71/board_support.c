@@ -146,6 +146,13 @@ void board_cfg_lowlevel(bool clocks, bool ddram, bool mpu)
 	}
 }
 
+#if defined(ACC_CFG_TCM) && (ACC_CFG_TCM > 0)
+/* ITCM and DTCM are taken from the top of SRAM, the non cached part follows the top */
+#define SRAM_NOCACHE_ADDR (0x2045F000 - 2 * ACC_CFG_TCM * 1024)
+#else
+#define SRAM_NOCACHE_ADDR 0x2045F000
+#endif
+
 void board_cfg_mpu(void)
 {
 	const uint32_t mpu_regions[] = {
@@ -177,8 +184,8 @@ void board_cfg_mpu(void)
 		MPU_ATTR_NORMAL_WB_WA |
 		MPU_ATTR_ENABLE,
 
-		/* Not Cached SRAM, 0x2045F000-0x20460000, 4KB=2^12 */
-		MPU_REGION(4, 0x2045F000),
+		/* Not Cached SRAM, 0x2045F000-0x20460000 less the TCM, 4KB=2^12 */
+		MPU_REGION(4, SRAM_NOCACHE_ADDR),
 		MPU_REGION_SIZE(11) |
 		MPU_AP_READWRITE |
 		MPU_ATTR_NORMAL |
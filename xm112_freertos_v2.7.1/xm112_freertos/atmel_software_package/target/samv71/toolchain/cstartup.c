@@ -8,6 +8,8 @@
 #include "barriers.h"
 #include "board.h"
 #include "irq/nvic.h"
+#include "nvm/flash/eefc.h"
+#include "peripherals/rstc.h"
 
 /*----------------------------------------------------------------------------
  *        Imported variables / functions
@@ -30,6 +32,17 @@ extern uint32_t _ezero;
 
 #define CSTACK_TOP (&_cstack)
 
+#if defined(ACC_CFG_TCM) && (ACC_CFG_TCM > 0)
+extern uint32_t _sitcm;
+extern uint32_t _eitcm;
+extern uint32_t _litcm;
+extern uint32_t _sdtcm_data;
+extern uint32_t _edtcm_data;
+extern uint32_t _ldtcm_data;
+extern uint32_t _szero_dtcm;
+extern uint32_t _ezero_dtcm;
+#endif
+
 #elif defined(__ICCARM__)
 
 void __iar_data_init3(void);
@@ -125,6 +138,56 @@ static void _default_debugmon_handler(void)
 }
 
 
+#if defined(ACC_CFG_TCM) && (ACC_CFG_TCM > 0)
+
+#if ACC_CFG_TCM == 32
+#define TCM_GPNVM_CONFIG 1u
+#elif ACC_CFG_TCM == 64
+#define TCM_GPNVM_CONFIG 2u
+#elif ACC_CFG_TCM == 128
+#define TCM_GPNVM_CONFIG 3u
+#else
+#error "ACC_CFG_TCM must be 32, 64 or 128"
+#endif
+#else
+#define TCM_GPNVM_CONFIG 0u
+#endif
+
+/* GPNVM bits 7 and 8 give the size of each TCM, 0: none, 1: 32 kB, 2: 64 kB, 3: 128 kB */
+#define TCM_GPNVM_FIRST_BIT 7
+
+/**
+ * \brief Make the TCM size in the GPNVM bits match ACC_CFG_TCM and enable ITCM and DTCM.
+ * The size is only read at reset, so a device with another size is reprogrammed
+ * and reset once. This also clears the bits on a device that ran a TCM build
+ * before, which would otherwise have SRAM missing under the linker script.
+ * Runs before any RAM is initialized and must not use .data or .bss.
+ */
+static void _tcm_configure(void)
+{
+	uint32_t gpnvm;
+	int i;
+
+	eefc_perform_command(EEFC, EEFC_FCR_FCMD_GGPB, 0);
+	gpnvm = eefc_get_result(EEFC);
+
+	if (((gpnvm >> TCM_GPNVM_FIRST_BIT) & 3u) != TCM_GPNVM_CONFIG) {
+		for (i = 0; i < 2; i++) {
+			uint32_t cmd = (TCM_GPNVM_CONFIG & (1u << i)) ? EEFC_FCR_FCMD_SGPB : EEFC_FCR_FCMD_CGPB;
+			eefc_perform_command(EEFC, cmd, TCM_GPNVM_FIRST_BIT + i);
+		}
+		rstc_reset_all();
+		while (1);
+	}
+
+#if TCM_GPNVM_CONFIG != 0
+	SCB->SCB_ITCMCR |= SCB_ITCMCR_EN | SCB_ITCMCR_RMW | SCB_ITCMCR_RETEN;
+	SCB->SCB_DTCMCR |= SCB_DTCMCR_EN | SCB_DTCMCR_RMW | SCB_DTCMCR_RETEN;
+	dsb();
+	isb();
+#endif
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -141,6 +204,8 @@ void reset_handler(void)
 	dsb();
 	isb();
 
+	_tcm_configure();
+
 #if defined(__GNUC__)
 
 	uint32_t *src, *dst;
@@ -153,6 +218,21 @@ void reset_handler(void)
 	for (dst = (uint32_t*)&_srelocate, src = (uint32_t*)&_etext; dst < (uint32_t*)&_erelocate; dst++, src++)
 		*dst = *src;
 
+#if defined(ACC_CFG_TCM) && (ACC_CFG_TCM > 0)
+	/* copy code to ITCM and data to DTCM, zero DTCM BSS */
+	for (dst = (uint32_t*)&_sitcm, src = (uint32_t*)&_litcm; dst < (uint32_t*)&_eitcm; dst++, src++)
+		*dst = *src;
+
+	for (dst = (uint32_t*)&_sdtcm_data, src = (uint32_t*)&_ldtcm_data; dst < (uint32_t*)&_edtcm_data; dst++, src++)
+		*dst = *src;
+
+	for (dst = (uint32_t*)&_szero_dtcm; dst < (uint32_t*)&_ezero_dtcm; dst++)
+		*dst = 0;
+
+	dsb();
+	isb();
+#endif
+
 	/* initialize the C library */
 	__libc_init_array();
 
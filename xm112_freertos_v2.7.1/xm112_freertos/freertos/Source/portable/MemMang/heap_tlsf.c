@@ -0,0 +1,169 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+/**
+ * @brief FreeRTOS heap using the TLSF allocator in acc_tlsf.c
+ *
+ * A replacement for heap_5.c with the same interface, the heap is set up
+ * with vPortDefineHeapRegions. Allocation and free take constant time and
+ * free blocks are merged immediately, see acc_tlsf.h.
+ *
+ * Selected with FREERTOS_HEAP=heap_tlsf when building.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "acc_tlsf.h"
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+
+#if defined(__ARM_ARCH_7EM__)
+/**
+ * @brief The DWT cycle counter of Cortex-M7, used for the worst case time statistics
+ */
+#define DEMCR              (*(volatile uint32_t *)0xE000EDFCU)
+#define DEMCR_TRCENA       (1U << 24)
+#define DWT_CTRL           (*(volatile uint32_t *)0xE0001000U)
+#define DWT_CTRL_CYCCNTENA 1U
+#define DWT_CYCCNT         (*(volatile uint32_t *)0xE0001004U)
+#define DWT_LAR            (*(volatile uint32_t *)0xE0001FB0U)
+#define DWT_LAR_KEY        0xC5ACCE55U
+
+
+static uint32_t cycle_counter(void)
+{
+	return DWT_CYCCNT;
+}
+
+
+static acc_tlsf_cycle_counter_func_t *cycle_counter_enable(void)
+{
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_LAR   = DWT_LAR_KEY;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+	return cycle_counter;
+}
+
+
+#else
+
+
+static acc_tlsf_cycle_counter_func_t *cycle_counter_enable(void)
+{
+	return NULL;
+}
+
+
+#endif
+
+
+static acc_tlsf_t *heap = NULL;
+
+
+void vPortDefineHeapRegions(const HeapRegion_t * const pxHeapRegions)
+{
+	configASSERT(heap == NULL);
+	configASSERT(pxHeapRegions[0].xSizeInBytes > 0);
+
+	heap = acc_tlsf_create(pxHeapRegions[0].pucStartAddress, pxHeapRegions[0].xSizeInBytes, cycle_counter_enable());
+	configASSERT(heap != NULL);
+
+	for (const HeapRegion_t *region = &pxHeapRegions[1]; region->xSizeInBytes > 0; region++)
+	{
+		bool added = acc_tlsf_add_region(heap, region->pucStartAddress, region->xSizeInBytes);
+
+		configASSERT(added);
+		(void)added;
+	}
+}
+
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+	void *pvReturn;
+
+	// vPortDefineHeapRegions must be called before the first allocation
+	configASSERT(heap != NULL);
+
+	vTaskSuspendAll();
+	{
+		pvReturn = acc_tlsf_alloc(heap, xWantedSize);
+		traceMALLOC(pvReturn, xWantedSize);
+	}
+	(void)xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if (pvReturn == NULL)
+		{
+			extern void vApplicationMallocFailedHook(void);
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+
+
+void vPortFree(void *pv)
+{
+	if (pv != NULL)
+	{
+		vTaskSuspendAll();
+		{
+			traceFREE(pv, acc_tlsf_get_allocated_size(pv));
+			acc_tlsf_free(heap, pv);
+		}
+		(void)xTaskResumeAll();
+	}
+}
+
+
+size_t xPortGetFreeHeapSize(void)
+{
+	acc_tlsf_stats_t stats;
+
+	acc_heap_tlsf_get_stats(&stats);
+
+	return stats.free_size;
+}
+
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+	acc_tlsf_stats_t stats;
+
+	acc_heap_tlsf_get_stats(&stats);
+
+	return stats.min_ever_free_size;
+}
+
+
+void acc_heap_tlsf_get_stats(acc_tlsf_stats_t *stats)
+{
+	configASSERT(heap != NULL);
+
+	vTaskSuspendAll();
+	acc_tlsf_get_stats(heap, stats);
+	(void)xTaskResumeAll();
+}
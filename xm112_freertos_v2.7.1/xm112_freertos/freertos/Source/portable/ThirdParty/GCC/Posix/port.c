@@ -0,0 +1,517 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portMAX_INTERRUPTS				( ( uint32_t ) sizeof( uint32_t ) * 8UL ) /* The number of bits in an uint32_t. */
+#define portNO_CRITICAL_NESTING			( ( UBaseType_t ) 0 )
+#define portINTERRUPT_SIGNAL			SIGUSR1
+#define portTICK_PERIOD_NS				( 1000000000L / configTICK_RATE_HZ )
+
+/*-----------------------------------------------------------*/
+
+/* Each task is executed by a pthread.  The task stack is not used for
+anything but a pointer to the thread state, which maps the task handle to
+the thread.  The thread state is allocated separately so it outlives the
+stack while the thread terminates. */
+typedef struct
+{
+	/* The thread that executes the task. */
+	pthread_t xThread;
+
+	/* Entry point and parameter of the task. */
+	TaskFunction_t pxCode;
+	void *pvParameters;
+
+	/* Set when the task has been deleted, the thread terminates as soon as
+	it is scheduled out. */
+	BaseType_t xDying;
+
+} ThreadState_t;
+
+/* Protects pxRunningThread and xSchedulerEnded. */
+static pthread_mutex_t xRunMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Signalled every time the running thread changes. */
+static pthread_cond_t xRunCond = PTHREAD_COND_INITIALIZER;
+
+/* The only thread that is allowed to execute. */
+static ThreadState_t *pxRunningThread = NULL;
+
+/* Set by vPortEndScheduler() to make xPortStartScheduler() return. */
+static BaseType_t xSchedulerEnded = pdFALSE;
+
+/* Ticks and simulated interrupts waiting to be processed.  Ticks are counted
+so none are lost when the running thread has interrupts disabled for more
+than a tick period. */
+static volatile uint32_t ulPendingTicks = 0UL;
+static volatile uint32_t ulPendingInterrupts = 0UL;
+
+/* Handlers for the simulated interrupts. */
+static uint32_t ( *ulIsrHandler[ portMAX_INTERRUPTS ] )( void ) = { 0 };
+
+/* The critical nesting count is global since a context switch only happens
+when it is zero.  It is initialised to a non-zero value so interrupts are not
+enabled by the kernel before the first task runs. */
+static volatile UBaseType_t uxCriticalNesting = 9999UL;
+
+/* A context switch was requested while it could not be performed. */
+static volatile BaseType_t xSwitchPending = pdFALSE;
+
+/* True while a simulated interrupt handler executes. */
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+
+/* The signal set used to disable interrupts. */
+static sigset_t xInterruptSignals;
+
+/* Pointer to the TCB of the currently executing task. */
+extern void * volatile pxCurrentTCB;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Set up the signal set used to disable interrupts.
+ */
+static void prvInitialiseInterruptSignals( void )
+{
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portINTERRUPT_SIGNAL );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Get the thread state of a task, stored at the top of its stack.
+ */
+static ThreadState_t *prvGetThreadState( void *pvTCB )
+{
+	return ( ThreadState_t * ) *( *( StackType_t ** ) pvTCB );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Block until pxThread is the running thread or has been deleted, must be
+ * called with xRunMutex held.
+ */
+static void prvWaitUntilRunning( ThreadState_t *pxThread )
+{
+	while( ( pxRunningThread != pxThread ) && ( pxThread->xDying == pdFALSE ) )
+	{
+		pthread_cond_wait( &xRunCond, &xRunMutex );
+	}
+
+	if( pxThread->xDying != pdFALSE )
+	{
+		pthread_mutex_unlock( &xRunMutex );
+		pthread_exit( NULL );
+	}
+
+	/* Make sure interrupts raised while the thread was scheduled out are
+	delivered as soon as it enables interrupts. */
+	if( ( ulPendingTicks != 0UL ) || ( ulPendingInterrupts != 0UL ) )
+	{
+		pthread_kill( pxThread->xThread, portINTERRUPT_SIGNAL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Hand over execution from one thread to another.  Interrupts must be
+ * disabled in the calling thread.
+ */
+static void prvSwitchThread( ThreadState_t *pxFrom, ThreadState_t *pxTo )
+{
+	pthread_mutex_lock( &xRunMutex );
+
+	pxRunningThread = pxTo;
+	pthread_cond_broadcast( &xRunCond );
+
+	prvWaitUntilRunning( pxFrom );
+
+	pthread_mutex_unlock( &xRunMutex );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Select the next task to run and switch to its thread.  Interrupts must be
+ * disabled in the calling thread.
+ */
+static void prvSwitchContext( void )
+{
+ThreadState_t *pxFrom, *pxTo;
+
+	xSwitchPending = pdFALSE;
+
+	pxFrom = prvGetThreadState( pxCurrentTCB );
+	vTaskSwitchContext();
+	pxTo = prvGetThreadState( pxCurrentTCB );
+
+	if( pxFrom != pxTo )
+	{
+		prvSwitchThread( pxFrom, pxTo );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Simulated interrupt entry, executed by the running thread.
+ */
+static void prvInterruptSignalHandler( int iSignal )
+{
+uint32_t ulTicks, ulInterrupts, i;
+BaseType_t xSwitchRequired = pdFALSE;
+
+	( void ) iSignal;
+
+	xInsideInterrupt = pdTRUE;
+
+	ulTicks = __atomic_exchange_n( &ulPendingTicks, 0UL, __ATOMIC_ACQ_REL );
+	while( ulTicks-- > 0UL )
+	{
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xSwitchRequired = pdTRUE;
+		}
+	}
+
+	ulInterrupts = __atomic_exchange_n( &ulPendingInterrupts, 0UL, __ATOMIC_ACQ_REL );
+	for( i = 0; i < portMAX_INTERRUPTS; i++ )
+	{
+		if( ( ( ulInterrupts & ( 1UL << i ) ) != 0UL ) && ( ulIsrHandler[ i ] != NULL ) )
+		{
+			if( ulIsrHandler[ i ]() != pdFALSE )
+			{
+				xSwitchRequired = pdTRUE;
+			}
+		}
+	}
+
+	xInsideInterrupt = pdFALSE;
+
+	if( ( xSwitchRequired != pdFALSE ) || ( xSwitchPending != pdFALSE ) )
+	{
+		/* The interrupt signal is blocked while the handler executes, so the
+		switch is done with interrupts disabled. */
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Deliver pending interrupts to the running thread.
+ */
+static void prvKickRunningThread( void )
+{
+sigset_t xSaved;
+
+	/* The running thread may be the caller, do not let the handler run while
+	xRunMutex is held. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSaved );
+	pthread_mutex_lock( &xRunMutex );
+
+	if( pxRunningThread != NULL )
+	{
+		pthread_kill( pxRunningThread->xThread, portINTERRUPT_SIGNAL );
+	}
+
+	pthread_mutex_unlock( &xRunMutex );
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Created with interrupts disabled, this thread simulates the tick timer.
+ * Absolute wake times are used so the tick does not drift.
+ */
+static void *prvTimerThread( void *pvParameters )
+{
+struct timespec xNextWake;
+
+	( void ) pvParameters;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNextWake );
+
+	for( ;; )
+	{
+		xNextWake.tv_nsec += portTICK_PERIOD_NS;
+		if( xNextWake.tv_nsec >= 1000000000L )
+		{
+			xNextWake.tv_nsec -= 1000000000L;
+			xNextWake.tv_sec++;
+		}
+
+		while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xNextWake, NULL ) == EINTR )
+		{
+		}
+
+		__atomic_add_fetch( &ulPendingTicks, 1UL, __ATOMIC_ACQ_REL );
+		prvKickRunningThread();
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Entry point of the thread executing a task.
+ */
+static void *prvTaskThread( void *pvParameters )
+{
+ThreadState_t *pxThread = ( ThreadState_t * ) pvParameters;
+
+	pthread_mutex_lock( &xRunMutex );
+	prvWaitUntilRunning( pxThread );
+	pthread_mutex_unlock( &xRunMutex );
+
+	/* A task starts with interrupts enabled. */
+	uxCriticalNesting = portNO_CRITICAL_NESTING;
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks must not return, delete it the same way as if it had done so
+	itself. */
+	vTaskDelete( NULL );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+ThreadState_t *pxThread;
+sigset_t xSaved;
+int iResult;
+
+	/* The thread inherits the signal mask, it is created with interrupts
+	disabled and enables them when it runs for the first time. */
+	prvInitialiseInterruptSignals();
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSaved );
+
+	pxThread = malloc( sizeof( *pxThread ) );
+	configASSERT( pxThread != NULL );
+
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xDying = pdFALSE;
+
+	iResult = pthread_create( &pxThread->xThread, NULL, prvTaskThread, pxThread );
+	configASSERT( iResult == 0 );
+	( void ) iResult;
+
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+
+	*pxTopOfStack = ( StackType_t ) pxThread;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xAction = { 0 };
+pthread_t xTimerThread;
+
+	/* The thread calling the scheduler never executes a task, neither does
+	the timer thread which inherits the signal mask. */
+	prvInitialiseInterruptSignals();
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+
+	xAction.sa_handler = prvInterruptSignalHandler;
+	xAction.sa_flags = SA_RESTART;
+	xAction.sa_mask = xInterruptSignals;
+	sigaction( portINTERRUPT_SIGNAL, &xAction, NULL );
+
+	if( pthread_create( &xTimerThread, NULL, prvTimerThread, NULL ) != 0 )
+	{
+		return pdFAIL;
+	}
+
+	pthread_mutex_lock( &xRunMutex );
+
+	/* Start the first task. */
+	pxRunningThread = prvGetThreadState( pxCurrentTCB );
+	pthread_cond_broadcast( &xRunCond );
+
+	while( xSchedulerEnded == pdFALSE )
+	{
+		pthread_cond_wait( &xRunCond, &xRunMutex );
+	}
+
+	pthread_mutex_unlock( &xRunMutex );
+
+	pthread_cancel( xTimerThread );
+	pthread_join( xTimerThread, NULL );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+ThreadState_t *pxThread = prvGetThreadState( pxCurrentTCB );
+
+	vPortDisableInterrupts();
+
+	pthread_mutex_lock( &xRunMutex );
+
+	pxRunningThread = NULL;
+	xSchedulerEnded = pdTRUE;
+	pthread_cond_broadcast( &xRunCond );
+
+	/* No task will run again. */
+	while( pxThread->xDying == pdFALSE )
+	{
+		pthread_cond_wait( &xRunCond, &xRunMutex );
+	}
+
+	pthread_mutex_unlock( &xRunMutex );
+	pthread_exit( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+sigset_t xSaved;
+
+	if( ( xInsideInterrupt != pdFALSE ) || ( uxCriticalNesting != portNO_CRITICAL_NESTING ) )
+	{
+		/* Performed when the interrupt handler returns or when interrupts
+		are enabled again, like a pended PendSV. */
+		xSwitchPending = pdTRUE;
+		return;
+	}
+
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSaved );
+	prvSwitchContext();
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	/* Interrupts stay disabled until the interrupt handler returns. */
+	if( xInsideInterrupt == pdFALSE )
+	{
+		pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	if( uxCriticalNesting > portNO_CRITICAL_NESTING )
+	{
+		uxCriticalNesting--;
+
+		if( uxCriticalNesting == portNO_CRITICAL_NESTING )
+		{
+			if( ( xSwitchPending != pdFALSE ) && ( xInsideInterrupt == pdFALSE ) )
+			{
+				prvSwitchContext();
+			}
+
+			vPortEnableInterrupts();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortPreDeleteThread( void *pvTaskToDelete )
+{
+	/* The thread terminates when it is scheduled out by the yield that
+	follows. */
+	prvGetThreadState( pvTaskToDelete )->xDying = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpThread( void *pvTaskToDelete )
+{
+ThreadState_t *pxThread = prvGetThreadState( pvTaskToDelete );
+sigset_t xSaved;
+
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSaved );
+
+	pthread_mutex_lock( &xRunMutex );
+	pxThread->xDying = pdTRUE;
+	pthread_cond_broadcast( &xRunCond );
+	pthread_mutex_unlock( &xRunMutex );
+
+	pthread_join( pxThread->xThread, NULL );
+	free( pxThread );
+
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+sigset_t xSaved, xWaitMask;
+
+	( void ) xExpectedIdleTime;
+
+	/* Called with the scheduler suspended.  Sleep until the next tick or
+	simulated interrupt, which is the host counterpart of a WFI. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSaved );
+
+	if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+	{
+		xWaitMask = xSaved;
+		sigdelset( &xWaitMask, portINTERRUPT_SIGNAL );
+		sigsuspend( &xWaitMask );
+	}
+
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t ( *pvHandler )( void ) )
+{
+	if( ulInterruptNumber < portMAX_INTERRUPTS )
+	{
+		ulIsrHandler[ ulInterruptNumber ] = pvHandler;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber )
+{
+	if( ulInterruptNumber < portMAX_INTERRUPTS )
+	{
+		__atomic_or_fetch( &ulPendingInterrupts, 1UL << ulInterruptNumber, __ATOMIC_ACQ_REL );
+		prvKickRunningThread();
+	}
+}
+/*-----------------------------------------------------------*/
@@ -29,9 +29,11 @@
 #ifndef FREERTOS_CONFIG_H
 #define FREERTOS_CONFIG_H
 
+#if !defined(TARGET_ARCH_x86_64)                                              //Acconeer modification
 /* Atmel includes. */
 #include <board.h>
 #include "peripherals/pmc.h"
+#endif
 #ifdef USE_ACCONEER_TICKLESS_IDLE
 #include "acc_device_pm.h"
 #endif
@@ -59,11 +61,16 @@ void system_fatal_error_handler(const char* reason);
 #define configUSE_QUEUE_SETS                    1
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0                              //Acconeer modification
+#if defined(TARGET_ARCH_x86_64)
+#define configCPU_CLOCK_HZ                      ( 1000000000UL )               //Acconeer modification, unused by the POSIX port
+#else
 #define configCPU_CLOCK_HZ                      ( pmc_get_processor_clock() )  //Acconeer modification
+#endif
 #define configTICK_RATE_HZ                      ( 1000 )
 #define configMAX_PRIORITIES                    ( 5 )
 #define configMINIMAL_STACK_SIZE                ( ( unsigned short ) 130 )
 #define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 185 * 1024 ) ) //Acconeer modification
+#define configSUPPORT_STATIC_ALLOCATION         1                             //Acconeer modification, kernel objects from pools
 #define configMAX_TASK_NAME_LEN                 ( 10 )
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_16_BIT_TICKS                  0
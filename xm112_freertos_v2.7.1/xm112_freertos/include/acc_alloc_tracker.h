@@ -0,0 +1,134 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_ALLOC_TRACKER_H_
+#define ACC_ALLOC_TRACKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Tracker of live dynamic memory allocations
+ *
+ * The tracker is built in with "make ACC_CFG_ALLOC_TRACKER=1". It then sits
+ * between acc_os_mem_alloc/acc_os_mem_free, the memory functions of the HAL
+ * given to RSS, and the heap of the OS driver. Each allocation gets a small
+ * header that records the call site, the size, the owning task, the time and
+ * a sequence number, and links the allocation into a list of live allocations.
+ *
+ * Call sites are file and line for acc_os_mem_alloc and the return address
+ * for allocations made by RSS, which can be resolved with addr2line.
+ *
+ * A leak check brackets the code under test with two checkpoints:
+ *
+ *   acc_alloc_tracker_checkpoint_t before = acc_alloc_tracker_checkpoint();
+ *   ... create and destroy a detector ...
+ *   acc_alloc_tracker_checkpoint_t after = acc_alloc_tracker_checkpoint();
+ *
+ *   acc_alloc_tracker_log_leaks(before, after);
+ */
+
+
+typedef uint32_t acc_alloc_tracker_checkpoint_t;
+
+
+typedef struct
+{
+	/** Bytes requested by the live allocations, headers not included */
+	size_t   current_bytes;
+	/** Highest value of current_bytes */
+	size_t   peak_bytes;
+	uint32_t live_count;
+	/** Bytes of headers added to the live allocations */
+	size_t   overhead_bytes;
+	uint32_t failed_count;
+	/** Allocations whose call site or owner did not fit in the tables and were counted as "other" */
+	uint32_t untracked_site_count;
+} acc_alloc_tracker_stats_t;
+
+
+/**
+ * @brief Allocate tracked memory
+ *
+ * @param size The number of bytes to allocate
+ * @param file The file which makes the allocation, NULL if caller is a return address
+ * @param line The line where the allocation takes place
+ * @param caller The return address of the caller when file is NULL
+ * @return Pointer to the allocated memory, or NULL if allocation failed
+ */
+void *acc_alloc_tracker_alloc(size_t size, const char *file, uint16_t line, const void *caller);
+
+
+/**
+ * @brief Free memory from acc_alloc_tracker_alloc
+ *
+ * Memory without a valid header is logged and not freed.
+ *
+ * @param ptr The memory, or NULL
+ */
+void acc_alloc_tracker_free(void *ptr);
+
+
+/**
+ * @brief Allocate tracked memory on behalf of RSS, to be used as mem_alloc of the HAL
+ *
+ * @param size The number of bytes to allocate
+ * @return Pointer to the allocated memory, or NULL if allocation failed
+ */
+void *acc_alloc_tracker_hal_mem_alloc(size_t size);
+
+
+/**
+ * @brief Take a checkpoint for a later leak check
+ *
+ * @return The checkpoint
+ */
+acc_alloc_tracker_checkpoint_t acc_alloc_tracker_checkpoint(void);
+
+
+/**
+ * @brief Log allocations made between two checkpoints which are still live
+ *
+ * @param start Checkpoint taken before the code under test
+ * @param end Checkpoint taken after the code under test
+ * @return The number of leaked allocations
+ */
+uint32_t acc_alloc_tracker_log_leaks(acc_alloc_tracker_checkpoint_t start, acc_alloc_tracker_checkpoint_t end);
+
+
+/**
+ * @brief Log current and peak bytes per call site
+ *
+ * Besides the peak of each call site, the bytes each call site held when the
+ * total was at its peak are logged.
+ */
+void acc_alloc_tracker_log_report(void);
+
+
+/**
+ * @brief Log all live allocations in address order with the gaps between them
+ */
+void acc_alloc_tracker_log_heap_map(void);
+
+
+/**
+ * @brief Get the totals of the tracker
+ *
+ * @param[out] stats The statistics
+ */
+void acc_alloc_tracker_get_stats(acc_alloc_tracker_stats_t *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_APP_INTEGRATION_FREERTOS_H_
+#define ACC_APP_INTEGRATION_FREERTOS_H_
+
+#include <stdint.h>
+
+#include "acc_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Threads, mutexes and semaphores of the FreeRTOS integration come from pools
+ *
+ * The capacities are set with ACC_APP_INTEGRATION_THREAD_POOL_SIZE,
+ * ACC_APP_INTEGRATION_MUTEX_POOL_SIZE and ACC_APP_INTEGRATION_SEMAPHORE_POOL_SIZE.
+ * When a pool is exhausted the object is allocated from the heap instead,
+ * which shows as exhausted_count in the pool statistics.
+ *
+ * With "make ACC_CFG_STATIC_ALLOCATION=1" each thread object also holds the
+ * task control block and the stack of the thread, so threads are created
+ * without heap allocation and their RAM shows in the linker map.
+ */
+
+
+#define ACC_APP_INTEGRATION_FREERTOS_POOL_COUNT 3U
+
+
+/**
+ * @brief Get the occupancy of the thread, mutex and semaphore pools
+ *
+ * @param[out] stats Statistics of ACC_APP_INTEGRATION_FREERTOS_POOL_COUNT pools
+ */
+void acc_app_integration_freertos_get_pool_stats(acc_pool_stats_t stats[ACC_APP_INTEGRATION_FREERTOS_POOL_COUNT]);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
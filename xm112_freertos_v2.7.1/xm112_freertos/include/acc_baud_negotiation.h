@@ -0,0 +1,226 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_BAUD_NEGOTIATION_H_
+#define ACC_BAUD_NEGOTIATION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup BaudNegotiation UART Baudrate Negotiation
+ *
+ * @brief Switch a UART link to a higher baudrate at runtime
+ *
+ * The negotiation is made with text commands on the link, one per line:
+ *
+ * | Host                           | Device                              |
+ * |--------------------------------|-------------------------------------|
+ * | BAUD?                          | BAUD MAX <highest baudrate>         |
+ * | BAUD <baudrate>                | BAUD OK <baudrate> <actual baudrate> or BAUD NAK <baudrate> <error in ppm> |
+ * | BAUD TEST <seed> <pattern>     | BAUD ECHO <seed> <pattern>          |
+ * | BAUD COMMIT                    | BAUD DONE <baudrate>                |
+ *
+ * The device acknowledges a baudrate if its divisor error is at most
+ * ACC_BAUD_NEGOTIATION_MAX_ERROR_PPM, and both sides switch after the
+ * acknowledgement. The host sends a test pattern at the new baudrate that the
+ * device checks and echoes. Both sides go back to the previous baudrate if the
+ * pattern is wrong or the next step does not arrive within
+ * ACC_BAUD_NEGOTIATION_TIMEOUT_MS.
+ *
+ * BAUD? and BAUD <baudrate> start with a line break that ends any noise
+ * received while the baudrates did not match.
+ *
+ * If the last message is lost the device is at the new baudrate and the host at
+ * the previous. The host can find the device again by sending BAUD? at both.
+ *
+ * The same state machine is used on the device and on the host. It does not
+ * depend on a UART driver, commands are passed to it by the application and
+ * replies are written with the functions in acc_baud_negotiation_port_t.
+ *
+ * @{
+ */
+
+
+/**
+ * @brief Time to wait for the next step of a negotiation
+ */
+#define ACC_BAUD_NEGOTIATION_TIMEOUT_MS 500U
+
+/**
+ * @brief Largest accepted difference between the requested and the actual baudrate, 2 %
+ */
+#define ACC_BAUD_NEGOTIATION_MAX_ERROR_PPM 20000U
+
+/**
+ * @brief Number of characters in the test pattern
+ */
+#define ACC_BAUD_NEGOTIATION_PATTERN_LENGTH 32U
+
+/**
+ * @brief Longest command or reply without delimiter
+ */
+#define ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH (22U + ACC_BAUD_NEGOTIATION_PATTERN_LENGTH)
+
+
+/**
+ * @brief Functions used to reach the link
+ */
+typedef struct
+{
+	/** Write a line, return when it has been sent */
+	bool     (*write)(const char *line, size_t length, void *client_reference);
+	/** Change the baudrate of the link */
+	bool     (*baudrate_set)(uint32_t baudrate, void *client_reference);
+	/** Get the time in ms */
+	uint32_t (*time_get)(void *client_reference);
+	void     *client_reference;
+} acc_baud_negotiation_port_t;
+
+
+/**
+ * @brief Negotiation states
+ */
+typedef enum
+{
+	ACC_BAUD_NEGOTIATION_STATE_IDLE,
+	/** Host is waiting for the acknowledgement */
+	ACC_BAUD_NEGOTIATION_STATE_PROPOSED,
+	/** Host is waiting for the echo or device for the test pattern */
+	ACC_BAUD_NEGOTIATION_STATE_TESTING,
+	/** Host is waiting for done or device for commit */
+	ACC_BAUD_NEGOTIATION_STATE_COMMITTING,
+	/** Host has switched to the new baudrate */
+	ACC_BAUD_NEGOTIATION_STATE_DONE,
+	/** Host is at the previous baudrate */
+	ACC_BAUD_NEGOTIATION_STATE_FAILED,
+} acc_baud_negotiation_state_enum_t;
+typedef uint32_t acc_baud_negotiation_state_t;
+
+
+/**
+ * @brief Negotiation state
+ */
+typedef struct
+{
+	acc_baud_negotiation_port_t  port;
+	bool                         is_device;
+	acc_baud_negotiation_state_t state;
+	/** The highest baudrate of the device, 0 on the host until BAUD MAX has been received */
+	uint32_t                     max_baudrate;
+	uint32_t                     baudrate;
+	uint32_t                     fallback_baudrate;
+	uint32_t                     proposed_baudrate;
+	uint32_t                     deadline_ms;
+	uint32_t                     seed;
+} acc_baud_negotiation_t;
+
+
+/**
+ * @brief Get the error of a baudrate
+ *
+ * @param[in] max_baudrate The highest baudrate of the UART, see acc_device_uart_get_max_baudrate
+ * @param[in] baudrate The requested baudrate
+ * @param[out] actual_baudrate The baudrate the UART will use, may be NULL
+ * @return The difference between the requested and the actual baudrate in ppm
+ */
+uint32_t acc_baud_negotiation_error_ppm(uint32_t max_baudrate, uint32_t baudrate, uint32_t *actual_baudrate);
+
+
+/**
+ * @brief Initialize the device side
+ *
+ * @param[out] negotiation The negotiation state
+ * @param[in] port Functions used to reach the link
+ * @param[in] max_baudrate The highest baudrate the device can receive and send at
+ * @param[in] baudrate The current baudrate
+ */
+void acc_baud_negotiation_device_init(acc_baud_negotiation_t            *negotiation,
+                                      const acc_baud_negotiation_port_t *port,
+                                      uint32_t                          max_baudrate,
+                                      uint32_t                          baudrate);
+
+
+/**
+ * @brief Initialize the host side
+ *
+ * @param[out] negotiation The negotiation state
+ * @param[in] port Functions used to reach the link
+ * @param[in] baudrate The current baudrate
+ */
+void acc_baud_negotiation_host_init(acc_baud_negotiation_t            *negotiation,
+                                    const acc_baud_negotiation_port_t *port,
+                                    uint32_t                          baudrate);
+
+
+/**
+ * @brief Ask the device for its highest baudrate, the reply sets max_baudrate
+ *
+ * @param[in] negotiation The host negotiation state
+ * @return True if the question was sent
+ */
+bool acc_baud_negotiation_host_query(acc_baud_negotiation_t *negotiation);
+
+
+/**
+ * @brief Propose a new baudrate to the device
+ *
+ * The result is in the state, ACC_BAUD_NEGOTIATION_STATE_DONE or
+ * ACC_BAUD_NEGOTIATION_STATE_FAILED, when the negotiation has ended.
+ *
+ * @param[in] negotiation The host negotiation state
+ * @param[in] baudrate The proposed baudrate
+ * @return True if the proposal was sent
+ */
+bool acc_baud_negotiation_host_start(acc_baud_negotiation_t *negotiation, uint32_t baudrate);
+
+
+/**
+ * @brief Handle a received command or reply
+ *
+ * On the device all commands received while a negotiation is ongoing belong
+ * to it, a command that is not part of the negotiation means that the baudrates
+ * do not match.
+ *
+ * @param[in] negotiation The negotiation state
+ * @param[in] command The command without delimiter, modified when split into words
+ * @return True if the command was handled, false if it is not a negotiation command
+ */
+bool acc_baud_negotiation_command(acc_baud_negotiation_t *negotiation, char *command);
+
+
+/**
+ * @brief Check for timeouts, call regularly and at least every ACC_BAUD_NEGOTIATION_TIMEOUT_MS
+ *
+ * @param[in] negotiation The negotiation state
+ */
+void acc_baud_negotiation_poll(acc_baud_negotiation_t *negotiation);
+
+
+/**
+ * @brief Check if a negotiation is ongoing
+ *
+ * @param[in] negotiation The negotiation state
+ * @return True if waiting for the other side
+ */
+bool acc_baud_negotiation_is_busy(const acc_baud_negotiation_t *negotiation);
+
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -11,18 +11,54 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "acc_console_ring.h"
 #include "acc_device.h"
+#include "acc_driver_spi_same70.h"
+
+
+/**
+ * @brief Maximum number of sensors connected to the module
+ */
+#define XM11x_SENSOR_MAX 4
 
 typedef struct
 {
-	bool     open;
-	uint32_t baudrate;
-	bool     use_as_debug;
+	bool                   open;
+	uint32_t               baudrate;
+	bool                   use_as_debug;
+	/** Size of the debug output ring, a power of two, 0 for unbuffered debug output */
+	uint32_t               debug_buffer_size;
+	/** What debug output does when the ring is full */
+	acc_console_overflow_t debug_overflow;
+	/** Write logs as binary records, decoded on the host with acc_log_decoder */
+	bool                   debug_binary_log;
 } acc_board_xm112_uart_config_t;
 
+/**
+ * @brief Connection of one sensor
+ *
+ * Sensors on different SPI buses are transferred concurrently, sensors sharing
+ * a bus use different chip selects and are transferred one at a time.
+ */
 typedef struct
 {
-	acc_board_xm112_uart_config_t uart_config[UART_IFACE_COUNT];
+	uint8_t                        spi_bus;
+	uint8_t                        spi_cs;
+	acc_driver_spi_same70_config_t spi_pins;
+	uint8_t                        interrupt_pin;
+	uint8_t                        enable_pin;
+	uint8_t                        ps_enable_pin;
+} acc_board_xm112_sensor_config_t;
+
+typedef struct
+{
+	acc_board_xm112_uart_config_t   uart_config[UART_IFACE_COUNT];
+	/** USB CDC virtual COM port, port ACC_DRIVER_USB_CDC_SAME70_PORT, only opened when built with ACC_CFG_USB_CDC */
+	acc_board_xm112_uart_config_t   usb_cdc_config;
+	uint32_t                        sensor_count;
+	acc_board_xm112_sensor_config_t sensor_config[XM11x_SENSOR_MAX];
+	/** Size of the driver buffer of each sensor SPI bus, see acc_driver_spi_same70_buffer_size_set() */
+	uint32_t                        sensor_spi_buffer_size;
 } acc_board_xm112_config_t;
 
 typedef void (*acc_board_get_config_t)(acc_board_xm112_config_t *config);
@@ -36,6 +72,14 @@ uint32_t acc_board_set_sensor_transfer_speed(uint_fast32_t speed);
 void acc_board_set_sensor_transfer_default_speed(void);
 
 
+/**
+ * @brief Get the SPI device of the first sensor
+ *
+ * @return The SPI device
+ */
+acc_device_handle_t acc_board_get_spi_master_handle(void);
+
+
 acc_device_handle_t acc_board_get_spi_slave_handle(void);
 
 
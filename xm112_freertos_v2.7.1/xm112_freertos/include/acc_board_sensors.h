@@ -0,0 +1,172 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_BOARD_SENSORS_H_
+#define ACC_BOARD_SENSORS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_board.h"
+#include "acc_definitions.h"
+#include "acc_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Maximum number of sensors handled by the sensor table
+ */
+#define ACC_BOARD_SENSORS_MAX 4
+
+
+/**
+ * @brief Connection of one sensor
+ *
+ * Sensors on the same SPI bus are transferred one at a time, sensors on
+ * different buses can transfer concurrently.
+ */
+typedef struct
+{
+	/** SPI device of the sensor, a bus and a chip select */
+	acc_device_handle_t spi_handle;
+	/** GPIO pin connected to SENS_INT */
+	uint_fast8_t        interrupt_pin;
+	/** GPIO pin connected to ENABLE */
+	uint_fast8_t        enable_pin;
+	/** GPIO pin enabling the sensor power supply, may be shared by several sensors */
+	uint_fast8_t        ps_enable_pin;
+	/** Use acc_device_spi_transfer_async and block on a semaphore instead of a blocking transfer */
+	bool                transfer_async;
+} acc_board_sensor_config_t;
+
+
+/**
+ * @brief Set up the sensor table
+ *
+ * The pins are configured, the sensors are disabled and the sensor interrupts
+ * are registered. Sensor ids are 1 to sensor_count in table order.
+ *
+ * @param[in] configs The sensor connections, copied
+ * @param[in] sensor_count The number of sensors, at most ACC_BOARD_SENSORS_MAX
+ * @return True if successful, false otherwise
+ */
+bool acc_board_sensors_init(const acc_board_sensor_config_t *configs, uint32_t sensor_count);
+
+
+/**
+ * @brief Release the resources of the sensor table
+ */
+void acc_board_sensors_deinit(void);
+
+
+/**
+ * @brief Get the number of sensors in the sensor table
+ *
+ * @return The number of sensors
+ */
+uint32_t acc_board_sensors_get_count(void);
+
+
+/**
+ * @brief Register a function called from interrupt context on every sensor interrupt
+ *
+ * @param[in] callback The function, NULL to unregister
+ */
+void acc_board_sensors_register_interrupt_callback(acc_board_isr_t callback);
+
+
+/**
+ * @brief Power on a sensor
+ *
+ * @param[in] sensor_id The sensor
+ */
+void acc_board_sensors_start(acc_sensor_id_t sensor_id);
+
+
+/**
+ * @brief Power off a sensor
+ *
+ * A power supply shared with other sensors is kept on while any of them is active.
+ *
+ * @param[in] sensor_id The sensor
+ */
+void acc_board_sensors_stop(acc_sensor_id_t sensor_id);
+
+
+/**
+ * @brief Transfer data to and from a sensor
+ *
+ * The SPI bus of the sensor is locked during the transfer. With transfer_async set
+ * the calling task sleeps until the driver signals completion, so other tasks can
+ * run while the data is clocked out.
+ *
+ * @param[in] sensor_id The sensor
+ * @param[in, out] buffer The data to transfer, received data is written to the same buffer
+ * @param[in] buffer_length The size of the buffer in bytes
+ * @return True if successful, false otherwise
+ */
+bool acc_board_sensors_transfer(acc_sensor_id_t sensor_id, uint8_t *buffer, size_t buffer_length);
+
+
+/**
+ * @brief Wait for an interrupt from a sensor
+ *
+ * @param[in] sensor_id The sensor
+ * @param[in] timeout_ms The maximum time to wait
+ * @return True if the interrupt arrived, false on timeout
+ */
+bool acc_board_sensors_wait_for_interrupt(acc_sensor_id_t sensor_id, uint32_t timeout_ms);
+
+
+/**
+ * @brief Check the level of the interrupt pin of a sensor
+ *
+ * @param[in] sensor_id The sensor
+ * @return True if the interrupt pin is high
+ */
+bool acc_board_sensors_is_interrupt_active(acc_sensor_id_t sensor_id);
+
+
+/**
+ * @brief Get the SPI device of a sensor
+ *
+ * @param[in] sensor_id The sensor
+ * @return The SPI device, NULL for an invalid sensor id
+ */
+acc_device_handle_t acc_board_sensors_get_spi_handle(acc_sensor_id_t sensor_id);
+
+
+/**
+ * @brief Wait for the SPI transfer of a sensor to complete
+ *
+ * To be called from the wait function registered with the SPI driver.
+ *
+ * @param[in] spi_handle The SPI device of the transfer
+ * @param[in] timeout_ms The maximum time to wait
+ */
+void acc_board_sensors_spi_wait(acc_device_handle_t spi_handle, uint16_t timeout_ms);
+
+
+/**
+ * @brief Signal that the SPI transfer of a sensor is complete
+ *
+ * To be called from the transfer complete callback registered with the SPI driver,
+ * may be called from interrupt context.
+ *
+ * @param[in] spi_handle The SPI device of the transfer
+ */
+void acc_board_sensors_spi_complete(acc_device_handle_t spi_handle);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_COMMAND_H_
+#define ACC_COMMAND_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Function called for every complete command
+ *
+ * @param[in] command The command, zero terminated, without the delimiter
+ * @param[in] length The length of the command
+ * @param[in] client_reference The client reference given to acc_command_tokenizer_init
+ */
+typedef void (*acc_command_func_t)(char *command, size_t length, void *client_reference);
+
+
+/**
+ * @brief Command tokenizer state
+ */
+typedef struct
+{
+	char               *buffer;
+	size_t             buffer_size;
+	size_t             length;
+	bool               overflow;
+	const char         *delimiters;
+	acc_command_func_t callback;
+	void               *client_reference;
+	/** Commands dropped because they did not fit the buffer */
+	uint32_t           overflow_count;
+} acc_command_tokenizer_t;
+
+
+/**
+ * @brief Initialize a command tokenizer
+ *
+ * @param[out] tokenizer The tokenizer
+ * @param[in] buffer Memory for the longest command and its terminating zero
+ * @param[in] buffer_size The size of buffer
+ * @param[in] delimiters The characters that end a command, for example ";\r\n"
+ * @param[in] callback Called for every complete command that is not empty
+ * @param[in] client_reference Passed to the callback
+ */
+void acc_command_tokenizer_init(acc_command_tokenizer_t *tokenizer,
+                                char                    *buffer,
+                                size_t                  buffer_size,
+                                const char              *delimiters,
+                                acc_command_func_t      callback,
+                                void                    *client_reference);
+
+
+/**
+ * @brief Split received data into commands
+ *
+ * The data does not need to start or end at a command boundary. Must not be
+ * called from interrupt context since the callback is called directly.
+ *
+ * @param[in] tokenizer The tokenizer
+ * @param[in] data The received data
+ * @param[in] length The number of bytes
+ */
+void acc_command_tokenizer_feed(acc_command_tokenizer_t *tokenizer, const uint8_t *data, size_t length);
+
+
+/**
+ * @brief Split a command into words separated by spaces, tabs or commas
+ *
+ * The separators in command are replaced with zeros. If there are more than
+ * max_words words the last word holds the rest of the command.
+ *
+ * @param[in] command The command
+ * @param[out] words Pointers to the words
+ * @param[in] max_words The size of words
+ * @return The number of words, at most max_words
+ */
+size_t acc_command_split(char *command, char **words, size_t max_words);
+
+
+/**
+ * @brief Parse an integer
+ *
+ * Accepts decimal numbers and hexadecimal numbers starting with 0x.
+ *
+ * @param[in] text The text
+ * @param[out] value The value
+ * @return True if all of text is a number that fits in an int32_t
+ */
+bool acc_command_parse_int32(const char *text, int32_t *value);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_COMPRESSION_H_
+#define ACC_COMPRESSION_H_
+
+#include <stdint.h>
+
+/**
+ * @defgroup Compression Lossless Frame Compression
+ *
+ * @brief Compressed format for frames of uint16_t samples, envelope and sparse data
+ *
+ * A compressed frame is an acc_compression_header_t followed by the coded
+ * samples. A frame holds one or more sweeps of sweep_length samples, one for
+ * envelope and sweeps_per_frame for sparse. Intra frames code the difference to
+ * the previous sample along the sweep. Sweep frames code the first sweep like
+ * an intra frame and the other sweeps as the difference to the same sample in
+ * the sweep before. Inter frames are sweep frames where the first sweep is coded
+ * as the difference to the last sweep of the previous frame. Raw frames hold the
+ * samples as they are and are used when coding would not make the frame smaller.
+ *
+ * The differences are zigzag mapped to unsigned values, 0, -1, 1, -2, ... become
+ * 0, 1, 2, 3, ..., and Rice coded in blocks of ACC_COMPRESSION_BLOCK_LENGTH
+ * samples. Each block starts with its Rice parameter k in 5 bits, then every
+ * value v is coded as v >> k one bits, a zero bit and the k low bits of v.
+ * Values with v >> k of ACC_COMPRESSION_ESCAPE_LENGTH or more are coded as
+ * that many one bits followed by v in 17 bits. Bits are written most
+ * significant first and the last byte is padded with zeros.
+ *
+ * The frame number is incremented for every frame. An inter frame can only be
+ * decoded if the frame before it was decoded, all other frames are key frames.
+ *
+ * @{
+ */
+
+
+/**
+ * @brief Number of samples coded with the same Rice parameter
+ */
+#define ACC_COMPRESSION_BLOCK_LENGTH 64U
+
+/**
+ * @brief Number of one bits that starts an escaped value
+ */
+#define ACC_COMPRESSION_ESCAPE_LENGTH 16U
+
+/**
+ * @brief Number of bits in an escaped value, a zigzag mapped difference of two uint16_t
+ */
+#define ACC_COMPRESSION_ESCAPE_BITS 17U
+
+/**
+ * @brief Number of bits in the Rice parameter at the start of a block
+ */
+#define ACC_COMPRESSION_K_BITS 5U
+
+/**
+ * @brief Largest size of a compressed frame, the size of a raw frame
+ */
+#define ACC_COMPRESSION_MAX_SIZE(data_length) (sizeof(acc_compression_header_t) + 2U * (size_t)(data_length))
+
+
+/**
+ * @brief Frame types
+ */
+typedef enum
+{
+	/** Samples as little endian uint16_t */
+	ACC_COMPRESSION_FRAME_RAW   = 0,
+	/** Differences to the previous sample in the frame */
+	ACC_COMPRESSION_FRAME_INTRA = 1,
+	/** Differences to the same sample in the previous sweep, the first sweep from the previous frame */
+	ACC_COMPRESSION_FRAME_INTER = 2,
+	/** Differences to the same sample in the previous sweep, the first sweep coded as intra */
+	ACC_COMPRESSION_FRAME_SWEEP = 3,
+} acc_compression_frame_type_enum_t;
+typedef uint32_t acc_compression_frame_type_t;
+
+
+/**
+ * @brief Compressed frame header
+ */
+typedef struct
+{
+	uint8_t  frame_type;
+	uint8_t  frame_number;
+	/** Number of samples in the frame */
+	uint16_t data_length;
+	/** Number of samples in a sweep, data_length is a multiple of it */
+	uint16_t sweep_length;
+} acc_compression_header_t;
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_COMPRESSION_DECODER_H_
+#define ACC_COMPRESSION_DECODER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_compression.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Decoder state
+ */
+typedef struct
+{
+	uint16_t *previous;
+	uint16_t max_sweep_length;
+	uint16_t previous_length;
+	bool     previous_valid;
+	uint8_t  previous_frame_number;
+} acc_compression_decoder_t;
+
+
+/**
+ * @brief Initialize a decoder
+ *
+ * @param[out] decoder The decoder
+ * @param[in] previous Memory for the last sweep of the previous frame, max_sweep_length samples
+ * @param[in] max_sweep_length The largest number of samples in a sweep
+ */
+void acc_compression_decoder_init(acc_compression_decoder_t *decoder, uint16_t *previous, uint16_t max_sweep_length);
+
+
+/**
+ * @brief Decompress a frame
+ *
+ * Fails for inter frames when the frame before was not decoded, decoding
+ * continues with the next key frame.
+ *
+ * @param[in] decoder The decoder
+ * @param[in] input The compressed frame
+ * @param[in] input_size The size of the compressed frame
+ * @param[out] data The samples
+ * @param[in] max_data_length The size of data in samples
+ * @param[out] data_length The number of samples
+ * @param[out] sweep_length The number of samples in a sweep, may be NULL
+ * @return True if successful, false if the frame is invalid or its reference is missing
+ */
+bool acc_compression_decode(acc_compression_decoder_t *decoder,
+                            const uint8_t             *input,
+                            size_t                    input_size,
+                            uint16_t                  *data,
+                            uint16_t                  max_data_length,
+                            uint16_t                  *data_length,
+                            uint16_t                  *sweep_length);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
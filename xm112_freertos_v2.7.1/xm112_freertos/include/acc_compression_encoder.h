@@ -0,0 +1,101 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_COMPRESSION_ENCODER_H_
+#define ACC_COMPRESSION_ENCODER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_compression.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief How the encoder codes frames
+ */
+typedef enum
+{
+	/** Every frame is an intra frame */
+	ACC_COMPRESSION_MODE_INTRA,
+	/** Every frame except key frames is an inter frame, key frames are sweep frames if there are several sweeps */
+	ACC_COMPRESSION_MODE_INTER,
+	/** Intra, sweep or inter, whichever has the smallest differences */
+	ACC_COMPRESSION_MODE_ADAPTIVE,
+} acc_compression_mode_enum_t;
+typedef uint32_t acc_compression_mode_t;
+
+
+/**
+ * @brief Encoder state
+ */
+typedef struct
+{
+	acc_compression_mode_t mode;
+	uint16_t               *previous;
+	uint16_t               max_sweep_length;
+	uint16_t               previous_length;
+	bool                   previous_valid;
+	uint8_t                frame_number;
+	uint16_t               key_frame_interval;
+	uint16_t               frames_since_key_frame;
+} acc_compression_encoder_t;
+
+
+/**
+ * @brief Initialize an encoder
+ *
+ * @param[out] encoder The encoder
+ * @param[in] mode How frames are coded
+ * @param[in] previous Memory for the last sweep of the previous frame, max_sweep_length samples,
+ *                     NULL to code without inter frames
+ * @param[in] max_sweep_length The largest number of samples in a sweep
+ * @param[in] key_frame_interval Number of frames from one key frame to the next, 0 to only send
+ *                               key frames when acc_compression_encoder_reset is called
+ */
+void acc_compression_encoder_init(acc_compression_encoder_t *encoder,
+                                  acc_compression_mode_t    mode,
+                                  uint16_t                  *previous,
+                                  uint16_t                  max_sweep_length,
+                                  uint16_t                  key_frame_interval);
+
+
+/**
+ * @brief Make the next frame a key frame, for example after a receiver reported lost frames
+ *
+ * @param[in] encoder The encoder
+ */
+void acc_compression_encoder_reset(acc_compression_encoder_t *encoder);
+
+
+/**
+ * @brief Compress a frame
+ *
+ * @param[in] encoder The encoder
+ * @param[in] data The samples
+ * @param[in] data_length The number of samples
+ * @param[in] sweep_length The number of samples in a sweep, at most max_sweep_length, data_length must be a multiple of it
+ * @param[out] output Memory for the compressed frame
+ * @param[in] output_size The size of output, at least ACC_COMPRESSION_MAX_SIZE(data_length)
+ * @return The size of the compressed frame, 0 if the arguments are invalid
+ */
+size_t acc_compression_encode(acc_compression_encoder_t *encoder,
+                              const uint16_t            *data,
+                              uint16_t                  data_length,
+                              uint16_t                  sweep_length,
+                              uint8_t                   *output,
+                              size_t                    output_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_CONSOLE_H_
+#define ACC_CONSOLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_console_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Console output counters
+ */
+typedef struct
+{
+	/** Bytes written to the ring */
+	uint32_t written_bytes;
+	/** Bytes dropped because the ring was full */
+	uint32_t dropped_bytes;
+} acc_console_counters_t;
+
+
+/**
+ * @brief Start buffered console output
+ *
+ * Console writes are copied to a RAM ring and a drain task writes the ring to
+ * the UART in large writes, so writers do not wait for the UART.
+ *
+ * @param[in] port The UART port to write to
+ * @param[in] ring_size The size of the ring in bytes, a power of two
+ * @param[in] overflow What writers do when the ring is full
+ * @return True if successful, false otherwise
+ */
+bool acc_console_buffered_start(uint_fast8_t port, uint32_t ring_size, acc_console_overflow_t overflow);
+
+
+/**
+ * @brief Check if buffered console output is started
+ *
+ * @return True if console writes go through the ring
+ */
+bool acc_console_is_buffered(void);
+
+
+/**
+ * @brief Write to the buffered console
+ *
+ * @param[in] data The data
+ * @param[in] length The number of bytes
+ */
+void acc_console_write(const void *data, size_t length);
+
+
+/**
+ * @brief Wait until all buffered output has been handed to the UART
+ *
+ * @param[in] timeout_ms The maximum time to wait
+ * @return True if the ring is empty
+ */
+bool acc_console_flush(uint32_t timeout_ms);
+
+
+/**
+ * @brief Get the console output counters
+ *
+ * @param[out] counters The counters
+ */
+void acc_console_get_counters(acc_console_counters_t *counters);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
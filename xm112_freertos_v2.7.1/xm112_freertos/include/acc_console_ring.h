@@ -0,0 +1,107 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_CONSOLE_RING_H_
+#define ACC_CONSOLE_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief What a write does when the ring is full
+ */
+typedef enum
+{
+	/** The written data is dropped */
+	ACC_CONSOLE_OVERFLOW_DROP,
+	/** The write fails without dropping anything, the caller waits and tries again */
+	ACC_CONSOLE_OVERFLOW_BLOCK,
+	/** The oldest unread data is dropped to make room */
+	ACC_CONSOLE_OVERFLOW_OVERWRITE,
+} acc_console_overflow_enum_t;
+typedef uint32_t acc_console_overflow_t;
+
+
+/**
+ * @brief Byte ring with any number of producers and one consumer
+ *
+ * Producers reserve space with compare-and-swap on the reserve index, copy
+ * their data and then add their length to the commit index. The consumer only
+ * reads when the two indexes are equal, that is when no write is in progress,
+ * so it never sees partly written data. No producer ever waits for another.
+ *
+ * All indexes are free running, the ring size must be a power of two.
+ */
+typedef struct
+{
+	uint8_t  *buffer;
+	uint32_t size;
+	uint32_t reserve;
+	uint32_t commit;
+	uint32_t tail;
+	uint32_t written_bytes;
+	uint32_t dropped_bytes;
+} acc_console_ring_t;
+
+
+/**
+ * @brief Initialize a ring
+ *
+ * @param[out] ring The ring
+ * @param[in] buffer Memory for the data, must be valid while the ring is used
+ * @param[in] size The size of the buffer, a power of two
+ * @return True if successful, false if size is not a power of two
+ */
+bool acc_console_ring_init(acc_console_ring_t *ring, uint8_t *buffer, uint32_t size);
+
+
+/**
+ * @brief Write data to the ring, may be called by several producers at the same time
+ *
+ * Data larger than the ring is truncated to its last part with
+ * ACC_CONSOLE_OVERFLOW_OVERWRITE and dropped with the other policies.
+ *
+ * @param[in] ring The ring
+ * @param[in] data The data
+ * @param[in] length The number of bytes
+ * @param[in] overflow What to do if there isn't room for the data
+ * @return True if the data was written, false if it was dropped or the write should be retried
+ */
+bool acc_console_ring_write(acc_console_ring_t *ring, const void *data, uint32_t length, acc_console_overflow_t overflow);
+
+
+/**
+ * @brief Read data from the ring, must only be called by one consumer
+ *
+ * Returns 0 while a write is in progress even if there is committed data.
+ *
+ * @param[in] ring The ring
+ * @param[out] data Memory for the data
+ * @param[in] max_length The size of data
+ * @return The number of bytes read
+ */
+uint32_t acc_console_ring_read(acc_console_ring_t *ring, void *data, uint32_t max_length);
+
+
+/**
+ * @brief Check if all written data has been read
+ *
+ * @param[in] ring The ring
+ * @return True if the ring is empty
+ */
+bool acc_console_ring_is_empty(acc_console_ring_t *ring);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
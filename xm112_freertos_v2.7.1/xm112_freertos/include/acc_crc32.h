@@ -0,0 +1,61 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_CRC32_H_
+#define ACC_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Initial value of a CRC-32 calculation
+ */
+#define ACC_CRC32_INIT 0xFFFFFFFFU
+
+
+/**
+ * @brief Update a CRC-32 (IEEE 802.3, as used by zlib) with more data
+ *
+ * Start with ACC_CRC32_INIT and finish with acc_crc32_final, or use acc_crc32
+ * for data in one piece.
+ *
+ * @param[in] crc The CRC so far
+ * @param[in] data The data
+ * @param[in] size The number of bytes
+ * @return The updated CRC
+ */
+uint32_t acc_crc32_update(uint32_t crc, const void *data, size_t size);
+
+
+/**
+ * @brief Finish a CRC-32 calculation
+ *
+ * @param[in] crc The CRC from acc_crc32_update
+ * @return The CRC-32 of the data
+ */
+uint32_t acc_crc32_final(uint32_t crc);
+
+
+/**
+ * @brief Calculate the CRC-32 of data
+ *
+ * @param[in] data The data
+ * @param[in] size The number of bytes
+ * @return The CRC-32 of the data
+ */
+uint32_t acc_crc32(const void *data, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -120,6 +120,18 @@ acc_app_integration_thread_id_t acc_os_get_thread_id(void);
 uint32_t acc_os_get_time(void);
 
 
+/**
+ * @brief Get the time of a free-running microsecond counter
+ *
+ * The counter is not synchronized with acc_os_get_time and is only available
+ * if a driver has registered it.
+ *
+ * @param[out] time_us Time in microseconds
+ * @return True if a microsecond counter is available, false otherwise
+ */
+bool acc_os_get_time_us(uint64_t *time_us);
+
+
 /**
  * @brief Create a mutex
  *
@@ -21,6 +21,15 @@ extern "C" {
 #define ACC_DEVICE_SPI_BUS_MAX	2
 
 
+/**
+ * @brief Number of bins in the transfer duration histogram
+ *
+ * Bin 0 counts transfers shorter than 2 us, bin n counts transfers of [2^n, 2^(n+1)) us
+ * and the last bin also counts all longer transfers.
+ */
+#define ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS	16
+
+
 typedef struct {
 	uint8_t  bus;
 	uint8_t  device;
@@ -38,6 +47,44 @@ typedef enum {
 typedef uint32_t acc_device_spi_transfer_status_t;
 
 
+/**
+ * @brief One part of a scatter-gather transfer
+ */
+typedef struct {
+	/** The data to be transferred, received data is written back to the same memory */
+	uint8_t *buffer;
+	/** The size of the buffer in bytes */
+	size_t  buffer_size;
+} acc_device_spi_segment_t;
+
+
+/**
+ * @brief Telemetry counters for one SPI bus
+ */
+typedef struct {
+	/** Number of bytes transferred */
+	uint64_t bytes;
+	/** Number of transfers, asynchronous transfers included */
+	uint32_t transfer_count;
+	/** Number of transfers the driver had to split into several DMA transfers */
+	uint32_t chunked_transfer_count;
+	/** Number of DMA transfers used by the chunked transfers */
+	uint32_t chunk_count;
+	/** Total duration of the transfers in microseconds */
+	uint64_t transfer_time_us;
+	/** Longest transfer in microseconds */
+	uint32_t transfer_time_max_us;
+	/** Log2 histogram of transfer durations */
+	uint32_t transfer_time_histogram[ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS];
+	/** Number of calls to acc_device_spi_lock */
+	uint32_t lock_count;
+	/** Total time spent waiting in acc_device_spi_lock in microseconds */
+	uint64_t lock_wait_time_us;
+	/** Longest wait in acc_device_spi_lock in microseconds */
+	uint32_t lock_wait_time_max_us;
+} acc_device_spi_telemetry_t;
+
+
 /**
  * @brief Function that will be called when acc_device_spi_transfer_async is done
  *
@@ -54,6 +101,20 @@ extern void			(*acc_device_spi_destroy_func)(acc_device_handle_t *handle);
 extern bool		(*acc_device_spi_transfer_func)(acc_device_handle_t handle, uint8_t *buffer, size_t buffer_size);
 extern bool		(*acc_device_spi_transfer_async_func)(acc_device_handle_t handle, uint8_t *buffer, bool rx, bool tx, size_t buffer_size, acc_device_spi_transfer_callback_t callback);
 extern uint8_t			(*acc_device_spi_get_bus_func)(acc_device_handle_t);
+extern bool		(*acc_device_spi_transfer_segments_func)(acc_device_handle_t handle, const acc_device_spi_segment_t *segments, size_t segment_count);
+extern bool		(*acc_device_spi_transfer_abort_func)(acc_device_handle_t handle);
+extern uint32_t		(*acc_device_spi_telemetry_get_time_us_func)(void);
+
+
+/**
+ * @brief Report that a transfer was split into several DMA transfers
+ *
+ * To be used by drivers only, ignored unless telemetry is enabled.
+ *
+ * @param bus The SPI bus
+ * @param chunk_count The number of DMA transfers used
+ */
+extern void acc_device_spi_telemetry_chunks_record(uint_fast8_t bus, uint32_t chunk_count);
 
 
 /**
@@ -118,6 +179,21 @@ extern size_t acc_device_spi_get_max_transfer_size(void);
 extern bool acc_device_spi_transfer(acc_device_handle_t handle, uint8_t *buffer, size_t buffer_size);
 
 
+/**
+ * @brief Scatter-gather data transfer (SPI)
+ *
+ * All segments are transferred as one SPI transfer, chip select is kept asserted
+ * between the segments. Drivers program all segments at once when the hardware
+ * supports it.
+ *
+ * @param handle SPI device handle
+ * @param segments The segments to be transferred, in order
+ * @param segment_count The number of segments
+ * @return Status
+ */
+extern bool acc_device_spi_transfer_segments(acc_device_handle_t handle, const acc_device_spi_segment_t *segments, size_t segment_count);
+
+
 /**
  * @brief Data transfer (SPI)
  *
@@ -132,6 +208,59 @@ extern bool acc_device_spi_transfer(acc_device_handle_t handle, uint8_t *buffer,
  */
 extern bool acc_device_spi_transfer_async(acc_device_handle_t handle, uint8_t *buffer, bool rx, bool tx, size_t buffer_size, acc_device_spi_transfer_callback_t callback);
 
+
+/**
+ * @brief Abort an asynchronous transfer
+ *
+ * The callback of the transfer is not called. The buffer of the transfer is not
+ * accessed by the driver once this function returns.
+ *
+ * @param handle SPI device handle
+ * @return True if a transfer was aborted, false if no transfer was ongoing
+ */
+extern bool acc_device_spi_transfer_abort(acc_device_handle_t handle);
+
+
+
+/**
+ * @brief Enable or disable SPI telemetry
+ *
+ * Telemetry is disabled by default. Durations are measured with the time source
+ * registered in acc_device_spi_telemetry_get_time_us_func if any, otherwise with
+ * the millisecond OS time which puts all short transfers in the first bin.
+ *
+ * @param enable True to enable telemetry, false to disable it
+ */
+extern void acc_device_spi_telemetry_enable(bool enable);
+
+
+/**
+ * @brief Get a snapshot of the telemetry counters of a bus
+ *
+ * The counters are updated without locking, a snapshot taken during a transfer
+ * may include parts of that transfer.
+ *
+ * @param bus The SPI bus
+ * @param[out] telemetry The counters
+ * @param reset True to reset the counters after reading them
+ * @return True if successful, false otherwise
+ */
+extern bool acc_device_spi_telemetry_get(uint_fast8_t bus, acc_device_spi_telemetry_t *telemetry, bool reset);
+
+
+/**
+ * @brief Reset the telemetry counters of all buses
+ */
+extern void acc_device_spi_telemetry_reset(void);
+
+
+/**
+ * @brief Print the telemetry counters of a bus through the log
+ *
+ * @param bus The SPI bus
+ */
+extern void acc_device_spi_telemetry_log(uint_fast8_t bus);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,7 +17,10 @@ extern "C" {
 #endif
 
 
-#define ACC_DEVICE_UART_MAX	4
+/**
+ * @brief The highest port number, ports after the UARTs of the chip are virtual, e.g. USB CDC
+ */
+#define ACC_DEVICE_UART_MAX	5
 
 
 /**
@@ -33,12 +36,20 @@ typedef uint32_t acc_device_uart_options_t;
 
 typedef void (acc_device_uart_read_func_t)(uint_fast8_t port, uint8_t data, uint32_t status);
 
+/**
+ * @brief Called from interrupt context when data arrives on an idle line in block read mode
+ */
+typedef void (acc_device_uart_rx_event_func_t)(uint_fast8_t port);
+
 // These functions are to be used by drivers only, do not use them directly
 extern bool	(*acc_device_uart_init_func)(uint_fast8_t port, uint32_t baudrate, acc_device_uart_options_t options);
 extern bool	(*acc_device_uart_write_func)(uint_fast8_t port, const uint8_t *data, size_t length);
 extern void		(*acc_device_uart_register_read_func)(uint_fast8_t port, acc_device_uart_read_func_t *callback);
 extern int32_t (*acc_device_uart_get_error_count_func)(uint_fast8_t port);
 extern void    (*acc_device_uart_deinit_func)(uint_fast8_t port);
+extern bool    (*acc_device_uart_block_read_start_func)(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event);
+extern size_t  (*acc_device_uart_block_read_func)(uint_fast8_t port, uint8_t *data, size_t max_length);
+extern uint32_t (*acc_device_uart_get_max_baudrate_func)(uint_fast8_t port);
 
 
 /**
@@ -88,6 +99,48 @@ extern bool acc_device_uart_write_buffer(
  */
 extern void acc_device_uart_register_read_callback(uint_fast8_t port, acc_device_uart_read_func_t *callback);
 
+/**
+ * @brief Start receiving in blocks instead of one callback per byte
+ *
+ * Received data is written by DMA to a circular buffer. The event callback is
+ * called for the first byte after the line has been idle, after that no
+ * interrupts are taken until acc_device_uart_block_read finds no new data.
+ * The buffer must hold the data received between two reads.
+ *
+ * @param port        The UART port
+ * @param buffer_size The size of the circular buffer
+ * @param event       Called from interrupt context when data starts arriving
+ * @return True if successful, false if not supported or the port already receives
+ */
+extern bool acc_device_uart_block_read_start(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event);
+
+
+/**
+ * @brief Read the data received since the last call in block read mode
+ *
+ * Must not be called from interrupt context. When no new data has been
+ * received the event callback is enabled again and 0 is returned.
+ *
+ * @param port       The UART port
+ * @param data       Memory for the data
+ * @param max_length The size of data
+ * @return The number of bytes read
+ */
+extern size_t acc_device_uart_block_read(uint_fast8_t port, uint8_t *data, size_t max_length);
+
+
+/**
+ * @brief Get the highest baudrate of a UART
+ *
+ * The baudrate generator divides the highest baudrate by an integer, so the
+ * baudrates a UART can use exactly are the highest baudrate divided by 1, 2, 3 and so on.
+ *
+ * @param port The UART port
+ * @return The highest baudrate, 0 if not known
+ */
+extern uint32_t acc_device_uart_get_max_baudrate(uint_fast8_t port);
+
+
 /**
  * @brief Get the error count, typically overrun errors when receiving data
  * @param port the UART port
@@ -21,6 +21,7 @@ extern void                                *(*acc_device_os_mem_alloc_func)(size
 extern void                                (*acc_device_os_mem_free_func)(void *);
 extern acc_app_integration_thread_id_t     (*acc_device_os_get_thread_id_func)(void);
 extern uint32_t                            (*acc_device_os_get_time_func)(void);
+extern uint64_t                            (*acc_device_os_get_time_us_func)(void);
 extern acc_app_integration_mutex_t         (*acc_device_os_mutex_create_func)(void);
 extern void                                (*acc_device_os_mutex_lock_func)(acc_app_integration_mutex_t mutex);
 extern void                                (*acc_device_os_mutex_unlock_func)(acc_app_integration_mutex_t mutex);
@@ -0,0 +1,72 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_DRIVER_SPI_CHUNK_H_
+#define ACC_DRIVER_SPI_CHUNK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Limits used when splitting a transfer into DMA chunks
+ */
+typedef struct
+{
+	/** Size of the bounce buffer, a multiple of alignment */
+	size_t bounce_buffer_size;
+	/** Cache line size, data transferred in place must start and end on a multiple of this */
+	size_t alignment;
+	/** Largest chunk transferred in place, 0 to always use the bounce buffer */
+	size_t direct_max_size;
+} acc_driver_spi_chunk_limits_t;
+
+
+/**
+ * @brief A part of a transfer that is handled by one DMA transfer
+ */
+typedef struct
+{
+	/** Offset of the chunk in the transfer buffer */
+	size_t offset;
+	/** Size of the chunk */
+	size_t size;
+	/** True if DMA is done directly on the transfer buffer, false if the bounce buffer is used */
+	bool   direct;
+} acc_driver_spi_chunk_t;
+
+
+/**
+ * @brief Get the next chunk of a transfer
+ *
+ * Whole cache lines of the transfer buffer are transferred in place so that cache
+ * maintenance never touches memory outside the buffer. A misaligned head and tail,
+ * and transfers too small to contain a whole cache line, go through the bounce buffer.
+ *
+ * The function has no side effects and does not access the buffer.
+ *
+ * @param[in] buffer_address Address of the transfer buffer
+ * @param[in] buffer_size Size of the transfer buffer
+ * @param[in] offset Number of bytes already transferred, less than buffer_size
+ * @param[in] limits The chunk limits
+ * @return The next chunk
+ */
+acc_driver_spi_chunk_t acc_driver_spi_chunk_next(uintptr_t                           buffer_address,
+                                                 size_t                              buffer_size,
+                                                 size_t                              offset,
+                                                 const acc_driver_spi_chunk_limits_t *limits);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
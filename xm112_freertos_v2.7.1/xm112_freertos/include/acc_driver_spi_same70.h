@@ -11,6 +11,11 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_device.h"
 #include "pio.h"
 
 typedef struct
@@ -19,8 +24,31 @@ typedef struct
 	struct _pin spi_mosi;
 	struct _pin spi_clk;
 	struct _pin spi_npcs;
+	/**
+	 * Run DMA directly on the cache line aligned part of the transfer buffer instead
+	 * of copying all data through the driver buffer
+	 */
+	bool        zero_copy;
 } acc_driver_spi_same70_config_t;
 
+/**
+ * @brief Number of bytes transferred per path on a bus since creation or last reset
+ */
+typedef struct
+{
+	/** Bytes transferred in place in the caller's buffer */
+	uint64_t direct_bytes;
+	/** Bytes copied through the driver buffer */
+	uint64_t bounced_bytes;
+	/** Number of blocking transfers */
+	uint32_t transfer_count;
+	/**
+	 * Total time of the blocking transfers. Each transfer is measured with the
+	 * millisecond OS time, the sum over many transfers gives the average time.
+	 */
+	uint32_t transfer_time_ms;
+} acc_driver_spi_same70_statistics_t;
+
 /**
  * @brief Function called by driver to wait for transfer complete.
  *
@@ -41,8 +69,44 @@ typedef void (*wait_for_transfer_complete_t)(acc_device_handle_t dev_handle);
  */
 typedef void (*transfer_complete_callback_t)(acc_device_handle_t dev_handle);
 
+/**
+ * @brief Get transfer statistics for the bus of a SPI device
+ *
+ * The statistics are shared by all devices on the same bus. They are read, and
+ * reset, with the DMA interrupt masked so that an asynchronous transfer
+ * completing meanwhile can't tear the counters.
+ *
+ * @param[in] dev_handle The device handle
+ * @param[out] statistics The statistics
+ * @param[in] reset True to reset the statistics after reading them
+ */
+void acc_driver_spi_same70_statistics_get(acc_device_handle_t dev_handle, acc_driver_spi_same70_statistics_t *statistics, bool reset);
+
+/**
+ * @brief Change the size of the driver buffer of the bus of a SPI device
+ *
+ * Transfers larger than the driver buffer are split into several DMA transfers
+ * unless they can be made in place. Without zero copy, the maximum transfer size
+ * reported through acc_device_spi_get_max_transfer_size() follows the new size, so
+ * RSS must be activated again for it to take effect. With zero copy, the reported
+ * size is the DMA block limit, about 16 MB: any transfer up to it goes in one DMA
+ * linked list, and only its misaligned head and tail, less than a cache line each,
+ * go through the driver buffer. Must not be called during a transfer on the bus.
+ *
+ * @param[in] dev_handle The device handle
+ * @param[in] buffer_size The new buffer size in bytes, rounded up to whole cache lines
+ * @return True if successful, false if the buffer could not be allocated. The
+ *         previous buffer is kept on failure.
+ */
+bool acc_driver_spi_same70_buffer_size_set(acc_device_handle_t dev_handle, size_t buffer_size);
+
 /**
  * @brief Request driver to register with appropriate device(s)
+ *
+ * One device can be created per bus and chip select. Devices on the same bus share
+ * the SPI peripheral and the transfer buffers, and the bus must be locked with
+ * acc_device_spi_lock() around transfers. Devices on different buses can transfer
+ * concurrently.
  */
 extern void acc_driver_spi_same70_register(wait_for_transfer_complete_t wait_function,
                                            transfer_complete_callback_t transfer_complete);
@@ -0,0 +1,24 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_DRIVER_TIMESTAMP_SAME70_H_
+#define ACC_DRIVER_TIMESTAMP_SAME70_H_
+
+#include <stdbool.h>
+
+
+/**
+ * @brief Start the microsecond counter and register it with appropriate device(s)
+ *
+ * The counter uses the three channels of TC3 and PCK6. It runs from the main
+ * clock and does not use any interrupts, but it stops in wait mode.
+ *
+ * @return True if successful, false if the main clock is not a multiple of 1 MHz
+ */
+extern bool acc_driver_timestamp_same70_register(void);
+
+
+#endif
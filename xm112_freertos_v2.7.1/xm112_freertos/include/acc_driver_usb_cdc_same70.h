@@ -0,0 +1,153 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_DRIVER_USB_CDC_SAME70_H_
+#define ACC_DRIVER_USB_CDC_SAME70_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_device_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief USB CDC ACM (virtual COM port) on the USBHS controller of SAME70
+ *
+ * The read and write functions work like the acc_device_uart functions for
+ * one port. The port number given to the read callbacks is always
+ * ACC_DRIVER_USB_CDC_SAME70_PORT. The baudrate set by the host is ignored,
+ * the data moves at the USB speed, 480 Mbit/s when the host supports high speed.
+ *
+ * acc_driver_usb_cdc_same70_register adds the port to acc_device_uart. Build
+ * with "make ACC_CFG_USB_CDC=1" to include the driver and the USBHS HAL.
+ */
+
+
+/**
+ * @brief The acc_device_uart port of the virtual COM port, after the UARTs of the chip
+ */
+#define ACC_DRIVER_USB_CDC_SAME70_PORT ACC_DEVICE_UART_MAX
+
+/**
+ * @brief The largest write with a header, the USB DMA can only chain the header to one transfer
+ */
+#define ACC_DRIVER_USB_CDC_SAME70_HEADER_WRITE_MAX_SIZE 32768U
+
+
+/**
+ * @brief Called from interrupt context when an asynchronous write has completed
+ *
+ * @param[in] success True if all data was sent, false if the transfer was aborted by a bus reset or disconnect
+ * @param[in] client_reference The client reference given to the write function
+ */
+typedef void (acc_driver_usb_cdc_same70_write_done_func_t)(bool success, void *client_reference);
+
+
+/**
+ * @brief Request driver to register with appropriate device(s)
+ *
+ * Adds ACC_DRIVER_USB_CDC_SAME70_PORT to acc_device_uart, all other ports go
+ * to the UART driver registered before, so call it after that driver.
+ * acc_device_uart_init on the port calls acc_driver_usb_cdc_same70_init.
+ */
+extern void acc_driver_usb_cdc_same70_register(void);
+
+
+/**
+ * @brief Start the USB controller and connect to the host
+ *
+ * Needs the UPLL, which is started if needed.
+ *
+ * @return True if successful
+ */
+extern bool acc_driver_usb_cdc_same70_init(void);
+
+
+/**
+ * @brief Check if a host has opened the port
+ *
+ * @return True if the device is configured and the host has set DTR
+ */
+extern bool acc_driver_usb_cdc_same70_is_connected(void);
+
+
+/**
+ * @brief Send data and wait until it has been sent
+ *
+ * Fails without writing if the host has not opened the port, or if another
+ * write is ongoing. A write that the host does not read within the timeout
+ * is aborted.
+ *
+ * @param[in] buffer The data
+ * @param[in] buffer_size The size of the data
+ * @return True if successful
+ */
+extern bool acc_driver_usb_cdc_same70_write_buffer(const void *buffer, size_t buffer_size);
+
+
+/**
+ * @brief Start sending data without copying it
+ *
+ * The data is read by DMA directly from header and data, which must be kept
+ * until the done callback has been called. The header, if any, and the data
+ * are sent as one transfer.
+ *
+ * @param[in] header Data to send before the data, NULL if header_size is 0
+ * @param[in] header_size The size of the header, the total size is then at most ACC_DRIVER_USB_CDC_SAME70_HEADER_WRITE_MAX_SIZE
+ * @param[in] data The data
+ * @param[in] data_size The size of the data
+ * @param[in] done Called from interrupt context when the write has completed, may be NULL
+ * @param[in] client_reference Passed to done
+ * @return True if the write was started, false if the device is not configured or another write is ongoing
+ */
+extern bool acc_driver_usb_cdc_same70_write_async(const void *header, size_t header_size, const void *data,
+                                                  size_t data_size, acc_driver_usb_cdc_same70_write_done_func_t *done,
+                                                  void *client_reference);
+
+
+/**
+ * @brief Register a callback called from interrupt context for every received byte
+ *
+ * @param[in] callback The callback, NULL to stop receiving
+ */
+extern void acc_driver_usb_cdc_same70_register_read_callback(acc_device_uart_read_func_t *callback);
+
+
+/**
+ * @brief Start receiving in blocks instead of one callback per byte
+ *
+ * Works like acc_device_uart_block_read_start. When the buffer is full the
+ * host is held off by the USB flow control, no data is lost.
+ *
+ * @param[in] buffer_size The size of the receive buffer
+ * @param[in] event Called from interrupt context when data arrives and the previous read returned 0
+ * @return True if successful
+ */
+extern bool acc_driver_usb_cdc_same70_block_read_start(size_t buffer_size, acc_device_uart_rx_event_func_t *event);
+
+
+/**
+ * @brief Read the data received since the last call in block read mode
+ *
+ * Must not be called from interrupt context.
+ *
+ * @param[out] data Memory for the data
+ * @param[in] max_length The size of data
+ * @return The number of bytes read
+ */
+extern size_t acc_driver_usb_cdc_same70_block_read(uint8_t *data, size_t max_length);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
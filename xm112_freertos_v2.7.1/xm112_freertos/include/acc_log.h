@@ -8,13 +8,33 @@
 #define ACC_LOG_H_
 
 #include "acc_hal_definitions.h"
+#include "acc_log_filter.h"
 #include "acc_log_integration.h"
 
 #ifdef ACC_LOG_RSS_H_
 #error "acc_log.h and acc_log_rss.h cannot coexist"
 #endif
 
-#define ACC_LOG(level, ...) (level > ACC_LOG_LEVEL_INFO) ? (void)(0) : acc_log(level, MODULE, __VA_ARGS__)
+/**
+ * @brief Log a message from MODULE
+ *
+ * Calls above ACC_LOG_LEVEL_MAX are removed by the compiler. Calls above
+ * acc_log_level_limit are rejected before the arguments are evaluated. The
+ * level of the module is checked once, in acc_log.
+ */
+#define ACC_LOG(level, ...) \
+	(((level) > ACC_LOG_LEVEL_MAX) || ((level) > acc_log_level_limit)) ? \
+	(void)(0) : acc_log(level, MODULE, __VA_ARGS__)
+
+/**
+ * @brief Log a message from MODULE without rate limiting
+ *
+ * For long reports that are asked for, such as allocation dumps, which the
+ * rate limit would otherwise cut off. Filtered by level like ACC_LOG.
+ */
+#define ACC_LOG_UNLIMITED(level, ...) \
+	(((level) > ACC_LOG_LEVEL_MAX) || ((level) > acc_log_level_limit)) ? \
+	(void)(0) : acc_log_unlimited(level, MODULE, __VA_ARGS__)
 
 #define ACC_LOG_ERROR(...)   ACC_LOG(ACC_LOG_LEVEL_ERROR, __VA_ARGS__)
 #define ACC_LOG_WARNING(...) ACC_LOG(ACC_LOG_LEVEL_WARNING, __VA_ARGS__)
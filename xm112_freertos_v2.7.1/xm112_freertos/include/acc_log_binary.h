@@ -0,0 +1,194 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_LOG_BINARY_H_
+#define ACC_LOG_BINARY_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_hal_definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief First byte of a binary log record, never part of ASCII log text
+ */
+#define ACC_LOG_BINARY_SYNC_0 0xAC
+
+/**
+ * @brief Second byte of a binary log record
+ */
+#define ACC_LOG_BINARY_SYNC_1 0xC1
+
+/**
+ * @brief Largest size of a record, longer records are truncated
+ */
+#define ACC_LOG_BINARY_RECORD_MAX_SIZE 256
+
+/**
+ * @brief Largest number of bytes copied from a string argument
+ */
+#define ACC_LOG_BINARY_STRING_MAX_LENGTH 64
+
+
+/**
+ * @brief Binary log record header
+ *
+ * All fields are little endian. The format and module fields hold the
+ * addresses of the format string and the module name in the application
+ * image, they are looked up in the log dictionary by the decoder.
+ *
+ * The header is followed by the arguments in format string order. Integers
+ * of int size and smaller take 4 bytes, wider integers, pointers and
+ * floating point arguments take 8 bytes. Strings are copied as a 2 byte
+ * length and the characters, padded to a multiple of 4 bytes.
+ */
+typedef struct
+{
+	uint8_t  sync[2];
+	uint16_t length;
+	uint8_t  level;
+	uint8_t  reserved[3];
+	uint32_t time_ms;
+	uint32_t thread_id;
+	uint64_t format;
+	uint64_t module;
+} acc_log_binary_header_t;
+
+
+/**
+ * @brief Size of the argument of a conversion in a binary log record
+ */
+typedef enum
+{
+	/** The conversion takes no argument */
+	ACC_LOG_BINARY_ARG_NONE,
+	/** An integer of int size or smaller, 4 bytes */
+	ACC_LOG_BINARY_ARG_INT,
+	/** An integer wider than int, 8 bytes */
+	ACC_LOG_BINARY_ARG_LONG,
+	/** A floating point argument, 8 bytes */
+	ACC_LOG_BINARY_ARG_DOUBLE,
+	/** A pointer, 8 bytes */
+	ACC_LOG_BINARY_ARG_POINTER,
+	/** A string, copied */
+	ACC_LOG_BINARY_ARG_STRING,
+} acc_log_binary_arg_enum_t;
+typedef uint32_t acc_log_binary_arg_t;
+
+
+/**
+ * @brief Length modifier of a conversion
+ */
+typedef enum
+{
+	ACC_LOG_BINARY_LENGTH_NONE,
+	ACC_LOG_BINARY_LENGTH_HH,
+	ACC_LOG_BINARY_LENGTH_H,
+	ACC_LOG_BINARY_LENGTH_L,
+	ACC_LOG_BINARY_LENGTH_LL,
+	ACC_LOG_BINARY_LENGTH_J,
+	ACC_LOG_BINARY_LENGTH_Z,
+	ACC_LOG_BINARY_LENGTH_T,
+	ACC_LOG_BINARY_LENGTH_BIG_L,
+} acc_log_binary_length_enum_t;
+typedef uint32_t acc_log_binary_length_t;
+
+
+/**
+ * @brief A conversion specification in a format string
+ */
+typedef struct
+{
+	/** The '%' that starts the conversion */
+	const char              *start;
+	/** The number of characters in the conversion */
+	size_t                  size;
+	/** The conversion character */
+	char                    conversion;
+	/** The length modifier */
+	acc_log_binary_length_t length;
+	/** The argument of the conversion */
+	acc_log_binary_arg_t    arg;
+	/** True if the conversion is signed */
+	bool                    is_signed;
+	/** True if the width is an int argument, '*' */
+	bool                    width_arg;
+	/** True if the precision is an int argument, '.*' */
+	bool                    precision_arg;
+} acc_log_binary_conversion_t;
+
+
+/**
+ * @brief Enable or disable binary logging
+ *
+ * When enabled, acc_log writes binary records instead of text. The records
+ * hold only the addresses of the format string and the module name, so the
+ * log is decoded on the host with the log dictionary made at build time.
+ *
+ * @param[in] enable True to enable binary logging
+ */
+void acc_log_binary_enable(bool enable);
+
+
+/**
+ * @brief Check if binary logging is enabled
+ *
+ * @return True if binary logging is enabled
+ */
+bool acc_log_binary_is_enabled(void);
+
+
+/**
+ * @brief Write a binary log record
+ *
+ * @param[in] level The log level
+ * @param[in] module The module name
+ * @param[in] format The format string
+ * @param[in] ap The arguments
+ */
+void acc_log_binary_write(acc_log_level_t level, const char *module, const char *format, va_list ap);
+
+
+/**
+ * @brief Encode a binary log record
+ *
+ * @param[out] record Memory for the record, ACC_LOG_BINARY_RECORD_MAX_SIZE bytes
+ * @param[in] level The log level
+ * @param[in] time_ms The time stamp
+ * @param[in] thread_id The thread id
+ * @param[in] module The module name
+ * @param[in] format The format string
+ * @param[in] ap The arguments
+ * @return The size of the record
+ */
+size_t acc_log_binary_encode(uint8_t *record, acc_log_level_t level, uint32_t time_ms, uint32_t thread_id,
+                             const char *module, const char *format, va_list ap);
+
+
+/**
+ * @brief Find the next conversion in a format string
+ *
+ * Used both when encoding and decoding so the two agree on the arguments.
+ *
+ * @param[in, out] format The format string, moved past the conversion
+ * @param[out] conversion The conversion
+ * @return True if a conversion was found, false at the end of the format string
+ */
+bool acc_log_binary_next_conversion(const char **format, acc_log_binary_conversion_t *conversion);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
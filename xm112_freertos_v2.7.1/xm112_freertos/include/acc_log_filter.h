@@ -0,0 +1,121 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_LOG_FILTER_H_
+#define ACC_LOG_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acc_hal_definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Highest log level compiled in
+ *
+ * Log calls above this level compile to nothing, arguments included. Set with
+ * ACC_CFG_LOG_LEVEL_MAX when building, e.g.
+ * "make ACC_CFG_LOG_LEVEL_MAX=ACC_LOG_LEVEL_VERBOSE".
+ */
+#ifndef ACC_LOG_LEVEL_MAX
+#define ACC_LOG_LEVEL_MAX ACC_LOG_LEVEL_INFO
+#endif
+
+/**
+ * @brief Largest number of modules with their own log level
+ */
+#define ACC_LOG_MODULE_LEVEL_MAX_COUNT 8
+
+/**
+ * @brief Largest number of modules that are rate limited separately
+ */
+#define ACC_LOG_RATE_LIMIT_MODULE_MAX_COUNT 16
+
+
+/**
+ * @brief The highest log level enabled for any module
+ *
+ * Read by the ACC_LOG macros so that most disabled calls are rejected without
+ * a function call. Change it with acc_log_level_set and acc_log_module_level_set.
+ */
+extern acc_log_level_t acc_log_level_limit;
+
+
+/**
+ * @brief Set the log level of all modules without a level of their own
+ *
+ * RSS filters its own calls by the level in the HAL, which is
+ * acc_log_level_limit when acc_driver_hal_get_implementation is called. A
+ * lower level also applies to RSS at once, since its calls pass through
+ * acc_log. A higher level only reaches RSS when it is activated again with a
+ * new HAL.
+ *
+ * @param[in] level The highest level logged
+ */
+void acc_log_level_set(acc_log_level_t level);
+
+
+/**
+ * @brief Set the log level of a module
+ *
+ * The level may be higher or lower than the level of other modules. The level
+ * can't enable calls above ACC_LOG_LEVEL_MAX, they are not compiled in.
+ *
+ * @param[in] module The module name, must be valid while the level is set
+ * @param[in] level The highest level logged by the module
+ * @return True if successful, false if too many modules have their own level
+ */
+bool acc_log_module_level_set(const char *module, acc_log_level_t level);
+
+
+/**
+ * @brief Remove the log levels of all modules, all use the level from acc_log_level_set
+ */
+void acc_log_module_level_reset(void);
+
+
+/**
+ * @brief Check if a log call is enabled
+ *
+ * @param[in] level The level of the call
+ * @param[in] module The module name
+ * @return True if the call should be logged
+ */
+bool acc_log_is_enabled(acc_log_level_t level, const char *module);
+
+
+/**
+ * @brief Set the log rate limit
+ *
+ * Each module may log burst messages at once and then messages_per_second
+ * messages per second. Messages over the limit are dropped and counted, the
+ * count is logged with the next message that is let through.
+ *
+ * @param[in] burst The number of messages a module may log at once, 0 to disable rate limiting
+ * @param[in] messages_per_second The number of messages per second a module may log over time
+ */
+void acc_log_rate_limit_set(uint32_t burst, uint32_t messages_per_second);
+
+
+/**
+ * @brief Check the rate limit of a module before logging
+ *
+ * @param[in] module The module name
+ * @param[out] suppressed The number of messages dropped since the last message let through
+ * @return True if the message should be logged
+ */
+bool acc_log_rate_limit_check(const char *module, uint32_t *suppressed);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
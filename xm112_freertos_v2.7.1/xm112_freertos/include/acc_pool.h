@@ -0,0 +1,127 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_POOL_H_
+#define ACC_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Pool of fixed size objects with the capacity set at compile time
+ *
+ * A bitmap tells which objects are in use. Objects are taken and returned
+ * with atomic operations on the bitmap, so the pool needs no lock and may be
+ * used from interrupt context. Allocation takes at most one scan of the
+ * bitmap, which is one word for pools of up to 32 objects.
+ *
+ * A pool is defined with ACC_POOL_DEFINE, which reserves the objects as a
+ * static array of the object type:
+ *
+ *   ACC_POOL_DEFINE(event_pool, event_t, 8);
+ *
+ *   event_t *event = acc_pool_alloc(&event_pool);
+ *   ...
+ *   acc_pool_free(&event_pool, event);
+ */
+
+
+#define ACC_POOL_BITMAP_WORDS(capacity) (((capacity) + 31U) / 32U)
+
+
+/**
+ * @brief A pool, the members are private
+ */
+typedef struct
+{
+	const char *name;
+	uint8_t    *objects;
+	size_t     object_size;
+	uint32_t   capacity;
+	uint32_t   *used_bitmap;
+	uint32_t   in_use;
+	uint32_t   peak;
+	uint32_t   exhausted_count;
+} acc_pool_t;
+
+
+typedef struct
+{
+	const char *name;
+	uint32_t   capacity;
+	uint32_t   in_use;
+	/** Highest number of objects in use at the same time */
+	uint32_t   peak;
+	/** Allocations that failed because all objects were in use */
+	uint32_t   exhausted_count;
+} acc_pool_stats_t;
+
+
+/**
+ * @brief Define a static pool of capacity objects of a type
+ *
+ * @param name The name of the pool variable
+ * @param type The object type
+ * @param capacity The number of objects
+ */
+#define ACC_POOL_DEFINE(name, type, capacity) \
+	static type     name ## _objects[capacity]; \
+	static uint32_t name ## _used_bitmap[ACC_POOL_BITMAP_WORDS(capacity)]; \
+	static acc_pool_t name = { #name, (uint8_t *)name ## _objects, sizeof(type), (capacity), name ## _used_bitmap, 0U, 0U, 0U }
+
+
+/**
+ * @brief Take an object from a pool
+ *
+ * The object is not cleared.
+ *
+ * @param[in] pool The pool
+ * @return The object, NULL if all objects are in use
+ */
+void *acc_pool_alloc(acc_pool_t *pool);
+
+
+/**
+ * @brief Return an object to a pool
+ *
+ * @param[in] pool The pool
+ * @param[in] object An object from acc_pool_alloc of the same pool, or NULL
+ */
+void acc_pool_free(acc_pool_t *pool, void *object);
+
+
+/**
+ * @brief Check if memory is an object of a pool
+ *
+ * Can be used to tell pool objects from objects allocated elsewhere when a pool is exhausted.
+ *
+ * @param[in] pool The pool
+ * @param[in] object The memory
+ * @return True if object is in the pool
+ */
+bool acc_pool_contains(const acc_pool_t *pool, const void *object);
+
+
+/**
+ * @brief Get the occupancy of a pool
+ *
+ * @param[in] pool The pool
+ * @param[out] stats The statistics
+ */
+void acc_pool_get_stats(const acc_pool_t *pool, acc_pool_stats_t *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_RECORDING_H_
+#define ACC_RECORDING_H_
+
+#include <stdint.h>
+
+/**
+ * @defgroup Recording Sweep Recording Format
+ *
+ * @brief Binary container for service data
+ *
+ * A recording is a file header followed by frame records of equal size:
+ *
+ * | Offset                                    | Content                        |
+ * |-------------------------------------------|--------------------------------|
+ * | 0                                         | acc_recording_header_t         |
+ * | header_size + n * frame_record_size       | acc_recording_frame_header_t   |
+ * | ... + sizeof(acc_recording_frame_header_t) | data_length * sample_size bytes |
+ *
+ * Frame records are padded to a multiple of 8 bytes so that every payload is aligned
+ * when the file is memory mapped, and frame n can be located without parsing the
+ * frames before it. A recording that was cut off ends with the last complete frame.
+ *
+ * All fields are little endian and the header size is a multiple of 8 bytes. New fields
+ * are only added at the end of the header, readers use header_size to find the first frame.
+ *
+ * @{
+ */
+
+
+#define ACC_RECORDING_MAGIC   0x52434341U // "ACCR"
+#define ACC_RECORDING_VERSION 1U
+
+#define ACC_RECORDING_FRAME_ALIGNMENT 8U
+
+
+/**
+ * @brief The service that produced the data
+ */
+typedef enum
+{
+	ACC_RECORDING_SERVICE_TYPE_ENVELOPE   = 1,
+	ACC_RECORDING_SERVICE_TYPE_IQ         = 2,
+	ACC_RECORDING_SERVICE_TYPE_SPARSE     = 3,
+	ACC_RECORDING_SERVICE_TYPE_POWER_BINS = 4,
+} acc_recording_service_type_enum_t;
+typedef uint32_t acc_recording_service_type_t;
+
+
+/**
+ * @brief Flags in acc_recording_frame_header_t, mirrors the service result info
+ */
+#define ACC_RECORDING_RESULT_INFO_MISSED_DATA                (1U << 0)
+#define ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR (1U << 1)
+#define ACC_RECORDING_RESULT_INFO_DATA_SATURATED             (1U << 2)
+#define ACC_RECORDING_RESULT_INFO_DATA_QUALITY_WARNING       (1U << 3)
+
+
+/**
+ * @brief Flags in acc_recording_configuration_t
+ */
+#define ACC_RECORDING_CONFIGURATION_TX_DISABLE                  (1U << 0)
+#define ACC_RECORDING_CONFIGURATION_ASYNCHRONOUS_MEASUREMENT    (1U << 1)
+#define ACC_RECORDING_CONFIGURATION_MAXIMIZE_SIGNAL_ATTENUATION (1U << 2)
+#define ACC_RECORDING_CONFIGURATION_NOISE_LEVEL_NORMALIZATION   (1U << 3)
+
+
+/**
+ * @brief Service metadata, the union of the acc_service_*_metadata_t fields
+ */
+typedef struct
+{
+	float    start_m;
+	float    length_m;
+	float    step_length_m;
+	/** Sparse only */
+	float    sweep_rate;
+	/** IQ only */
+	float    depth_lowpass_cutoff_ratio;
+	/** Number of elements in a frame, bin_count for power bins */
+	uint16_t data_length;
+	uint16_t stitch_count;
+	/** Sparse only */
+	uint16_t sweeps_per_frame;
+	uint16_t reserved[3];
+} acc_recording_metadata_t;
+
+
+/**
+ * @brief Service configuration used for the recording
+ */
+typedef struct
+{
+	uint32_t sensor_id;
+	float    requested_start_m;
+	float    requested_length_m;
+	/** Update rate in streaming mode, 0 in on demand mode or if not known */
+	float    update_rate;
+	float    receiver_gain;
+	float    running_average_factor;
+	uint32_t power_save_mode;
+	uint32_t profile;
+	/** Sparse sampling mode or IQ output format */
+	uint32_t mode;
+	uint16_t downsampling_factor;
+	uint8_t  hw_accelerated_average_samples;
+	/** ACC_RECORDING_CONFIGURATION_* flags */
+	uint8_t  flags;
+} acc_recording_configuration_t;
+
+
+/**
+ * @brief File header
+ */
+typedef struct
+{
+	uint32_t                      magic;
+	uint16_t                      version;
+	uint16_t                      header_size;
+	acc_recording_service_type_t  service_type;
+	/** Size of one data element in bytes */
+	uint32_t                      sample_size;
+	/** Size of a frame record including the frame header and padding */
+	uint32_t                      frame_record_size;
+	uint32_t                      reserved;
+	acc_recording_metadata_t      metadata;
+	acc_recording_configuration_t configuration;
+} acc_recording_header_t;
+
+
+/**
+ * @brief Header of a frame record, followed by the service data
+ */
+typedef struct
+{
+	uint32_t sequence_number;
+	uint32_t timestamp_ms;
+	/** ACC_RECORDING_RESULT_INFO_* flags */
+	uint16_t result_info;
+	/** IQ proximity power, 0 otherwise */
+	uint16_t proximity_power;
+	uint32_t reserved;
+} acc_recording_frame_header_t;
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_RECORDING_READER_H_
+#define ACC_RECORDING_READER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_recording.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup RecordingReader Recording Reader
+ * @ingroup Recording
+ *
+ * @brief Host library for reading recordings
+ *
+ * The recording is memory mapped read only. Frames are returned as pointers into the
+ * mapping so no data is copied, and only the pages that are accessed are read from disk.
+ * Frames can be accessed in any order.
+ *
+ * @{
+ */
+
+
+/**
+ * @brief Reader handle
+ */
+struct acc_recording_reader;
+
+typedef struct acc_recording_reader *acc_recording_reader_t;
+
+
+/**
+ * @brief Open a recording
+ *
+ * @param[in] path The recording file
+ * @return Reader handle, NULL if the file could not be opened or is not a valid recording
+ */
+acc_recording_reader_t acc_recording_reader_open(const char *path);
+
+
+/**
+ * @brief Close a recording
+ *
+ * Pointers returned by the reader are invalid after the recording has been closed.
+ *
+ * @param[in] reader The reader to close, set to NULL
+ */
+void acc_recording_reader_close(acc_recording_reader_t *reader);
+
+
+/**
+ * @brief Get the file header
+ *
+ * @param[in] reader The reader
+ * @return The header
+ */
+const acc_recording_header_t *acc_recording_reader_header_get(acc_recording_reader_t reader);
+
+
+/**
+ * @brief Get the number of complete frames in the recording
+ *
+ * @param[in] reader The reader
+ * @return The number of frames
+ */
+uint32_t acc_recording_reader_frame_count(acc_recording_reader_t reader);
+
+
+/**
+ * @brief Get a frame
+ *
+ * @param[in] reader The reader
+ * @param[in] index Index of the frame, less than acc_recording_reader_frame_count
+ * @param[out] data The frame data, uint16_t or acc_int16_complex_t depending on service type
+ * @return The frame header, NULL if the index is out of range
+ */
+const acc_recording_frame_header_t *acc_recording_reader_frame_get(acc_recording_reader_t reader, uint32_t index,
+                                                                   const void **data);
+
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
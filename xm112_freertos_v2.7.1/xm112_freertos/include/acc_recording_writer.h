@@ -0,0 +1,316 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_RECORDING_WRITER_H_
+#define ACC_RECORDING_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_recording.h"
+#include "acc_service.h"
+#include "acc_service_envelope.h"
+#include "acc_service_iq.h"
+#include "acc_service_power_bins.h"
+#include "acc_service_sparse.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup RecordingWriter Recording Writer
+ * @ingroup Recording
+ *
+ * @brief Produces a recording from service or detector data
+ *
+ * The writer does not buffer data, every frame is passed to the output function as
+ * it is written. The output function decides where the recording ends up, for example
+ * a UART, a file or external flash.
+ *
+ * The file header is written together with the first frame. When the data length is
+ * not known in advance, which is the case for the detector callbacks, it is taken from
+ * the first frame and later frames of a different length are dropped.
+ *
+ * @{
+ */
+
+
+/**
+ * @brief Output function for the recording
+ *
+ * Must either write all data or return false. The writer stops after a failed write
+ * since the frame records in the output would no longer be aligned.
+ *
+ * @param[in] data The data to write
+ * @param[in] size Number of bytes to write
+ * @param[in] client_reference The client reference given to acc_recording_writer_init
+ * @return True if all data was written, false otherwise
+ */
+typedef bool (*acc_recording_writer_output_t)(const void *data, size_t size, void *client_reference);
+
+
+/**
+ * @brief Writer state, initialize with acc_recording_writer_init
+ */
+typedef struct
+{
+	acc_recording_writer_output_t output;
+	void                          *client_reference;
+	acc_recording_header_t        header;
+	bool                          started;
+	bool                          header_written;
+	bool                          failed;
+	uint32_t                      sequence_number;
+	uint32_t                      dropped_frame_count;
+} acc_recording_writer_t;
+
+
+/**
+ * @brief Initialize a writer
+ *
+ * @param[out] writer The writer to initialize
+ * @param[in] output The output function
+ * @param[in] client_reference Passed to the output function
+ */
+void acc_recording_writer_init(acc_recording_writer_t *writer, acc_recording_writer_output_t output, void *client_reference);
+
+
+/**
+ * @brief Start a recording
+ *
+ * @param[in] writer The writer
+ * @param[in] service_type The service type of the data
+ * @param[in] metadata Metadata of the data, NULL if not known
+ * @param[in] configuration Configuration used for the data, NULL if not known
+ * @return True if successful, false otherwise
+ */
+bool acc_recording_writer_start(acc_recording_writer_t              *writer,
+                                acc_recording_service_type_t        service_type,
+                                const acc_recording_metadata_t      *metadata,
+                                const acc_recording_configuration_t *configuration);
+
+
+/**
+ * @brief Describe envelope data with the types of the recording format
+ *
+ * Used when starting a recording of envelope data, and by other writers of the format types.
+ *
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @param[out] recording_metadata The metadata in recording format
+ * @param[out] recording_configuration The configuration in recording format
+ */
+void acc_recording_writer_describe_envelope(const acc_service_envelope_metadata_t *metadata,
+                                            acc_service_configuration_t           configuration,
+                                            acc_recording_metadata_t              *recording_metadata,
+                                            acc_recording_configuration_t         *recording_configuration);
+
+
+/**
+ * @brief Start a recording of envelope data
+ *
+ * @param[in] writer The writer
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @return True if successful, false otherwise
+ */
+bool acc_recording_writer_start_envelope(acc_recording_writer_t                *writer,
+                                         const acc_service_envelope_metadata_t *metadata,
+                                         acc_service_configuration_t           configuration);
+
+
+/**
+ * @brief Describe IQ data with the types of the recording format
+ *
+ * Used when starting a recording of IQ data, and by other writers of the format types.
+ *
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @param[out] recording_metadata The metadata in recording format
+ * @param[out] recording_configuration The configuration in recording format
+ */
+void acc_recording_writer_describe_iq(const acc_service_iq_metadata_t *metadata,
+                                      acc_service_configuration_t     configuration,
+                                      acc_recording_metadata_t        *recording_metadata,
+                                      acc_recording_configuration_t   *recording_configuration);
+
+
+/**
+ * @brief Start a recording of IQ data
+ *
+ * The data is recorded as acc_int16_complex_t, as returned by acc_service_iq_get_next_by_reference.
+ *
+ * @param[in] writer The writer
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @return True if successful, false otherwise
+ */
+bool acc_recording_writer_start_iq(acc_recording_writer_t          *writer,
+                                   const acc_service_iq_metadata_t *metadata,
+                                   acc_service_configuration_t     configuration);
+
+
+/**
+ * @brief Describe sparse data with the types of the recording format
+ *
+ * Used when starting a recording of sparse data, and by other writers of the format types.
+ *
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @param[out] recording_metadata The metadata in recording format
+ * @param[out] recording_configuration The configuration in recording format
+ */
+void acc_recording_writer_describe_sparse(const acc_service_sparse_metadata_t *metadata,
+                                          acc_service_configuration_t         configuration,
+                                          acc_recording_metadata_t            *recording_metadata,
+                                          acc_recording_configuration_t       *recording_configuration);
+
+
+/**
+ * @brief Start a recording of sparse data
+ *
+ * @param[in] writer The writer
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @return True if successful, false otherwise
+ */
+bool acc_recording_writer_start_sparse(acc_recording_writer_t              *writer,
+                                       const acc_service_sparse_metadata_t *metadata,
+                                       acc_service_configuration_t         configuration);
+
+
+/**
+ * @brief Describe power bins data with the types of the recording format
+ *
+ * Used when starting a recording of power bins data, and by other writers of the format types.
+ *
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @param[out] recording_metadata The metadata in recording format
+ * @param[out] recording_configuration The configuration in recording format
+ */
+void acc_recording_writer_describe_power_bins(const acc_service_power_bins_metadata_t *metadata,
+                                              acc_service_configuration_t             configuration,
+                                              acc_recording_metadata_t                *recording_metadata,
+                                              acc_recording_configuration_t           *recording_configuration);
+
+
+/**
+ * @brief Start a recording of power bins data
+ *
+ * @param[in] writer The writer
+ * @param[in] metadata The metadata of the service
+ * @param[in] configuration The service configuration, NULL to leave the configuration empty
+ * @return True if successful, false otherwise
+ */
+bool acc_recording_writer_start_power_bins(acc_recording_writer_t                  *writer,
+                                           const acc_service_power_bins_metadata_t *metadata,
+                                           acc_service_configuration_t             configuration);
+
+
+/**
+ * @brief Set the update rate stored in the recording
+ *
+ * The service API has no getter for the update rate so it is not filled in by the
+ * start functions. Must be called before the first frame is written.
+ *
+ * @param[in] writer The writer
+ * @param[in] update_rate The update rate in Hz, 0 for on demand mode
+ */
+void acc_recording_writer_update_rate_set(acc_recording_writer_t *writer, float update_rate);
+
+
+/**
+ * @brief Write a frame
+ *
+ * @param[in] writer The writer
+ * @param[in] data The frame data, uint16_t or acc_int16_complex_t depending on service type
+ * @param[in] data_length Number of elements in data
+ * @param[in] result_info ACC_RECORDING_RESULT_INFO_* flags
+ * @param[in] proximity_power IQ proximity power, 0 for other services
+ * @return True if the frame was written, false otherwise
+ */
+bool acc_recording_writer_write_frame(acc_recording_writer_t *writer, const void *data, uint16_t data_length,
+                                      uint16_t result_info, uint16_t proximity_power);
+
+
+/**
+ * @brief Convert service result info to ACC_RECORDING_RESULT_INFO_* flags
+ *
+ * @param[in] result_info The result info, NULL gives no flags
+ * @return The flags
+ */
+uint16_t acc_recording_writer_envelope_result_info(const acc_service_envelope_result_info_t *result_info);
+
+
+/**
+ * @copydoc acc_recording_writer_envelope_result_info
+ */
+uint16_t acc_recording_writer_iq_result_info(const acc_service_iq_result_info_t *result_info);
+
+
+/**
+ * @copydoc acc_recording_writer_envelope_result_info
+ */
+uint16_t acc_recording_writer_sparse_result_info(const acc_service_sparse_result_info_t *result_info);
+
+
+/**
+ * @copydoc acc_recording_writer_envelope_result_info
+ */
+uint16_t acc_recording_writer_power_bins_result_info(const acc_service_power_bins_result_info_t *result_info);
+
+
+/**
+ * @brief Service data callback for the presence detector
+ *
+ * Matches acc_detector_presence_service_data_callback_t. Set the writer as client reference:
+ *
+ *     acc_detector_presence_configuration_set_service_data_callback(config,
+ *                                                                   acc_recording_writer_presence_service_data_callback,
+ *                                                                   &writer);
+ *
+ * @param[in] data The service data
+ * @param[in] data_size Size of the data in bytes
+ * @param[in] client_reference The writer
+ */
+void acc_recording_writer_presence_service_data_callback(const uint16_t *data, size_t data_size, void *client_reference);
+
+
+/**
+ * @brief Select the writer used by acc_recording_writer_distance_service_data_callback
+ *
+ * The distance detector callback has no client reference so the writer is kept here.
+ *
+ * @param[in] writer The writer, NULL to stop recording
+ */
+void acc_recording_writer_distance_set(acc_recording_writer_t *writer);
+
+
+/**
+ * @brief Service data callback for the distance detector
+ *
+ * Matches acc_detector_distance_service_data_callback_t, the data is written to the
+ * writer selected with acc_recording_writer_distance_set.
+ *
+ * @param[in] data The envelope data
+ * @param[in] data_length Number of elements in data
+ */
+void acc_recording_writer_distance_service_data_callback(const uint16_t *data, uint16_t data_length);
+
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
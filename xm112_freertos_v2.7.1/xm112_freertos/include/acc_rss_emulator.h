@@ -0,0 +1,107 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_RSS_EMULATOR_H_
+#define ACC_RSS_EMULATOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acc_definitions.h"
+#include "acc_service.h"
+
+/**
+ * @defgroup Emulator Service Emulator
+ *
+ * @brief Host implementation of the RSS service API
+ *
+ * The emulator implements acc_rss.h, acc_service.h, acc_base_configuration.h and the
+ * envelope, IQ, sparse and power bins service APIs on the Linux host target, so that
+ * applications can be run and benchmarked without a sensor.
+ *
+ * Frames are read from a data source per sensor. A source is either synthetic data,
+ * generated from a fixed seed, or a raw data file with frames of data_length elements
+ * stored back to back (uint16_t for envelope, sparse and power bins and
+ * acc_int16_complex_t for IQ, little endian). The file is replayed from the start when
+ * the end is reached, so the same frames are produced in every run. A source can also be a
+ * recording, see acc_recording.h, in which case the metadata and result info are taken
+ * from the recording.
+ *
+ * The emulator can also be controlled with environment variables, which allows
+ * unmodified applications to be used:
+ * - ACC_RSS_EMULATOR_SOURCE - data file used for all sensors without an explicit source
+ * - ACC_RSS_EMULATOR_FREE_RUN - set to 1 to produce frames without honouring the update rate
+ *
+ * @{
+ */
+
+
+/**
+ * @brief Statistics for a service, collected between activation and deactivation
+ */
+typedef struct
+{
+	/** Number of frames delivered to the application */
+	uint32_t frame_count;
+	/** Number of frames flagged with missed_data because the application was too slow */
+	uint32_t missed_frame_count;
+	/** Total time spent by the application between two calls to get_next */
+	uint64_t processing_time_us;
+	/** Maximum time spent by the application between two calls to get_next */
+	uint32_t max_processing_time_us;
+	/** Total time get_next waited for the next frame to be due */
+	uint64_t wait_time_us;
+} acc_rss_emulator_statistics_t;
+
+
+/**
+ * @brief Set the data source for a sensor
+ *
+ * Must be called before the service is created.
+ *
+ * @param[in] sensor_id The sensor to set the data source for
+ * @param[in] path Data file or recording to replay, NULL to generate synthetic data
+ * @return True if successful, false otherwise
+ */
+bool acc_rss_emulator_source_set(acc_sensor_id_t sensor_id, const char *path);
+
+
+/**
+ * @brief Select if frames are paced according to the configured update rate
+ *
+ * With pacing disabled, get_next returns as soon as the next frame has been read
+ * which is useful to measure the maximum frame rate of an application.
+ * Pacing is enabled by default.
+ *
+ * @param[in] enable True to honour the configured update rate
+ */
+void acc_rss_emulator_pacing_set(bool enable);
+
+
+/**
+ * @brief Set the seed used for synthetic data
+ *
+ * The generator is restarted from the seed every time a service is activated.
+ *
+ * @param[in] seed The seed, must not be zero
+ */
+void acc_rss_emulator_seed_set(uint32_t seed);
+
+
+/**
+ * @brief Get statistics for a service
+ *
+ * @param[in] handle The service handle to get statistics for
+ * @param[out] statistics The statistics
+ */
+void acc_rss_emulator_statistics_get(acc_service_handle_t handle, acc_rss_emulator_statistics_t *statistics);
+
+
+/**
+ * @}
+ */
+
+#endif
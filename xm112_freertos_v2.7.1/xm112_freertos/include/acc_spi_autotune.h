@@ -0,0 +1,109 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_SPI_AUTOTUNE_H_
+#define ACC_SPI_AUTOTUNE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_device.h"
+#include "acc_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Function reading one frame from an active service
+ *
+ * Typically a wrapper around the get_next function of the service type.
+ *
+ * @param[in] handle The service handle
+ * @return True if successful, false otherwise
+ */
+typedef bool (*acc_spi_autotune_get_next_t)(acc_service_handle_t handle);
+
+
+/**
+ * @brief Function changing the driver buffer size of a SPI device
+ *
+ * @param[in] spi_handle The SPI device
+ * @param[in] buffer_size The new buffer size in bytes
+ * @return True if successful, false otherwise
+ */
+typedef bool (*acc_spi_autotune_buffer_size_set_t)(acc_device_handle_t spi_handle, size_t buffer_size);
+
+
+/**
+ * @brief Measured throughput for one buffer size
+ */
+typedef struct
+{
+	/** The buffer size */
+	size_t   buffer_size;
+	/** Number of bytes transferred while reading the frames */
+	uint64_t bytes;
+	/** Time spent in transfers while reading the frames */
+	uint64_t transfer_time_us;
+	/** Throughput in bytes per millisecond, which is kB/s */
+	uint32_t kb_per_s;
+} acc_spi_autotune_result_t;
+
+
+/**
+ * @brief Find the smallest SPI buffer size that gives close to peak throughput
+ *
+ * For each candidate size the buffer is changed, RSS is activated so that the new
+ * maximum transfer size is used, the service is created from the configuration and
+ * frame_count frames are read while the SPI telemetry of the bus is recorded. RSS
+ * must not be active when this function is called and is deactivated when it returns.
+ *
+ * The smallest candidate reaching at least (100 - tolerance_percent) % of the highest
+ * measured throughput is selected and set before returning.
+ *
+ * @param[in] configuration The service configuration giving the frame sizes to tune for
+ * @param[in] get_next Function reading one frame of the service type
+ * @param[in] spi_handle The SPI device of the sensor in the configuration
+ * @param[in] buffer_size_set Function changing the buffer size of the SPI device
+ * @param[in] candidates Buffer sizes to measure, in increasing order
+ * @param[out] results Measurement per candidate, same length as candidates
+ * @param[in] candidate_count The number of candidates
+ * @param[in] frame_count The number of frames read per candidate
+ * @param[in] tolerance_percent Allowed throughput loss compared to the best candidate
+ * @param[out] buffer_size The selected buffer size
+ * @return True if successful, false otherwise
+ */
+bool acc_spi_autotune(acc_service_configuration_t        configuration,
+                      acc_spi_autotune_get_next_t        get_next,
+                      acc_device_handle_t                spi_handle,
+                      acc_spi_autotune_buffer_size_set_t buffer_size_set,
+                      const size_t                       *candidates,
+                      acc_spi_autotune_result_t          *results,
+                      size_t                             candidate_count,
+                      uint32_t                           frame_count,
+                      uint32_t                           tolerance_percent,
+                      size_t                             *buffer_size);
+
+
+/**
+ * @brief Select the smallest buffer size within a tolerance of the peak throughput
+ *
+ * @param[in] results Measurements in increasing buffer size order
+ * @param[in] result_count The number of measurements
+ * @param[in] tolerance_percent Allowed throughput loss compared to the best measurement
+ * @return Index of the selected measurement
+ */
+size_t acc_spi_autotune_select(const acc_spi_autotune_result_t *results, size_t result_count, uint32_t tolerance_percent);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_STREAM_H_
+#define ACC_STREAM_H_
+
+#include <stdint.h>
+
+#include "acc_recording.h"
+
+/**
+ * @defgroup Stream Framed Sweep Streaming Protocol
+ *
+ * @brief Binary messages with service data for a serial link
+ *
+ * Each message is a header, a payload and a CRC, COBS encoded and written
+ * between two zero bytes. COBS removes all zero bytes from the message, so a
+ * receiver finds the start of the next message after any error by waiting for a
+ * zero byte. Text written to the same link between messages is discarded by the
+ * decoder.
+ *
+ * | Offset                | Content                                   |
+ * |-----------------------|-------------------------------------------|
+ * | 0                     | acc_stream_message_header_t               |
+ * | 4                     | payload, depends on the message type      |
+ * | 4 + payload size      | CRC-32 of header and payload              |
+ *
+ * The sequence number in the header is incremented for every message, a gap
+ * tells the receiver that messages were lost. All fields are little endian.
+ *
+ * Service data is described with the types from the recording format so that
+ * a received stream can be stored as a recording.
+ *
+ * @{
+ */
+
+
+#define ACC_STREAM_VERSION 1U
+
+/**
+ * @brief The byte written before and after every message
+ */
+#define ACC_STREAM_DELIMITER 0x00U
+
+/**
+ * @brief Size of the CRC after the payload
+ */
+#define ACC_STREAM_CRC_SIZE 4U
+
+/**
+ * @brief Largest number of bytes a message with a payload of the given size takes on the link
+ *
+ * COBS adds one byte per 254 bytes and one byte at the start, the delimiters are two bytes.
+ */
+#define ACC_STREAM_ENCODED_SIZE(payload_size) \
+	((sizeof(acc_stream_message_header_t) + (payload_size) + ACC_STREAM_CRC_SIZE) + \
+	 (sizeof(acc_stream_message_header_t) + (payload_size) + ACC_STREAM_CRC_SIZE) / 254U + 3U)
+
+
+/**
+ * @brief Message types
+ */
+typedef enum
+{
+	/** Service type, metadata and configuration, acc_stream_metadata_t */
+	ACC_STREAM_MESSAGE_METADATA         = 1,
+	/** Service data, acc_stream_frame_header_t followed by the data */
+	ACC_STREAM_MESSAGE_FRAME            = 2,
+	/** Result info of the last frame, acc_stream_result_info_t, only sent when not all zero */
+	ACC_STREAM_MESSAGE_RESULT_INFO      = 3,
+	/** Detector result, acc_stream_detector_result_header_t followed by detector specific data */
+	ACC_STREAM_MESSAGE_DETECTOR_RESULT  = 4,
+	/** Service data, acc_stream_frame_header_t followed by a frame compressed as in acc_compression.h */
+	ACC_STREAM_MESSAGE_COMPRESSED_FRAME = 5,
+} acc_stream_message_type_enum_t;
+typedef uint32_t acc_stream_message_type_t;
+
+
+/**
+ * @brief Message header
+ */
+typedef struct
+{
+	uint8_t  version;
+	uint8_t  type;
+	uint16_t sequence_number;
+} acc_stream_message_header_t;
+
+
+/**
+ * @brief Payload of ACC_STREAM_MESSAGE_METADATA
+ */
+typedef struct
+{
+	acc_recording_service_type_t  service_type;
+	/** Size of one data element in bytes */
+	uint32_t                      sample_size;
+	acc_recording_metadata_t      metadata;
+	acc_recording_configuration_t configuration;
+} acc_stream_metadata_t;
+
+
+/**
+ * @brief Start of the payload of ACC_STREAM_MESSAGE_FRAME and ACC_STREAM_MESSAGE_COMPRESSED_FRAME
+ */
+typedef struct
+{
+	uint32_t timestamp_ms;
+	/** Number of data elements after the header */
+	uint16_t data_length;
+	uint16_t reserved;
+} acc_stream_frame_header_t;
+
+
+/**
+ * @brief Payload of ACC_STREAM_MESSAGE_RESULT_INFO
+ */
+typedef struct
+{
+	/** ACC_RECORDING_RESULT_INFO_* flags */
+	uint16_t result_info;
+	/** IQ proximity power, 0 otherwise */
+	uint16_t proximity_power;
+} acc_stream_result_info_t;
+
+
+/**
+ * @brief Start of the payload of ACC_STREAM_MESSAGE_DETECTOR_RESULT
+ */
+typedef struct
+{
+	/** Chosen by the application to tell detector results apart */
+	uint32_t detector_type;
+	uint32_t timestamp_ms;
+} acc_stream_detector_result_header_t;
+
+
+/**
+ * @}
+ */
+
+#endif
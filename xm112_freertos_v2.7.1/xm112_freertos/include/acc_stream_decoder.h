@@ -0,0 +1,172 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_STREAM_DECODER_H_
+#define ACC_STREAM_DECODER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief A decoded message
+ */
+typedef struct
+{
+	acc_stream_message_type_t type;
+	uint16_t                  sequence_number;
+	/** The payload, valid until the next call to acc_stream_decoder_feed */
+	const uint8_t             *payload;
+	size_t                    payload_size;
+} acc_stream_message_t;
+
+
+/**
+ * @brief Function called for every decoded message
+ *
+ * @param[in] message The message
+ * @param[in] client_reference The client reference given to acc_stream_decoder_init
+ */
+typedef void (*acc_stream_decoder_callback_t)(const acc_stream_message_t *message, void *client_reference);
+
+
+/**
+ * @brief Decoder statistics
+ */
+typedef struct
+{
+	/** Messages passed to the callback */
+	uint32_t message_count;
+	/** Messages missing according to the sequence numbers */
+	uint32_t lost_message_count;
+	/** Messages with wrong CRC */
+	uint32_t crc_error_count;
+	/** Data between delimiters that is not a message, such as text on the same link */
+	uint32_t framing_error_count;
+} acc_stream_decoder_statistics_t;
+
+
+/**
+ * @brief Stream decoder state
+ */
+typedef struct
+{
+	acc_stream_decoder_callback_t   callback;
+	void                            *client_reference;
+	uint8_t                         *buffer;
+	size_t                          buffer_size;
+	size_t                          length;
+	bool                            overflow;
+	bool                            sequence_number_valid;
+	uint16_t                        next_sequence_number;
+	acc_stream_decoder_statistics_t statistics;
+} acc_stream_decoder_t;
+
+
+/**
+ * @brief Initialize a stream decoder
+ *
+ * @param[out] decoder The decoder
+ * @param[in] callback Called for every decoded message
+ * @param[in] client_reference Passed to the callback
+ * @param[in] buffer Memory for one encoded message, ACC_STREAM_ENCODED_SIZE of the largest payload
+ * @param[in] buffer_size The size of the buffer
+ */
+void acc_stream_decoder_init(acc_stream_decoder_t          *decoder,
+                             acc_stream_decoder_callback_t callback,
+                             void                          *client_reference,
+                             uint8_t                       *buffer,
+                             size_t                        buffer_size);
+
+
+/**
+ * @brief Decode received data
+ *
+ * The data does not need to start or end at a message boundary. The callback
+ * is called for every complete and valid message.
+ *
+ * @param[in] decoder The decoder
+ * @param[in] data The received data
+ * @param[in] size The number of bytes
+ */
+void acc_stream_decoder_feed(acc_stream_decoder_t *decoder, const void *data, size_t size);
+
+
+/**
+ * @brief Get the metadata from a metadata message
+ *
+ * @param[in] message The message
+ * @param[out] metadata The metadata
+ * @return True if the message is a valid metadata message
+ */
+bool acc_stream_decoder_metadata_get(const acc_stream_message_t *message, acc_stream_metadata_t *metadata);
+
+
+/**
+ * @brief Get the header and the data of a frame message
+ *
+ * @param[in] message The message
+ * @param[in] sample_size The size of a data element, from the metadata
+ * @param[out] frame_header The frame header
+ * @param[out] data The data, points into the message payload
+ * @return True if the message is a valid frame message
+ */
+bool acc_stream_decoder_frame_get(const acc_stream_message_t *message, uint32_t sample_size,
+                                  acc_stream_frame_header_t *frame_header, const void **data);
+
+
+/**
+ * @brief Get the header and the compressed data of a compressed frame message
+ *
+ * The data is decompressed with acc_compression_decode.
+ *
+ * @param[in] message The message
+ * @param[out] frame_header The frame header
+ * @param[out] compressed The compressed frame, points into the message payload
+ * @param[out] compressed_size The size of the compressed frame
+ * @return True if the message is a compressed frame message
+ */
+bool acc_stream_decoder_compressed_frame_get(const acc_stream_message_t *message, acc_stream_frame_header_t *frame_header,
+                                             const uint8_t **compressed, size_t *compressed_size);
+
+
+/**
+ * @brief Get the result info from a result info message
+ *
+ * @param[in] message The message
+ * @param[out] result_info The result info
+ * @return True if the message is a valid result info message
+ */
+bool acc_stream_decoder_result_info_get(const acc_stream_message_t *message, acc_stream_result_info_t *result_info);
+
+
+/**
+ * @brief Get the header and the result of a detector result message
+ *
+ * @param[in] message The message
+ * @param[out] result_header The result header
+ * @param[out] result The detector result, points into the message payload
+ * @param[out] result_size The size of the detector result
+ * @return True if the message is a valid detector result message
+ */
+bool acc_stream_decoder_detector_result_get(const acc_stream_message_t          *message,
+                                            acc_stream_detector_result_header_t *result_header,
+                                            const void                          **result,
+                                            size_t                              *result_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_STREAM_WRITER_H_
+#define ACC_STREAM_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_recording.h"
+#include "acc_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Output function for the encoded messages
+ *
+ * Called once per message with the complete encoded message, delimiters included.
+ *
+ * @param[in] data The encoded message
+ * @param[in] size The number of bytes
+ * @param[in] client_reference The client reference given to acc_stream_writer_init
+ * @return True if successful, false otherwise
+ */
+typedef bool (*acc_stream_writer_output_t)(const void *data, size_t size, void *client_reference);
+
+
+/**
+ * @brief Stream writer state
+ */
+typedef struct
+{
+	acc_stream_writer_output_t   output;
+	void                         *client_reference;
+	uint8_t                      *buffer;
+	size_t                       buffer_size;
+	acc_recording_service_type_t service_type;
+	uint32_t                     sample_size;
+	uint16_t                     sequence_number;
+	/** Messages that were too large for the buffer or failed in the output function */
+	uint32_t                     failed_message_count;
+} acc_stream_writer_t;
+
+
+/**
+ * @brief Initialize a stream writer
+ *
+ * @param[out] writer The writer
+ * @param[in] output The output function
+ * @param[in] client_reference Passed to the output function
+ * @param[in] buffer Memory for encoding, ACC_STREAM_ENCODED_SIZE of the largest payload
+ * @param[in] buffer_size The size of the buffer
+ */
+void acc_stream_writer_init(acc_stream_writer_t        *writer,
+                            acc_stream_writer_output_t output,
+                            void                       *client_reference,
+                            uint8_t                    *buffer,
+                            size_t                     buffer_size);
+
+
+/**
+ * @brief Initialize a stream writer that writes the messages to a UART
+ *
+ * Each message is written with one call to acc_device_uart_write_buffer. The
+ * port may also carry text, such as the debug output, since the receiver
+ * discards everything between messages.
+ *
+ * @param[out] writer The writer
+ * @param[in] port The UART port, opened with acc_device_uart_init
+ * @param[in] buffer Memory for encoding, ACC_STREAM_ENCODED_SIZE of the largest payload
+ * @param[in] buffer_size The size of the buffer
+ */
+void acc_stream_writer_init_uart(acc_stream_writer_t *writer, uint_fast8_t port, uint8_t *buffer, size_t buffer_size);
+
+
+/**
+ * @brief Send a message
+ *
+ * @param[in] writer The writer
+ * @param[in] type The message type
+ * @param[in] payload The payload
+ * @param[in] payload_size The size of the payload
+ * @return True if successful, false otherwise
+ */
+bool acc_stream_writer_send(acc_stream_writer_t *writer, acc_stream_message_type_t type, const void *payload, size_t payload_size);
+
+
+/**
+ * @brief Send the metadata message, must be sent before the frames it describes
+ *
+ * Use acc_recording_writer_describe_* to get the metadata and configuration of a service.
+ *
+ * @param[in] writer The writer
+ * @param[in] service_type The service that produces the frames
+ * @param[in] metadata The service metadata
+ * @param[in] configuration The service configuration, NULL if not known
+ * @return True if successful, false otherwise
+ */
+bool acc_stream_writer_send_metadata(acc_stream_writer_t                 *writer,
+                                     acc_recording_service_type_t        service_type,
+                                     const acc_recording_metadata_t      *metadata,
+                                     const acc_recording_configuration_t *configuration);
+
+
+/**
+ * @brief Send a frame of service data
+ *
+ * A result info message follows the frame if result_info or proximity_power is not zero.
+ *
+ * @param[in] writer The writer
+ * @param[in] data The service data
+ * @param[in] data_length The number of data elements
+ * @param[in] result_info ACC_RECORDING_RESULT_INFO_* flags, see acc_recording_writer_*_result_info
+ * @param[in] proximity_power IQ proximity power, 0 otherwise
+ * @return True if successful, false otherwise
+ */
+bool acc_stream_writer_send_frame(acc_stream_writer_t *writer, const void *data, uint16_t data_length,
+                                  uint16_t result_info, uint16_t proximity_power);
+
+
+/**
+ * @brief Send a frame of service data compressed with acc_compression_encode
+ *
+ * A result info message follows the frame if result_info or proximity_power is not zero.
+ *
+ * @param[in] writer The writer
+ * @param[in] compressed The compressed frame
+ * @param[in] compressed_size The size of the compressed frame
+ * @param[in] data_length The number of data elements in the frame
+ * @param[in] result_info ACC_RECORDING_RESULT_INFO_* flags, see acc_recording_writer_*_result_info
+ * @param[in] proximity_power IQ proximity power, 0 otherwise
+ * @return True if successful, false otherwise
+ */
+bool acc_stream_writer_send_compressed_frame(acc_stream_writer_t *writer, const void *compressed, size_t compressed_size,
+                                             uint16_t data_length, uint16_t result_info, uint16_t proximity_power);
+
+
+/**
+ * @brief Send a detector result
+ *
+ * @param[in] writer The writer
+ * @param[in] detector_type Chosen by the application to tell detector results apart
+ * @param[in] result The detector result
+ * @param[in] result_size The size of the detector result
+ * @return True if successful, false otherwise
+ */
+bool acc_stream_writer_send_detector_result(acc_stream_writer_t *writer, uint32_t detector_type, const void *result,
+                                            size_t result_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
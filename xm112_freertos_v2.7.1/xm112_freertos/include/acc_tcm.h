@@ -0,0 +1,72 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_TCM_H_
+#define ACC_TCM_H_
+
+
+/**
+ * @brief Placement of code and data in the tightly coupled memories of the SAME70
+ *
+ * The TCMs are enabled with "make ACC_CFG_TCM=<kB>", where kB is 32, 64 or 128
+ * and is the size of both the ITCM and the DTCM. The SRAM shrinks by twice
+ * that amount. The TCMs are not cached, so code and data placed there have
+ * the same access time whether the cache is warm or not.
+ *
+ * "make ACC_CFG_TCM_HEAP=<kB>" moves that part of the FreeRTOS heap from SRAM to DTCM.
+ * The rest of the heap must still fit in the SRAM that is left, together with the
+ * static data: with 128 kB TCMs only 124 kB SRAM remains, less than
+ * configTOTAL_HEAP_SIZE, so ACC_CFG_TCM=128 needs a large ACC_CFG_TCM_HEAP.
+ * acc_heap.c fails to build when the heap alone does not fit, the linker
+ * reports an overflowed sram region when the static data does not fit.
+ *
+ * Without ACC_CFG_TCM the attributes are empty and everything stays in flash and SRAM.
+ *
+ *   ACC_TCM_CODE static void isr(void) { ... }
+ *   ACC_TCM_BSS static uint8_t buffer[256];
+ */
+
+
+#if defined(ACC_CFG_TCM) && (ACC_CFG_TCM > 0)
+
+#define ACC_TCM_ENABLED  1
+
+/** Code copied from flash to ITCM at startup */
+#define ACC_TCM_CODE     __attribute__((section(".itcm"), noinline))
+/** Initialized data copied from flash to DTCM at startup */
+#define ACC_TCM_DATA     __attribute__((section(".dtcm_data")))
+/** Zero initialized data in DTCM */
+#define ACC_TCM_BSS      __attribute__((section(".dtcm_bss")))
+
+#define ACC_TCM_SIZE     (ACC_CFG_TCM * 1024U)
+
+#else
+
+#define ACC_TCM_ENABLED  0
+
+#define ACC_TCM_CODE
+#define ACC_TCM_DATA
+#define ACC_TCM_BSS
+
+#define ACC_TCM_SIZE     0U
+
+#endif
+
+#if defined(ACC_CFG_TCM_HEAP) && (ACC_CFG_TCM_HEAP > 0)
+#define ACC_TCM_HEAP_SIZE (ACC_CFG_TCM_HEAP * 1024U)
+#else
+#define ACC_TCM_HEAP_SIZE 0U
+#endif
+
+#if ACC_TCM_HEAP_SIZE > ACC_TCM_SIZE
+#error "ACC_CFG_TCM_HEAP does not fit in the DTCM given by ACC_CFG_TCM"
+#endif
+
+/** The cached SRAM left next to ITCM and DTCM, see the sram region of the linker scripts */
+#define ACC_TCM_SRAM_SIZE ((380U * 1024U) - 2U * ACC_TCM_SIZE)
+
+
+#endif
@@ -0,0 +1,169 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_TLSF_H_
+#define ACC_TLSF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Two-level segregated fit (TLSF) allocator
+ *
+ * Free blocks are kept in lists per size class. The first level splits the
+ * sizes in powers of two and the second level splits every power of two in
+ * ACC_TLSF_SECOND_LEVEL_COUNT classes. A bitmap per level tells which lists
+ * have blocks, so a block is found with two bit scans and allocation and
+ * free take the same time regardless of the number of free blocks. Freed
+ * blocks are merged with free neighbours immediately.
+ *
+ * The allocator is not thread safe, the caller must serialize the calls.
+ */
+
+
+/**
+ * @brief Alignment of allocated memory and granularity of block sizes
+ */
+#define ACC_TLSF_ALIGNMENT 8U
+
+#define ACC_TLSF_SECOND_LEVEL_COUNT_LOG2 4U
+#define ACC_TLSF_SECOND_LEVEL_COUNT      (1U << ACC_TLSF_SECOND_LEVEL_COUNT_LOG2)
+
+/**
+ * @brief Blocks are smaller than 2^ACC_TLSF_FIRST_LEVEL_MAX_LOG2 bytes, memory beyond that in a region is not used
+ */
+#define ACC_TLSF_FIRST_LEVEL_MAX_LOG2 24U
+
+
+/**
+ * @brief A free running counter used to measure the time of allocations
+ *
+ * @return The counter value, may wrap
+ */
+typedef uint32_t (acc_tlsf_cycle_counter_func_t)(void);
+
+
+typedef struct
+{
+	size_t   total_size;
+	size_t   free_size;
+	size_t   min_ever_free_size;
+	size_t   largest_free_block;
+	uint32_t free_block_count;
+	/** 0 when all free memory is one block, approaching 1000 when it is split in many small blocks */
+	uint32_t fragmentation_permille;
+	uint32_t alloc_count;
+	uint32_t free_count;
+	uint32_t failed_alloc_count;
+	/** Worst case time in cycle counter ticks, 0 without a cycle counter */
+	uint32_t max_alloc_cycles;
+	uint32_t max_free_cycles;
+} acc_tlsf_stats_t;
+
+
+/**
+ * @brief An allocator, the state is kept at the start of the first region
+ */
+typedef struct acc_tlsf acc_tlsf_t;
+
+
+/**
+ * @brief Create an allocator in a memory region
+ *
+ * About 1 kB of the region, 2 kB on 64-bit hosts, is used for the allocator state.
+ *
+ * @param[in] memory The memory
+ * @param[in] size The size of the memory
+ * @param[in] cycle_counter Optional counter for the time statistics, may be NULL
+ * @return The allocator, NULL if the region is too small
+ */
+acc_tlsf_t *acc_tlsf_create(void *memory, size_t size, acc_tlsf_cycle_counter_func_t *cycle_counter);
+
+
+/**
+ * @brief Add another memory region to an allocator
+ *
+ * A block is never allocated across regions, even if they are adjacent.
+ *
+ * @param[in] tlsf The allocator
+ * @param[in] memory The memory
+ * @param[in] size The size of the memory
+ * @return True if the region was added
+ */
+bool acc_tlsf_add_region(acc_tlsf_t *tlsf, void *memory, size_t size);
+
+
+/**
+ * @brief Allocate memory
+ *
+ * @param[in] tlsf The allocator
+ * @param[in] size The number of bytes
+ * @return Memory aligned to ACC_TLSF_ALIGNMENT, NULL if size is 0 or there is no free block large enough
+ */
+void *acc_tlsf_alloc(acc_tlsf_t *tlsf, size_t size);
+
+
+/**
+ * @brief Free memory
+ *
+ * @param[in] tlsf The allocator
+ * @param[in] ptr Memory from acc_tlsf_alloc, or NULL
+ */
+void acc_tlsf_free(acc_tlsf_t *tlsf, void *ptr);
+
+
+/**
+ * @brief Get the usable size of an allocation, which may be larger than requested
+ *
+ * @param[in] ptr Memory from acc_tlsf_alloc
+ * @return The size
+ */
+size_t acc_tlsf_get_allocated_size(const void *ptr);
+
+
+/**
+ * @brief Get statistics
+ *
+ * Walks the free blocks of the largest size class, so it takes longer than an allocation.
+ *
+ * @param[in] tlsf The allocator
+ * @param[out] stats The statistics
+ */
+void acc_tlsf_get_stats(const acc_tlsf_t *tlsf, acc_tlsf_stats_t *stats);
+
+
+/**
+ * @brief Check the consistency of all blocks and free lists
+ *
+ * Intended for tests, the time is proportional to the number of blocks.
+ *
+ * @param[in] tlsf The allocator
+ * @return True if consistent
+ */
+bool acc_tlsf_check(const acc_tlsf_t *tlsf);
+
+
+/**
+ * @brief Get statistics of the FreeRTOS heap
+ *
+ * Only available when FreeRTOS is built with the TLSF heap, FREERTOS_HEAP=heap_tlsf.
+ *
+ * @param[out] stats The statistics
+ */
+void acc_heap_tlsf_get_stats(acc_tlsf_stats_t *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
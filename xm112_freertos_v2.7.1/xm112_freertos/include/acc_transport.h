@@ -0,0 +1,304 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_TRANSPORT_H_
+#define ACC_TRANSPORT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Packetisation and flow control on top of a byte stream such as USB CDC or UART
+ *
+ * Frames are split into packets of at most max_payload_size bytes. Every
+ * packet starts with a header:
+ *
+ *   offset  size  content
+ *   0       2     0xAC 0xC0
+ *   2       1     flags, ACC_TRANSPORT_FLAG_*
+ *   3       1     sequence number of the data packet, or of the next data packet
+ *   4       2     payload length, little endian
+ *   6       2     credits granted to the peer since start, little endian
+ *   8       4     CRC-32 of bytes 0-7 and the payload, 0 without ACC_TRANSPORT_FLAG_CRC
+ *
+ * A side may only send a data packet when the peer has granted a credit for
+ * it, one credit is one packet in the receive callback. The credits travel
+ * in the header of every packet, a header without payload is sent when the
+ * credits must be updated and there is no data to send.
+ *
+ * Frames are sent zero-copy, the write function gets the header and a
+ * pointer into the frame. One packet is written at a time.
+ *
+ * The receiver finds the next header after noise or a broken packet by
+ * looking for the sync bytes. Packets lost this way are detected from the
+ * sequence number of the next header and their credits are given back to
+ * the peer. On a link that can lose data acc_transport_announce must be
+ * called when nothing has been received for a while, since the peer may be
+ * waiting for credits that were lost.
+ *
+ * All functions except acc_transport_write_done must be called from the same
+ * context, or be serialized by the caller.
+ */
+
+
+#define ACC_TRANSPORT_HEADER_SIZE 12U
+
+/**
+ * @brief Number of frames that can be queued for sending
+ */
+#define ACC_TRANSPORT_SEND_QUEUE_LENGTH 4U
+
+
+#define ACC_TRANSPORT_FLAG_DATA    0x01U
+#define ACC_TRANSPORT_FLAG_FIRST   0x02U
+#define ACC_TRANSPORT_FLAG_LAST    0x04U
+#define ACC_TRANSPORT_FLAG_CRC     0x08U
+/** The sender has no credits left, the receiver sends its credits again */
+#define ACC_TRANSPORT_FLAG_REQUEST 0x10U
+
+/**
+ * @brief Only in the receive callback, data packets were lost before this packet
+ */
+#define ACC_TRANSPORT_FLAG_LOST    0x80U
+
+
+/**
+ * @brief Start writing a packet
+ *
+ * The header and the payload must be written in this order. When both have
+ * been written acc_transport_write_done must be called, possibly before this
+ * function returns. Both buffers are valid until then.
+ *
+ * @param[in] header The header
+ * @param[in] header_size ACC_TRANSPORT_HEADER_SIZE
+ * @param[in] payload The payload, NULL if payload_size is 0
+ * @param[in] payload_size The size of the payload
+ * @param[in] client_reference The client reference in the configuration
+ * @return True if the write was started, false to retry on the next call to acc_transport_process
+ */
+typedef bool (acc_transport_write_func_t)(const uint8_t *header, size_t header_size, const uint8_t *payload,
+                                          size_t payload_size, void *client_reference);
+
+
+/**
+ * @brief Called for every received data packet
+ *
+ * A frame starts with a packet with ACC_TRANSPORT_FLAG_FIRST and ends with a
+ * packet with ACC_TRANSPORT_FLAG_LAST, both are set for a frame of one packet.
+ * A frame in progress when a packet with ACC_TRANSPORT_FLAG_LOST arrives is
+ * incomplete. The payload is only valid during the call.
+ *
+ * @param[in] payload The payload
+ * @param[in] payload_size The size of the payload
+ * @param[in] flags ACC_TRANSPORT_FLAG_FIRST, ACC_TRANSPORT_FLAG_LAST and ACC_TRANSPORT_FLAG_LOST
+ * @param[in] client_reference The client reference in the configuration
+ */
+typedef void (acc_transport_packet_func_t)(const uint8_t *payload, size_t payload_size, uint8_t flags,
+                                           void *client_reference);
+
+
+/**
+ * @brief Called when all of a frame has been written and the frame may be reused
+ *
+ * @param[in] frame The frame given to acc_transport_send
+ * @param[in] client_reference The client reference in the configuration
+ */
+typedef void (acc_transport_frame_sent_func_t)(const void *frame, void *client_reference);
+
+
+typedef struct
+{
+	acc_transport_write_func_t      *write;
+	acc_transport_packet_func_t     *packet_received;
+	/** Optional */
+	acc_transport_frame_sent_func_t *frame_sent;
+	void                            *client_reference;
+	/** Memory for one received payload, at least max_payload_size bytes */
+	uint8_t                         *receive_buffer;
+	uint16_t                        max_payload_size;
+	/** Packets the peer may send before any is released */
+	uint16_t                        receive_credits;
+	/** Release every packet when the receive callback returns instead of with acc_transport_release */
+	bool                            auto_release;
+	/** Protect sent packets with a CRC and drop received packets without a valid CRC */
+	bool                            use_crc;
+} acc_transport_config_t;
+
+
+typedef struct
+{
+	uint32_t packets_sent;
+	uint32_t packets_received;
+	uint32_t crc_errors;
+	/** Data packets missing in the sequence */
+	uint32_t lost_packets;
+	/** Bytes skipped while looking for a header */
+	uint32_t skipped_bytes;
+} acc_transport_stats_t;
+
+
+typedef struct
+{
+	const void *data;
+	size_t     size;
+} acc_transport_frame_t;
+
+
+/**
+ * @brief Transport state, the members are private
+ */
+typedef struct
+{
+	acc_transport_config_t config;
+	acc_transport_stats_t  stats;
+
+	acc_transport_frame_t send_queue[ACC_TRANSPORT_SEND_QUEUE_LENGTH];
+	size_t                send_queue_head;
+	size_t                send_queue_count;
+	size_t                send_offset;
+	uint8_t               send_header[ACC_TRANSPORT_HEADER_SIZE];
+	uint8_t               send_sequence;
+	bool                  write_busy;
+	bool                  write_ends_frame;
+	volatile bool         write_done;
+	uint16_t              packets_sent;
+	uint16_t              peer_credits;
+
+	uint16_t credits_granted;
+	uint16_t credits_advertised;
+	bool     credits_update;
+	bool     credits_request;
+
+	uint8_t  receive_header[ACC_TRANSPORT_HEADER_SIZE];
+	size_t   receive_header_length;
+	size_t   receive_payload_length;
+	size_t   receive_payload_size;
+	uint8_t  receive_sequence;
+	bool     receive_sequence_valid;
+	bool     receive_lost;
+} acc_transport_t;
+
+
+/**
+ * @brief Initialize a transport
+ *
+ * The first call to acc_transport_process sends the initial credits to the peer.
+ *
+ * @param[out] transport The transport
+ * @param[in] config The configuration, copied
+ * @return True if the configuration is valid
+ */
+bool acc_transport_init(acc_transport_t *transport, const acc_transport_config_t *config);
+
+
+/**
+ * @brief Queue a frame for sending
+ *
+ * The frame is not copied, it must be kept until the frame sent callback has been called.
+ *
+ * @param[in] transport The transport
+ * @param[in] frame The frame
+ * @param[in] size The size of the frame, may be 0
+ * @return True if the frame was queued, false if the queue is full
+ */
+bool acc_transport_send(acc_transport_t *transport, const void *frame, size_t size);
+
+
+/**
+ * @brief Tell the transport that the last write has completed
+ *
+ * May be called from interrupt context, the next packet is written by
+ * acc_transport_process.
+ *
+ * @param[in] transport The transport
+ */
+void acc_transport_write_done(acc_transport_t *transport);
+
+
+/**
+ * @brief Continue sending
+ *
+ * Must be called after acc_transport_write_done, the other functions call it
+ * themselves.
+ *
+ * @param[in] transport The transport
+ */
+void acc_transport_process(acc_transport_t *transport);
+
+
+/**
+ * @brief Parse received data
+ *
+ * The data does not need to start or end at a packet boundary.
+ *
+ * @param[in] transport The transport
+ * @param[in] data The received data
+ * @param[in] size The number of bytes
+ */
+void acc_transport_receive(acc_transport_t *transport, const uint8_t *data, size_t size);
+
+
+/**
+ * @brief Give the peer credits for packets that have been handled
+ *
+ * Not needed with auto_release.
+ *
+ * @param[in] transport The transport
+ * @param[in] packets The number of packets
+ */
+void acc_transport_release(acc_transport_t *transport, uint16_t packets);
+
+
+/**
+ * @brief Send the credits to the peer again
+ *
+ * Call this when the peer may have missed earlier packets, for example
+ * when it connects or restarts. If frames are waiting for credits the peer
+ * is also asked to send its credits again.
+ *
+ * @param[in] transport The transport
+ */
+void acc_transport_announce(acc_transport_t *transport);
+
+
+/**
+ * @brief Get the number of packets that may be sent before the peer grants more credits
+ *
+ * @param[in] transport The transport
+ * @return The number of packets
+ */
+uint16_t acc_transport_get_send_credits(const acc_transport_t *transport);
+
+
+/**
+ * @brief Check if all queued frames have been sent
+ *
+ * @param[in] transport The transport
+ * @return True if nothing is queued or being written
+ */
+bool acc_transport_is_idle(const acc_transport_t *transport);
+
+
+/**
+ * @brief Get statistics
+ *
+ * @param[in] transport The transport
+ * @return The statistics
+ */
+const acc_transport_stats_t *acc_transport_get_stats(const acc_transport_t *transport);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
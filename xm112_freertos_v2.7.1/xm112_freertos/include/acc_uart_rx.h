@@ -0,0 +1,89 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#ifndef ACC_UART_RX_H_
+#define ACC_UART_RX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Function called by the receive task with received data
+ *
+ * @param[in] port The UART port
+ * @param[in] data The received data, only valid during the call
+ * @param[in] length The number of bytes available in data
+ * @param[in] client_reference The client reference given to acc_uart_rx_start
+ */
+typedef void (*acc_uart_rx_handler_t)(uint_fast8_t port, const uint8_t *data, size_t length, void *client_reference);
+
+
+/**
+ * @brief Receive counters
+ */
+typedef struct
+{
+	/** Bytes passed to the handler */
+	uint32_t received_bytes;
+	/** Bursts of data, each started by one interrupt */
+	uint32_t burst_count;
+	/** UART errors such as overruns, -1 if not supported by the driver */
+	int32_t  error_count;
+} acc_uart_rx_counters_t;
+
+
+/**
+ * @brief Start receiving on a UART in a task
+ *
+ * Received data is written by DMA to a circular buffer. The first byte after an
+ * idle period wakes a receive task, which then reads the buffer every poll period
+ * and passes the data to the handler until a poll finds no new data. The poll
+ * period is short enough for the task to read the buffer before it is half full.
+ *
+ * The handler runs in task context and may parse and act on the data.
+ *
+ * @param[in] port The UART port, initialized with acc_device_uart_init
+ * @param[in] baudrate The baudrate of the port
+ * @param[in] buffer_size The size of the DMA buffer
+ * @param[in] handler Called with the received data
+ * @param[in] client_reference Passed to the handler
+ * @return True if successful, false otherwise
+ */
+bool acc_uart_rx_start(uint_fast8_t port, uint32_t baudrate, size_t buffer_size, acc_uart_rx_handler_t handler,
+                       void *client_reference);
+
+
+/**
+ * @brief Update the poll period after the baudrate of a port has been changed
+ *
+ * @param[in] port The UART port
+ * @param[in] baudrate The new baudrate
+ * @return True if successful, false if receiving was not started or the buffer is too small for the baudrate
+ */
+bool acc_uart_rx_baudrate_set(uint_fast8_t port, uint32_t baudrate);
+
+
+/**
+ * @brief Get the receive counters of a port
+ *
+ * @param[in] port The UART port
+ * @param[out] counters The counters
+ * @return True if receiving was started on the port
+ */
+bool acc_uart_rx_get_counters(uint_fast8_t port, acc_uart_rx_counters_t *counters);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -119,6 +119,31 @@ int fctprintf(void (*out)(char character, void* arg), void* arg, const char* for
  */
 int fctvprintf(void (*out)(char character, void* arg), void* arg, const char* format, va_list va);
 
+
+/**
+ * printf with span output function
+ * Like fctprintf() but the output function gets runs of characters, such as literal text
+ * and whole converted fields, instead of one call per character
+ * \param out An output function which takes a span of characters and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param format A string that specifies the format of the output
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int fctprintf_span(void (*out)(const char* data, size_t length, void* arg), void* arg, const char* format, ...);
+
+
+/**
+ * vprintf with span output function
+ * Like fctvprintf() but the output function gets runs of characters, such as literal text
+ * and whole converted fields, instead of one call per character
+ * \param out An output function which takes a span of characters and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param format A string that specifies the format of the output
+ * \param va A value identifying a variable arguments list
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int fctvprintf_span(void (*out)(const char* data, size_t length, void* arg), void* arg, const char* format, va_list va);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,495 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "acc_alloc_tracker.h"
+#include "acc_device_os.h"
+#include "acc_driver_os.h"
+#include "acc_log.h"
+
+
+#define MODULE "alloc_tracker"
+
+/**
+ * @brief Report lines are not rate limited, a report would otherwise be cut off after the first lines
+ */
+#define REPORT_INFO(...)    ACC_LOG_UNLIMITED(ACC_LOG_LEVEL_INFO, __VA_ARGS__)
+#define REPORT_WARNING(...) ACC_LOG_UNLIMITED(ACC_LOG_LEVEL_WARNING, __VA_ARGS__)
+
+
+#ifndef ACC_ALLOC_TRACKER_SITE_COUNT
+#define ACC_ALLOC_TRACKER_SITE_COUNT 64U
+#endif
+
+#ifndef ACC_ALLOC_TRACKER_OWNER_COUNT
+#define ACC_ALLOC_TRACKER_OWNER_COUNT 16U
+#endif
+
+#if ACC_ALLOC_TRACKER_SITE_COUNT > 256U || ACC_ALLOC_TRACKER_OWNER_COUNT > 256U
+#error "Call sites and owners are stored as 8 bit indexes"
+#endif
+
+// Index 0 of the site and owner tables collects everything that did not fit
+#define OTHER_INDEX  0U
+
+#define HEADER_MAGIC 0xA110U
+
+// Heap block headers and alignment padding are not shown as gaps in the heap map
+#define MAP_GAP_MIN 16U
+
+
+/**
+ * @brief Header in front of each tracked allocation
+ *
+ * The call site and the owner are indexes into the tables below, which keeps
+ * the header at 24 bytes on a 32 bit target.
+ */
+typedef struct header
+{
+	struct header *next;
+	struct header *prev;
+	uint32_t      size;
+	uint32_t      sequence;
+	uint32_t      time_ms;
+	uint8_t       site;
+	uint8_t       owner;
+	uint16_t      check;
+} header_t;
+
+// Rounded up to keep the returned memory 8 byte aligned
+#define HEADER_SIZE ((sizeof(header_t) + 7U) & ~(size_t)7U)
+
+
+typedef struct
+{
+	/** File name, or return address when line is 0 */
+	const void *site;
+	uint16_t   line;
+	uint32_t   live_count;
+	uint32_t   total_count;
+	size_t     current_bytes;
+	size_t     peak_bytes;
+	/** Bytes held by this site when the total was at its peak */
+	size_t     bytes_at_total_peak;
+} site_t;
+
+
+static site_t   sites[ACC_ALLOC_TRACKER_SITE_COUNT];
+static char     owners[ACC_ALLOC_TRACKER_OWNER_COUNT][configMAX_TASK_NAME_LEN];
+static uint32_t owner_count = 1U;
+
+static header_t                  *live_list;
+static uint32_t                  next_sequence = 1U;
+static acc_alloc_tracker_stats_t totals;
+
+
+static uint16_t header_check(const header_t *header)
+{
+	return (uint16_t)(HEADER_MAGIC ^ (uint16_t)((uintptr_t)header >> 3) ^ (uint16_t)header->size);
+}
+
+
+/**
+ * @brief Find or add the table entry of a call site, must be called with the scheduler suspended
+ */
+static uint8_t site_lookup(const void *site, uint16_t line)
+{
+	uint32_t hash  = (uint32_t)(((uintptr_t)site >> 2) ^ ((uintptr_t)line * 2654435761U));
+	uint32_t slots = ACC_ALLOC_TRACKER_SITE_COUNT - 1U;
+
+	for (uint32_t probe = 0U; probe < slots; probe++)
+	{
+		uint32_t index = 1U + (hash + probe) % slots;
+
+		if (sites[index].site == site && sites[index].line == line)
+		{
+			return (uint8_t)index;
+		}
+
+		if (sites[index].site == NULL)
+		{
+			sites[index].site = site;
+			sites[index].line = line;
+
+			return (uint8_t)index;
+		}
+	}
+
+	totals.untracked_site_count++;
+
+	return OTHER_INDEX;
+}
+
+
+/**
+ * @brief Find or add the table entry of the calling task, must be called with the scheduler suspended
+ */
+static uint8_t owner_lookup(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+	{
+		return OTHER_INDEX;
+	}
+
+	const char *name = pcTaskGetName(NULL);
+
+	for (uint32_t index = 1U; index < owner_count; index++)
+	{
+		if (strncmp(owners[index], name, configMAX_TASK_NAME_LEN) == 0)
+		{
+			return (uint8_t)index;
+		}
+	}
+
+	if (owner_count < ACC_ALLOC_TRACKER_OWNER_COUNT)
+	{
+		strncpy(owners[owner_count], name, configMAX_TASK_NAME_LEN);
+
+		return (uint8_t)owner_count++;
+	}
+
+	return OTHER_INDEX;
+}
+
+
+static void site_format(const site_t *site, char *buffer, size_t buffer_size)
+{
+	if (site->site == NULL)
+	{
+		snprintf(buffer, buffer_size, "other");
+	}
+	else if (site->line == 0U)
+	{
+		snprintf(buffer, buffer_size, "rss@%p", site->site);
+	}
+	else
+	{
+		snprintf(buffer, buffer_size, "%s:%u", (const char *)site->site, (unsigned int)site->line);
+	}
+}
+
+
+void *acc_alloc_tracker_alloc(size_t size, const char *file, uint16_t line, const void *caller)
+{
+	if (size == 0U || size > UINT32_MAX - HEADER_SIZE || acc_device_os_mem_alloc_func == NULL)
+	{
+		return NULL;
+	}
+
+	uint32_t time_ms = acc_os_get_time();
+	header_t *header = acc_device_os_mem_alloc_func(HEADER_SIZE + size);
+
+	vTaskSuspendAll();
+
+	if (header == NULL)
+	{
+		totals.failed_count++;
+		(void)xTaskResumeAll();
+
+		return NULL;
+	}
+
+	site_t *site = &sites[site_lookup(file != NULL ? (const void *)file : caller, file != NULL ? line : 0U)];
+
+	header->size     = (uint32_t)size;
+	header->sequence = next_sequence++;
+	header->time_ms  = time_ms;
+	header->site     = (uint8_t)(site - sites);
+	header->owner    = owner_lookup();
+	header->check    = header_check(header);
+
+	header->prev = NULL;
+	header->next = live_list;
+	if (live_list != NULL)
+	{
+		live_list->prev = header;
+	}
+
+	live_list = header;
+
+	site->live_count++;
+	site->total_count++;
+	site->current_bytes += size;
+	if (site->current_bytes > site->peak_bytes)
+	{
+		site->peak_bytes = site->current_bytes;
+	}
+
+	totals.live_count++;
+	totals.current_bytes  += size;
+	totals.overhead_bytes += HEADER_SIZE;
+	if (totals.current_bytes > totals.peak_bytes)
+	{
+		totals.peak_bytes = totals.current_bytes;
+
+		for (uint32_t index = 0U; index < ACC_ALLOC_TRACKER_SITE_COUNT; index++)
+		{
+			sites[index].bytes_at_total_peak = sites[index].current_bytes;
+		}
+	}
+
+	(void)xTaskResumeAll();
+
+	return (uint8_t *)header + HEADER_SIZE;
+}
+
+
+void acc_alloc_tracker_free(void *ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	header_t *header = (header_t *)(void *)((uint8_t *)ptr - HEADER_SIZE);
+
+	if (header->check != header_check(header))
+	{
+		ACC_LOG_ERROR("Free of untracked or corrupted memory %p, not freed", ptr);
+		return;
+	}
+
+	vTaskSuspendAll();
+
+	site_t *site = &sites[header->site];
+
+	site->live_count--;
+	site->current_bytes -= header->size;
+
+	totals.live_count--;
+	totals.current_bytes  -= header->size;
+	totals.overhead_bytes -= HEADER_SIZE;
+
+	if (header->prev != NULL)
+	{
+		header->prev->next = header->next;
+	}
+	else
+	{
+		live_list = header->next;
+	}
+
+	if (header->next != NULL)
+	{
+		header->next->prev = header->prev;
+	}
+
+	// Catch double free
+	header->check = 0U;
+
+	(void)xTaskResumeAll();
+
+	acc_device_os_mem_free_func(header);
+}
+
+
+void *acc_alloc_tracker_hal_mem_alloc(size_t size)
+{
+	return acc_alloc_tracker_alloc(size, NULL, 0U, __builtin_return_address(0));
+}
+
+
+acc_alloc_tracker_checkpoint_t acc_alloc_tracker_checkpoint(void)
+{
+	vTaskSuspendAll();
+	acc_alloc_tracker_checkpoint_t checkpoint = next_sequence;
+	(void)xTaskResumeAll();
+
+	return checkpoint;
+}
+
+
+/**
+ * @brief Copy of a live allocation, so that it can be logged without the scheduler suspended
+ */
+typedef struct
+{
+	const void *address;
+	header_t   header;
+	site_t     site;
+	char       owner[configMAX_TASK_NAME_LEN + 1U];
+} allocation_t;
+
+
+static void allocation_copy(const header_t *header, allocation_t *allocation)
+{
+	allocation->address = (const uint8_t *)header + HEADER_SIZE;
+	allocation->header  = *header;
+	allocation->site    = sites[header->site];
+	strncpy(allocation->owner, header->owner != OTHER_INDEX ? owners[header->owner] : "-", configMAX_TASK_NAME_LEN);
+	allocation->owner[configMAX_TASK_NAME_LEN] = '\0';
+}
+
+
+static void allocation_log(const allocation_t *allocation)
+{
+	char site[48];
+
+	site_format(&allocation->site, site, sizeof(site));
+
+	REPORT_INFO("%p %6" PRIu32 " bytes  #%-6" PRIu32 " %8" PRIu32 " ms  %-10s %s",
+	            allocation->address, allocation->header.size, allocation->header.sequence,
+	            allocation->header.time_ms, allocation->owner, site);
+}
+
+
+uint32_t acc_alloc_tracker_log_leaks(acc_alloc_tracker_checkpoint_t start, acc_alloc_tracker_checkpoint_t end)
+{
+	uint32_t     leak_count = 0U;
+	uint32_t     leak_bytes = 0U;
+	uint32_t     last       = start;
+	allocation_t allocation;
+
+	// The live list is newest first, each pass finds the oldest leak after the previous one
+	while (true)
+	{
+		const header_t *oldest = NULL;
+
+		vTaskSuspendAll();
+
+		for (const header_t *header = live_list; header != NULL && header->sequence >= last; header = header->next)
+		{
+			if (header->sequence < end)
+			{
+				oldest = header;
+			}
+		}
+
+		if (oldest != NULL)
+		{
+			allocation_copy(oldest, &allocation);
+		}
+
+		(void)xTaskResumeAll();
+
+		if (oldest == NULL)
+		{
+			break;
+		}
+
+		if (leak_count == 0U)
+		{
+			REPORT_WARNING("Allocations between checkpoint %" PRIu32 " and %" PRIu32 " still live:", start, end);
+		}
+
+		allocation_log(&allocation);
+
+		leak_count++;
+		leak_bytes += allocation.header.size;
+		last        = allocation.header.sequence + 1U;
+	}
+
+	if (leak_count == 0U)
+	{
+		REPORT_INFO("No leaks between checkpoint %" PRIu32 " and %" PRIu32, start, end);
+	}
+	else
+	{
+		REPORT_WARNING("%" PRIu32 " allocations leaked, %" PRIu32 " bytes", leak_count, leak_bytes);
+	}
+
+	return leak_count;
+}
+
+
+void acc_alloc_tracker_log_report(void)
+{
+	acc_alloc_tracker_stats_t stats;
+
+	acc_alloc_tracker_get_stats(&stats);
+
+	REPORT_INFO("Allocations: %" PRIu32 " live, %" PRIu32 " bytes, peak %" PRIu32 " bytes, header overhead %" PRIu32 " bytes",
+	            stats.live_count, (uint32_t)stats.current_bytes, (uint32_t)stats.peak_bytes, (uint32_t)stats.overhead_bytes);
+	REPORT_INFO("%8s %8s %8s %6s %8s  %s", "current", "peak", "at peak", "live", "total", "site");
+
+	for (uint32_t index = 0U; index < ACC_ALLOC_TRACKER_SITE_COUNT; index++)
+	{
+		site_t site;
+
+		vTaskSuspendAll();
+		site = sites[index];
+		(void)xTaskResumeAll();
+
+		if (site.total_count == 0U)
+		{
+			continue;
+		}
+
+		char name[48];
+
+		site_format(&site, name, sizeof(name));
+
+		REPORT_INFO("%8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %6" PRIu32 " %8" PRIu32 "  %s",
+		            (uint32_t)site.current_bytes, (uint32_t)site.peak_bytes, (uint32_t)site.bytes_at_total_peak,
+		            site.live_count, site.total_count, name);
+	}
+}
+
+
+void acc_alloc_tracker_log_heap_map(void)
+{
+	uintptr_t    last_end = 0U;
+	uintptr_t    after    = 0U;
+	allocation_t allocation;
+
+	REPORT_INFO("Heap map, header of %u bytes in front of each allocation:", (unsigned int)HEADER_SIZE);
+
+	// Each pass finds the allocation with the lowest address above the previous one
+	while (true)
+	{
+		const header_t *next = NULL;
+
+		vTaskSuspendAll();
+
+		for (const header_t *header = live_list; header != NULL; header = header->next)
+		{
+			if ((uintptr_t)header > after && (next == NULL || header < next))
+			{
+				next = header;
+			}
+		}
+
+		if (next != NULL)
+		{
+			allocation_copy(next, &allocation);
+		}
+
+		(void)xTaskResumeAll();
+
+		if (next == NULL)
+		{
+			break;
+		}
+
+		if (last_end != 0U && (uintptr_t)next > last_end + MAP_GAP_MIN)
+		{
+			REPORT_INFO("%p %6" PRIu32 " bytes  free or untracked", (const void *)last_end,
+			            (uint32_t)((uintptr_t)next - last_end));
+		}
+
+		allocation_log(&allocation);
+
+		after    = (uintptr_t)next;
+		last_end = (uintptr_t)allocation.address + allocation.header.size;
+	}
+}
+
+
+void acc_alloc_tracker_get_stats(acc_alloc_tracker_stats_t *stats)
+{
+	vTaskSuspendAll();
+	*stats = totals;
+	(void)xTaskResumeAll();
+}
@@ -5,15 +5,36 @@
 // of this source code package.
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "acc_app_integration.h"
+#include "acc_app_integration_freertos.h"
+#include "acc_pool.h"
+#include "acc_tcm.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
 
 #define ACC_APP_STACK_SIZE 6000
 
+#ifndef ACC_APP_INTEGRATION_THREAD_POOL_SIZE
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+// Each thread object holds its stack
+#define ACC_APP_INTEGRATION_THREAD_POOL_SIZE 4U
+#else
+#define ACC_APP_INTEGRATION_THREAD_POOL_SIZE 8U
+#endif
+#endif
+
+#ifndef ACC_APP_INTEGRATION_MUTEX_POOL_SIZE
+#define ACC_APP_INTEGRATION_MUTEX_POOL_SIZE 16U
+#endif
+
+#ifndef ACC_APP_INTEGRATION_SEMAPHORE_POOL_SIZE
+#define ACC_APP_INTEGRATION_SEMAPHORE_POOL_SIZE 24U
+#endif
+
 
 typedef struct acc_app_integration_thread_handle
 {
@@ -21,15 +42,81 @@ typedef struct acc_app_integration_thread_handle
 	void (*func)(void *param);
 	void              *param;
 	SemaphoreHandle_t stopped;
+	StaticSemaphore_t stopped_buffer;
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	StaticTask_t      task_buffer;
+	StackType_t       stack[ACC_APP_STACK_SIZE / sizeof(StackType_t)];
+#endif
 } acc_app_integration_thread_handle;
 
 
+ACC_POOL_DEFINE(thread_pool, acc_app_integration_thread_handle, ACC_APP_INTEGRATION_THREAD_POOL_SIZE);
+ACC_POOL_DEFINE(mutex_pool, StaticSemaphore_t, ACC_APP_INTEGRATION_MUTEX_POOL_SIZE);
+ACC_POOL_DEFINE(semaphore_pool, StaticSemaphore_t, ACC_APP_INTEGRATION_SEMAPHORE_POOL_SIZE);
+
+
+/**
+ * @brief Take an object from a pool, or from the heap when the pool is exhausted
+ */
+static void *pool_alloc(acc_pool_t *pool, size_t size)
+{
+	void *object = acc_pool_alloc(pool);
+
+	return object != NULL ? object : pvPortMalloc(size);
+}
+
+
+static void pool_free(acc_pool_t *pool, void *object)
+{
+	if (acc_pool_contains(pool, object))
+	{
+		acc_pool_free(pool, object);
+	}
+	else
+	{
+		vPortFree(object);
+	}
+}
+
+
+/**
+ * @brief Create a FreeRTOS semaphore or mutex in a pool object, or on the heap when the pool is exhausted
+ */
+static SemaphoreHandle_t semaphore_create(acc_pool_t *pool, bool mutex)
+{
+	StaticSemaphore_t *buffer = acc_pool_alloc(pool);
+
+	if (buffer == NULL)
+	{
+		return mutex ? xSemaphoreCreateMutex() : xSemaphoreCreateBinary();
+	}
+
+	return mutex ? xSemaphoreCreateMutexStatic(buffer) : xSemaphoreCreateBinaryStatic(buffer);
+}
+
+
+static void semaphore_destroy(acc_pool_t *pool, SemaphoreHandle_t semaphore)
+{
+	// Frees the memory only if it was allocated from the heap
+	vSemaphoreDelete(semaphore);
+
+	if (acc_pool_contains(pool, semaphore))
+	{
+		acc_pool_free(pool, semaphore);
+	}
+}
+
+
 void acc_app_integration_thread_cleanup(acc_app_integration_thread_handle_t thread)
 {
 	assert(thread != NULL);
 	xSemaphoreTake(thread->stopped, portMAX_DELAY);
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	// Deleting another task is done at once, the stack and task buffer can then be reused
+	vTaskDelete(thread->handle);
+#endif
 	vSemaphoreDelete(thread->stopped);
-	vPortFree(thread);
+	pool_free(&thread_pool, thread);
 }
 
 
@@ -50,7 +137,18 @@ static void acc_app_integration_thread_work(void *thread_handle)
 	thread->func(thread->param);
 
 	xSemaphoreGive(thread->stopped);
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	/*
+	 * A task deleting itself is removed by the idle task later, which must not
+	 * happen after its memory has been reused. Wait for the cleanup to delete it.
+	 */
+	for (;;)
+	{
+		vTaskSuspend(NULL);
+	}
+#else
 	vTaskDelete(NULL);
+#endif
 }
 
 
@@ -60,29 +158,29 @@ acc_app_integration_thread_handle_t acc_app_integration_thread_create(void (*fun
 	BaseType_t                          result;
 	acc_app_integration_thread_handle_t thread = NULL;
 
-	thread = pvPortMalloc(sizeof(*thread));
+	thread = pool_alloc(&thread_pool, sizeof(*thread));
 
 	if (thread == NULL)
 	{
 		return NULL;
 	}
 
-	thread->func  = func;
-	thread->param = param;
-
-	thread->stopped = xSemaphoreCreateBinary();
-	if (thread->stopped == NULL)
-	{
-		vPortFree(thread);
-		return NULL;
-	}
+	thread->func    = func;
+	thread->param   = param;
+	thread->stopped = xSemaphoreCreateBinaryStatic(&thread->stopped_buffer);
 
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	thread->handle = xTaskCreateStatic(acc_app_integration_thread_work, name, ACC_APP_STACK_SIZE / sizeof(StackType_t), thread,
+	                                   tskIDLE_PRIORITY + 1, thread->stack, &thread->task_buffer);
+	result = thread->handle != NULL ? pdPASS : pdFAIL;
+#else
 	result = xTaskCreate(acc_app_integration_thread_work, name, ACC_APP_STACK_SIZE / sizeof(int), thread, tskIDLE_PRIORITY + 1,
 	                     (TaskHandle_t *)&thread->handle);
+#endif
 	if (result != pdPASS)
 	{
 		vSemaphoreDelete(thread->stopped);
-		vPortFree(thread);
+		pool_free(&thread_pool, thread);
 		return NULL;
 	}
 
@@ -92,14 +190,14 @@ acc_app_integration_thread_handle_t acc_app_integration_thread_create(void (*fun
 
 acc_app_integration_mutex_t acc_app_integration_mutex_create(void)
 {
-	return (acc_app_integration_mutex_t)xSemaphoreCreateMutex();
+	return (acc_app_integration_mutex_t)semaphore_create(&mutex_pool, true);
 }
 
 
 void acc_app_integration_mutex_destroy(acc_app_integration_mutex_t mutex)
 {
 	assert(mutex != NULL);
-	vSemaphoreDelete(mutex);
+	semaphore_destroy(&mutex_pool, (SemaphoreHandle_t)mutex);
 	mutex = NULL;
 }
 
@@ -153,14 +251,14 @@ void acc_app_integration_sleep_ms(uint32_t time_msec)
 
 acc_app_integration_semaphore_t acc_app_integration_semaphore_create(void)
 {
-	return (acc_app_integration_semaphore_t)xSemaphoreCreateBinary();;
+	return (acc_app_integration_semaphore_t)semaphore_create(&semaphore_pool, false);
 }
 
 
 void acc_app_integration_semaphore_destroy(acc_app_integration_semaphore_t sem)
 {
 	assert(sem != NULL);
-	vSemaphoreDelete(sem);
+	semaphore_destroy(&semaphore_pool, (SemaphoreHandle_t)sem);
 }
 
 
@@ -173,14 +271,11 @@ bool acc_app_integration_semaphore_wait(acc_app_integration_semaphore_t sem, uin
 
 static bool is_interrupt_context(void)
 {
-	uint32_t ipsr;
-
-	__asm("mrs %0, ipsr" : "=r" (ipsr));
-	return ipsr != 0;
+	return xPortIsInsideInterrupt() == pdTRUE;
 }
 
 
-void acc_app_integration_semaphore_signal(acc_app_integration_semaphore_t sem)
+ACC_TCM_CODE void acc_app_integration_semaphore_signal(acc_app_integration_semaphore_t sem)
 {
 	assert(sem != NULL);
 	if (is_interrupt_context())
@@ -206,3 +301,11 @@ void acc_app_integration_mem_free(void *ptr)
 {
 	vPortFree(ptr);
 }
+
+
+void acc_app_integration_freertos_get_pool_stats(acc_pool_stats_t stats[ACC_APP_INTEGRATION_FREERTOS_POOL_COUNT])
+{
+	acc_pool_get_stats(&thread_pool, &stats[0]);
+	acc_pool_get_stats(&mutex_pool, &stats[1]);
+	acc_pool_get_stats(&semaphore_pool, &stats[2]);
+}
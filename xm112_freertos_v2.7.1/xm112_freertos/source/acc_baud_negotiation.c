@@ -0,0 +1,454 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "acc_baud_negotiation.h"
+#include "acc_command.h"
+#include "acc_log.h"
+
+
+#define MODULE "baud_negotiation" /**< module name */
+
+
+/**
+ * @brief Largest number of words in a command
+ */
+#define MAX_WORDS 4
+
+/**
+ * @brief Seeds are sent as positive int32_t
+ */
+#define SEED_MASK 0x7fffffffU
+
+/**
+ * @brief Characters in the test pattern, no separators or delimiters
+ */
+static const char pattern_characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+
+static uint32_t next_random(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	*state = x;
+
+	return x;
+}
+
+
+static void pattern_create(uint32_t seed, char *pattern)
+{
+	uint32_t state = seed != 0 ? seed : 1U;
+
+	for (uint32_t i = 0; i < ACC_BAUD_NEGOTIATION_PATTERN_LENGTH; i++)
+	{
+		pattern[i] = pattern_characters[next_random(&state) % (sizeof(pattern_characters) - 1)];
+	}
+
+	pattern[ACC_BAUD_NEGOTIATION_PATTERN_LENGTH] = '\0';
+}
+
+
+static bool pattern_is_valid(uint32_t seed, const char *pattern)
+{
+	char expected[ACC_BAUD_NEGOTIATION_PATTERN_LENGTH + 1];
+
+	pattern_create(seed, expected);
+
+	return strcmp(pattern, expected) == 0;
+}
+
+
+static bool parse_uint32(const char *text, uint32_t *value)
+{
+	int32_t parsed;
+
+	if (!acc_command_parse_int32(text, &parsed) || parsed < 0)
+	{
+		return false;
+	}
+
+	*value = (uint32_t)parsed;
+
+	return true;
+}
+
+
+/**
+ * @brief Check if the first word of a command is BAUD or BAUD?
+ *
+ * Other commands that happen to start with BAUD are not negotiation commands.
+ */
+static bool is_baud_command(const char *command)
+{
+	if (strncmp(command, "BAUD", 4) != 0)
+	{
+		return false;
+	}
+
+	const char *end = command[4] == '?' ? &command[5] : &command[4];
+
+	return *end == '\0' || *end == ' ' || *end == '\t' || *end == ',';
+}
+
+
+static bool send_line(acc_baud_negotiation_t *negotiation, const char *line, int length)
+{
+	if (length < 0 || length > (int)ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 1)
+	{
+		return false;
+	}
+
+	return negotiation->port.write(line, (size_t)length, negotiation->port.client_reference);
+}
+
+
+static void deadline_set(acc_baud_negotiation_t *negotiation)
+{
+	negotiation->deadline_ms = negotiation->port.time_get(negotiation->port.client_reference) + ACC_BAUD_NEGOTIATION_TIMEOUT_MS;
+}
+
+
+static bool switch_baudrate(acc_baud_negotiation_t *negotiation, uint32_t baudrate)
+{
+	if (!negotiation->port.baudrate_set(baudrate, negotiation->port.client_reference))
+	{
+		ACC_LOG_ERROR("Failed to set baudrate %u", (unsigned int)baudrate);
+		return false;
+	}
+
+	negotiation->baudrate = baudrate;
+
+	return true;
+}
+
+
+/**
+ * @brief Go back to the baudrate used before the negotiation
+ */
+static void fall_back(acc_baud_negotiation_t *negotiation)
+{
+	if (negotiation->baudrate != negotiation->fallback_baudrate)
+	{
+		ACC_LOG_WARNING("Baudrate %u failed, back to %u", (unsigned int)negotiation->baudrate,
+		                (unsigned int)negotiation->fallback_baudrate);
+		switch_baudrate(negotiation, negotiation->fallback_baudrate);
+	}
+
+	negotiation->state = negotiation->is_device ? ACC_BAUD_NEGOTIATION_STATE_IDLE : ACC_BAUD_NEGOTIATION_STATE_FAILED;
+}
+
+
+static void device_command(acc_baud_negotiation_t *negotiation, char **words, size_t word_count)
+{
+	char     line[ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 2];
+	int      length;
+	uint32_t value;
+
+	switch (negotiation->state)
+	{
+		case ACC_BAUD_NEGOTIATION_STATE_IDLE:
+			if (word_count == 1 && strcmp(words[0], "BAUD?") == 0)
+			{
+				length = snprintf(line, sizeof(line), "BAUD MAX %u\n", (unsigned int)negotiation->max_baudrate);
+				send_line(negotiation, line, length);
+			}
+			else if (word_count == 2 && parse_uint32(words[1], &value) && value > 0)
+			{
+				uint32_t actual_baudrate;
+				uint32_t error_ppm = acc_baud_negotiation_error_ppm(negotiation->max_baudrate, value, &actual_baudrate);
+
+				if (value > negotiation->max_baudrate || error_ppm > ACC_BAUD_NEGOTIATION_MAX_ERROR_PPM)
+				{
+					length = snprintf(line, sizeof(line), "BAUD NAK %u %u\n", (unsigned int)value, (unsigned int)error_ppm);
+					send_line(negotiation, line, length);
+					break;
+				}
+
+				// The acknowledgement is sent at the current baudrate before switching
+				length = snprintf(line, sizeof(line), "BAUD OK %u %u\n", (unsigned int)value, (unsigned int)actual_baudrate);
+
+				if (send_line(negotiation, line, length))
+				{
+					negotiation->fallback_baudrate = negotiation->baudrate;
+					negotiation->proposed_baudrate = value;
+
+					if (switch_baudrate(negotiation, value))
+					{
+						negotiation->state = ACC_BAUD_NEGOTIATION_STATE_TESTING;
+						deadline_set(negotiation);
+					}
+				}
+			}
+
+			break;
+		case ACC_BAUD_NEGOTIATION_STATE_TESTING:
+			if (word_count == 4 && strcmp(words[1], "TEST") == 0 && parse_uint32(words[2], &value) &&
+			    pattern_is_valid(value, words[3]))
+			{
+				length = snprintf(line, sizeof(line), "BAUD ECHO %u %s\n", (unsigned int)value, words[3]);
+				send_line(negotiation, line, length);
+				negotiation->state = ACC_BAUD_NEGOTIATION_STATE_COMMITTING;
+				deadline_set(negotiation);
+			}
+			else
+			{
+				fall_back(negotiation);
+			}
+
+			break;
+		case ACC_BAUD_NEGOTIATION_STATE_COMMITTING:
+			if (word_count == 2 && strcmp(words[1], "COMMIT") == 0)
+			{
+				length = snprintf(line, sizeof(line), "BAUD DONE %u\n", (unsigned int)negotiation->baudrate);
+				send_line(negotiation, line, length);
+				negotiation->state = ACC_BAUD_NEGOTIATION_STATE_IDLE;
+				ACC_LOG_INFO("Baudrate changed to %u", (unsigned int)negotiation->baudrate);
+			}
+			else
+			{
+				fall_back(negotiation);
+			}
+
+			break;
+		default:
+			break;
+	}
+}
+
+
+static void host_command(acc_baud_negotiation_t *negotiation, char **words, size_t word_count)
+{
+	char     line[ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 2];
+	int      length;
+	uint32_t value;
+
+	if (word_count == 3 && strcmp(words[1], "MAX") == 0 && parse_uint32(words[2], &value))
+	{
+		negotiation->max_baudrate = value;
+		return;
+	}
+
+	switch (negotiation->state)
+	{
+		case ACC_BAUD_NEGOTIATION_STATE_PROPOSED:
+			if (word_count >= 3 && parse_uint32(words[2], &value) && value == negotiation->proposed_baudrate)
+			{
+				if (strcmp(words[1], "OK") != 0)
+				{
+					negotiation->state = ACC_BAUD_NEGOTIATION_STATE_FAILED;
+					break;
+				}
+
+				char pattern[ACC_BAUD_NEGOTIATION_PATTERN_LENGTH + 1];
+
+				negotiation->fallback_baudrate = negotiation->baudrate;
+				negotiation->seed              = (next_random(&negotiation->seed) & SEED_MASK) | 1U;
+
+				if (!switch_baudrate(negotiation, value))
+				{
+					negotiation->state = ACC_BAUD_NEGOTIATION_STATE_FAILED;
+					break;
+				}
+
+				pattern_create(negotiation->seed, pattern);
+				length = snprintf(line, sizeof(line), "BAUD TEST %u %s\n", (unsigned int)negotiation->seed, pattern);
+				send_line(negotiation, line, length);
+				negotiation->state = ACC_BAUD_NEGOTIATION_STATE_TESTING;
+				deadline_set(negotiation);
+			}
+
+			break;
+		case ACC_BAUD_NEGOTIATION_STATE_TESTING:
+			if (word_count == 4 && strcmp(words[1], "ECHO") == 0 && parse_uint32(words[2], &value) &&
+			    value == negotiation->seed && pattern_is_valid(value, words[3]))
+			{
+				send_line(negotiation, "BAUD COMMIT\n", (int)strlen("BAUD COMMIT\n"));
+				negotiation->state = ACC_BAUD_NEGOTIATION_STATE_COMMITTING;
+				deadline_set(negotiation);
+			}
+			else
+			{
+				fall_back(negotiation);
+			}
+
+			break;
+		case ACC_BAUD_NEGOTIATION_STATE_COMMITTING:
+			if (word_count == 3 && strcmp(words[1], "DONE") == 0 && parse_uint32(words[2], &value) &&
+			    value == negotiation->baudrate)
+			{
+				negotiation->state = ACC_BAUD_NEGOTIATION_STATE_DONE;
+			}
+
+			break;
+		default:
+			break;
+	}
+}
+
+
+uint32_t acc_baud_negotiation_error_ppm(uint32_t max_baudrate, uint32_t baudrate, uint32_t *actual_baudrate)
+{
+	if (max_baudrate == 0 || baudrate == 0)
+	{
+		return UINT32_MAX;
+	}
+
+	uint32_t divisor = (max_baudrate + baudrate / 2) / baudrate;
+
+	if (divisor == 0)
+	{
+		divisor = 1;
+	}
+
+	uint32_t actual     = max_baudrate / divisor;
+	uint32_t difference = actual > baudrate ? actual - baudrate : baudrate - actual;
+
+	if (actual_baudrate != NULL)
+	{
+		*actual_baudrate = actual;
+	}
+
+	return (uint32_t)(((uint64_t)difference * 1000000U) / baudrate);
+}
+
+
+void acc_baud_negotiation_device_init(acc_baud_negotiation_t            *negotiation,
+                                      const acc_baud_negotiation_port_t *port,
+                                      uint32_t                          max_baudrate,
+                                      uint32_t                          baudrate)
+{
+	memset(negotiation, 0, sizeof(*negotiation));
+
+	negotiation->port              = *port;
+	negotiation->is_device         = true;
+	negotiation->state             = ACC_BAUD_NEGOTIATION_STATE_IDLE;
+	negotiation->max_baudrate      = max_baudrate;
+	negotiation->baudrate          = baudrate;
+	negotiation->fallback_baudrate = baudrate;
+}
+
+
+void acc_baud_negotiation_host_init(acc_baud_negotiation_t            *negotiation,
+                                    const acc_baud_negotiation_port_t *port,
+                                    uint32_t                          baudrate)
+{
+	memset(negotiation, 0, sizeof(*negotiation));
+
+	negotiation->port              = *port;
+	negotiation->is_device         = false;
+	negotiation->state             = ACC_BAUD_NEGOTIATION_STATE_IDLE;
+	negotiation->baudrate          = baudrate;
+	negotiation->fallback_baudrate = baudrate;
+	negotiation->seed              = (port->time_get(port->client_reference) & SEED_MASK) | 1U;
+}
+
+
+bool acc_baud_negotiation_host_query(acc_baud_negotiation_t *negotiation)
+{
+	return send_line(negotiation, "\nBAUD?\n", (int)strlen("\nBAUD?\n"));
+}
+
+
+bool acc_baud_negotiation_host_start(acc_baud_negotiation_t *negotiation, uint32_t baudrate)
+{
+	if (acc_baud_negotiation_is_busy(negotiation) || baudrate == 0)
+	{
+		return false;
+	}
+
+	negotiation->proposed_baudrate = baudrate;
+
+	char line[ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 2];
+	int  length = snprintf(line, sizeof(line), "\nBAUD %u\n", (unsigned int)baudrate);
+
+	if (!send_line(negotiation, line, length))
+	{
+		negotiation->state = ACC_BAUD_NEGOTIATION_STATE_FAILED;
+		return false;
+	}
+
+	negotiation->state = ACC_BAUD_NEGOTIATION_STATE_PROPOSED;
+	deadline_set(negotiation);
+
+	return true;
+}
+
+
+bool acc_baud_negotiation_command(acc_baud_negotiation_t *negotiation, char *command)
+{
+	char   *words[MAX_WORDS];
+	bool   busy       = acc_baud_negotiation_is_busy(negotiation);
+	bool   is_command = is_baud_command(command);
+	size_t word_count;
+
+	if (!is_command && !(busy && negotiation->is_device))
+	{
+		return false;
+	}
+
+	word_count = acc_command_split(command, words, MAX_WORDS);
+
+	if (word_count == 0 || !is_command)
+	{
+		// Anything else received by the device during a negotiation means that the baudrates differ
+		fall_back(negotiation);
+		return true;
+	}
+
+	if (negotiation->is_device)
+	{
+		device_command(negotiation, words, word_count);
+	}
+	else
+	{
+		host_command(negotiation, words, word_count);
+	}
+
+	return true;
+}
+
+
+void acc_baud_negotiation_poll(acc_baud_negotiation_t *negotiation)
+{
+	if (!acc_baud_negotiation_is_busy(negotiation))
+	{
+		return;
+	}
+
+	uint32_t now = negotiation->port.time_get(negotiation->port.client_reference);
+
+	if ((int32_t)(now - negotiation->deadline_ms) < 0)
+	{
+		return;
+	}
+
+	if (negotiation->state == ACC_BAUD_NEGOTIATION_STATE_PROPOSED)
+	{
+		// Nothing has been switched yet
+		negotiation->state = ACC_BAUD_NEGOTIATION_STATE_FAILED;
+		return;
+	}
+
+	fall_back(negotiation);
+}
+
+
+bool acc_baud_negotiation_is_busy(const acc_baud_negotiation_t *negotiation)
+{
+	return negotiation->state == ACC_BAUD_NEGOTIATION_STATE_PROPOSED ||
+	       negotiation->state == ACC_BAUD_NEGOTIATION_STATE_TESTING ||
+	       negotiation->state == ACC_BAUD_NEGOTIATION_STATE_COMMITTING;
+}
@@ -34,14 +34,22 @@
 #include "acc_driver_os_freertos.h"
 #include "acc_driver_pm_same70.h"
 #include "acc_driver_spi_same70.h"
+#include "acc_driver_timestamp_same70.h"
+#ifdef ACC_CFG_USB_CDC
+#include "acc_driver_usb_cdc_same70.h"
+#endif
 #ifdef ACC_CFG_ENABLE_TRACECLOCK
 #include "acc_driver_traceclock_cmx.h"
 #endif
 #include "acc_board.h"
 #include "acc_board_a1r2_xm112.h"
+#include "acc_board_sensors.h"
+#include "acc_console.h"
 #include "acc_driver_uart_same70.h"
 #include "acc_log.h"
+#include "acc_log_binary.h"
 #include "acc_ms_system.h"
+#include "acc_tcm.h"
 
 /**
  * @brief The module name
@@ -62,8 +70,6 @@
 extern uint8_t acc_debug_uart_port;
 
 
-#define XM11x_SENSOR_COUNT (1)
-
 #define XM11x_SENSOR_REFERENCE_FREQUENCY (24000000)
 #define XM11x_SPI_SPEED                  (48000000)
 #define XM11x_SPI_MASTER_BUS             (1)
@@ -71,6 +77,7 @@ extern uint8_t acc_debug_uart_port;
 #define XM11x_SPI_CS                     (0)
 #define XM11x_SPI_MASTER_BUF_SIZE        (1024)
 #define XM11x_SPI_SLAVE_BUF_SIZE         (8)
+#define XM11x_SPI_MASTER_ZERO_COPY       (true)
 
 #define XM11x_SENS_INT_PIN   0   // PA0
 #define XM11x_SENS_EN_PIN    106 // PD10
@@ -98,12 +105,15 @@ static acc_app_integration_semaphore_t uart_complete_semaphores[UART_IFACE_COUNT
 
 #define UART_TRANSFER_TIMEOUT 1000
 
+#define DEBUG_BUFFER_SIZE   2048
+#define DEBUG_FLUSH_TIMEOUT 100
+
 #define SPI_MASTER_TRANSFER_TIMEOUT 1000
 
 /**
- * @brief The sensor SPI pins
+ * @brief The SPI pins of the sensor on the module
  */
-static acc_driver_spi_same70_config_t sensor_spi_config = PINS_SPI1_NPCS0;
+static const acc_driver_spi_same70_config_t sensor_spi_config = PINS_SPI1_NPCS0;
 
 /**
  * @brief The slave SPI pins
@@ -112,17 +122,12 @@ static acc_driver_spi_same70_config_t slave_spi_config = PINS_SPI0_NPCS0;
 
 static acc_device_handle_t             i2c_0_device_handle;
 static acc_device_handle_t             i2c_2_device_handle;
-static acc_device_handle_t             spi_master_handle;
-static acc_app_integration_semaphore_t spi_master_transfer_complete_semaphore;
+static acc_device_handle_t             sensor_spi_handles[XM11x_SENSOR_MAX];
 static acc_device_handle_t             spi_slave_handle;
 static gpio_t                          gpios[XM11x_GPIO_PINS];
 
-static bool sensor_active = false;
-
 static acc_board_xm112_config_t config;
 
-static acc_app_integration_semaphore_t isr_semaphore;
-
 static acc_ms_sensor_interrupt_callback_t isr_callback;
 
 /**
@@ -136,10 +141,7 @@ acc_board_get_config_t acc_board_get_config = acc_board_get_config_default;
 
 bool acc_ms_system_is_sensor_interrupt_active(void)
 {
-	uint_fast8_t level;
-
-	acc_device_gpio_read(XM11x_SENS_INT_PIN, &level);
-	return level;
+	return acc_board_sensors_is_interrupt_active(1);
 }
 
 
@@ -149,31 +151,28 @@ void acc_ms_system_register_sensor_interrupt_callback(acc_ms_sensor_interrupt_ca
 }
 
 
-static void isr_sensor(void)
+uint32_t acc_ms_system_get_max_uart_baudrate(void)
 {
-	acc_os_semaphore_signal_from_interrupt(isr_semaphore);
-	if (isr_callback != NULL)
-	{
-		isr_callback();
-	}
+	return acc_device_uart_get_max_baudrate(acc_debug_uart_port);
 }
 
 
-static bool setup_isr(void)
+void acc_ms_system_uart_set_baudrate(uint32_t baudrate)
 {
-	isr_semaphore = acc_os_semaphore_create();
+	// Let buffered output leave at the old baudrate
+	acc_console_flush(DEBUG_FLUSH_TIMEOUT);
+	acc_device_uart_init(acc_debug_uart_port, baudrate, ACC_DEVICE_UART_OPTIONS_ALT_PINS_1);
+}
 
-	if (isr_semaphore == NULL)
-	{
-		return false;
-	}
 
-	if (!acc_device_gpio_register_isr(XM11x_SENS_INT_PIN, ACC_DEVICE_GPIO_EDGE_RISING, &isr_sensor))
+ACC_TCM_CODE static void isr_sensor(acc_sensor_id_t sensor_id)
+{
+	(void)sensor_id;
+
+	if (isr_callback != NULL)
 	{
-		return false;
+		isr_callback();
 	}
-
-	return true;
 }
 
 
@@ -188,19 +187,60 @@ static bool is_service_mode(void);
 
 static void xm11x_wait_for_spi_transfer_complete(acc_device_handle_t dev_handle)
 {
-	if (dev_handle == spi_master_handle)
+	acc_board_sensors_spi_wait(dev_handle, SPI_MASTER_TRANSFER_TIMEOUT);
+}
+
+
+static void xm11x_spi_transfer_complete_callback(acc_device_handle_t dev_handle)
+{
+	acc_board_sensors_spi_complete(dev_handle);
+}
+
+
+static bool create_sensor_spi_handles(void)
+{
+	for (uint32_t i = 0; i < config.sensor_count; i++)
 	{
-		acc_os_semaphore_wait(spi_master_transfer_complete_semaphore, SPI_MASTER_TRANSFER_TIMEOUT);
+		acc_board_xm112_sensor_config_t *sensor_config = &config.sensor_config[i];
+		acc_device_spi_configuration_t  master_configuration;
+
+		sensor_config->spi_pins.zero_copy = XM11x_SPI_MASTER_ZERO_COPY;
+
+		master_configuration.bus           = sensor_config->spi_bus;
+		master_configuration.configuration = &sensor_config->spi_pins;
+		master_configuration.device        = sensor_config->spi_cs;
+		master_configuration.master        = true;
+		master_configuration.speed         = XM11x_SPI_SPEED;
+		master_configuration.buffer_size   = config.sensor_spi_buffer_size;
+
+		sensor_spi_handles[i] = acc_device_spi_create(&master_configuration);
+		if (NULL == sensor_spi_handles[i])
+		{
+			ACC_LOG_ERROR("Unable to create SPI master for sensor %" PRIu32, i + 1);
+			return false;
+		}
 	}
+
+	return true;
 }
 
 
-static void xm11x_spi_transfer_complete_callback(acc_device_handle_t dev_handle)
+static bool setup_sensors(void)
 {
-	if (dev_handle == spi_master_handle)
+	acc_board_sensor_config_t sensor_configs[XM11x_SENSOR_MAX];
+
+	for (uint32_t i = 0; i < config.sensor_count; i++)
 	{
-		acc_os_semaphore_signal_from_interrupt(spi_master_transfer_complete_semaphore);
+		sensor_configs[i].spi_handle     = sensor_spi_handles[i];
+		sensor_configs[i].interrupt_pin  = config.sensor_config[i].interrupt_pin;
+		sensor_configs[i].enable_pin     = config.sensor_config[i].enable_pin;
+		sensor_configs[i].ps_enable_pin  = config.sensor_config[i].ps_enable_pin;
+		sensor_configs[i].transfer_async = true;
 	}
+
+	acc_board_sensors_register_interrupt_callback(isr_sensor);
+
+	return acc_board_sensors_init(sensor_configs, config.sensor_count);
 }
 
 
@@ -229,9 +269,39 @@ void acc_board_get_config_default(acc_board_xm112_config_t *config)
 	//config->uart_config[0].baudrate     = 115200;
 	//config->uart_config[0].use_as_debug = true;
 
-	config->uart_config[2].open         = true;
-	config->uart_config[2].baudrate     = 115200;
-	config->uart_config[2].use_as_debug = true;
+	config->uart_config[2].open              = true;
+	config->uart_config[2].baudrate          = 115200;
+	config->uart_config[2].use_as_debug      = true;
+	config->uart_config[2].debug_buffer_size = DEBUG_BUFFER_SIZE;
+	config->uart_config[2].debug_overflow    = ACC_CONSOLE_OVERFLOW_BLOCK;
+
+#ifdef ACC_CFG_USB_CDC
+	config->usb_cdc_config.open = true;
+#endif
+
+	config->sensor_count           = 1;
+	config->sensor_spi_buffer_size = XM11x_SPI_MASTER_BUF_SIZE;
+
+	config->sensor_config[0].spi_bus       = XM11x_SPI_MASTER_BUS;
+	config->sensor_config[0].spi_cs        = XM11x_SPI_CS;
+	config->sensor_config[0].spi_pins      = sensor_spi_config;
+	config->sensor_config[0].interrupt_pin = XM11x_SENS_INT_PIN;
+	config->sensor_config[0].enable_pin    = XM11x_SENS_EN_PIN;
+	config->sensor_config[0].ps_enable_pin = XM11x_PS_ENABLE_PIN;
+}
+
+
+static void debug_port_start(uint_fast8_t port, const acc_board_xm112_uart_config_t *uart_config)
+{
+	acc_debug_uart_port = port;
+
+	if (uart_config->debug_buffer_size > 0 &&
+	    !acc_console_buffered_start(port, uart_config->debug_buffer_size, uart_config->debug_overflow))
+	{
+		ACC_LOG_WARNING("Unable to start buffered debug output");
+	}
+
+	acc_log_binary_enable(uart_config->debug_binary_log);
 }
 
 
@@ -239,9 +309,20 @@ bool acc_board_init(void)
 {
 	acc_board_get_config(&config);
 
+	if (config.sensor_count > XM11x_SENSOR_MAX)
+	{
+		ACC_LOG_ERROR("At most %u sensors are supported", (unsigned int)XM11x_SENSOR_MAX);
+		return false;
+	}
+
 	acc_driver_os_freertos_register();
 	acc_os_init();
 
+	if (!acc_driver_timestamp_same70_register())
+	{
+		ACC_LOG_WARNING("Microsecond timestamps are not available");
+	}
+
 	// Initialize interrupt priority for all external interrupts to
 	// the most urgent priority allowed in FreeRTOS.
 	uint32_t prioReg = (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8U - configPRIO_BITS));
@@ -271,11 +352,30 @@ bool acc_board_init(void)
 			acc_device_uart_init(i, config.uart_config[i].baudrate, ACC_DEVICE_UART_OPTIONS_ALT_PINS_1);
 			if (config.uart_config[i].use_as_debug)
 			{
-				acc_debug_uart_port = i;
+				debug_port_start(i, &config.uart_config[i]);
 			}
 		}
 	}
 
+#ifdef ACC_CFG_USB_CDC
+	if (config.usb_cdc_config.open)
+	{
+		acc_driver_usb_cdc_same70_register();
+
+		if (!acc_device_uart_init(ACC_DRIVER_USB_CDC_SAME70_PORT, config.usb_cdc_config.baudrate, 0))
+		{
+			ACC_LOG_ERROR("Unable to start USB CDC");
+			acc_board_deinit();
+			return false;
+		}
+
+		if (config.usb_cdc_config.use_as_debug)
+		{
+			debug_port_start(ACC_DRIVER_USB_CDC_SAME70_PORT, &config.usb_cdc_config);
+		}
+	}
+#endif
+
 	ACC_LOG_INFO("Error counter is now %" PRIu32, GPBR->SYS_GPBR[GPBR_ERROR_COUNTER_REGISTER]);
 
 	acc_driver_gpio_same70_register(XM11x_GPIO_PINS, gpios);
@@ -286,29 +386,10 @@ bool acc_board_init(void)
 	acc_board_hibernate_enter_func = NULL;
 	acc_board_hibernate_exit_func  = NULL;
 
-	spi_master_transfer_complete_semaphore = acc_os_semaphore_create();
-	if (NULL == spi_master_transfer_complete_semaphore)
-	{
-		ACC_LOG_ERROR("Unable to create semaphore");
-		acc_board_deinit();
-		return false;
-	}
-
 	acc_driver_spi_same70_register(xm11x_wait_for_spi_transfer_complete, xm11x_spi_transfer_complete_callback);
 
-	acc_device_spi_configuration_t master_configuration;
-
-	master_configuration.bus           = XM11x_SPI_MASTER_BUS;
-	master_configuration.configuration = &sensor_spi_config;
-	master_configuration.device        = XM11x_SPI_CS;
-	master_configuration.master        = true;
-	master_configuration.speed         = XM11x_SPI_SPEED;
-	master_configuration.buffer_size   = XM11x_SPI_MASTER_BUF_SIZE;
-
-	spi_master_handle = acc_device_spi_create(&master_configuration);
-	if (NULL == spi_master_handle)
+	if (!create_sensor_spi_handles())
 	{
-		ACC_LOG_ERROR("Unable to create SPI master");
 		acc_board_deinit();
 		return false;
 	}
@@ -387,32 +468,8 @@ bool acc_board_init(void)
 		}
 	}
 
-	acc_device_gpio_set_initial_pull(XM11x_SENS_INT_PIN, 0);
-	acc_device_gpio_set_initial_pull(XM11x_SENS_EN_PIN, 0);
-	acc_device_gpio_set_initial_pull(XM11x_PS_ENABLE_PIN, 0);
 	acc_device_gpio_set_initial_pull(XM11x_PWR_SIGNAL_PIN, 0);
 
-	if (!acc_device_gpio_write(XM11x_SENS_EN_PIN, 0))
-	{
-		ACC_LOG_ERROR("Unable to deactivate SENS_EN");
-		acc_board_deinit();
-		return false;
-	}
-
-	if (!acc_device_gpio_write(XM11x_PS_ENABLE_PIN, 0))
-	{
-		ACC_LOG_ERROR("Unable to deactivate PS_ENABLE");
-		acc_board_deinit();
-		return false;
-	}
-
-	if (!acc_device_gpio_input(XM11x_SENS_INT_PIN))
-	{
-		ACC_LOG_ERROR("Unable to configure SENS_INT as input");
-		acc_board_deinit();
-		return false;
-	}
-
 	if (!acc_device_gpio_input(XM11x_MODULE_INT_PIN))
 	{
 		ACC_LOG_ERROR("Unable to deactivate module interrupt pin");
@@ -436,9 +493,9 @@ bool acc_board_init(void)
 		return false;
 	}
 
-	if (!setup_isr())
+	if (!setup_sensors())
 	{
-		ACC_LOG_ERROR("Unable to setup isr");
+		ACC_LOG_ERROR("Unable to setup sensors");
 		acc_board_deinit();
 		return false;
 	}
@@ -459,21 +516,14 @@ static void acc_board_deinit(void)
 		acc_device_spi_destroy(&spi_slave_handle);
 	}
 
-	if (NULL != spi_master_handle)
-	{
-		acc_device_spi_destroy(&spi_master_handle);
-	}
-
-	if (NULL != spi_master_transfer_complete_semaphore)
-	{
-		acc_os_semaphore_destroy(spi_master_transfer_complete_semaphore);
-		spi_master_transfer_complete_semaphore = NULL;
-	}
+	acc_board_sensors_deinit();
 
-	if (NULL != isr_semaphore)
+	for (int i = 0; i < XM11x_SENSOR_MAX; i++)
 	{
-		acc_os_semaphore_destroy(isr_semaphore);
-		isr_semaphore = NULL;
+		if (NULL != sensor_spi_handles[i])
+		{
+			acc_device_spi_destroy(&sensor_spi_handles[i]);
+		}
 	}
 
 	for (int i = 0; i < UART_IFACE_COUNT; i++)
@@ -488,87 +538,31 @@ static void acc_board_deinit(void)
 
 void acc_board_start_sensor(acc_sensor_id_t sensor)
 {
-	(void)sensor;
-
-	if (sensor_active)
-	{
-		ACC_LOG_ERROR("Sensor already active.");
-		return;
-	}
-
-	if (!acc_device_gpio_write(XM11x_PS_ENABLE_PIN, 1))
-	{
-		ACC_LOG_ERROR("Unable to activate PS_ENABLE");
-		return;
-	}
-
-	if (!acc_device_gpio_write(XM11x_SENS_EN_PIN, 1))
-	{
-		ACC_LOG_ERROR("Unable to activate SENS_EN");
-		return;
-	}
-
-	// Crystal stabilization time is 1-2 ms
-	// Sleep 3 ms just to be safe (sleep functions don't have to be accurate)
-	acc_os_sleep_ms(3);
-
-	// Clear pending interrupts
-	while (acc_os_semaphore_wait(isr_semaphore, 0));
-
-	sensor_active = true;
+	acc_board_sensors_start(sensor);
 }
 
 
 void acc_board_stop_sensor(acc_sensor_id_t sensor)
 {
-	(void)sensor;
-
-	if (!sensor_active)
-	{
-		ACC_LOG_ERROR("Sensor already inactive.");
-		return;
-	}
-
-	sensor_active = false;
-
-	if (!acc_device_gpio_write(XM11x_SENS_EN_PIN, 0))
-	{
-		ACC_LOG_WARNING("Unable to deactivate SENS_EN");
-	}
-
-	// t_wait according to integration specification at least 200 us
-	// but timer resolution is in ms.
-	acc_os_sleep_ms(1);
-
-	if (!acc_device_gpio_write(XM11x_PS_ENABLE_PIN, 0))
-	{
-		ACC_LOG_WARNING("Unable to deactivate PS_ENABLE");
-	}
+	acc_board_sensors_stop(sensor);
 }
 
 
 void acc_board_sensor_transfer(acc_sensor_id_t sensor_id, uint8_t *buffer, size_t buffer_length)
 {
-	(void)sensor_id;
-
-	acc_device_spi_lock(acc_device_spi_get_bus(spi_master_handle));
-
-	acc_device_spi_transfer(spi_master_handle, buffer, buffer_length);
-
-	acc_device_spi_unlock(acc_device_spi_get_bus(spi_master_handle));
+	acc_board_sensors_transfer(sensor_id, buffer, buffer_length);
 }
 
 
 bool acc_board_wait_for_sensor_interrupt(acc_sensor_id_t sensor_id, uint32_t timeout_ms)
 {
-	(void)sensor_id;
-	return acc_os_semaphore_wait(isr_semaphore, timeout_ms);
+	return acc_board_sensors_wait_for_interrupt(sensor_id, timeout_ms);
 }
 
 
 uint32_t acc_board_get_sensor_count(void)
 {
-	return 1;
+	return acc_board_sensors_get_count();
 }
 
 
@@ -578,6 +572,12 @@ float acc_board_get_ref_freq(void)
 }
 
 
+acc_device_handle_t acc_board_get_spi_master_handle(void)
+{
+	return sensor_spi_handles[0];
+}
+
+
 acc_device_handle_t acc_board_get_spi_slave_handle(void)
 {
 	return spi_slave_handle;
@@ -660,6 +660,7 @@ void system_fatal_error_handler(const char *reason)
 		ACC_LOG_ERROR("Error %s\n", reason);
 		ACC_LOG_ERROR("error counter=%" PRIu32 ", rebooting\n",
 		              GPBR->SYS_GPBR[GPBR_ERROR_COUNTER_REGISTER]);
+		acc_console_flush(DEBUG_FLUSH_TIMEOUT);
 	}
 
 	if (is_debugger_active())
@@ -0,0 +1,164 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "acc_board.h"
+#include "acc_definitions.h"
+#include "acc_device_os.h"
+#include "acc_driver_os.h"
+#include "acc_driver_os_freertos.h"
+#include "acc_log.h"
+
+
+/**
+ * @brief The module name
+ *
+ * Must exist if acc_log.h is used.
+ */
+#define MODULE "acc_board_host"
+
+
+/**
+ * Board used when running on the Linux host. There is no sensor, the services
+ * are provided by the RSS emulator, so only the OS driver and a microsecond
+ * clock are registered.
+ */
+#define HOST_SENSOR_COUNT               (4)
+#define HOST_SENSOR_REFERENCE_FREQUENCY (24000000)
+
+
+static bool sensor_active[HOST_SENSOR_COUNT];
+
+
+static uint64_t start_time_us;
+
+
+static uint64_t monotonic_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+
+static uint64_t get_time_us(void)
+{
+	return monotonic_time_us() - start_time_us;
+}
+
+
+bool acc_board_init(void)
+{
+	acc_driver_os_freertos_register();
+	acc_os_init();
+
+	start_time_us                  = monotonic_time_us();
+	acc_device_os_get_time_us_func = get_time_us;
+
+	// Hibernation is not supported on this board
+	acc_board_hibernate_enter_func = NULL;
+	acc_board_hibernate_exit_func  = NULL;
+
+	return true;
+}
+
+
+bool acc_board_gpio_init(void)
+{
+	return true;
+}
+
+
+void acc_board_start_sensor(acc_sensor_id_t sensor)
+{
+	if (sensor < 1 || sensor > HOST_SENSOR_COUNT)
+	{
+		ACC_LOG_ERROR("Invalid sensor id %" PRIsensor_id, sensor);
+		return;
+	}
+
+	if (sensor_active[sensor - 1])
+	{
+		ACC_LOG_ERROR("Sensor already active.");
+		return;
+	}
+
+	sensor_active[sensor - 1] = true;
+}
+
+
+void acc_board_stop_sensor(acc_sensor_id_t sensor)
+{
+	if (sensor < 1 || sensor > HOST_SENSOR_COUNT)
+	{
+		ACC_LOG_ERROR("Invalid sensor id %" PRIsensor_id, sensor);
+		return;
+	}
+
+	if (!sensor_active[sensor - 1])
+	{
+		ACC_LOG_ERROR("Sensor already inactive.");
+		return;
+	}
+
+	sensor_active[sensor - 1] = false;
+}
+
+
+bool acc_board_chip_select(acc_sensor_id_t sensor, uint_fast8_t cs_assert)
+{
+	(void)sensor;
+	(void)cs_assert;
+
+	return true;
+}
+
+
+void acc_board_sensor_transfer(acc_sensor_id_t sensor_id, uint8_t *buffer, size_t buffer_length)
+{
+	(void)sensor_id;
+	(void)buffer;
+	(void)buffer_length;
+}
+
+
+bool acc_board_wait_for_sensor_interrupt(acc_sensor_id_t sensor_id, uint32_t timeout_ms)
+{
+	(void)sensor_id;
+
+	// No sensor is connected, the interrupt never arrives
+	acc_os_sleep_ms(timeout_ms);
+
+	return false;
+}
+
+
+uint32_t acc_board_get_sensor_count(void)
+{
+	return HOST_SENSOR_COUNT;
+}
+
+
+float acc_board_get_ref_freq(void)
+{
+	return HOST_SENSOR_REFERENCE_FREQUENCY;
+}
+
+
+bool acc_board_set_ref_freq(float ref_freq)
+{
+	(void)ref_freq;
+
+	return false;
+}
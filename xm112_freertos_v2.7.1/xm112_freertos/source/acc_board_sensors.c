@@ -0,0 +1,454 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_board_sensors.h"
+
+#include "acc_device_gpio.h"
+#include "acc_device_os.h"
+#include "acc_device_spi.h"
+#include "acc_log.h"
+#include "acc_tcm.h"
+
+
+/**
+ * @brief The module name
+ *
+ * Must exist if acc_log.h is used.
+ */
+#define MODULE "board_sensors"
+
+
+#define SENSOR_TRANSFER_TIMEOUT_MS 1000
+
+
+typedef struct
+{
+	acc_board_sensor_config_t        config;
+	acc_app_integration_semaphore_t  interrupt_semaphore;
+	acc_app_integration_semaphore_t  transfer_semaphore;
+	acc_device_spi_transfer_status_t transfer_status;
+	bool                             active;
+} sensor_t;
+
+
+static sensor_t        sensors[ACC_BOARD_SENSORS_MAX];
+static uint32_t        sensor_count;
+static acc_board_isr_t interrupt_callback;
+
+
+static sensor_t *get_sensor(acc_sensor_id_t sensor_id)
+{
+	if (sensor_id < 1 || sensor_id > sensor_count)
+	{
+		ACC_LOG_ERROR("Invalid sensor id %" PRIsensor_id, sensor_id);
+		return NULL;
+	}
+
+	return &sensors[sensor_id - 1];
+}
+
+
+static sensor_t *get_sensor_by_spi_handle(acc_device_handle_t spi_handle)
+{
+	for (uint32_t index = 0; index < sensor_count; index++)
+	{
+		if (sensors[index].config.spi_handle == spi_handle)
+		{
+			return &sensors[index];
+		}
+	}
+
+	return NULL;
+}
+
+
+ACC_TCM_CODE static void isr_sensor(uint_fast8_t index)
+{
+	if (index >= sensor_count)
+	{
+		return;
+	}
+
+	acc_os_semaphore_signal_from_interrupt(sensors[index].interrupt_semaphore);
+
+	if (interrupt_callback != NULL)
+	{
+		interrupt_callback(index + 1);
+	}
+}
+
+
+// The GPIO interrupt service routines have no argument, so there is one per table entry
+ACC_TCM_CODE static void isr_sensor_1(void)
+{
+	isr_sensor(0);
+}
+
+
+ACC_TCM_CODE static void isr_sensor_2(void)
+{
+	isr_sensor(1);
+}
+
+
+ACC_TCM_CODE static void isr_sensor_3(void)
+{
+	isr_sensor(2);
+}
+
+
+ACC_TCM_CODE static void isr_sensor_4(void)
+{
+	isr_sensor(3);
+}
+
+
+static const acc_device_gpio_isr_t sensor_isrs[ACC_BOARD_SENSORS_MAX] = {
+	isr_sensor_1,
+	isr_sensor_2,
+	isr_sensor_3,
+	isr_sensor_4,
+};
+
+
+static bool sensor_pins_init(const acc_board_sensor_config_t *config)
+{
+	acc_device_gpio_set_initial_pull(config->interrupt_pin, 0);
+	acc_device_gpio_set_initial_pull(config->enable_pin, 0);
+	acc_device_gpio_set_initial_pull(config->ps_enable_pin, 0);
+
+	if (!acc_device_gpio_write(config->enable_pin, 0))
+	{
+		ACC_LOG_ERROR("Unable to deactivate SENS_EN");
+		return false;
+	}
+
+	if (!acc_device_gpio_write(config->ps_enable_pin, 0))
+	{
+		ACC_LOG_ERROR("Unable to deactivate PS_ENABLE");
+		return false;
+	}
+
+	if (!acc_device_gpio_input(config->interrupt_pin))
+	{
+		ACC_LOG_ERROR("Unable to configure SENS_INT as input");
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool is_ps_enable_pin_used(uint_fast8_t ps_enable_pin)
+{
+	for (uint32_t index = 0; index < sensor_count; index++)
+	{
+		if (sensors[index].active && sensors[index].config.ps_enable_pin == ps_enable_pin)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool acc_board_sensors_init(const acc_board_sensor_config_t *configs, uint32_t count)
+{
+	if (count > ACC_BOARD_SENSORS_MAX)
+	{
+		ACC_LOG_ERROR("At most %u sensors are supported", (unsigned int)ACC_BOARD_SENSORS_MAX);
+		return false;
+	}
+
+	memset(sensors, 0, sizeof(sensors));
+
+	for (uint32_t index = 0; index < count; index++)
+	{
+		sensors[index].config = configs[index];
+	}
+
+	sensor_count = count;
+
+	for (uint32_t index = 0; index < count; index++)
+	{
+		sensor_t *sensor = &sensors[index];
+
+		if (!sensor_pins_init(&sensor->config))
+		{
+			acc_board_sensors_deinit();
+			return false;
+		}
+
+		sensor->interrupt_semaphore = acc_os_semaphore_create();
+		sensor->transfer_semaphore  = acc_os_semaphore_create();
+
+		if (sensor->interrupt_semaphore == NULL || sensor->transfer_semaphore == NULL)
+		{
+			ACC_LOG_ERROR("Unable to create semaphore");
+			acc_board_sensors_deinit();
+			return false;
+		}
+
+		if (!acc_device_gpio_register_isr(sensor->config.interrupt_pin, ACC_DEVICE_GPIO_EDGE_RISING, sensor_isrs[index]))
+		{
+			ACC_LOG_ERROR("Unable to setup isr");
+			acc_board_sensors_deinit();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void acc_board_sensors_deinit(void)
+{
+	for (uint32_t index = 0; index < sensor_count; index++)
+	{
+		sensor_t *sensor = &sensors[index];
+
+		if (sensor->interrupt_semaphore != NULL)
+		{
+			acc_device_gpio_register_isr(sensor->config.interrupt_pin, ACC_DEVICE_GPIO_EDGE_RISING, NULL);
+			acc_os_semaphore_destroy(sensor->interrupt_semaphore);
+			sensor->interrupt_semaphore = NULL;
+		}
+
+		if (sensor->transfer_semaphore != NULL)
+		{
+			acc_os_semaphore_destroy(sensor->transfer_semaphore);
+			sensor->transfer_semaphore = NULL;
+		}
+	}
+
+	sensor_count = 0;
+}
+
+
+uint32_t acc_board_sensors_get_count(void)
+{
+	return sensor_count;
+}
+
+
+void acc_board_sensors_register_interrupt_callback(acc_board_isr_t callback)
+{
+	interrupt_callback = callback;
+}
+
+
+void acc_board_sensors_start(acc_sensor_id_t sensor_id)
+{
+	sensor_t *sensor = get_sensor(sensor_id);
+
+	if (sensor == NULL)
+	{
+		return;
+	}
+
+	if (sensor->active)
+	{
+		ACC_LOG_ERROR("Sensor already active.");
+		return;
+	}
+
+	if (!acc_device_gpio_write(sensor->config.ps_enable_pin, 1))
+	{
+		ACC_LOG_ERROR("Unable to activate PS_ENABLE");
+		return;
+	}
+
+	if (!acc_device_gpio_write(sensor->config.enable_pin, 1))
+	{
+		ACC_LOG_ERROR("Unable to activate SENS_EN");
+		return;
+	}
+
+	// Crystal stabilization time is 1-2 ms
+	// Sleep 3 ms just to be safe (sleep functions don't have to be accurate)
+	acc_os_sleep_ms(3);
+
+	// Clear pending interrupts
+	while (acc_os_semaphore_wait(sensor->interrupt_semaphore, 0));
+
+	sensor->active = true;
+}
+
+
+void acc_board_sensors_stop(acc_sensor_id_t sensor_id)
+{
+	sensor_t *sensor = get_sensor(sensor_id);
+
+	if (sensor == NULL)
+	{
+		return;
+	}
+
+	if (!sensor->active)
+	{
+		ACC_LOG_ERROR("Sensor already inactive.");
+		return;
+	}
+
+	sensor->active = false;
+
+	if (!acc_device_gpio_write(sensor->config.enable_pin, 0))
+	{
+		ACC_LOG_WARNING("Unable to deactivate SENS_EN");
+	}
+
+	if (is_ps_enable_pin_used(sensor->config.ps_enable_pin))
+	{
+		// The power supply is shared with a sensor that is still active
+		return;
+	}
+
+	// t_wait according to integration specification at least 200 us
+	// but timer resolution is in ms.
+	acc_os_sleep_ms(1);
+
+	if (!acc_device_gpio_write(sensor->config.ps_enable_pin, 0))
+	{
+		ACC_LOG_WARNING("Unable to deactivate PS_ENABLE");
+	}
+}
+
+
+static void transfer_async_callback(acc_device_handle_t spi_handle, acc_device_spi_transfer_status_t status)
+{
+	sensor_t *sensor = get_sensor_by_spi_handle(spi_handle);
+
+	if (sensor != NULL)
+	{
+		sensor->transfer_status = status;
+		acc_os_semaphore_signal_from_interrupt(sensor->transfer_semaphore);
+	}
+}
+
+
+static bool transfer_async(sensor_t *sensor, uint8_t *buffer, size_t buffer_length)
+{
+	// Remove completions left by a transfer that timed out
+	while (acc_os_semaphore_wait(sensor->transfer_semaphore, 0));
+
+	sensor->transfer_status = ACC_DEVICE_SPI_TRANSFER_STATUS_ABORTED;
+
+	if (!acc_device_spi_transfer_async(sensor->config.spi_handle, buffer, true, true, buffer_length, transfer_async_callback))
+	{
+		return false;
+	}
+
+	// The calling task blocks on the semaphore while the data is clocked out,
+	// leaving the CPU to other tasks
+	if (!acc_os_semaphore_wait(sensor->transfer_semaphore, SENSOR_TRANSFER_TIMEOUT_MS))
+	{
+		ACC_LOG_ERROR("Sensor transfer timed out");
+
+		// The DMA must not write to the buffer of the caller once the bus is released
+		acc_device_spi_transfer_abort(sensor->config.spi_handle);
+
+		// Remove a completion signalled before the transfer was stopped
+		while (acc_os_semaphore_wait(sensor->transfer_semaphore, 0));
+
+		return false;
+	}
+
+	return sensor->transfer_status == ACC_DEVICE_SPI_TRANSFER_STATUS_OK;
+}
+
+
+bool acc_board_sensors_transfer(acc_sensor_id_t sensor_id, uint8_t *buffer, size_t buffer_length)
+{
+	sensor_t *sensor = get_sensor(sensor_id);
+	bool     status;
+
+	if (sensor == NULL)
+	{
+		return false;
+	}
+
+	uint_fast8_t bus = acc_device_spi_get_bus(sensor->config.spi_handle);
+
+	acc_device_spi_lock(bus);
+
+	if (sensor->config.transfer_async)
+	{
+		status = transfer_async(sensor, buffer, buffer_length);
+	}
+	else
+	{
+		status = acc_device_spi_transfer(sensor->config.spi_handle, buffer, buffer_length);
+	}
+
+	acc_device_spi_unlock(bus);
+
+	return status;
+}
+
+
+bool acc_board_sensors_wait_for_interrupt(acc_sensor_id_t sensor_id, uint32_t timeout_ms)
+{
+	sensor_t *sensor = get_sensor(sensor_id);
+
+	if (sensor == NULL)
+	{
+		return false;
+	}
+
+	return acc_os_semaphore_wait(sensor->interrupt_semaphore, timeout_ms);
+}
+
+
+bool acc_board_sensors_is_interrupt_active(acc_sensor_id_t sensor_id)
+{
+	sensor_t     *sensor = get_sensor(sensor_id);
+	uint_fast8_t level   = 0;
+
+	if (sensor == NULL)
+	{
+		return false;
+	}
+
+	acc_device_gpio_read(sensor->config.interrupt_pin, &level);
+
+	return level;
+}
+
+
+acc_device_handle_t acc_board_sensors_get_spi_handle(acc_sensor_id_t sensor_id)
+{
+	sensor_t *sensor = get_sensor(sensor_id);
+
+	return sensor != NULL ? sensor->config.spi_handle : NULL;
+}
+
+
+void acc_board_sensors_spi_wait(acc_device_handle_t spi_handle, uint16_t timeout_ms)
+{
+	sensor_t *sensor = get_sensor_by_spi_handle(spi_handle);
+
+	if (sensor != NULL)
+	{
+		acc_os_semaphore_wait(sensor->transfer_semaphore, timeout_ms);
+	}
+}
+
+
+void acc_board_sensors_spi_complete(acc_device_handle_t spi_handle)
+{
+	sensor_t *sensor = get_sensor_by_spi_handle(spi_handle);
+
+	if (sensor != NULL)
+	{
+		acc_os_semaphore_signal_from_interrupt(sensor->transfer_semaphore);
+	}
+}
@@ -0,0 +1,174 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_command.h"
+
+
+static bool is_separator(char c)
+{
+	return c == ' ' || c == '\t' || c == ',';
+}
+
+
+void acc_command_tokenizer_init(acc_command_tokenizer_t *tokenizer,
+                                char                    *buffer,
+                                size_t                  buffer_size,
+                                const char              *delimiters,
+                                acc_command_func_t      callback,
+                                void                    *client_reference)
+{
+	memset(tokenizer, 0, sizeof(*tokenizer));
+
+	tokenizer->buffer           = buffer;
+	tokenizer->buffer_size      = buffer_size;
+	tokenizer->delimiters       = delimiters;
+	tokenizer->callback         = callback;
+	tokenizer->client_reference = client_reference;
+}
+
+
+void acc_command_tokenizer_feed(acc_command_tokenizer_t *tokenizer, const uint8_t *data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		char c = (char)data[i];
+
+		if (c != '\0' && strchr(tokenizer->delimiters, c) != NULL)
+		{
+			if (tokenizer->overflow)
+			{
+				tokenizer->overflow_count++;
+			}
+			else if (tokenizer->length > 0)
+			{
+				tokenizer->buffer[tokenizer->length] = '\0';
+				tokenizer->callback(tokenizer->buffer, tokenizer->length, tokenizer->client_reference);
+			}
+
+			tokenizer->length   = 0;
+			tokenizer->overflow = false;
+			continue;
+		}
+
+		if (tokenizer->length + 1 < tokenizer->buffer_size)
+		{
+			tokenizer->buffer[tokenizer->length++] = c;
+		}
+		else
+		{
+			tokenizer->overflow = true;
+		}
+	}
+}
+
+
+size_t acc_command_split(char *command, char **words, size_t max_words)
+{
+	size_t count = 0;
+
+	while (*command != '\0' && count < max_words)
+	{
+		while (is_separator(*command))
+		{
+			*command++ = '\0';
+		}
+
+		if (*command == '\0')
+		{
+			break;
+		}
+
+		words[count++] = command;
+
+		while (*command != '\0' && !is_separator(*command))
+		{
+			command++;
+		}
+	}
+
+	return count;
+}
+
+
+static int digit_value(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+
+	if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+
+	if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+
+bool acc_command_parse_int32(const char *text, int32_t *value)
+{
+	bool    negative = false;
+	int64_t result   = 0;
+	int     base     = 10;
+
+	if (*text == '-' || *text == '+')
+	{
+		negative = *text++ == '-';
+	}
+
+	if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+	{
+		base  = 16;
+		text += 2;
+	}
+
+	if (*text == '\0')
+	{
+		return false;
+	}
+
+	for (; *text != '\0'; text++)
+	{
+		int digit = digit_value(*text);
+
+		if (digit < 0 || digit >= base)
+		{
+			return false;
+		}
+
+		result = result * base + digit;
+
+		if (result > (int64_t)INT32_MAX + 1)
+		{
+			return false;
+		}
+	}
+
+	if (negative)
+	{
+		result = -result;
+	}
+
+	if (result > INT32_MAX)
+	{
+		return false;
+	}
+
+	*value = (int32_t)result;
+
+	return true;
+}
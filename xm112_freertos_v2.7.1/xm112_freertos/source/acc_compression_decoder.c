@@ -0,0 +1,259 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_compression.h"
+#include "acc_compression_decoder.h"
+
+
+typedef struct
+{
+	const uint8_t *data;
+	size_t        size;
+	size_t        position;
+	uint64_t      bits;
+	uint32_t      bit_count;
+} bit_reader_t;
+
+
+static void refill(bit_reader_t *reader)
+{
+	while (reader->bit_count <= 56U && reader->position < reader->size)
+	{
+		reader->bits       = (reader->bits << 8) | reader->data[reader->position++];
+		reader->bit_count += 8U;
+	}
+}
+
+
+/**
+ * @brief Read count bits, at most 32, most significant first
+ */
+static bool read_bits(bit_reader_t *reader, uint32_t count, uint32_t *value)
+{
+	refill(reader);
+
+	if (reader->bit_count < count)
+	{
+		return false;
+	}
+
+	reader->bit_count -= count;
+	*value             = (uint32_t)((reader->bits >> reader->bit_count) & ((UINT64_C(1) << count) - 1U));
+
+	return true;
+}
+
+
+/**
+ * @brief Read one bits up to a zero bit, or up to ACC_COMPRESSION_ESCAPE_LENGTH one bits
+ */
+static bool read_unary(bit_reader_t *reader, uint32_t *ones)
+{
+	refill(reader);
+
+	if (reader->bit_count == 0U)
+	{
+		return false;
+	}
+
+	uint64_t inverted = ~(reader->bits << (64U - reader->bit_count));
+	uint32_t count    = inverted != 0U ? (uint32_t)__builtin_clzll(inverted) : 64U;
+
+	if (count >= ACC_COMPRESSION_ESCAPE_LENGTH)
+	{
+		if (reader->bit_count < ACC_COMPRESSION_ESCAPE_LENGTH)
+		{
+			return false;
+		}
+
+		reader->bit_count -= ACC_COMPRESSION_ESCAPE_LENGTH;
+		*ones              = ACC_COMPRESSION_ESCAPE_LENGTH;
+		return true;
+	}
+
+	if (count >= reader->bit_count)
+	{
+		return false;
+	}
+
+	reader->bit_count -= count + 1U;
+	*ones              = count;
+
+	return true;
+}
+
+
+static bool decode_differences(const uint8_t *input, size_t input_size, uint16_t data_length, uint16_t sweep_length,
+                               const uint16_t *reference, uint16_t *data)
+{
+	bit_reader_t reader;
+
+	reader.data      = input;
+	reader.size      = input_size;
+	reader.position  = 0;
+	reader.bits      = 0;
+	reader.bit_count = 0;
+
+	for (uint32_t start = 0; start < data_length; start += ACC_COMPRESSION_BLOCK_LENGTH)
+	{
+		uint32_t length = data_length - start;
+		uint32_t k;
+
+		if (length > ACC_COMPRESSION_BLOCK_LENGTH)
+		{
+			length = ACC_COMPRESSION_BLOCK_LENGTH;
+		}
+
+		if (!read_bits(&reader, ACC_COMPRESSION_K_BITS, &k) || k > ACC_COMPRESSION_ESCAPE_BITS)
+		{
+			return false;
+		}
+
+		for (uint32_t i = start; i < start + length; i++)
+		{
+			uint32_t quotient;
+			uint32_t value;
+			int32_t  last;
+
+			if (!read_unary(&reader, &quotient))
+			{
+				return false;
+			}
+
+			if (quotient == ACC_COMPRESSION_ESCAPE_LENGTH)
+			{
+				if (!read_bits(&reader, ACC_COMPRESSION_ESCAPE_BITS, &value))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				if (!read_bits(&reader, k, &value))
+				{
+					return false;
+				}
+
+				value |= quotient << k;
+			}
+
+			if (i >= sweep_length)
+			{
+				last = data[i - sweep_length];
+			}
+			else if (reference != NULL)
+			{
+				last = reference[i];
+			}
+			else
+			{
+				last = i > 0U ? data[i - 1U] : 0;
+			}
+
+			int32_t difference = (value & 1U) != 0U ? -(int32_t)(value >> 1) - 1 : (int32_t)(value >> 1);
+			int32_t sample     = last + difference;
+
+			if (sample < 0 || sample > UINT16_MAX)
+			{
+				return false;
+			}
+
+			data[i] = (uint16_t)sample;
+		}
+	}
+
+	// Only the padding of the last byte may be left
+	return reader.bit_count < 8U && reader.position == reader.size;
+}
+
+
+void acc_compression_decoder_init(acc_compression_decoder_t *decoder, uint16_t *previous, uint16_t max_sweep_length)
+{
+	memset(decoder, 0, sizeof(*decoder));
+
+	decoder->previous         = previous;
+	decoder->max_sweep_length = max_sweep_length;
+}
+
+
+bool acc_compression_decode(acc_compression_decoder_t *decoder,
+                            const uint8_t             *input,
+                            size_t                    input_size,
+                            uint16_t                  *data,
+                            uint16_t                  max_data_length,
+                            uint16_t                  *data_length,
+                            uint16_t                  *sweep_length)
+{
+	acc_compression_header_t header;
+	bool                     success = false;
+
+	if (input_size < sizeof(header))
+	{
+		decoder->previous_valid = false;
+		return false;
+	}
+
+	memcpy(&header, input, sizeof(header));
+
+	const uint8_t *payload      = &input[sizeof(header)];
+	size_t        payload_size  = input_size - sizeof(header);
+	bool          has_reference = decoder->previous_valid && decoder->previous_length == header.sweep_length &&
+	                              header.frame_number == (uint8_t)(decoder->previous_frame_number + 1U);
+
+	if (header.data_length > 0 && header.data_length <= max_data_length && header.sweep_length > 0 &&
+	    header.sweep_length <= decoder->max_sweep_length && header.data_length % header.sweep_length == 0)
+	{
+		switch (header.frame_type)
+		{
+			case ACC_COMPRESSION_FRAME_RAW:
+				success = payload_size == (size_t)header.data_length * sizeof(uint16_t);
+				if (success)
+				{
+					memcpy(data, payload, payload_size);
+				}
+
+				break;
+			case ACC_COMPRESSION_FRAME_INTRA:
+				success = decode_differences(payload, payload_size, header.data_length, header.data_length, NULL, data);
+				break;
+			case ACC_COMPRESSION_FRAME_SWEEP:
+				success = decode_differences(payload, payload_size, header.data_length, header.sweep_length, NULL, data);
+				break;
+			case ACC_COMPRESSION_FRAME_INTER:
+				success = has_reference &&
+				          decode_differences(payload, payload_size, header.data_length, header.sweep_length,
+				                             decoder->previous, data);
+				break;
+			default:
+				break;
+		}
+	}
+
+	decoder->previous_valid = success;
+
+	if (!success)
+	{
+		return false;
+	}
+
+	memcpy(decoder->previous, &data[header.data_length - header.sweep_length],
+	       (size_t)header.sweep_length * sizeof(uint16_t));
+	decoder->previous_length       = header.sweep_length;
+	decoder->previous_frame_number = header.frame_number;
+	*data_length                   = header.data_length;
+
+	if (sweep_length != NULL)
+	{
+		*sweep_length = header.sweep_length;
+	}
+
+	return true;
+}
@@ -0,0 +1,325 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_compression.h"
+#include "acc_compression_encoder.h"
+
+
+/**
+ * @brief Largest Rice parameter, enough for any 17 bit value
+ */
+#define RICE_PARAMETER_MAX 16U
+
+/**
+ * @brief Largest number of bytes one value adds to the output, 7 pending bits and an escaped value
+ */
+#define VALUE_MAX_BYTES 5U
+
+
+typedef struct
+{
+	uint8_t  *data;
+	size_t   position;
+	uint32_t bits;
+	uint32_t bit_count;
+} bit_writer_t;
+
+
+/**
+ * @brief Write count bits, at most 24, most significant first
+ */
+static inline void write_bits(bit_writer_t *writer, uint32_t value, uint32_t count)
+{
+	writer->bits       = (writer->bits << count) | value;
+	writer->bit_count += count;
+
+	while (writer->bit_count >= 8U)
+	{
+		writer->bit_count                -= 8U;
+		writer->data[writer->position++]  = (uint8_t)(writer->bits >> writer->bit_count);
+	}
+}
+
+
+static inline void write_value(bit_writer_t *writer, uint32_t value, uint32_t k)
+{
+	uint32_t quotient = value >> k;
+
+	if (quotient >= ACC_COMPRESSION_ESCAPE_LENGTH)
+	{
+		write_bits(writer, (1U << ACC_COMPRESSION_ESCAPE_LENGTH) - 1U, ACC_COMPRESSION_ESCAPE_LENGTH);
+		write_bits(writer, value, ACC_COMPRESSION_ESCAPE_BITS);
+		return;
+	}
+
+	uint32_t unary = ((1U << quotient) - 1U) << 1;
+
+	if (quotient + 1U + k <= 24U)
+	{
+		write_bits(writer, (unary << k) | (value & ((1U << k) - 1U)), quotient + 1U + k);
+	}
+	else
+	{
+		write_bits(writer, unary, quotient + 1U);
+		write_bits(writer, value & ((1U << k) - 1U), k);
+	}
+}
+
+
+static inline uint32_t zigzag(int32_t difference)
+{
+	return difference >= 0 ? (uint32_t)difference << 1 : ((uint32_t)(-difference) << 1) - 1U;
+}
+
+
+/**
+ * @brief Choose the Rice parameter from the sum of the values in a block
+ *
+ * The best parameter for geometrically distributed values is close to
+ * log2 of the mean, 2^k is chosen between half the mean and the mean.
+ */
+static uint32_t rice_parameter(uint32_t sum, uint32_t length)
+{
+	uint32_t k = 0;
+
+	while (k < RICE_PARAMETER_MAX && (length << (k + 1U)) < sum)
+	{
+		k++;
+	}
+
+	return k;
+}
+
+
+/**
+ * @brief Reference of a sample, the same sample in the sweep before or the previous sample in the sweep
+ *
+ * Used the same way by the decoder. The first sweep refers to reference if not NULL.
+ */
+static inline uint16_t reference_get(const uint16_t *data, uint32_t index, uint16_t sweep_length, const uint16_t *reference)
+{
+	if (index >= sweep_length)
+	{
+		return data[index - sweep_length];
+	}
+
+	if (reference != NULL)
+	{
+		return reference[index];
+	}
+
+	return index > 0U ? data[index - 1U] : 0U;
+}
+
+
+/**
+ * @brief Code the differences of a frame
+ *
+ * @return The number of bytes written, 0 if the coded frame does not fit limit bytes
+ */
+static size_t encode_differences(const uint16_t *data, uint16_t data_length, uint16_t sweep_length,
+                                 const uint16_t *reference, uint8_t *output, size_t limit)
+{
+	bit_writer_t writer;
+	uint32_t     values[ACC_COMPRESSION_BLOCK_LENGTH];
+
+	writer.data      = output;
+	writer.position  = 0;
+	writer.bits      = 0;
+	writer.bit_count = 0;
+
+	for (uint32_t start = 0; start < data_length; start += ACC_COMPRESSION_BLOCK_LENGTH)
+	{
+		uint32_t length = data_length - start;
+		uint32_t sum    = 0;
+
+		if (length > ACC_COMPRESSION_BLOCK_LENGTH)
+		{
+			length = ACC_COMPRESSION_BLOCK_LENGTH;
+		}
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			uint32_t index = start + i;
+
+			values[i] = zigzag((int32_t)data[index] - (int32_t)reference_get(data, index, sweep_length, reference));
+			sum      += values[i];
+		}
+
+		uint32_t k = rice_parameter(sum, length);
+
+		if (writer.position + 1U > limit)
+		{
+			return 0;
+		}
+
+		write_bits(&writer, k, ACC_COMPRESSION_K_BITS);
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			if (writer.position + VALUE_MAX_BYTES > limit)
+			{
+				return 0;
+			}
+
+			write_value(&writer, values[i], k);
+		}
+	}
+
+	if (writer.bit_count > 0U)
+	{
+		if (writer.position + 1U > limit)
+		{
+			return 0;
+		}
+
+		write_bits(&writer, 0, 8U - writer.bit_count);
+	}
+
+	return writer.position;
+}
+
+
+/**
+ * @brief Sum of the absolute differences, an estimate of the coded size
+ */
+static uint32_t difference_sum(const uint16_t *data, uint16_t data_length, uint16_t sweep_length, const uint16_t *reference)
+{
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < data_length; i++)
+	{
+		int32_t difference = (int32_t)data[i] - (int32_t)reference_get(data, i, sweep_length, reference);
+
+		sum += difference >= 0 ? (uint32_t)difference : (uint32_t)(-difference);
+	}
+
+	return sum;
+}
+
+
+void acc_compression_encoder_init(acc_compression_encoder_t *encoder,
+                                  acc_compression_mode_t    mode,
+                                  uint16_t                  *previous,
+                                  uint16_t                  max_sweep_length,
+                                  uint16_t                  key_frame_interval)
+{
+	memset(encoder, 0, sizeof(*encoder));
+
+	encoder->mode               = mode;
+	encoder->previous           = previous;
+	encoder->max_sweep_length   = max_sweep_length;
+	encoder->key_frame_interval = key_frame_interval;
+}
+
+
+void acc_compression_encoder_reset(acc_compression_encoder_t *encoder)
+{
+	encoder->previous_valid = false;
+}
+
+
+size_t acc_compression_encode(acc_compression_encoder_t *encoder,
+                              const uint16_t            *data,
+                              uint16_t                  data_length,
+                              uint16_t                  sweep_length,
+                              uint8_t                   *output,
+                              size_t                    output_size)
+{
+	if (data == NULL || output == NULL || sweep_length == 0 || sweep_length > encoder->max_sweep_length ||
+	    data_length == 0 || data_length % sweep_length != 0 || output_size < ACC_COMPRESSION_MAX_SIZE(data_length))
+	{
+		return 0;
+	}
+
+	acc_compression_header_t     header;
+	acc_compression_frame_type_t frame_type = ACC_COMPRESSION_FRAME_INTRA;
+	const uint16_t               *reference = NULL;
+	size_t                       raw_size   = (size_t)data_length * sizeof(uint16_t);
+	size_t                       size;
+
+	bool key_frame_due = encoder->key_frame_interval > 0 && encoder->frames_since_key_frame >= encoder->key_frame_interval;
+	bool inter_allowed = encoder->previous != NULL && encoder->previous_valid && encoder->previous_length == sweep_length &&
+	                     !key_frame_due;
+	bool sweep_allowed = data_length > sweep_length;
+
+	if (encoder->mode == ACC_COMPRESSION_MODE_INTER)
+	{
+		if (inter_allowed)
+		{
+			frame_type = ACC_COMPRESSION_FRAME_INTER;
+		}
+		else if (sweep_allowed)
+		{
+			frame_type = ACC_COMPRESSION_FRAME_SWEEP;
+		}
+	}
+	else if (encoder->mode == ACC_COMPRESSION_MODE_ADAPTIVE)
+	{
+		uint32_t best_sum = difference_sum(data, data_length, data_length, NULL);
+
+		if (sweep_allowed)
+		{
+			uint32_t sum = difference_sum(data, data_length, sweep_length, NULL);
+
+			if (sum < best_sum)
+			{
+				best_sum   = sum;
+				frame_type = ACC_COMPRESSION_FRAME_SWEEP;
+			}
+		}
+
+		if (inter_allowed && difference_sum(data, data_length, sweep_length, encoder->previous) < best_sum)
+		{
+			frame_type = ACC_COMPRESSION_FRAME_INTER;
+		}
+	}
+
+	if (frame_type == ACC_COMPRESSION_FRAME_INTER)
+	{
+		reference = encoder->previous;
+	}
+
+	// Anything not smaller than the raw frame is sent raw
+	size = encode_differences(data, data_length, frame_type == ACC_COMPRESSION_FRAME_INTRA ? data_length : sweep_length,
+	                          reference, &output[sizeof(header)], raw_size - 1U);
+
+	if (size == 0)
+	{
+		frame_type = ACC_COMPRESSION_FRAME_RAW;
+		size       = raw_size;
+		memcpy(&output[sizeof(header)], data, raw_size);
+	}
+
+	header.frame_type   = (uint8_t)frame_type;
+	header.frame_number = encoder->frame_number++;
+	header.data_length  = data_length;
+	header.sweep_length = sweep_length;
+	memcpy(output, &header, sizeof(header));
+
+	if (encoder->previous != NULL)
+	{
+		memcpy(encoder->previous, &data[data_length - sweep_length], (size_t)sweep_length * sizeof(uint16_t));
+		encoder->previous_length = sweep_length;
+		encoder->previous_valid  = true;
+	}
+
+	if (frame_type == ACC_COMPRESSION_FRAME_INTER)
+	{
+		encoder->frames_since_key_frame++;
+	}
+	else
+	{
+		encoder->frames_since_key_frame = 1;
+	}
+
+	return sizeof(header) + size;
+}
@@ -0,0 +1,187 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_console.h"
+#include "acc_console_ring.h"
+
+#include "acc_device_os.h"
+#include "acc_device_uart.h"
+
+
+/**
+ * @brief Size of the largest UART write made by the drain task
+ */
+#define DRAIN_BUFFER_SIZE 512
+
+/**
+ * @brief Time the drain task sleeps when woken while a write is in progress
+ */
+#define DRAIN_RETRY_MS 1
+
+/**
+ * @brief Time a blocked writer waits for the drain task before trying again
+ */
+#define BLOCK_RETRY_MS 10
+
+
+static acc_console_ring_t                  ring;
+static uint8_t                             *ring_buffer;
+static acc_console_overflow_t              ring_overflow;
+static uint_fast8_t                        console_port;
+static bool                                buffered;
+static acc_app_integration_semaphore_t     data_semaphore;
+static acc_app_integration_semaphore_t     space_semaphore;
+static acc_app_integration_thread_handle_t drain_thread;
+static acc_app_integration_thread_id_t     drain_thread_id;
+static uint8_t                             drain_buffer[DRAIN_BUFFER_SIZE];
+
+
+static void drain_task(void *param)
+{
+	(void)param;
+
+	drain_thread_id = acc_os_get_thread_id();
+
+	while (true)
+	{
+		acc_os_semaphore_wait(data_semaphore, 1000);
+
+		while (!acc_console_ring_is_empty(&ring))
+		{
+			uint32_t length = acc_console_ring_read(&ring, drain_buffer, sizeof(drain_buffer));
+
+			if (length == 0)
+			{
+				// A writer is copying into the ring
+				acc_os_sleep_ms(DRAIN_RETRY_MS);
+				continue;
+			}
+
+			acc_device_uart_write_buffer(console_port, drain_buffer, length);
+			acc_os_semaphore_signal(space_semaphore);
+		}
+	}
+}
+
+
+bool acc_console_buffered_start(uint_fast8_t port, uint32_t ring_size, acc_console_overflow_t overflow)
+{
+	if (buffered)
+	{
+		return false;
+	}
+
+	ring_buffer = acc_os_mem_alloc(ring_size);
+	if (ring_buffer == NULL)
+	{
+		return false;
+	}
+
+	if (!acc_console_ring_init(&ring, ring_buffer, ring_size))
+	{
+		acc_os_mem_free(ring_buffer);
+		ring_buffer = NULL;
+		return false;
+	}
+
+	data_semaphore  = acc_os_semaphore_create();
+	space_semaphore = acc_os_semaphore_create();
+
+	if (data_semaphore == NULL || space_semaphore == NULL)
+	{
+		if (data_semaphore != NULL)
+		{
+			acc_os_semaphore_destroy(data_semaphore);
+		}
+
+		if (space_semaphore != NULL)
+		{
+			acc_os_semaphore_destroy(space_semaphore);
+		}
+
+		acc_os_mem_free(ring_buffer);
+		ring_buffer = NULL;
+		return false;
+	}
+
+	console_port  = port;
+	ring_overflow = overflow;
+
+	drain_thread = acc_os_thread_create(drain_task, NULL, "console");
+	if (drain_thread == NULL)
+	{
+		acc_os_semaphore_destroy(data_semaphore);
+		acc_os_semaphore_destroy(space_semaphore);
+		acc_os_mem_free(ring_buffer);
+		ring_buffer = NULL;
+		return false;
+	}
+
+	buffered = true;
+
+	return true;
+}
+
+
+bool acc_console_is_buffered(void)
+{
+	return buffered;
+}
+
+
+void acc_console_write(const void *data, size_t length)
+{
+	acc_console_overflow_t overflow = ring_overflow;
+
+	if (overflow == ACC_CONSOLE_OVERFLOW_BLOCK && acc_os_get_thread_id() == drain_thread_id)
+	{
+		// The drain task can't wait for itself
+		overflow = ACC_CONSOLE_OVERFLOW_DROP;
+	}
+
+	while (!acc_console_ring_write(&ring, data, length, overflow))
+	{
+		if (overflow != ACC_CONSOLE_OVERFLOW_BLOCK || length > ring.size)
+		{
+			break;
+		}
+
+		acc_os_semaphore_signal(data_semaphore);
+		acc_os_semaphore_wait(space_semaphore, BLOCK_RETRY_MS);
+	}
+
+	acc_os_semaphore_signal(data_semaphore);
+}
+
+
+bool acc_console_flush(uint32_t timeout_ms)
+{
+	uint32_t start = acc_os_get_time();
+
+	while (buffered && !acc_console_ring_is_empty(&ring))
+	{
+		if (acc_os_get_time() - start >= timeout_ms)
+		{
+			return false;
+		}
+
+		acc_os_semaphore_signal(data_semaphore);
+		acc_os_sleep_ms(DRAIN_RETRY_MS);
+	}
+
+	return true;
+}
+
+
+void acc_console_get_counters(acc_console_counters_t *counters)
+{
+	counters->written_bytes = ring.written_bytes;
+	counters->dropped_bytes = ring.dropped_bytes;
+}
@@ -0,0 +1,166 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_console_ring.h"
+
+
+#define LOAD(p)              __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v)          __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ADD(p, v)            __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define CAS(p, expected, v)  __atomic_compare_exchange_n((p), (expected), (v), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+
+static void copy_in(acc_console_ring_t *ring, uint32_t position, const uint8_t *data, uint32_t length)
+{
+	uint32_t offset = position & (ring->size - 1);
+	uint32_t first  = ring->size - offset;
+
+	if (first > length)
+	{
+		first = length;
+	}
+
+	memcpy(&ring->buffer[offset], data, first);
+	memcpy(ring->buffer, data + first, length - first);
+}
+
+
+static void copy_out(acc_console_ring_t *ring, uint32_t position, uint8_t *data, uint32_t length)
+{
+	uint32_t offset = position & (ring->size - 1);
+	uint32_t first  = ring->size - offset;
+
+	if (first > length)
+	{
+		first = length;
+	}
+
+	memcpy(data, &ring->buffer[offset], first);
+	memcpy(data + first, ring->buffer, length - first);
+}
+
+
+bool acc_console_ring_init(acc_console_ring_t *ring, uint8_t *buffer, uint32_t size)
+{
+	if (size == 0 || (size & (size - 1)) != 0)
+	{
+		return false;
+	}
+
+	memset(ring, 0, sizeof(*ring));
+	ring->buffer = buffer;
+	ring->size   = size;
+
+	return true;
+}
+
+
+bool acc_console_ring_write(acc_console_ring_t *ring, const void *data, uint32_t length, acc_console_overflow_t overflow)
+{
+	const uint8_t *bytes = data;
+
+	if (length > ring->size)
+	{
+		if (overflow != ACC_CONSOLE_OVERFLOW_OVERWRITE)
+		{
+			ADD(&ring->dropped_bytes, length);
+			return false;
+		}
+
+		ADD(&ring->dropped_bytes, length - ring->size);
+		bytes  += length - ring->size;
+		length  = ring->size;
+	}
+
+	uint32_t reserve = LOAD(&ring->reserve);
+
+	do
+	{
+		uint32_t tail = LOAD(&ring->tail);
+
+		if (reserve + length - tail > ring->size)
+		{
+			if (overflow == ACC_CONSOLE_OVERFLOW_BLOCK)
+			{
+				return false;
+			}
+
+			if (overflow == ACC_CONSOLE_OVERFLOW_DROP)
+			{
+				ADD(&ring->dropped_bytes, length);
+				return false;
+			}
+
+			// Drop the oldest data, a consumer reading it at the same time
+			// notices that the tail has moved and discards what it read
+			uint32_t new_tail = reserve + length - ring->size;
+
+			if (CAS(&ring->tail, &tail, new_tail))
+			{
+				ADD(&ring->dropped_bytes, new_tail - tail);
+			}
+
+			reserve = LOAD(&ring->reserve);
+			continue;
+		}
+
+		if (CAS(&ring->reserve, &reserve, reserve + length))
+		{
+			break;
+		}
+	} while (true);
+
+	copy_in(ring, reserve, bytes, length);
+
+	ADD(&ring->commit, length);
+	ADD(&ring->written_bytes, length);
+
+	return true;
+}
+
+
+uint32_t acc_console_ring_read(acc_console_ring_t *ring, void *data, uint32_t max_length)
+{
+	// Commit is read before reserve, if they are equal no reserved data was
+	// uncommitted when commit was read
+	uint32_t commit  = LOAD(&ring->commit);
+	uint32_t reserve = LOAD(&ring->reserve);
+
+	if (commit != reserve)
+	{
+		return 0;
+	}
+
+	while (true)
+	{
+		uint32_t tail      = LOAD(&ring->tail);
+		int32_t  available = (int32_t)(commit - tail);
+
+		if (available <= 0)
+		{
+			return 0;
+		}
+
+		uint32_t length = (uint32_t)available < max_length ? (uint32_t)available : max_length;
+
+		copy_out(ring, tail, data, length);
+
+		if (CAS(&ring->tail, &tail, tail + length))
+		{
+			return length;
+		}
+	}
+}
+
+
+bool acc_console_ring_is_empty(acc_console_ring_t *ring)
+{
+	return LOAD(&ring->tail) == LOAD(&ring->reserve);
+}
@@ -10,6 +10,11 @@
 #include "acc_device_os.h"
 
 #include "acc_app_integration.h"
+#include "acc_tcm.h"
+
+#if defined(ACC_CFG_ALLOC_TRACKER)
+#include "acc_alloc_tracker.h"
+#endif
 
 static bool init_done;
 
@@ -22,6 +27,7 @@ void                                *(*acc_device_os_mem_alloc_func)(size_t) = N
 void                                (*acc_device_os_mem_free_func)(void *) = NULL;
 acc_app_integration_thread_id_t     (*acc_device_os_get_thread_id_func)(void) = NULL;
 uint32_t                            (*acc_device_os_get_time_func)(void) = NULL;
+uint64_t                            (*acc_device_os_get_time_us_func)(void) = NULL;
 acc_app_integration_mutex_t         (*acc_device_os_mutex_create_func)(void) = NULL;
 void                                (*acc_device_os_mutex_lock_func)(acc_app_integration_mutex_t mutex) = NULL;
 void                                (*acc_device_os_mutex_unlock_func)(acc_app_integration_mutex_t mutex) = NULL;
@@ -94,14 +100,18 @@ void acc_os_sleep_ms(uint32_t time_msec)
 
 void *acc_os_mem_alloc_debug(size_t size, const char *file, uint16_t line)
 {
-	(void)file;
-	(void)line;
-
 	void *result = NULL;
 
 	if (init_done && acc_device_os_mem_alloc_func != NULL)
 	{
+#if defined(ACC_CFG_ALLOC_TRACKER)
+		result = acc_alloc_tracker_alloc(size, file, line, NULL);
+#else
+		(void)file;
+		(void)line;
+
 		result = acc_device_os_mem_alloc_func(size);
+#endif
 	}
 
 	return result;
@@ -133,7 +143,11 @@ void acc_os_mem_free(void *ptr)
 {
 	if (init_done && acc_device_os_mem_free_func != NULL)
 	{
+#if defined(ACC_CFG_ALLOC_TRACKER)
+		acc_alloc_tracker_free(ptr);
+#else
 		acc_device_os_mem_free_func(ptr);
+#endif
 	}
 }
 
@@ -162,6 +176,18 @@ uint32_t acc_os_get_time(void)
 }
 
 
+bool acc_os_get_time_us(uint64_t *time_us)
+{
+	if (acc_device_os_get_time_us_func != NULL)
+	{
+		*time_us = acc_device_os_get_time_us_func();
+		return true;
+	}
+
+	return false;
+}
+
+
 acc_app_integration_mutex_t acc_os_mutex_create(void)
 {
 	acc_app_integration_mutex_t result = NULL;
@@ -268,7 +294,7 @@ void acc_os_semaphore_signal(acc_app_integration_semaphore_t sem)
 }
 
 
-void acc_os_semaphore_signal_from_interrupt(acc_app_integration_semaphore_t sem)
+ACC_TCM_CODE void acc_os_semaphore_signal_from_interrupt(acc_app_integration_semaphore_t sem)
 {
 	if (init_done && acc_device_os_semaphore_signal_from_interrupt_func != NULL)
 	{
@@ -4,6 +4,7 @@
 // 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
 // of this source code package.
 
+#include <inttypes.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -13,6 +14,7 @@
 #include "acc_device.h"
 #include "acc_device_os.h"
 #include "acc_device_spi.h"
+#include "acc_log.h"
 
 /**
  * @brief The module name
@@ -26,6 +28,9 @@ void                (*acc_device_spi_destroy_func)(acc_device_handle_t *handle)
 bool                (*acc_device_spi_transfer_func)(acc_device_handle_t handle, uint8_t *buffer, size_t buffer_size) = NULL;
 bool		(*acc_device_spi_transfer_async_func)(acc_device_handle_t handle, uint8_t *buffer, bool rx, bool tx, size_t buffer_size, acc_device_spi_transfer_callback_t callback) = NULL;
 uint8_t	            (*acc_device_spi_get_bus_func)(acc_device_handle_t) = NULL;
+bool                (*acc_device_spi_transfer_segments_func)(acc_device_handle_t handle, const acc_device_spi_segment_t *segments, size_t segment_count) = NULL;
+bool                (*acc_device_spi_transfer_abort_func)(acc_device_handle_t handle) = NULL;
+uint32_t            (*acc_device_spi_telemetry_get_time_us_func)(void) = NULL;
 
 
 /**
@@ -34,6 +39,99 @@ uint8_t	            (*acc_device_spi_get_bus_func)(acc_device_handle_t) = NULL;
 static acc_app_integration_mutex_t spi_mutex[ACC_DEVICE_SPI_BUS_MAX] = {NULL};
 
 
+/**
+ * @brief True if telemetry counters are updated
+ */
+static bool telemetry_enabled = false;
+
+
+/**
+ * @brief Telemetry counters per bus
+ */
+static acc_device_spi_telemetry_t telemetry[ACC_DEVICE_SPI_BUS_MAX];
+
+
+/**
+ * @brief The asynchronous transfer in progress per bus while telemetry is enabled
+ */
+static struct {
+	acc_device_spi_transfer_callback_t callback;
+	uint32_t                           start_time_us;
+} telemetry_async[ACC_DEVICE_SPI_BUS_MAX];
+
+
+static uint32_t telemetry_get_time_us(void)
+{
+	if (acc_device_spi_telemetry_get_time_us_func != NULL) {
+		return acc_device_spi_telemetry_get_time_us_func();
+	}
+
+	return acc_os_get_time() * 1000;
+}
+
+
+static uint_fast8_t telemetry_histogram_bin(uint32_t time_us)
+{
+	uint_fast8_t bin = 0;
+
+	while (time_us > 1 && bin < ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS - 1) {
+		time_us >>= 1;
+		bin++;
+	}
+
+	return bin;
+}
+
+
+static acc_device_spi_telemetry_t *telemetry_get_bus(acc_device_handle_t handle)
+{
+	uint_fast8_t bus = acc_device_spi_get_bus(handle);
+
+	return bus < ACC_DEVICE_SPI_BUS_MAX ? &telemetry[bus] : NULL;
+}
+
+
+static void telemetry_transfer_record(acc_device_handle_t handle, size_t buffer_size)
+{
+	acc_device_spi_telemetry_t *bus_telemetry = telemetry_get_bus(handle);
+
+	if (bus_telemetry != NULL) {
+		bus_telemetry->bytes += buffer_size;
+		bus_telemetry->transfer_count++;
+	}
+}
+
+
+static void telemetry_transfer_time_record(acc_device_handle_t handle, uint32_t time_us)
+{
+	acc_device_spi_telemetry_t *bus_telemetry = telemetry_get_bus(handle);
+
+	if (bus_telemetry != NULL) {
+		bus_telemetry->transfer_time_us += time_us;
+		if (time_us > bus_telemetry->transfer_time_max_us) {
+			bus_telemetry->transfer_time_max_us = time_us;
+		}
+
+		bus_telemetry->transfer_time_histogram[telemetry_histogram_bin(time_us)]++;
+	}
+}
+
+
+static void telemetry_async_callback(acc_device_handle_t handle, acc_device_spi_transfer_status_t status)
+{
+	uint_fast8_t                       bus      = acc_device_spi_get_bus(handle);
+	acc_device_spi_transfer_callback_t callback = telemetry_async[bus].callback;
+
+	if (status == ACC_DEVICE_SPI_TRANSFER_STATUS_OK) {
+		telemetry_transfer_time_record(handle, telemetry_get_time_us() - telemetry_async[bus].start_time_us);
+	}
+
+	if (callback != NULL) {
+		callback(handle, status);
+	}
+}
+
+
 acc_device_handle_t acc_device_spi_create(acc_device_spi_configuration_t *configuration)
 {
 	if (acc_device_spi_create_func != NULL) {
@@ -77,8 +175,24 @@ bool acc_device_spi_lock(uint_fast8_t bus)
 		return false;
 	}
 
+	if (!telemetry_enabled) {
+		acc_os_mutex_lock(spi_mutex[bus]);
+		return true;
+	}
+
+	uint32_t start_time_us = telemetry_get_time_us();
+
 	acc_os_mutex_lock(spi_mutex[bus]);
 
+	// Updated while holding the lock
+	uint32_t wait_time_us = telemetry_get_time_us() - start_time_us;
+
+	telemetry[bus].lock_count++;
+	telemetry[bus].lock_wait_time_us += wait_time_us;
+	if (wait_time_us > telemetry[bus].lock_wait_time_max_us) {
+		telemetry[bus].lock_wait_time_max_us = wait_time_us;
+	}
+
 	return true;
 }
 
@@ -109,7 +223,45 @@ bool acc_device_spi_transfer(acc_device_handle_t handle, uint8_t *buffer, size_t
 {
 	bool status = false;
 	if (acc_device_spi_transfer_func != NULL) {
+		uint32_t start_time_us = telemetry_enabled ? telemetry_get_time_us() : 0;
+
 		status = acc_device_spi_transfer_func(handle, buffer, buffer_size);
+
+		if (telemetry_enabled && status) {
+			telemetry_transfer_time_record(handle, telemetry_get_time_us() - start_time_us);
+			telemetry_transfer_record(handle, buffer_size);
+		}
+	}
+
+	if (!status) {
+		printf("%s failed\n", __func__);
+	}
+
+	return status;
+}
+
+
+bool acc_device_spi_transfer_segments(acc_device_handle_t handle, const acc_device_spi_segment_t *segments, size_t segment_count)
+{
+	bool status = false;
+	if (acc_device_spi_transfer_segments_func != NULL) {
+		uint32_t start_time_us = telemetry_enabled ? telemetry_get_time_us() : 0;
+
+		status = acc_device_spi_transfer_segments_func(handle, segments, segment_count);
+
+		if (telemetry_enabled && status) {
+			size_t bytes = 0;
+
+			for (size_t index = 0; index < segment_count; index++) {
+				bytes += segments[index].buffer_size;
+			}
+
+			telemetry_transfer_time_record(handle, telemetry_get_time_us() - start_time_us);
+			telemetry_transfer_record(handle, bytes);
+		}
+	} else if (segment_count == 1) {
+		// Without driver support chip select can't be kept asserted between transfers
+		status = acc_device_spi_transfer(handle, segments[0].buffer, segments[0].buffer_size);
 	}
 
 	if (!status) {
@@ -124,7 +276,21 @@ bool acc_device_spi_transfer_async(acc_device_handle_t handle, uint8_t *buffer,
 {
 	bool status = false;
 	if (acc_device_spi_transfer_async_func != NULL) {
+		uint_fast8_t bus = acc_device_spi_get_bus(handle);
+
+		if (telemetry_enabled && bus < ACC_DEVICE_SPI_BUS_MAX) {
+			// Only one transfer at a time is possible on a bus, the duration is
+			// recorded when the driver calls back
+			telemetry_async[bus].callback      = callback;
+			telemetry_async[bus].start_time_us = telemetry_get_time_us();
+			callback                           = telemetry_async_callback;
+		}
+
 		status = acc_device_spi_transfer_async_func(handle, buffer, rx, tx, buffer_size, callback);
+
+		if (telemetry_enabled && status) {
+			telemetry_transfer_record(handle, buffer_size);
+		}
 	}
 
 	if (!status) {
@@ -133,3 +299,96 @@ bool acc_device_spi_transfer_async(acc_device_handle_t handle, uint8_t *buffer,
 
 	return status;
 }
+
+
+bool acc_device_spi_transfer_abort(acc_device_handle_t handle)
+{
+	if (acc_device_spi_transfer_abort_func != NULL) {
+		return acc_device_spi_transfer_abort_func(handle);
+	}
+
+	return false;
+}
+
+
+void acc_device_spi_telemetry_chunks_record(uint_fast8_t bus, uint32_t chunk_count)
+{
+	if (!telemetry_enabled || bus >= ACC_DEVICE_SPI_BUS_MAX || chunk_count < 2) {
+		return;
+	}
+
+	telemetry[bus].chunked_transfer_count++;
+	telemetry[bus].chunk_count += chunk_count;
+}
+
+
+void acc_device_spi_telemetry_enable(bool enable)
+{
+	telemetry_enabled = enable;
+}
+
+
+bool acc_device_spi_telemetry_get(uint_fast8_t bus, acc_device_spi_telemetry_t *bus_telemetry, bool reset)
+{
+	if (bus >= ACC_DEVICE_SPI_BUS_MAX) {
+		return false;
+	}
+
+	*bus_telemetry = telemetry[bus];
+
+	if (reset) {
+		memset(&telemetry[bus], 0, sizeof(telemetry[bus]));
+	}
+
+	return true;
+}
+
+
+void acc_device_spi_telemetry_reset(void)
+{
+	memset(telemetry, 0, sizeof(telemetry));
+}
+
+
+void acc_device_spi_telemetry_log(uint_fast8_t bus)
+{
+	acc_device_spi_telemetry_t bus_telemetry;
+
+	if (!acc_device_spi_telemetry_get(bus, &bus_telemetry, false)) {
+		return;
+	}
+
+	uint32_t average_time_us = 0;
+	uint32_t measured_count  = 0;
+
+	for (uint_fast8_t bin = 0; bin < ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS; bin++) {
+		measured_count += bus_telemetry.transfer_time_histogram[bin];
+	}
+
+	if (measured_count > 0) {
+		average_time_us = (uint32_t)(bus_telemetry.transfer_time_us / measured_count);
+	}
+
+	ACC_LOG_INFO("SPI bus %u: %" PRIu32 " transfers, %" PRIu64 " bytes, %" PRIu32 " chunked into %" PRIu32 " DMA transfers",
+	             (unsigned int)bus, bus_telemetry.transfer_count, bus_telemetry.bytes,
+	             bus_telemetry.chunked_transfer_count, bus_telemetry.chunk_count);
+	ACC_LOG_INFO("SPI bus %u: transfer time total %" PRIu64 " us, average %" PRIu32 " us, max %" PRIu32 " us",
+	             (unsigned int)bus, bus_telemetry.transfer_time_us, average_time_us, bus_telemetry.transfer_time_max_us);
+	ACC_LOG_INFO("SPI bus %u: %" PRIu32 " locks, wait time total %" PRIu64 " us, max %" PRIu32 " us",
+	             (unsigned int)bus, bus_telemetry.lock_count, bus_telemetry.lock_wait_time_us,
+	             bus_telemetry.lock_wait_time_max_us);
+
+	for (uint_fast8_t bin = 0; bin < ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS; bin++) {
+		uint32_t count = bus_telemetry.transfer_time_histogram[bin];
+
+		if (count == 0) {
+			continue;
+		}
+
+		if (bin == ACC_DEVICE_SPI_TELEMETRY_HISTOGRAM_BINS - 1) {
+			ACC_LOG_INFO("SPI bus %u: >= %" PRIu32 " us: %" PRIu32, (unsigned int)bus, (uint32_t)1 << bin, count);
+		} else {
+			ACC_LOG_INFO("SPI bus %u: < %" PRIu32 " us: %" PRIu32, (unsigned int)bus, (uint32_t)2 << bin, count);
+		}
+	}
+}
@@ -22,6 +22,9 @@ bool    (*acc_device_uart_write_func)(uint_fast8_t port, const uint8_t *data, si
 void    (*acc_device_uart_register_read_func)(uint_fast8_t port, acc_device_uart_read_func_t *callback) = NULL;
 int32_t (*acc_device_uart_get_error_count_func)(uint_fast8_t port) = NULL;
 void    (*acc_device_uart_deinit_func)(uint_fast8_t port) = NULL;
+bool    (*acc_device_uart_block_read_start_func)(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event) = NULL;
+size_t  (*acc_device_uart_block_read_func)(uint_fast8_t port, uint8_t *data, size_t max_length) = NULL;
+uint32_t (*acc_device_uart_get_max_baudrate_func)(uint_fast8_t port) = NULL;
 
 
 /**
@@ -96,6 +99,39 @@ void acc_device_uart_register_read_callback(uint_fast8_t port, acc_device_uart_r
 }
 
 
+bool acc_device_uart_block_read_start(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event)
+{
+	if (acc_device_uart_block_read_start_func == NULL)
+	{
+		return false;
+	}
+
+	return acc_device_uart_block_read_start_func(port, buffer_size, event);
+}
+
+
+size_t acc_device_uart_block_read(uint_fast8_t port, uint8_t *data, size_t max_length)
+{
+	if (acc_device_uart_block_read_func == NULL)
+	{
+		return 0;
+	}
+
+	return acc_device_uart_block_read_func(port, data, max_length);
+}
+
+
+uint32_t acc_device_uart_get_max_baudrate(uint_fast8_t port)
+{
+	if (acc_device_uart_get_max_baudrate_func == NULL)
+	{
+		return 0;
+	}
+
+	return acc_device_uart_get_max_baudrate_func(port);
+}
+
+
 int32_t acc_device_uart_get_error_count(uint_fast8_t port)
 {
 	if (acc_device_uart_get_error_count_func != NULL)
@@ -13,6 +13,7 @@
 #include "acc_device_gpio.h"
 #include "acc_device_os.h"
 #include "acc_log.h"
+#include "acc_tcm.h"
 
 #include "board.h"
 #include "pio.h"
@@ -203,7 +204,7 @@ static bool is_isr_registered(const gpio_t *gpio)
  * @param[in] status The PIO_ISR value
  * @param[in] arg The user argument which is gpio_t * in this case
  */
-static void gpio_isr(uint32_t group, uint32_t status, void *arg)
+ACC_TCM_CODE static void gpio_isr(uint32_t group, uint32_t status, void *arg)
 {
 	(void)group; // Ignore parameter
 	(void)status; // Ignore parameter
@@ -14,8 +14,13 @@
 #include "acc_device_spi.h"
 #include "acc_driver_os.h"
 #include "acc_hal_definitions.h"
+#include "acc_log_filter.h"
 #include "acc_log_integration.h"
 
+#if defined(ACC_CFG_ALLOC_TRACKER)
+#include "acc_alloc_tracker.h"
+#endif
+
 
 void (*acc_board_hibernate_enter_func)(acc_sensor_id_t sensor) = NULL;
 void (*acc_board_hibernate_exit_func)(acc_sensor_id_t sensor) = NULL;
@@ -71,9 +76,17 @@ const acc_hal_t *acc_driver_hal_get_implementation(void)
 	hal.sensor_device.hibernate_enter    = acc_board_hibernate_enter_func;
 	hal.sensor_device.hibernate_exit     = acc_board_hibernate_exit_func;
 
+#if defined(ACC_CFG_ALLOC_TRACKER)
+	hal.os.mem_alloc = acc_alloc_tracker_hal_mem_alloc;
+	hal.os.mem_free  = acc_alloc_tracker_free;
+#else
 	hal.os.mem_alloc = acc_device_os_mem_alloc_func;
 	hal.os.mem_free  = acc_device_os_mem_free_func;
+#endif
 	hal.os.gettime   = acc_device_os_get_time_func;
 
+	// RSS filters its own calls by this level, acc_log filters them per module
+	hal.log.log_level = acc_log_level_limit < ACC_LOG_LEVEL_MAX ? acc_log_level_limit : ACC_LOG_LEVEL_MAX;
+
 	return &hal;
 }
@@ -27,6 +27,7 @@
 #include "acc_driver_traceclock_cmx.h"
 #endif
 #include "acc_log.h"
+#include "acc_tcm.h"
 
 /**
  * @brief The module name
@@ -141,7 +142,7 @@ void rtt_alarm_handler(uint32_t source, void* user_arg)
  *
  * @return pdTRUE if a context switch is required in order to force the scheduler to run.
  */
-static BaseType_t update_tick_count(uint32_t ulExpectedIdleTimeTicks)
+ACC_TCM_CODE static BaseType_t update_tick_count(uint32_t ulExpectedIdleTimeTicks)
 {
 	BaseType_t pended = pdFALSE;
 
@@ -182,7 +183,7 @@ static BaseType_t update_tick_count(uint32_t ulExpectedIdleTimeTicks)
 }
 
 
-void SysTick_Handler(void)
+ACC_TCM_CODE void SysTick_Handler(void)
 {
 #ifdef ACC_CFG_ENABLE_TRACECLOCK
 	acc_driver_traceclock_cmx_systick_handler();
@@ -251,7 +252,7 @@ void vPortSetupTimerInterrupt( void )
 }
 
 
-void vPortSuppressTicksAndSleep( uint32_t xExpectedIdleTimeTicks )
+ACC_TCM_CODE void vPortSuppressTicksAndSleep( uint32_t xExpectedIdleTimeTicks )
 {
 	/* Enter a critical section but don't use the taskENTER_CRITICAL()
 	 * method as that will mask interrupts that should exit sleep mode.
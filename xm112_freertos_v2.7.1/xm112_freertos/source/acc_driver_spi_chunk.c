@@ -0,0 +1,68 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_driver_spi_chunk.h"
+
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+
+static acc_driver_spi_chunk_t bounce_chunk(size_t offset, size_t size, const acc_driver_spi_chunk_limits_t *limits)
+{
+	acc_driver_spi_chunk_t chunk = {
+		.offset = offset,
+		.size   = MIN(size, limits->bounce_buffer_size),
+		.direct = false,
+	};
+
+	return chunk;
+}
+
+
+acc_driver_spi_chunk_t acc_driver_spi_chunk_next(uintptr_t                           buffer_address,
+                                                 size_t                              buffer_size,
+                                                 size_t                              offset,
+                                                 const acc_driver_spi_chunk_limits_t *limits)
+{
+	size_t    remaining = buffer_size - offset;
+	uintptr_t start     = buffer_address + offset;
+	uintptr_t end       = start + remaining;
+	size_t    alignment = limits->alignment;
+
+	if (limits->direct_max_size < alignment)
+	{
+		return bounce_chunk(offset, remaining, limits);
+	}
+
+	uintptr_t aligned_start = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	uintptr_t aligned_end   = end & ~(uintptr_t)(alignment - 1);
+
+	if (aligned_start >= aligned_end)
+	{
+		// Not a single whole cache line left
+		return bounce_chunk(offset, remaining, limits);
+	}
+
+	if (start != aligned_start)
+	{
+		// Head up to the first cache line boundary
+		return bounce_chunk(offset, aligned_start - start, limits);
+	}
+
+	size_t direct_max_size = limits->direct_max_size & ~(alignment - 1);
+
+	acc_driver_spi_chunk_t chunk = {
+		.offset = offset,
+		.size   = MIN((size_t)(aligned_end - start), direct_max_size),
+		.direct = true,
+	};
+
+	return chunk;
+}
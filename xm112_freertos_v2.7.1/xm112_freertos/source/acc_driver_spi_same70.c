@@ -4,17 +4,21 @@
 // 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
 // of this source code package.
 
-#include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "acc_device_os.h"
 #include "acc_device_spi.h"
 #include "acc_device_pm.h"
+#include "acc_driver_spi_chunk.h"
 #include "acc_driver_spi_same70.h"
 #include "acc_log.h"
+#include "acc_tcm.h"
 
+#include "dma/dma.h"
+#include "irq/irq.h"
 #include "spid.h"
 #include "bus.h"
 
@@ -24,27 +28,99 @@
 #define MODULE "driver_spi_same70"
 
 #define SPI_BUS_MAX           2
-#define SPI_DEVICE_MAX        2
+#define SPI_DEVICE_MAX        4
+#define SPI_BUFFER_COUNT      2
+#define SPI_SEGMENT_CHUNK_MAX SPID_LINKED_LIST_SIZE
 #define MIN(a,b)              (a < b ? a : b)
 
+/**
+ * @brief Largest chunk transferred in place, whole cache lines within one DMA block
+ */
+#define DIRECT_CHUNK_MAX_SIZE (DMA_MAX_BT_SIZE & ~(L1_CACHE_BYTES - 1))
+
+// A zero copy transfer of up to DIRECT_CHUNK_MAX_SIZE is a head, a direct chunk and a tail
+_Static_assert(SPI_SEGMENT_CHUNK_MAX >= 3, "A DMA linked list must hold at least three chunks");
+
+/**
+ * @brief Size of the driver buffers kept in DTCM when TCM is enabled
+ */
+#ifndef ACC_DRIVER_SPI_SAME70_TCM_BUFFER_SIZE
+#define ACC_DRIVER_SPI_SAME70_TCM_BUFFER_SIZE 8192U
+#endif
+
+/**
+ * @brief A chunk of a transfer and the DMA buffer descriptor used for it
+ */
 typedef struct
 {
-	uint8_t          bus;
-	uint_fast8_t     device;
-	uint32_t         speed;
+	acc_driver_spi_chunk_t chunk;
+	struct _buffer         buf;
+} transfer_slot_t;
+
+
+/**
+ * @brief A transfer split into chunks that are programmed as one DMA linked list
+ */
+typedef struct
+{
+	struct _buffer         bufs[SPI_SEGMENT_CHUNK_MAX];
+	acc_driver_spi_chunk_t chunks[SPI_SEGMENT_CHUNK_MAX];
+	size_t                 chunk_segment[SPI_SEGMENT_CHUNK_MAX];
+	size_t                 chunk_count;
+} segment_plan_t;
+
+
+/**
+ * @brief State shared by all devices on a bus
+ */
+typedef struct
+{
+	uint_fast8_t     device_count;
 	bool             master;
 	struct _spi_desc spi_desc;
-	struct _buffer   async_buf;
 	uint8_t          *async_user_buffer;
+	size_t           async_buffer_size;
 	bool             async_rx;
+	bool             async_tx;
+	uint_fast8_t     async_current;
 	acc_device_spi_transfer_callback_t async_transfer_cb;
-	uint8_t          *buffer;
+	transfer_slot_t  async_slots[SPI_BUFFER_COUNT];
+	acc_device_spi_segment_t async_segment;
+	segment_plan_t   async_plan;
+	uint8_t          *buffer[SPI_BUFFER_COUNT];
 	uint8_t          *buffer_unaligned;
 	size_t           buffer_size;
+	bool             zero_copy;
+	acc_driver_spi_same70_statistics_t statistics;
+} spi_bus_state_t;
+
+
+/**
+ * @brief A device, one chip select on a bus
+ */
+typedef struct
+{
+	uint8_t         bus;
+	uint_fast8_t    device;
+	uint32_t        speed;
+	bool            master;
+	bool            created;
+	spi_bus_state_t *state;
 } acc_driver_spi_same70_handle_t;
 
 
-static acc_driver_spi_same70_handle_t handles[SPI_BUS_MAX];
+static spi_bus_state_t                bus_states[SPI_BUS_MAX];
+static acc_driver_spi_same70_handle_t handles[SPI_BUS_MAX][SPI_DEVICE_MAX];
+
+#if ACC_TCM_ENABLED
+/**
+ * @brief Driver buffers in DTCM, used by the first bus whose buffers fit
+ *
+ * DTCM is not cached, so the copies to and from it never miss, and it is reachable by the DMA.
+ */
+ACC_TCM_BSS static uint8_t tcm_buffer[ACC_DRIVER_SPI_SAME70_TCM_BUFFER_SIZE] __attribute__((aligned(L1_CACHE_BYTES)));
+static spi_bus_state_t     *tcm_buffer_owner;
+#endif
 
 
 static wait_for_transfer_complete_t wait_for_transfer_complete_func;
@@ -76,6 +152,79 @@ static bool lookup_spi(uint_fast8_t bus, Spi **spi)
 }
 
 
+static void bus_buffer_free(spi_bus_state_t *state)
+{
+#if ACC_TCM_ENABLED
+	if (tcm_buffer_owner == state)
+	{
+		tcm_buffer_owner = NULL;
+	}
+	else
+#endif
+	{
+		acc_os_mem_free(state->buffer_unaligned);
+	}
+
+	state->buffer_unaligned = NULL;
+	state->buffer[0] = NULL;
+	state->buffer[1] = NULL;
+	state->buffer_size = 0;
+}
+
+
+static bool bus_buffer_allocate(spi_bus_state_t *state, uint32_t buffer_size)
+{
+	// The buffer size must be at least L1_CACHE_BYTES and a multiple of L1_CACHE_BYTES
+	if (buffer_size % L1_CACHE_BYTES != 0)
+	{
+		buffer_size += L1_CACHE_BYTES - buffer_size % L1_CACHE_BYTES;
+	}
+
+	if (state->buffer_unaligned != NULL && buffer_size <= state->buffer_size)
+	{
+		return true;
+	}
+
+#if ACC_TCM_ENABLED
+	if ((tcm_buffer_owner == NULL || tcm_buffer_owner == state) && SPI_BUFFER_COUNT * buffer_size <= sizeof(tcm_buffer))
+	{
+		if (state->buffer_unaligned != NULL)
+		{
+			bus_buffer_free(state);
+		}
+
+		tcm_buffer_owner = state;
+		state->buffer_size = buffer_size;
+		state->buffer_unaligned = tcm_buffer;
+		state->buffer[0] = tcm_buffer;
+		state->buffer[1] = tcm_buffer + buffer_size;
+
+		return true;
+	}
+#endif
+
+	// Two buffers so that one chunk can be copied while the next is transferred
+	uint8_t *buffer = acc_os_mem_alloc(SPI_BUFFER_COUNT * buffer_size + L1_CACHE_BYTES - 1);
+	if (buffer == NULL)
+	{
+		ACC_LOG_ERROR("Failed to allocate SPI transfer buffer");
+		return false;
+	}
+
+	if (state->buffer_unaligned != NULL)
+	{
+		bus_buffer_free(state);
+	}
+
+	state->buffer_size = buffer_size;
+	state->buffer_unaligned = buffer;
+	state->buffer[0] = (void *)(((uintptr_t)buffer + L1_CACHE_BYTES - 1) & ~(L1_CACHE_BYTES - 1));
+	state->buffer[1] = state->buffer[0] + buffer_size;
+
+	return true;
+}
+
+
 static acc_device_handle_t acc_driver_spi_same70_create(acc_device_spi_configuration_t *configuration)
 {
 	Spi          *spi;
@@ -86,45 +235,66 @@ static acc_device_handle_t acc_driver_spi_same70_create(acc_device_spi_configura
 		return NULL;
 	}
 
+	if (configuration->device >= SPI_DEVICE_MAX)
+	{
+		ACC_LOG_ERROR("Invalid chip select");
+		return NULL;
+	}
+
 	if (!lookup_spi(configuration->bus, &spi))
 	{
 		ACC_LOG_ERROR("lookup_spi failed");
 		return NULL;
 	}
 
-	// The buffer size must be at least L1_CACHE_BYTES and a multiple of L1_CACHE_BYTES
-	uint32_t buffer_size = configuration->buffer_size;
-	if (buffer_size % L1_CACHE_BYTES != 0)
+	spi_bus_state_t                *state  = &bus_states[configuration->bus];
+	acc_driver_spi_same70_handle_t *handle = &handles[configuration->bus][configuration->device];
+
+	if (handle->created)
 	{
-		buffer_size += L1_CACHE_BYTES - buffer_size % L1_CACHE_BYTES;
+		ACC_LOG_ERROR("SPI device already created");
+		return NULL;
 	}
 
-	uint8_t *buffer = acc_os_mem_alloc(buffer_size + L1_CACHE_BYTES - 1);
-	if (buffer == NULL)
+	if (state->device_count > 0 && state->master != configuration->master)
+	{
+		ACC_LOG_ERROR("All devices on a bus must have the same role");
+		return NULL;
+	}
+
+	if (!bus_buffer_allocate(state, configuration->buffer_size))
 	{
-		ACC_LOG_ERROR("Failed to allocate SPI transfer buffer");
 		return NULL;
 	}
-	handles[configuration->bus].buffer_size = buffer_size;
-	handles[configuration->bus].buffer_unaligned = buffer;
-	handles[configuration->bus].buffer = (void *)(((uintptr_t)buffer + L1_CACHE_BYTES - 1) & ~(L1_CACHE_BYTES - 1));
 
 	acc_driver_spi_same70_config_t spi_pins = *(acc_driver_spi_same70_config_t *)configuration->configuration;
 
-	// Configure SPI GPIO pins
-	pio_configure(&spi_pins.spi_miso, 1);
-	pio_configure(&spi_pins.spi_mosi, 1);
-	pio_configure(&spi_pins.spi_clk, 1);
+	// Configure SPI GPIO pins, the data and clock pins are shared by all devices on the bus
+	if (state->device_count == 0)
+	{
+		pio_configure(&spi_pins.spi_miso, 1);
+		pio_configure(&spi_pins.spi_mosi, 1);
+		pio_configure(&spi_pins.spi_clk, 1);
+	}
+
 	pio_configure(&spi_pins.spi_npcs, 1);
 
-	handles[configuration->bus].spi_desc.addr = spi;
-	handles[configuration->bus].spi_desc.chip_select = configuration->device;
-	handles[configuration->bus].spi_desc.transfer_mode = BUS_TRANSFER_MODE_DMA;
+	if (state->device_count == 0)
+	{
+		state->spi_desc.addr = spi;
+		state->spi_desc.chip_select = configuration->device;
+		state->spi_desc.transfer_mode = BUS_TRANSFER_MODE_DMA;
+
+		spid_configure(&state->spi_desc);
+		spid_configure_master(&state->spi_desc, configuration->master);
+
+		state->master    = configuration->master;
+		state->zero_copy = spi_pins.zero_copy;
+		memset(&state->statistics, 0, sizeof(state->statistics));
+	}
 
-	spid_configure(&handles[configuration->bus].spi_desc);
-	spid_configure_master(&handles[configuration->bus].spi_desc, configuration->master);
-	spid_configure_cs(&handles[configuration->bus].spi_desc,
-	                  handles[configuration->bus].spi_desc.chip_select,
+	spid_configure_cs(&state->spi_desc,
+	                  configuration->device,
 	                  configuration->speed / 1000, // bitrate in kbps
 	                  0, // delay_dlybs
 	                  0, // delay_dlybct
@@ -132,27 +302,37 @@ static acc_device_handle_t acc_driver_spi_same70_create(acc_device_spi_configura
 
 	ACC_LOG_VERBOSE("SAME70 SPI driver initialized");
 
-	handles[configuration->bus].bus    = configuration->bus;
-	handles[configuration->bus].device = configuration->device;
-	handles[configuration->bus].speed  = configuration->speed;
-	handles[configuration->bus].master = configuration->master;
+	handle->bus     = configuration->bus;
+	handle->device  = configuration->device;
+	handle->speed   = configuration->speed;
+	handle->master  = configuration->master;
+	handle->created = true;
+	handle->state   = state;
+	state->device_count++;
 
 	// Fill in actual speed
-	configuration->speed = spid_get_cs_bitrate(&handles[configuration->bus].spi_desc,
-	                                           handles[configuration->bus].spi_desc.chip_select);
+	configuration->speed = spid_get_cs_bitrate(&state->spi_desc, configuration->device);
 
-	return (acc_device_handle_t)&handles[configuration->bus];
+	return (acc_device_handle_t)handle;
 }
 
 
 static void acc_driver_spi_same70_destroy(acc_device_handle_t *dev_handle)
 {
 	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)*dev_handle;
-	spid_destroy(&handle->spi_desc);
-	acc_os_mem_free(handle->buffer_unaligned);
-	handle->buffer_unaligned = NULL;
-	handle->buffer = NULL;
-	*dev_handle = NULL;
+	spi_bus_state_t                *state  = handle->state;
+
+	handle->created = false;
+	handle->state   = NULL;
+	*dev_handle     = NULL;
+
+	if (--state->device_count > 0)
+	{
+		return;
+	}
+
+	spid_destroy(&state->spi_desc);
+	bus_buffer_free(state);
 }
 
 
@@ -168,6 +348,236 @@ static int spi_transfer_complete_callback(void *arg1, void *arg2)
 }
 
 
+static void chunk_prepare(acc_driver_spi_same70_handle_t      *handle,
+                          uint8_t                             *buffer,
+                          size_t                              buffer_size,
+                          size_t                              offset,
+                          const acc_driver_spi_chunk_limits_t *limits,
+                          transfer_slot_t                     *slot,
+                          uint8_t                             *bounce_buffer)
+{
+	spi_bus_state_t *state = handle->state;
+
+	slot->chunk = acc_driver_spi_chunk_next((uintptr_t)buffer, buffer_size, offset, limits);
+
+	if (slot->chunk.direct)
+	{
+		// Whole cache lines of the caller's buffer, the clean and invalidate done
+		// by the SPI driver does not affect any other data
+		slot->buf.data = buffer + offset;
+		state->statistics.direct_bytes += slot->chunk.size;
+	}
+	else
+	{
+		// We need to copy the data to cache line aligned memory so that we
+		// don't invalidate data outside the buffer
+		memcpy(bounce_buffer, buffer + offset, slot->chunk.size);
+		slot->buf.data = bounce_buffer;
+		state->statistics.bounced_bytes += slot->chunk.size;
+	}
+
+	slot->buf.size = slot->chunk.size;
+	slot->buf.attr = BUS_BUF_ATTR_RX | BUS_BUF_ATTR_TX;
+
+	if (offset + slot->chunk.size == buffer_size)
+	{
+		// Release CS after last transfer
+		slot->buf.attr |= BUS_SPI_BUF_ATTR_RELEASE_CS;
+	}
+}
+
+
+static bool chunk_start(acc_driver_spi_same70_handle_t *handle, acc_device_handle_t dev_handle, transfer_slot_t *slot,
+                        callback_method_t method)
+{
+	spi_bus_state_t *state = handle->state;
+
+	struct _callback callback = {
+		.method = method,
+		.arg = dev_handle
+	};
+
+	return spid_transfer(&state->spi_desc, &slot->buf, 1, &callback) == 0;
+}
+
+
+static void chunk_wait(acc_driver_spi_same70_handle_t *handle, acc_device_handle_t dev_handle)
+{
+	spi_bus_state_t *state = handle->state;
+
+	if (wait_for_transfer_complete_func)
+	{
+		wait_for_transfer_complete_func(dev_handle);
+
+		if (!spid_is_busy(&state->spi_desc))
+		{
+			return;
+		}
+
+		// The completion was not signalled in time, fall back to polling the DMA
+		ACC_LOG_WARNING("SPI transfer complete not signalled, polling");
+	}
+
+	spid_wait_transfer(&state->spi_desc);
+}
+
+
+static void chunk_finish(uint8_t *buffer, const transfer_slot_t *slot)
+{
+	if (!slot->chunk.direct)
+	{
+		// Copy back the data to the buffer
+		memcpy(buffer + slot->chunk.offset, slot->buf.data, slot->chunk.size);
+	}
+}
+
+
+/**
+ * @brief Plan segments as one DMA linked list
+ *
+ * Both driver buffers are used as one bounce area, each bounced chunk starts on
+ * a cache line boundary.
+ *
+ * @return False if the chunks do not fit in one linked list or in the driver buffers
+ */
+static bool segments_plan(spi_bus_state_t                     *state,
+                          const acc_device_spi_segment_t      *segments,
+                          size_t                              segment_count,
+                          const acc_driver_spi_chunk_limits_t *limits,
+                          uint32_t                            attr,
+                          segment_plan_t                      *plan)
+{
+	size_t bounce_offset = 0;
+
+	plan->chunk_count = 0;
+
+	for (size_t segment = 0; segment < segment_count; segment++)
+	{
+		uint8_t *buffer     = segments[segment].buffer;
+		size_t  buffer_size = segments[segment].buffer_size;
+		size_t  offset      = 0;
+
+		while (offset < buffer_size)
+		{
+			if (plan->chunk_count == SPI_SEGMENT_CHUNK_MAX)
+			{
+				return false;
+			}
+
+			acc_driver_spi_chunk_t chunk = acc_driver_spi_chunk_next((uintptr_t)buffer, buffer_size, offset, limits);
+			struct _buffer         *buf  = &plan->bufs[plan->chunk_count];
+
+			if (chunk.direct)
+			{
+				buf->data = buffer + offset;
+			}
+			else
+			{
+				size_t slot_size = (chunk.size + L1_CACHE_BYTES - 1) & ~(size_t)(L1_CACHE_BYTES - 1);
+
+				if (bounce_offset + slot_size > SPI_BUFFER_COUNT * state->buffer_size)
+				{
+					return false;
+				}
+
+				buf->data = state->buffer[0] + bounce_offset;
+				bounce_offset += slot_size;
+			}
+
+			buf->size = chunk.size;
+			buf->attr = attr;
+
+			plan->chunks[plan->chunk_count]        = chunk;
+			plan->chunk_segment[plan->chunk_count] = segment;
+			plan->chunk_count++;
+
+			offset += chunk.size;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Copy the bounced chunks of a plan to the driver buffers
+ */
+static void segments_copy_in(const acc_device_spi_segment_t *segments, segment_plan_t *plan)
+{
+	for (size_t i = 0; i < plan->chunk_count; i++)
+	{
+		if (!plan->chunks[i].direct)
+		{
+			memcpy(plan->bufs[i].data, segments[plan->chunk_segment[i]].buffer + plan->chunks[i].offset, plan->chunks[i].size);
+		}
+	}
+}
+
+
+/**
+ * @brief Copy the bounced chunks of a plan back from the driver buffers
+ */
+static void segments_copy_out(spi_bus_state_t *state, const acc_device_spi_segment_t *segments, const segment_plan_t *plan)
+{
+	for (size_t i = 0; i < plan->chunk_count; i++)
+	{
+		if (plan->chunks[i].direct)
+		{
+			state->statistics.direct_bytes += plan->chunks[i].size;
+		}
+		else
+		{
+			memcpy(segments[plan->chunk_segment[i]].buffer + plan->chunks[i].offset, plan->bufs[i].data, plan->chunks[i].size);
+			state->statistics.bounced_bytes += plan->chunks[i].size;
+		}
+	}
+}
+
+
+/**
+ * @brief Transfer a plan with one call to spid_transfer and wait for it
+ *
+ * The SPI driver programs all chunks as one DMA linked list, so the transfer
+ * completes with a single interrupt.
+ */
+static bool segments_transfer(acc_driver_spi_same70_handle_t *handle,
+                              acc_device_handle_t            dev_handle,
+                              const acc_device_spi_segment_t *segments,
+                              segment_plan_t                 *plan)
+{
+	spi_bus_state_t *state = handle->state;
+
+	struct _callback callback = {
+		.method = spi_transfer_complete_callback,
+		.arg = dev_handle
+	};
+
+	segments_copy_in(segments, plan);
+
+	// Release CS after last transfer
+	plan->bufs[plan->chunk_count - 1].attr |= BUS_SPI_BUF_ATTR_RELEASE_CS;
+
+	uint32_t start_time = acc_os_get_time();
+
+	state->spi_desc.chip_select = handle->device;
+
+	if (spid_transfer(&state->spi_desc, plan->bufs, plan->chunk_count, &callback) != 0)
+	{
+		return false;
+	}
+
+	chunk_wait(handle, dev_handle);
+
+	segments_copy_out(state, segments, plan);
+
+	state->statistics.transfer_count++;
+	state->statistics.transfer_time_ms += acc_os_get_time() - start_time;
+	acc_device_spi_telemetry_chunks_record(handle->bus, 1);
+
+	return true;
+}
+
+
 static bool acc_driver_spi_same70_transfer(
 	acc_device_handle_t dev_handle,
 	uint8_t             *buffer,
@@ -175,6 +585,7 @@ static bool acc_driver_spi_same70_transfer(
 {
 	Spi          *spi;
 	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)dev_handle;
+	spi_bus_state_t                *state  = handle->state;
 
 	/* Prevent low power mode until DMA transfer is completed */
 	acc_device_pm_wake_lock();
@@ -191,69 +602,263 @@ static bool acc_driver_spi_same70_transfer(
 		return false;
 	}
 
-	size_t transferred = 0;
-	while (transferred < buffer_size)
+	if (buffer_size == 0)
 	{
-		uint32_t chunk_size = MIN(handle->buffer_size, buffer_size - transferred);
-		// We need to copy the data to cache line aligned memory so that we
-		// don't invalidate data outside the buffer
-		memcpy(handle->buffer, buffer + transferred, chunk_size);
-		struct _buffer buf = {
-			.data = handle->buffer,
-			.size = chunk_size,
-			.attr = BUS_BUF_ATTR_RX | BUS_BUF_ATTR_TX,
-		};
-
-		if (transferred + chunk_size == buffer_size)
+		acc_device_pm_wake_unlock();
+		return true;
+	}
+
+	acc_driver_spi_chunk_limits_t limits = {
+		.bounce_buffer_size = state->buffer_size,
+		.alignment          = L1_CACHE_BYTES,
+		.direct_max_size    = state->zero_copy ? DIRECT_CHUNK_MAX_SIZE : 0,
+	};
+
+	acc_device_spi_segment_t segment = {
+		.buffer      = buffer,
+		.buffer_size = buffer_size,
+	};
+	segment_plan_t           plan;
+
+	limits.bounce_buffer_size = SPI_BUFFER_COUNT * state->buffer_size;
+
+	// A transfer that fits in one DMA linked list, typically a misaligned head,
+	// the cache lines in between and a misaligned tail, is programmed at once and
+	// completes with one interrupt
+	if (segments_plan(state, &segment, 1, &limits, BUS_BUF_ATTR_RX | BUS_BUF_ATTR_TX, &plan))
+	{
+		bool status = segments_transfer(handle, dev_handle, &segment, &plan);
+
+		acc_device_pm_wake_unlock();
+		return status;
+	}
+
+	limits.bounce_buffer_size = state->buffer_size;
+
+	uint32_t        start_time = acc_os_get_time();
+	transfer_slot_t slots[SPI_BUFFER_COUNT];
+	uint_fast8_t    current     = 0;
+	uint32_t        chunk_count = 1;
+
+	// Devices on the same bus share the SPI peripheral, the caller holds the bus lock
+	state->spi_desc.chip_select = handle->device;
+
+	chunk_prepare(handle, buffer, buffer_size, 0, &limits, &slots[current], state->buffer[current]);
+
+	if (!chunk_start(handle, dev_handle, &slots[current], spi_transfer_complete_callback))
+	{
+		acc_device_pm_wake_unlock();
+		return false;
+	}
+
+	// The next chunk is copied in while the current chunk is transferred and the
+	// current chunk is copied out while the next chunk is transferred. CS is kept
+	// asserted until the last chunk has been transferred.
+	while (true)
+	{
+		uint_fast8_t next        = current ^ 1;
+		size_t       next_offset = slots[current].chunk.offset + slots[current].chunk.size;
+		bool         last        = next_offset == buffer_size;
+
+		if (!last)
 		{
-			// Release CS after last transfer
-			buf.attr |= BUS_SPI_BUF_ATTR_RELEASE_CS;
+			chunk_prepare(handle, buffer, buffer_size, next_offset, &limits, &slots[next], state->buffer[next]);
 		}
 
-		struct _callback callback = {
-			.method = spi_transfer_complete_callback,
-			.arg = dev_handle
-		};
+		chunk_wait(handle, dev_handle);
 
-		int err = spid_transfer(&handle->spi_desc, &buf, 1, &callback);
-		if (err)
+		if (!last)
 		{
-			acc_device_pm_wake_unlock();
-			return false;
+			if (!chunk_start(handle, dev_handle, &slots[next], spi_transfer_complete_callback))
+			{
+				acc_device_pm_wake_unlock();
+				return false;
+			}
+
+			chunk_count++;
 		}
 
-		if (wait_for_transfer_complete_func)
+		chunk_finish(buffer, &slots[current]);
+
+		if (last)
 		{
-			wait_for_transfer_complete_func(dev_handle);
+			break;
 		}
-		spid_wait_transfer(&handle->spi_desc);
 
-		// Copy back the data to the buffer
-		memcpy(buffer + transferred, handle->buffer, chunk_size);
-
-		transferred += chunk_size;
+		current = next;
 	}
 
+	state->statistics.transfer_count++;
+	state->statistics.transfer_time_ms += acc_os_get_time() - start_time;
+	acc_device_spi_telemetry_chunks_record(handle->bus, chunk_count);
+
 	acc_device_pm_wake_unlock();
 
 	return true;
 }
 
 
+static bool acc_driver_spi_same70_transfer_segments(
+	acc_device_handle_t            dev_handle,
+	const acc_device_spi_segment_t *segments,
+	size_t                         segment_count)
+{
+	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)dev_handle;
+	spi_bus_state_t                *state  = handle->state;
+	segment_plan_t                 plan;
+
+	if ((handle->device >= SPI_DEVICE_MAX) || segment_count == 0)
+	{
+		return false;
+	}
+
+	acc_driver_spi_chunk_limits_t limits = {
+		.bounce_buffer_size = SPI_BUFFER_COUNT * state->buffer_size,
+		.alignment          = L1_CACHE_BYTES,
+		.direct_max_size    = state->zero_copy ? DIRECT_CHUNK_MAX_SIZE : 0,
+	};
+
+	if (!segments_plan(state, segments, segment_count, &limits, BUS_BUF_ATTR_RX | BUS_BUF_ATTR_TX, &plan))
+	{
+		ACC_LOG_ERROR("SPI segments do not fit in one DMA linked list");
+		return false;
+	}
+
+	if (plan.chunk_count == 0)
+	{
+		return true;
+	}
+
+	/* Prevent low power mode until DMA transfer is completed */
+	acc_device_pm_wake_lock();
+
+	bool status = segments_transfer(handle, dev_handle, segments, &plan);
+
+	acc_device_pm_wake_unlock();
+
+	return status;
+}
+
+
+static void async_chunk_prepare(acc_driver_spi_same70_handle_t      *handle,
+                                size_t                              offset,
+                                const acc_driver_spi_chunk_limits_t *limits,
+                                uint_fast8_t                        index)
+{
+	spi_bus_state_t *state = handle->state;
+	transfer_slot_t *slot  = &state->async_slots[index];
+
+	chunk_prepare(handle, state->async_user_buffer, state->async_buffer_size, offset, limits, slot, state->buffer[index]);
+
+	if (!state->async_rx)
+	{
+		slot->buf.attr &= ~BUS_BUF_ATTR_RX;
+	}
+
+	if (!state->async_tx)
+	{
+		slot->buf.attr &= ~BUS_BUF_ATTR_TX;
+	}
+
+	if (!handle->master)
+	{
+		// A slave can't control chip select
+		slot->buf.attr &= ~BUS_SPI_BUF_ATTR_RELEASE_CS;
+	}
+}
+
+
+static void async_chunk_limits(acc_driver_spi_same70_handle_t *handle, acc_driver_spi_chunk_limits_t *limits)
+{
+	spi_bus_state_t *state = handle->state;
+
+	limits->bounce_buffer_size = state->buffer_size;
+
+	if (!state->async_rx)
+	{
+		// Nothing is invalidated when only transmitting, the whole buffer is used in place
+		limits->alignment       = 1;
+		limits->direct_max_size = DMA_MAX_BT_SIZE;
+	}
+	else
+	{
+		limits->alignment       = L1_CACHE_BYTES;
+		limits->direct_max_size = state->zero_copy && handle->master ? DIRECT_CHUNK_MAX_SIZE : 0;
+	}
+}
+
+
+/**
+ * @brief Called from interrupt context when a chunk of an asynchronous transfer is done
+ *
+ * The next chunk is started before the completed chunk is copied back, the callback
+ * of the caller is called when the last chunk is done.
+ */
 static int spi_transfer_async_callback(void *arg1, void *arg2)
 {
 	acc_device_handle_t dev_handle = (acc_device_handle_t)arg1;
 	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)dev_handle;
+	spi_bus_state_t                *state  = handle->state;
+	acc_device_spi_transfer_status_t status = (acc_device_spi_transfer_status_t)(uintptr_t)arg2;
+	uint_fast8_t                   current = state->async_current;
+	const transfer_slot_t          *slot   = &state->async_slots[current];
+	size_t                         next_offset = slot->chunk.offset + slot->chunk.size;
+	bool                           started = false;
+
+	if (status == ACC_DEVICE_SPI_TRANSFER_STATUS_OK && next_offset < state->async_buffer_size)
+	{
+		acc_driver_spi_chunk_limits_t limits;
+		uint_fast8_t                  next = current ^ 1;
+
+		async_chunk_limits(handle, &limits);
+		async_chunk_prepare(handle, next_offset, &limits, next);
 
-	if (handle->async_rx)
+		started = chunk_start(handle, dev_handle, &state->async_slots[next], spi_transfer_async_callback);
+		if (started)
+		{
+			state->async_current = next;
+		}
+		else
+		{
+			status = ACC_DEVICE_SPI_TRANSFER_STATUS_ABORTED;
+		}
+	}
+
+	if (state->async_rx)
 	{
 		// Copy back data from the cache aligned buffer
-		memcpy(handle->async_user_buffer, handle->buffer, handle->async_buf.size);
+		chunk_finish(state->async_user_buffer, slot);
 	}
 
-	if (handle->async_transfer_cb)
+	if (started)
 	{
-		handle->async_transfer_cb(dev_handle, (acc_device_spi_transfer_status_t)arg2);
+		return 0;
+	}
+
+	if (state->async_transfer_cb)
+	{
+		state->async_transfer_cb(dev_handle, status);
+	}
+	return 0;
+}
+
+
+/**
+ * @brief Called from interrupt context when an asynchronous transfer programmed as one linked list is done
+ */
+static int spi_transfer_async_linked_callback(void *arg1, void *arg2)
+{
+	acc_device_handle_t              dev_handle = (acc_device_handle_t)arg1;
+	acc_driver_spi_same70_handle_t   *handle    = (acc_driver_spi_same70_handle_t *)dev_handle;
+	spi_bus_state_t                  *state     = handle->state;
+	acc_device_spi_transfer_status_t status     = (acc_device_spi_transfer_status_t)(uintptr_t)arg2;
+
+	// Copy back data from the cache aligned buffers
+	segments_copy_out(state, &state->async_segment, &state->async_plan);
+
+	if (state->async_transfer_cb)
+	{
+		state->async_transfer_cb(dev_handle, status);
 	}
 	return 0;
 }
@@ -268,10 +873,10 @@ static bool acc_driver_spi_same70_transfer_async(
 	acc_device_spi_transfer_callback_t callback)
 {
 	Spi          *spi;
-	struct _callback transfer_callback = {NULL,};
 	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)dev_handle;
+	spi_bus_state_t                *state  = handle->state;
 
-	if ((handle->device >= SPI_DEVICE_MAX))
+	if ((handle->device >= SPI_DEVICE_MAX) || buffer_size == 0)
 	{
 		return false;
 	}
@@ -281,50 +886,153 @@ static bool acc_driver_spi_same70_transfer_async(
 		return false;
 	}
 
-	handle->async_rx = rx;
-	if (rx)
+	if (!handle->master && rx && buffer_size > state->buffer_size)
 	{
-		// If we receive data, caches will be invalidated by the driver
-		// so we must copy to a cache line aligned buffer in order
-		// to prevent possible data loss of surrounding data.
-		assert(handle->buffer_size >= buffer_size);
-		memcpy(handle->buffer, buffer, buffer_size);
-		handle->async_buf.data = handle->buffer;
-		handle->async_user_buffer = buffer;
+		// The transfer of a slave ends when the master releases chip select,
+		// so it can't be split into chunks
+		ACC_LOG_ERROR("SPI slave transfer larger than the driver buffer");
+		return false;
 	}
-	else
+
+	state->async_user_buffer = buffer;
+	state->async_buffer_size = buffer_size;
+	state->async_rx          = rx;
+	state->async_tx          = tx;
+	state->async_current     = 0;
+	state->async_transfer_cb = callback;
+
+	acc_driver_spi_chunk_limits_t limits;
+
+	async_chunk_limits(handle, &limits);
+
+	if (handle->master)
 	{
-		handle->async_buf.data = buffer;
-		handle->async_user_buffer = NULL;
+		uint32_t attr = (rx ? BUS_BUF_ATTR_RX : 0) | (tx ? BUS_BUF_ATTR_TX : 0);
+
+		state->async_segment.buffer      = buffer;
+		state->async_segment.buffer_size = buffer_size;
+		limits.bounce_buffer_size        = SPI_BUFFER_COUNT * state->buffer_size;
+
+		// One DMA linked list and one completion interrupt for the whole transfer when it fits
+		if (segments_plan(state, &state->async_segment, 1, &limits, attr, &state->async_plan))
+		{
+			struct _callback linked_callback = {
+				.method = spi_transfer_async_linked_callback,
+				.arg = dev_handle
+			};
+
+			segments_copy_in(&state->async_segment, &state->async_plan);
+
+			// Release CS after last transfer
+			state->async_plan.bufs[state->async_plan.chunk_count - 1].attr |= BUS_SPI_BUF_ATTR_RELEASE_CS;
+			state->spi_desc.chip_select = handle->device;
+
+			return spid_transfer(&state->spi_desc, state->async_plan.bufs, state->async_plan.chunk_count, &linked_callback) == 0;
+		}
+
+		limits.bounce_buffer_size = state->buffer_size;
 	}
 
-	handle->async_buf.size = buffer_size;
-	handle->async_buf.attr = 0;
-	if (rx)
+	// If we receive data, caches will be invalidated by the driver so data that
+	// is not whole cache lines of the buffer goes through the driver buffer in
+	// order to prevent possible data loss of surrounding data. Chunks after the
+	// first one are prepared from the completion callback.
+	async_chunk_prepare(handle, 0, &limits, 0);
+
+	state->spi_desc.chip_select = handle->device;
+
+	return chunk_start(handle, dev_handle, &state->async_slots[0], spi_transfer_async_callback);
+}
+
+
+static bool acc_driver_spi_same70_transfer_abort(acc_device_handle_t dev_handle)
+{
+	acc_driver_spi_same70_handle_t *handle = (acc_driver_spi_same70_handle_t *)dev_handle;
+
+	return spid_abort_transfer(&handle->state->spi_desc);
+}
+
+
+bool acc_driver_spi_same70_buffer_size_set(acc_device_handle_t dev_handle, size_t buffer_size)
+{
+	acc_driver_spi_same70_handle_t *handle = dev_handle;
+	spi_bus_state_t                *state  = handle->state;
+	uint8_t                        *buffer = state->buffer_unaligned;
+
+	// Allocate the new buffer before the old one is released so that the bus
+	// keeps a working buffer if the allocation fails
+	state->buffer_unaligned = NULL;
+
+	if (!bus_buffer_allocate(state, buffer_size))
 	{
-		handle->async_buf.attr |= BUS_BUF_ATTR_RX;
+		state->buffer_unaligned = buffer;
+		return false;
 	}
 
-	if (tx)
+#if ACC_TCM_ENABLED
+	if (buffer == tcm_buffer)
 	{
-		handle->async_buf.attr |= BUS_BUF_ATTR_TX;
+		// The static DTCM buffer is never freed, it is only released when the new buffer is on the heap
+		if (state->buffer_unaligned != tcm_buffer)
+		{
+			tcm_buffer_owner = NULL;
+		}
+
+		return true;
 	}
-	handle->async_transfer_cb = callback;
+#endif
 
-	if (handle->master)
+	acc_os_mem_free(buffer);
+
+	return true;
+}
+
+
+static size_t acc_driver_spi_same70_get_max_transfer_size(void)
+{
+	size_t max_transfer_size = SIZE_MAX;
+
+	for (uint_fast8_t bus = 0; bus < SPI_BUS_MAX; bus++)
 	{
-		handle->async_buf.attr |= BUS_SPI_BUF_ATTR_RELEASE_CS;
+		spi_bus_state_t *state = &bus_states[bus];
+
+		if (state->device_count == 0 || !state->master)
+		{
+			continue;
+		}
+
+		// Report the largest size that is guaranteed to go in one DMA linked list
+		// whatever the alignment of the buffer. Without zero copy, all data goes
+		// through the driver buffer. With zero copy, only the misaligned head and
+		// tail do, each less than a cache line, which always fits since the driver
+		// buffer is at least one cache line. The rest is one direct chunk of at
+		// most DIRECT_CHUNK_MAX_SIZE. Larger transfers are split by the driver.
+		size_t bus_max_transfer_size = state->zero_copy ? DIRECT_CHUNK_MAX_SIZE : state->buffer_size;
+
+		max_transfer_size = MIN(max_transfer_size, bus_max_transfer_size);
 	}
 
-	callback_set(&transfer_callback, (callback_method_t)spi_transfer_async_callback, dev_handle);
+	return max_transfer_size;
+}
+
 
-	int err = spid_transfer(&handle->spi_desc, &handle->async_buf, 1, &transfer_callback);
-	if (err)
+void acc_driver_spi_same70_statistics_get(acc_device_handle_t dev_handle, acc_driver_spi_same70_statistics_t *statistics, bool reset)
+{
+	acc_driver_spi_same70_handle_t *handle = dev_handle;
+	spi_bus_state_t                *state  = handle->state;
+
+	// The byte counters are 64 bits and are also updated by the asynchronous
+	// transfer callbacks, which run in the DMA interrupt
+	irq_disable(ID_XDMAC0);
+
+	*statistics = state->statistics;
+
+	if (reset)
 	{
-		return false;
+		memset(&state->statistics, 0, sizeof(state->statistics));
 	}
 
-	return true;
+	irq_enable(ID_XDMAC0);
 }
 
 
@@ -339,10 +1047,13 @@ static uint8_t acc_driver_spi_same70_get_bus(acc_device_handle_t dev_handle)
 extern void acc_driver_spi_same70_register(wait_for_transfer_complete_t wait_function,
                                            transfer_complete_callback_t transfer_complete)
 {
+	acc_device_spi_get_max_transfer_size_func   = acc_driver_spi_same70_get_max_transfer_size;
 	acc_device_spi_create_func                  = acc_driver_spi_same70_create;
 	acc_device_spi_destroy_func                 = acc_driver_spi_same70_destroy;
 	acc_device_spi_transfer_func                = acc_driver_spi_same70_transfer;
 	acc_device_spi_transfer_async_func          = acc_driver_spi_same70_transfer_async;
+	acc_device_spi_transfer_segments_func       = acc_driver_spi_same70_transfer_segments;
+	acc_device_spi_transfer_abort_func          = acc_driver_spi_same70_transfer_abort;
 	acc_device_spi_get_bus_func                 = acc_driver_spi_same70_get_bus;
 
 	wait_for_transfer_complete_func             = wait_function;
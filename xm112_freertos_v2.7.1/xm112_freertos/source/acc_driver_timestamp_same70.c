@@ -0,0 +1,132 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acc_driver_timestamp_same70.h"
+#include "acc_device_spi.h"
+#include "acc_driver_os.h"
+#include "acc_log.h"
+
+#include "board.h"
+#include "pmc.h"
+#include "tc.h"
+
+
+/**
+ * @brief The module name
+ */
+#define MODULE "driver_timestamp_same70"
+
+/**
+ * @brief Timer counter block, channel 0 counts microseconds and clocks channel 1 which clocks channel 2
+ */
+#define TIMESTAMP_TC TC3
+
+/**
+ * @brief Programmable clock used as TIMER_CLOCK1 by the timer counters
+ */
+#define TIMESTAMP_PCK 6
+
+#define COUNTER_FREQUENCY 1000000U
+
+#define PCK_PRESCALER_MAX 256U
+
+#define CHANNEL_COUNTER_MASK 0xffffU
+
+
+static uint64_t start_time;
+
+
+/**
+ * @brief Read the 48 bit counter, the channels are read until no carry happens during the read
+ *
+ * The low channel is read again after the check of the other channels. If it
+ * wrapped after the first read, the carry may not have reached the middle
+ * channel in time for the check, and the read is retried.
+ */
+static uint64_t counter_read(void)
+{
+	TcChannel *channels = TIMESTAMP_TC->TC_CHANNEL;
+	uint32_t  high;
+	uint32_t  middle;
+	uint32_t  low;
+
+	do
+	{
+		high   = channels[2].TC_CV;
+		middle = channels[1].TC_CV;
+		low    = channels[0].TC_CV;
+	} while (channels[1].TC_CV != middle || channels[2].TC_CV != high ||
+	         (channels[0].TC_CV & CHANNEL_COUNTER_MASK) < (low & CHANNEL_COUNTER_MASK));
+
+	return ((uint64_t)(high & CHANNEL_COUNTER_MASK) << 32) | ((uint64_t)(middle & CHANNEL_COUNTER_MASK) << 16) |
+	       (low & CHANNEL_COUNTER_MASK);
+}
+
+
+static uint64_t acc_driver_timestamp_same70_get_time_us(void)
+{
+	return counter_read() - start_time;
+}
+
+
+static uint32_t acc_driver_timestamp_same70_get_time_us_32(void)
+{
+	return (uint32_t)acc_driver_timestamp_same70_get_time_us();
+}
+
+
+bool acc_driver_timestamp_same70_register(void)
+{
+	uint32_t main_clock = pmc_get_main_clock();
+
+	if (main_clock == 0 || main_clock % COUNTER_FREQUENCY != 0 || main_clock / COUNTER_FREQUENCY > PCK_PRESCALER_MAX)
+	{
+		ACC_LOG_ERROR("Main clock %u Hz can not be divided to %u Hz", (unsigned int)main_clock,
+		              (unsigned int)COUNTER_FREQUENCY);
+		return false;
+	}
+
+	pmc_configure_pck(TIMESTAMP_PCK, PMC_PCK_CSS_MAIN_CLK, main_clock / COUNTER_FREQUENCY - 1U);
+	pmc_enable_pck(TIMESTAMP_PCK);
+
+	pmc_configure_peripheral(ID_TC3_CH0, NULL, true);
+	pmc_configure_peripheral(ID_TC3_CH1, NULL, true);
+	pmc_configure_peripheral(ID_TC3_CH2, NULL, true);
+
+	/*
+	 * Channel 0 and 1 count up to 0xffff and wrap. TIOA is set on RA compare
+	 * when the counter wraps to 0 and cleared on RC compare halfway, so the
+	 * rising edge of TIOA is the carry into the next channel.
+	 */
+	uint32_t carry_mode = TC_CMR_WAVE | TC_CMR_WAVSEL_UP | TC_CMR_ACPA_SET | TC_CMR_ACPC_CLEAR;
+
+	TIMESTAMP_TC->TC_BMR = TC_BMR_TC1XC1S_TIOA0 | TC_BMR_TC2XC2S_TIOA1;
+
+	tc_configure(TIMESTAMP_TC, 0, TC_CMR_TCCLKS_TIMER_CLOCK1 | carry_mode);
+	tc_configure(TIMESTAMP_TC, 1, TC_CMR_TCCLKS_XC1 | carry_mode);
+	tc_configure(TIMESTAMP_TC, 2, TC_CMR_TCCLKS_XC2);
+
+	for (uint32_t channel = 0; channel < 2; channel++)
+	{
+		TIMESTAMP_TC->TC_CHANNEL[channel].TC_RA = 0;
+		TIMESTAMP_TC->TC_CHANNEL[channel].TC_RC = (CHANNEL_COUNTER_MASK + 1U) / 2U;
+	}
+
+	tc_start(TIMESTAMP_TC, 2);
+	tc_start(TIMESTAMP_TC, 1);
+	tc_start(TIMESTAMP_TC, 0);
+
+	// A carry may be counted when the channels start, the time starts at 0 from here
+	start_time = counter_read();
+
+	acc_device_os_get_time_us_func            = acc_driver_timestamp_same70_get_time_us;
+	acc_device_spi_telemetry_get_time_us_func = acc_driver_timestamp_same70_get_time_us_32;
+
+	return true;
+}
@@ -36,6 +36,7 @@ typedef struct {
 	Uart *uart;
 	const struct _pin *uart_pins;
 	acc_device_uart_read_func_t *isr_read_callback;
+	acc_device_uart_rx_event_func_t *rx_event_callback;
 	struct _uart_desc uart_config;
 	int32_t error_count;
 	uint8_t *read_buffer;
@@ -52,6 +53,7 @@ static acc_uart_description uarts[] = {
 				.uart = UART0,
 				.uart_pins = uart0_pins,
 				.isr_read_callback = NULL,
+				.rx_event_callback = NULL,
 				.uart_config = {0},
 				.error_count = 0,
 				.read_buffer = NULL,
@@ -60,6 +62,7 @@ static acc_uart_description uarts[] = {
 				.uart = UART1,
 				.uart_pins = uart1_pins,
 				.isr_read_callback = NULL,
+				.rx_event_callback = NULL,
 				.uart_config = {0},
 				.error_count = 0,
 				.read_buffer = NULL,
@@ -68,6 +71,7 @@ static acc_uart_description uarts[] = {
 				.uart = UART2,
 				.uart_pins = uart2_pins,
 				.isr_read_callback = NULL,
+				.rx_event_callback = NULL,
 				.uart_config = {0},
 				.error_count = 0,
 				.read_buffer = NULL,
@@ -76,6 +80,7 @@ static acc_uart_description uarts[] = {
 				.uart = UART3,
 				.uart_pins = uart3_pins,
 				.isr_read_callback = NULL,
+				.rx_event_callback = NULL,
 				.uart_config = {0},
 				.error_count = 0,
 				.read_buffer = NULL,
@@ -84,6 +89,7 @@ static acc_uart_description uarts[] = {
 				.uart = UART4,
 				.uart_pins = uart4_pins,
 				.isr_read_callback = NULL,
+				.rx_event_callback = NULL,
 				.uart_config = {0},
 				.error_count = 0,
 				.read_buffer = NULL,
@@ -123,6 +129,19 @@ static int uart_rx_callback(void *arg1, void *arg2)
 }
 
 
+static int uart_rx_event_callback(void *arg1, void *arg2)
+{
+	(void)arg2;
+	uint_fast8_t port = (uint_fast8_t)arg1;
+
+	if (uarts[port].rx_event_callback != NULL)
+	{
+		uarts[port].rx_event_callback(port);
+	}
+	return 0;
+}
+
+
 /**
  * @brief Initialize UART
  *
@@ -255,6 +274,81 @@ static void acc_driver_uart_same70_register_read_callback(uint_fast8_t port, acc
 }
 
 
+static bool acc_driver_uart_same70_block_read_start(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event)
+{
+	if (port >= UART_IFACE_COUNT || event == NULL || uarts[port].read_buffer != NULL)
+	{
+		return false;
+	}
+
+	// The whole buffer is invalidated on every read, it must not share cache lines with other data
+	buffer_size = (buffer_size + L1_CACHE_BYTES - 1) & ~(L1_CACHE_BYTES - 1);
+
+	uint8_t *buffer = acc_os_mem_alloc(buffer_size + L1_CACHE_BYTES);
+	if (buffer == NULL)
+	{
+		return false;
+	}
+
+	uarts[port].read_buffer = (void *)(((uintptr_t)buffer + L1_CACHE_BYTES - 1) & ~(L1_CACHE_BYTES - 1));
+
+	struct _buffer buf = {
+		.data = uarts[port].read_buffer,
+		.size = buffer_size,
+		.attr = UARTD_BUF_ATTR_READ,
+	};
+
+	struct _callback callback = {
+		.method = uart_rx_event_callback,
+		.arg = (void*)(uintptr_t)port
+	};
+
+	uarts[port].rx_event_callback         = event;
+	uarts[port].uart_config.rx_block_mode = true;
+
+	uint32_t result = uartd_transfer(port, &buf, &callback);
+	if (result != UARTD_SUCCESS)
+	{
+		ACC_LOG_ERROR("Failed to start block read on UART %u", (unsigned int)port);
+		uarts[port].uart_config.rx_block_mode = false;
+		uarts[port].rx_event_callback         = NULL;
+		uarts[port].read_buffer               = NULL;
+		acc_os_mem_free(buffer);
+		return false;
+	}
+
+	return true;
+}
+
+
+static size_t acc_driver_uart_same70_block_read(uint_fast8_t port, uint8_t *data, size_t max_length)
+{
+	size_t length = uartd_dma_rx_read(port, data, max_length);
+
+	if (length == 0)
+	{
+		// The line is idle, take an interrupt on the next byte. Read again in case
+		// a byte arrived before the interrupt was enabled.
+		uartd_dma_rx_enable_notify(port);
+		length = uartd_dma_rx_read(port, data, max_length);
+	}
+
+	return length;
+}
+
+
+static uint32_t acc_driver_uart_same70_get_max_baudrate(uint_fast8_t port)
+{
+	if (port >= UART_IFACE_COUNT)
+	{
+		return 0;
+	}
+
+	// The UART only has 16 times oversampling, BRGR holds the divisor
+	return pmc_get_peripheral_clock(get_uart_id_from_addr(uarts[port].uart)) / 16;
+}
+
+
 static int32_t acc_driver_uart_same70_get_error_count(uint_fast8_t port)
 {
 	return uarts[port].error_count;
@@ -284,6 +378,9 @@ extern void acc_driver_uart_same70_register(uart_wait_for_transfer_complete_t wa
 	acc_device_uart_register_read_func	= acc_driver_uart_same70_register_read_callback;
 	acc_device_uart_get_error_count_func = acc_driver_uart_same70_get_error_count;
 	acc_device_uart_deinit_func          = acc_driver_uart_same70_deinit;
+	acc_device_uart_block_read_start_func = acc_driver_uart_same70_block_read_start;
+	acc_device_uart_block_read_func      = acc_driver_uart_same70_block_read;
+	acc_device_uart_get_max_baudrate_func = acc_driver_uart_same70_get_max_baudrate;
 
 	wait_for_transfer_complete_func = wait_function;
 	transfer_complete_func = transfer_complete;
@@ -0,0 +1,1125 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_driver_usb_cdc_same70.h"
+
+#include "acc_device_os.h"
+#include "acc_device_pm.h"
+#include "acc_log.h"
+
+#include "barriers.h"
+#include "chip.h"
+#include "irq/irq.h"
+#include "mm/cache.h"
+#include "usb/device/usbd_hal.h"
+
+
+/**
+ * @brief The module name
+ */
+#define MODULE "driver_usb_cdc_same70"
+
+/**
+ * @brief Vendor and product id of the Atmel CDC serial example, handled by the standard CDC ACM drivers
+ */
+#define USB_VENDOR_ID  0x03EBU
+#define USB_PRODUCT_ID 0x6119U
+#define USB_RELEASE    0x0100U
+
+#define EP_CONTROL  0U
+#define EP_DATA_IN  1U
+#define EP_DATA_OUT 2U
+#define EP_NOTIFY   3U
+
+#define CONTROL_PACKET_SIZE   64U
+#define BULK_PACKET_SIZE_HS   512U
+#define BULK_PACKET_SIZE_FS   64U
+#define NOTIFY_PACKET_SIZE    16U
+/** 16 ms at full speed (ms) and high speed (2^(n-1) * 125 us) */
+#define NOTIFY_INTERVAL_FS    16U
+#define NOTIFY_INTERVAL_HS    8U
+
+#define CONFIGURATION_VALUE 1U
+
+#define STRING_LANGUAGE     0U
+#define STRING_MANUFACTURER 1U
+#define STRING_PRODUCT      2U
+
+#define CDC_CLASS_COMMUNICATION      0x02U
+#define CDC_CLASS_DATA               0x0AU
+#define CDC_SUBCLASS_ACM             0x02U
+#define CDC_PROTOCOL_AT              0x01U
+#define CDC_DESCRIPTOR_CS_INTERFACE  0x24U
+#define CDC_SUBTYPE_HEADER           0x00U
+#define CDC_SUBTYPE_CALL_MANAGEMENT  0x01U
+#define CDC_SUBTYPE_ACM              0x02U
+#define CDC_SUBTYPE_UNION            0x06U
+
+#define CDC_REQUEST_SET_LINE_CODING        0x20U
+#define CDC_REQUEST_GET_LINE_CODING        0x21U
+#define CDC_REQUEST_SET_CONTROL_LINE_STATE 0x22U
+#define CDC_REQUEST_SEND_BREAK             0x23U
+
+#define CDC_CONTROL_LINE_DTR 0x01U
+
+#define WRITE_TIMEOUT_MS 1000U
+
+/**
+ * @brief A read is only started when a whole buffer fits, the host is held off meanwhile
+ */
+#define READ_PACKET_BUFFER_SIZE BULK_PACKET_SIZE_HS
+
+
+typedef struct __attribute__((packed))
+{
+	uint8_t  bFunctionLength;
+	uint8_t  bDescriptorType;
+	uint8_t  bDescriptorSubtype;
+	uint16_t bcdCDC;
+} cdc_header_descriptor_t;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t bFunctionLength;
+	uint8_t bDescriptorType;
+	uint8_t bDescriptorSubtype;
+	uint8_t bmCapabilities;
+	uint8_t bDataInterface;
+} cdc_call_management_descriptor_t;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t bFunctionLength;
+	uint8_t bDescriptorType;
+	uint8_t bDescriptorSubtype;
+	uint8_t bmCapabilities;
+} cdc_acm_descriptor_t;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t bFunctionLength;
+	uint8_t bDescriptorType;
+	uint8_t bDescriptorSubtype;
+	uint8_t bMasterInterface;
+	uint8_t bSlaveInterface;
+} cdc_union_descriptor_t;
+
+typedef struct __attribute__((packed))
+{
+	uint32_t dwDTERate;
+	uint8_t  bCharFormat;
+	uint8_t  bParityType;
+	uint8_t  bDataBits;
+} cdc_line_coding_t;
+
+typedef struct __attribute__((packed))
+{
+	USBConfigurationDescriptor       configuration;
+	USBInterfaceDescriptor           communication_interface;
+	cdc_header_descriptor_t          header;
+	cdc_call_management_descriptor_t call_management;
+	cdc_acm_descriptor_t             acm;
+	cdc_union_descriptor_t           union_functional;
+	USBEndpointDescriptor            notify_endpoint;
+	USBInterfaceDescriptor           data_interface;
+	USBEndpointDescriptor            data_out_endpoint;
+	USBEndpointDescriptor            data_in_endpoint;
+} cdc_configuration_descriptors_t;
+
+
+static const USBDeviceDescriptor device_descriptor = {
+	.bLength            = sizeof(USBDeviceDescriptor),
+	.bDescriptorType    = USBGenericDescriptor_DEVICE,
+	.bcdUSB             = 0x0200,
+	.bDeviceClass       = CDC_CLASS_COMMUNICATION,
+	.bDeviceSubClass    = 0,
+	.bDeviceProtocol    = 0,
+	.bMaxPacketSize0    = CONTROL_PACKET_SIZE,
+	.idVendor           = USB_VENDOR_ID,
+	.idProduct          = USB_PRODUCT_ID,
+	.bcdDevice          = USB_RELEASE,
+	.iManufacturer      = STRING_MANUFACTURER,
+	.iProduct           = STRING_PRODUCT,
+	.iSerialNumber      = 0,
+	.bNumConfigurations = 1,
+};
+
+static const USBDeviceQualifierDescriptor device_qualifier_descriptor = {
+	.bLength            = sizeof(USBDeviceQualifierDescriptor),
+	.bDescriptorType    = USBGenericDescriptor_DEVICEQUALIFIER,
+	.bcdUSB             = 0x0200,
+	.bDeviceClass       = CDC_CLASS_COMMUNICATION,
+	.bDeviceSubClass    = 0,
+	.bDeviceProtocol    = 0,
+	.bMaxPacketSize0    = CONTROL_PACKET_SIZE,
+	.bNumConfigurations = 1,
+	.bReserved          = 0,
+};
+
+
+#define CDC_CONFIGURATION_DESCRIPTORS(bulk_packet_size, notify_interval) \
+	{ \
+		.configuration = { \
+			.bLength             = sizeof(USBConfigurationDescriptor), \
+			.bDescriptorType     = USBGenericDescriptor_CONFIGURATION, \
+			.wTotalLength        = sizeof(cdc_configuration_descriptors_t), \
+			.bNumInterfaces      = 2, \
+			.bConfigurationValue = CONFIGURATION_VALUE, \
+			.iConfiguration      = 0, \
+			.bmAttributes        = USBConfigurationDescriptor_BUSPOWERED_NORWAKEUP, \
+			.bMaxPower           = USBConfigurationDescriptor_POWER(100), \
+		}, \
+		.communication_interface = { \
+			.bLength            = sizeof(USBInterfaceDescriptor), \
+			.bDescriptorType    = USBGenericDescriptor_INTERFACE, \
+			.bInterfaceNumber   = 0, \
+			.bAlternateSetting  = 0, \
+			.bNumEndpoints      = 1, \
+			.bInterfaceClass    = CDC_CLASS_COMMUNICATION, \
+			.bInterfaceSubClass = CDC_SUBCLASS_ACM, \
+			.bInterfaceProtocol = CDC_PROTOCOL_AT, \
+			.iInterface         = 0, \
+		}, \
+		.header = { \
+			.bFunctionLength    = sizeof(cdc_header_descriptor_t), \
+			.bDescriptorType    = CDC_DESCRIPTOR_CS_INTERFACE, \
+			.bDescriptorSubtype = CDC_SUBTYPE_HEADER, \
+			.bcdCDC             = 0x0110, \
+		}, \
+		.call_management = { \
+			.bFunctionLength    = sizeof(cdc_call_management_descriptor_t), \
+			.bDescriptorType    = CDC_DESCRIPTOR_CS_INTERFACE, \
+			.bDescriptorSubtype = CDC_SUBTYPE_CALL_MANAGEMENT, \
+			.bmCapabilities     = 0, \
+			.bDataInterface     = 1, \
+		}, \
+		.acm = { \
+			.bFunctionLength    = sizeof(cdc_acm_descriptor_t), \
+			.bDescriptorType    = CDC_DESCRIPTOR_CS_INTERFACE, \
+			.bDescriptorSubtype = CDC_SUBTYPE_ACM, \
+			.bmCapabilities     = 0x02, \
+		}, \
+		.union_functional = { \
+			.bFunctionLength    = sizeof(cdc_union_descriptor_t), \
+			.bDescriptorType    = CDC_DESCRIPTOR_CS_INTERFACE, \
+			.bDescriptorSubtype = CDC_SUBTYPE_UNION, \
+			.bMasterInterface   = 0, \
+			.bSlaveInterface    = 1, \
+		}, \
+		.notify_endpoint = { \
+			.bLength          = sizeof(USBEndpointDescriptor), \
+			.bDescriptorType  = USBGenericDescriptor_ENDPOINT, \
+			.bEndpointAddress = USBEndpointDescriptor_ADDRESS(USBEndpointDescriptor_IN, EP_NOTIFY), \
+			.bmAttributes     = USBEndpointDescriptor_INTERRUPT, \
+			.wMaxPacketSize   = NOTIFY_PACKET_SIZE, \
+			.bInterval        = notify_interval, \
+		}, \
+		.data_interface = { \
+			.bLength            = sizeof(USBInterfaceDescriptor), \
+			.bDescriptorType    = USBGenericDescriptor_INTERFACE, \
+			.bInterfaceNumber   = 1, \
+			.bAlternateSetting  = 0, \
+			.bNumEndpoints      = 2, \
+			.bInterfaceClass    = CDC_CLASS_DATA, \
+			.bInterfaceSubClass = 0, \
+			.bInterfaceProtocol = 0, \
+			.iInterface         = 0, \
+		}, \
+		.data_out_endpoint = { \
+			.bLength          = sizeof(USBEndpointDescriptor), \
+			.bDescriptorType  = USBGenericDescriptor_ENDPOINT, \
+			.bEndpointAddress = USBEndpointDescriptor_ADDRESS(USBEndpointDescriptor_OUT, EP_DATA_OUT), \
+			.bmAttributes     = USBEndpointDescriptor_BULK, \
+			.wMaxPacketSize   = bulk_packet_size, \
+			.bInterval        = 0, \
+		}, \
+		.data_in_endpoint = { \
+			.bLength          = sizeof(USBEndpointDescriptor), \
+			.bDescriptorType  = USBGenericDescriptor_ENDPOINT, \
+			.bEndpointAddress = USBEndpointDescriptor_ADDRESS(USBEndpointDescriptor_IN, EP_DATA_IN), \
+			.bmAttributes     = USBEndpointDescriptor_BULK, \
+			.wMaxPacketSize   = bulk_packet_size, \
+			.bInterval        = 0, \
+		}, \
+	}
+
+static const cdc_configuration_descriptors_t configuration_descriptors_fs =
+	CDC_CONFIGURATION_DESCRIPTORS(BULK_PACKET_SIZE_FS, NOTIFY_INTERVAL_FS);
+
+static const cdc_configuration_descriptors_t configuration_descriptors_hs =
+	CDC_CONFIGURATION_DESCRIPTORS(BULK_PACKET_SIZE_HS, NOTIFY_INTERVAL_HS);
+
+static const uint8_t string_language[] = {4, USBGenericDescriptor_STRING, 0x09, 0x04};
+
+static const char *const strings[] = {
+	[STRING_MANUFACTURER] = "Acconeer",
+	[STRING_PRODUCT]      = "XM112 Virtual COM Port",
+};
+
+
+typedef struct
+{
+	volatile bool      configured;
+	volatile bool      dtr;
+	uint8_t            configuration;
+	uint16_t           bulk_packet_size;
+	cdc_line_coding_t  line_coding;
+
+	// Control transfers, the data must stay valid until the transfer is done
+	uint8_t            control_data[sizeof(cdc_configuration_descriptors_t)];
+	uint8_t            address;
+
+	// Writes
+	acc_app_integration_semaphore_t             write_semaphore;
+	volatile bool                               write_busy;
+	volatile bool                               write_success;
+	bool                                        write_zlp;
+	volatile bool                               write_failure_logging;
+	acc_driver_usb_cdc_same70_write_done_func_t *write_done;
+	void                                        *write_client_reference;
+
+	// Reads, the ring buffer is written in interrupt context and read by the task
+	acc_device_uart_read_func_t     *read_callback;
+	acc_device_uart_rx_event_func_t *read_event;
+	volatile bool                   read_event_enabled;
+	volatile bool                   read_busy;
+	uint8_t                         *read_ring;
+	size_t                          read_ring_size;
+	volatile size_t                 read_head;
+	volatile size_t                 read_tail;
+} usb_cdc_t;
+
+
+/**
+ * @brief The UART driver registered before, it handles all other ports
+ */
+typedef struct
+{
+	bool (*init)(uint_fast8_t port, uint32_t baudrate, acc_device_uart_options_t options);
+	bool (*write)(uint_fast8_t port, const uint8_t *data, size_t length);
+	void (*register_read)(uint_fast8_t port, acc_device_uart_read_func_t *callback);
+	int32_t (*get_error_count)(uint_fast8_t port);
+	void (*deinit)(uint_fast8_t port);
+	bool (*block_read_start)(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event);
+	size_t (*block_read)(uint_fast8_t port, uint8_t *data, size_t max_length);
+	uint32_t (*get_max_baudrate)(uint_fast8_t port);
+} uart_driver_t;
+
+
+static bool          initialized = false;
+static usb_cdc_t     usb_cdc;
+static uart_driver_t uart_driver;
+
+CACHE_ALIGNED static uint8_t read_packet_buffer[READ_PACKET_BUFFER_SIZE];
+
+
+static void read_start(void);
+
+
+static size_t read_ring_free(void)
+{
+	return (usb_cdc.read_tail + usb_cdc.read_ring_size - usb_cdc.read_head - 1U) % usb_cdc.read_ring_size;
+}
+
+
+static void read_done(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
+{
+	(void)arg;
+	(void)remaining;
+
+	usb_cdc.read_busy = false;
+
+	if (status != USBD_STATUS_SUCCESS)
+	{
+		return;
+	}
+
+	if (usb_cdc.read_callback != NULL)
+	{
+		for (uint32_t i = 0; i < transferred; i++)
+		{
+			usb_cdc.read_callback(ACC_DRIVER_USB_CDC_SAME70_PORT, read_packet_buffer[i], 0);
+		}
+	}
+	else if (usb_cdc.read_ring != NULL)
+	{
+		size_t head = usb_cdc.read_head;
+
+		// read_start only reads when the whole packet buffer fits
+		for (uint32_t i = 0; i < transferred; i++)
+		{
+			usb_cdc.read_ring[head] = read_packet_buffer[i];
+			head                    = (head + 1U) % usb_cdc.read_ring_size;
+		}
+
+		dmb();
+		usb_cdc.read_head = head;
+
+		if (usb_cdc.read_event_enabled && transferred > 0)
+		{
+			usb_cdc.read_event_enabled = false;
+			usb_cdc.read_event(ACC_DRIVER_USB_CDC_SAME70_PORT);
+		}
+	}
+
+	read_start();
+}
+
+
+/**
+ * @brief Start a read if configured, not already reading and there is room for the data
+ *
+ * Called in interrupt context or with the USB interrupt disabled.
+ */
+static void read_start(void)
+{
+	if (!usb_cdc.configured || usb_cdc.read_busy)
+	{
+		return;
+	}
+
+	if (usb_cdc.read_callback == NULL && (usb_cdc.read_ring == NULL || read_ring_free() < READ_PACKET_BUFFER_SIZE))
+	{
+		return;
+	}
+
+	usb_cdc.read_busy = true;
+	usbd_hal_set_transfer_callback(EP_DATA_OUT, read_done, NULL);
+
+	if (usbd_hal_read(EP_DATA_OUT, read_packet_buffer, READ_PACKET_BUFFER_SIZE) != USBD_STATUS_SUCCESS)
+	{
+		usb_cdc.read_busy = false;
+	}
+}
+
+
+static void write_finish(bool success)
+{
+	acc_driver_usb_cdc_same70_write_done_func_t *done             = usb_cdc.write_done;
+	void                                        *client_reference = usb_cdc.write_client_reference;
+
+	usb_cdc.write_done = NULL;
+	usb_cdc.write_busy = false;
+
+	if (done != NULL)
+	{
+		done(success, client_reference);
+	}
+}
+
+
+static void write_done(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
+{
+	(void)arg;
+	(void)transferred;
+	(void)remaining;
+
+	// A transfer of whole packets is ended with a zero length packet so that the host read returns
+	if (status == USBD_STATUS_SUCCESS && usb_cdc.write_zlp)
+	{
+		usb_cdc.write_zlp = false;
+
+		if (usbd_hal_write(EP_DATA_IN, NULL, 0) == USBD_STATUS_SUCCESS)
+		{
+			return;
+		}
+	}
+
+	write_finish(status == USBD_STATUS_SUCCESS);
+}
+
+
+static void write_blocking_done(bool success, void *client_reference)
+{
+	(void)client_reference;
+
+	usb_cdc.write_success = success;
+	acc_os_semaphore_signal_from_interrupt(usb_cdc.write_semaphore);
+}
+
+
+static void control_write(const void *data, size_t size, uint16_t max_length);
+
+
+static void control_zlp_done(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
+{
+	(void)arg;
+	(void)transferred;
+	(void)remaining;
+
+	if (status == USBD_STATUS_SUCCESS)
+	{
+		control_write(NULL, 0, 0);
+	}
+}
+
+
+/**
+ * @brief Send the data stage of a control read, or the status stage if size is 0
+ */
+static void control_write(const void *data, size_t size, uint16_t max_length)
+{
+	bool zlp = false;
+
+	if (size > max_length)
+	{
+		size = max_length;
+	}
+	else if (size > 0 && size < max_length && size % CONTROL_PACKET_SIZE == 0)
+	{
+		// The host expects more data, a short packet ends the transfer
+		zlp = true;
+	}
+
+	usbd_hal_set_transfer_callback(EP_CONTROL, zlp ? control_zlp_done : NULL, NULL);
+	usbd_hal_write(EP_CONTROL, data, size);
+}
+
+
+static void control_status(void)
+{
+	control_write(NULL, 0, 0);
+}
+
+
+static void control_stall(void)
+{
+	usbd_hal_stall(EP_CONTROL);
+}
+
+
+static void set_address_done(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
+{
+	(void)arg;
+	(void)transferred;
+	(void)remaining;
+
+	// The new address is used after the status stage
+	if (status == USBD_STATUS_SUCCESS)
+	{
+		usbd_hal_set_address(usb_cdc.address);
+	}
+}
+
+
+static void set_line_coding_done(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
+{
+	(void)arg;
+	(void)remaining;
+
+	if (status == USBD_STATUS_SUCCESS && transferred == sizeof(cdc_line_coding_t))
+	{
+		memcpy(&usb_cdc.line_coding, usb_cdc.control_data, sizeof(cdc_line_coding_t));
+	}
+
+	control_status();
+}
+
+
+static void endpoints_stop(void)
+{
+	usb_cdc.configured = false;
+	usb_cdc.dtr        = false;
+
+	usbd_hal_reset_endpoints((1U << EP_DATA_IN) | (1U << EP_DATA_OUT) | (1U << EP_NOTIFY), USBD_STATUS_RESET, false);
+}
+
+
+static void configuration_set(uint8_t configuration)
+{
+	endpoints_stop();
+	usb_cdc.configuration = configuration;
+
+	if (configuration == CONFIGURATION_VALUE)
+	{
+		const cdc_configuration_descriptors_t *descriptors = usbd_hal_is_high_speed() ?
+		                                                     &configuration_descriptors_hs :
+		                                                     &configuration_descriptors_fs;
+
+		usb_cdc.bulk_packet_size = descriptors->data_in_endpoint.wMaxPacketSize;
+
+		usbd_hal_configure(&descriptors->notify_endpoint);
+		usbd_hal_configure(&descriptors->data_out_endpoint);
+		usbd_hal_configure(&descriptors->data_in_endpoint);
+		usb_cdc.configured = true;
+
+		read_start();
+	}
+
+	usbd_hal_set_configuration(configuration);
+}
+
+
+static void descriptor_get(const USBGenericRequest *request)
+{
+	uint8_t type  = (uint8_t)(request->wValue >> 8);
+	uint8_t index = (uint8_t)request->wValue;
+
+	switch (type)
+	{
+		case USBGenericDescriptor_DEVICE:
+			control_write(&device_descriptor, sizeof(device_descriptor), request->wLength);
+			break;
+		case USBGenericDescriptor_DEVICEQUALIFIER:
+			control_write(&device_qualifier_descriptor, sizeof(device_qualifier_descriptor), request->wLength);
+			break;
+		case USBGenericDescriptor_CONFIGURATION:
+			control_write(usbd_hal_is_high_speed() ? &configuration_descriptors_hs : &configuration_descriptors_fs,
+			              sizeof(cdc_configuration_descriptors_t), request->wLength);
+			break;
+		case USBGenericDescriptor_OTHERSPEEDCONFIGURATION:
+		{
+			cdc_configuration_descriptors_t *other = (cdc_configuration_descriptors_t *)usb_cdc.control_data;
+
+			memcpy(other, usbd_hal_is_high_speed() ? &configuration_descriptors_fs : &configuration_descriptors_hs,
+			       sizeof(*other));
+			other->configuration.bDescriptorType = USBGenericDescriptor_OTHERSPEEDCONFIGURATION;
+			control_write(other, sizeof(*other), request->wLength);
+			break;
+		}
+		case USBGenericDescriptor_STRING:
+			if (index == STRING_LANGUAGE)
+			{
+				control_write(string_language, sizeof(string_language), request->wLength);
+			}
+			else if (index < sizeof(strings) / sizeof(strings[0]) && strings[index] != NULL)
+			{
+				// Strings are UTF-16LE, the ASCII strings are widened
+				size_t length = strlen(strings[index]);
+
+				usb_cdc.control_data[0] = (uint8_t)(2U + length * 2U);
+				usb_cdc.control_data[1] = USBGenericDescriptor_STRING;
+				for (size_t i = 0; i < length; i++)
+				{
+					usb_cdc.control_data[2U + i * 2U] = (uint8_t)strings[index][i];
+					usb_cdc.control_data[3U + i * 2U] = 0;
+				}
+
+				control_write(usb_cdc.control_data, usb_cdc.control_data[0], request->wLength);
+			}
+			else
+			{
+				control_stall();
+			}
+
+			break;
+		default:
+			control_stall();
+			break;
+	}
+}
+
+
+static void standard_request(const USBGenericRequest *request)
+{
+	uint8_t recipient = usb_generic_request_get_recipient(request);
+	uint8_t endpoint  = (uint8_t)(request->wIndex & 0x0FU);
+
+	switch (request->bRequest)
+	{
+		case USBGenericRequest_GETDESCRIPTOR:
+			descriptor_get(request);
+			break;
+		case USBGenericRequest_SETADDRESS:
+			usb_cdc.address = (uint8_t)(request->wValue & 0x7FU);
+			usbd_hal_set_transfer_callback(EP_CONTROL, set_address_done, NULL);
+			usbd_hal_write(EP_CONTROL, NULL, 0);
+			break;
+		case USBGenericRequest_SETCONFIGURATION:
+			if (request->wValue > CONFIGURATION_VALUE)
+			{
+				control_stall();
+				break;
+			}
+
+			configuration_set((uint8_t)request->wValue);
+			control_status();
+			break;
+		case USBGenericRequest_GETCONFIGURATION:
+			usb_cdc.control_data[0] = usb_cdc.configuration;
+			control_write(usb_cdc.control_data, 1, request->wLength);
+			break;
+		case USBGenericRequest_GETSTATUS:
+			usb_cdc.control_data[0] = 0;
+			usb_cdc.control_data[1] = 0;
+			if (recipient == USBGenericRequest_ENDPOINT && usbd_hal_is_halted(endpoint))
+			{
+				usb_cdc.control_data[0] = 1;
+			}
+
+			control_write(usb_cdc.control_data, 2, request->wLength);
+			break;
+		case USBGenericRequest_CLEARFEATURE:
+		case USBGenericRequest_SETFEATURE:
+			if (recipient == USBGenericRequest_ENDPOINT && request->wValue == USBFeatureRequest_ENDPOINTHALT &&
+			    endpoint != EP_CONTROL)
+			{
+				if (request->bRequest == USBGenericRequest_SETFEATURE)
+				{
+					usbd_hal_halt(endpoint);
+				}
+				else
+				{
+					usbd_hal_unhalt(endpoint);
+				}
+			}
+			else if (recipient != USBGenericRequest_DEVICE || request->wValue != USBFeatureRequest_DEVICEREMOTEWAKEUP)
+			{
+				control_stall();
+				break;
+			}
+
+			control_status();
+			break;
+		case USBGenericRequest_SETINTERFACE:
+			if (request->wValue != 0)
+			{
+				control_stall();
+				break;
+			}
+
+			control_status();
+			break;
+		case USBGenericRequest_GETINTERFACE:
+			usb_cdc.control_data[0] = 0;
+			control_write(usb_cdc.control_data, 1, request->wLength);
+			break;
+		default:
+			control_stall();
+			break;
+	}
+}
+
+
+static void class_request(const USBGenericRequest *request)
+{
+	switch (request->bRequest)
+	{
+		case CDC_REQUEST_SET_LINE_CODING:
+			usbd_hal_set_transfer_callback(EP_CONTROL, set_line_coding_done, NULL);
+			usbd_hal_read(EP_CONTROL, usb_cdc.control_data, sizeof(cdc_line_coding_t));
+			break;
+		case CDC_REQUEST_GET_LINE_CODING:
+			memcpy(usb_cdc.control_data, &usb_cdc.line_coding, sizeof(cdc_line_coding_t));
+			control_write(usb_cdc.control_data, sizeof(cdc_line_coding_t), request->wLength);
+			break;
+		case CDC_REQUEST_SET_CONTROL_LINE_STATE:
+			usb_cdc.dtr = (request->wValue & CDC_CONTROL_LINE_DTR) != 0;
+			control_status();
+			break;
+		case CDC_REQUEST_SEND_BREAK:
+			control_status();
+			break;
+		default:
+			control_stall();
+			break;
+	}
+}
+
+
+void usbd_request_handler(uint8_t ep, USBGenericRequest *request)
+{
+	if (ep != EP_CONTROL)
+	{
+		return;
+	}
+
+	switch (usb_generic_request_get_type(request))
+	{
+		case USBGenericRequest_STANDARD:
+			standard_request(request);
+			break;
+		case USBGenericRequest_CLASS:
+			class_request(request);
+			break;
+		default:
+			control_stall();
+			break;
+	}
+}
+
+
+void usbd_reset_handler(void)
+{
+	usb_cdc.configured    = false;
+	usb_cdc.dtr           = false;
+	usb_cdc.configuration = 0;
+
+	// Ends ongoing transfers with USBD_STATUS_RESET, which completes waiting writes
+	usbd_hal_reset_endpoints(UINT32_MAX, USBD_STATUS_RESET, false);
+	usbd_hal_configure((const USBEndpointDescriptor *)&device_descriptor);
+}
+
+
+void usbd_suspend_handler(void)
+{
+}
+
+
+void usbd_resume_handler(void)
+{
+}
+
+
+bool acc_driver_usb_cdc_same70_init(void)
+{
+	if (initialized)
+	{
+		return true;
+	}
+
+	memset(&usb_cdc, 0, sizeof(usb_cdc));
+	usb_cdc.line_coding.dwDTERate = 115200;
+	usb_cdc.line_coding.bDataBits = 8;
+
+	usb_cdc.write_semaphore = acc_os_semaphore_create();
+	if (usb_cdc.write_semaphore == NULL)
+	{
+		ACC_LOG_ERROR("Could not create write semaphore");
+		return false;
+	}
+
+	usbd_hal_init();
+	usbd_hal_connect();
+
+	initialized = true;
+
+	ACC_LOG_VERBOSE("SAME70 USB CDC driver initialized");
+
+	return true;
+}
+
+
+bool acc_driver_usb_cdc_same70_is_connected(void)
+{
+	return usb_cdc.configured && usb_cdc.dtr;
+}
+
+
+bool acc_driver_usb_cdc_same70_write_async(const void *header, size_t header_size, const void *data,
+                                           size_t data_size, acc_driver_usb_cdc_same70_write_done_func_t *done,
+                                           void *client_reference)
+{
+	size_t size = header_size + data_size;
+
+	if (!usb_cdc.configured || size == 0 || (header_size > 0 && size > ACC_DRIVER_USB_CDC_SAME70_HEADER_WRITE_MAX_SIZE))
+	{
+		return false;
+	}
+
+	irq_disable(ID_USBHS);
+	bool busy = usb_cdc.write_busy;
+	usb_cdc.write_busy = true;
+	irq_enable(ID_USBHS);
+
+	if (busy)
+	{
+		return false;
+	}
+
+	usb_cdc.write_done             = done;
+	usb_cdc.write_client_reference = client_reference;
+	usb_cdc.write_zlp              = size % usb_cdc.bulk_packet_size == 0;
+
+	usbd_hal_set_transfer_callback(EP_DATA_IN, write_done, NULL);
+
+	uint8_t status = header_size > 0 ?
+	                 usbd_hal_write_with_header(EP_DATA_IN, header, header_size, data, data_size) :
+	                 usbd_hal_write(EP_DATA_IN, data, data_size);
+
+	if (status != USBD_STATUS_SUCCESS)
+	{
+		usb_cdc.write_done = NULL;
+		usb_cdc.write_busy = false;
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Abort a blocking write that timed out
+ *
+ * The endpoint is reset with the done callback cleared, so the completion
+ * semaphore can not be given by this write any more. A completion that came
+ * in before the abort is drained so that it is not taken by the next write.
+ *
+ * @return True if the write completed successfully before it was aborted
+ */
+static bool write_blocking_abort(void)
+{
+	bool success = false;
+
+	irq_disable(ID_USBHS);
+	usb_cdc.write_done = NULL;
+	usbd_hal_reset_endpoints(1U << EP_DATA_IN, USBD_STATUS_ABORTED, true);
+	usb_cdc.write_zlp  = false;
+	usb_cdc.write_busy = false;
+	irq_enable(ID_USBHS);
+
+	while (acc_os_semaphore_wait(usb_cdc.write_semaphore, 0))
+	{
+		success = usb_cdc.write_success;
+	}
+
+	return success;
+}
+
+
+bool acc_driver_usb_cdc_same70_write_buffer(const void *buffer, size_t buffer_size)
+{
+	if (buffer_size == 0)
+	{
+		return true;
+	}
+
+	// Nothing reads the data while the port is not open. A write from the
+	// failure warning below, when this is the debug port, is dropped too.
+	if (!acc_driver_usb_cdc_same70_is_connected() || usb_cdc.write_failure_logging)
+	{
+		return false;
+	}
+
+	// Prevent low power mode until the transfer is completed
+	acc_device_pm_wake_lock();
+
+	bool success = acc_driver_usb_cdc_same70_write_async(NULL, 0, buffer, buffer_size, write_blocking_done, NULL);
+
+	if (success)
+	{
+		if (acc_os_semaphore_wait(usb_cdc.write_semaphore, WRITE_TIMEOUT_MS))
+		{
+			success = usb_cdc.write_success;
+		}
+		else
+		{
+			success = write_blocking_abort();
+		}
+
+		if (!success)
+		{
+			usb_cdc.write_failure_logging = true;
+			ACC_LOG_WARNING("Write of %u bytes failed", (unsigned int)buffer_size);
+			usb_cdc.write_failure_logging = false;
+		}
+	}
+
+	acc_device_pm_wake_unlock();
+
+	return success;
+}
+
+
+void acc_driver_usb_cdc_same70_register_read_callback(acc_device_uart_read_func_t *callback)
+{
+	irq_disable(ID_USBHS);
+	usb_cdc.read_callback = callback;
+	read_start();
+	irq_enable(ID_USBHS);
+}
+
+
+bool acc_driver_usb_cdc_same70_block_read_start(size_t buffer_size, acc_device_uart_rx_event_func_t *event)
+{
+	if (event == NULL || usb_cdc.read_ring != NULL || buffer_size < READ_PACKET_BUFFER_SIZE)
+	{
+		return false;
+	}
+
+	// One byte is always free to tell a full ring from an empty one
+	uint8_t *ring = acc_os_mem_alloc(buffer_size + 1U);
+	if (ring == NULL)
+	{
+		return false;
+	}
+
+	irq_disable(ID_USBHS);
+	usb_cdc.read_ring_size     = buffer_size + 1U;
+	usb_cdc.read_head          = 0;
+	usb_cdc.read_tail          = 0;
+	usb_cdc.read_event         = event;
+	usb_cdc.read_event_enabled = true;
+	usb_cdc.read_ring          = ring;
+	read_start();
+	irq_enable(ID_USBHS);
+
+	return true;
+}
+
+
+static size_t block_read_copy(uint8_t *data, size_t max_length)
+{
+	size_t head   = usb_cdc.read_head;
+	size_t tail   = usb_cdc.read_tail;
+	size_t length = 0;
+
+	dmb();
+
+	while (tail != head && length < max_length)
+	{
+		data[length++] = usb_cdc.read_ring[tail];
+		tail           = (tail + 1U) % usb_cdc.read_ring_size;
+	}
+
+	dmb();
+	usb_cdc.read_tail = tail;
+
+	return length;
+}
+
+
+size_t acc_driver_usb_cdc_same70_block_read(uint8_t *data, size_t max_length)
+{
+	if (usb_cdc.read_ring == NULL)
+	{
+		return 0;
+	}
+
+	size_t length = block_read_copy(data, max_length);
+
+	if (length == 0)
+	{
+		// Take an event on the next data. Read again in case data arrived before the event was enabled.
+		usb_cdc.read_event_enabled = true;
+		length                     = block_read_copy(data, max_length);
+	}
+
+	// The host was held off when the ring was full
+	irq_disable(ID_USBHS);
+	read_start();
+	irq_enable(ID_USBHS);
+
+	return length;
+}
+
+
+static bool uart_init(uint_fast8_t port, uint32_t baudrate, acc_device_uart_options_t options)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		// The baudrate is chosen by the host and does not affect the transfer speed
+		return acc_driver_usb_cdc_same70_init();
+	}
+
+	return uart_driver.init != NULL && uart_driver.init(port, baudrate, options);
+}
+
+
+static bool uart_write(uint_fast8_t port, const uint8_t *data, size_t length)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		return acc_driver_usb_cdc_same70_write_buffer(data, length);
+	}
+
+	return uart_driver.write != NULL && uart_driver.write(port, data, length);
+}
+
+
+static void uart_register_read(uint_fast8_t port, acc_device_uart_read_func_t *callback)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		acc_driver_usb_cdc_same70_register_read_callback(callback);
+	}
+	else if (uart_driver.register_read != NULL)
+	{
+		uart_driver.register_read(port, callback);
+	}
+}
+
+
+static int32_t uart_get_error_count(uint_fast8_t port)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		// Errors are retried by the USB protocol
+		return 0;
+	}
+
+	return uart_driver.get_error_count != NULL ? uart_driver.get_error_count(port) : -1;
+}
+
+
+static void uart_deinit(uint_fast8_t port)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		// The device stays connected so that the host keeps the port
+		acc_driver_usb_cdc_same70_register_read_callback(NULL);
+	}
+	else if (uart_driver.deinit != NULL)
+	{
+		uart_driver.deinit(port);
+	}
+}
+
+
+static bool uart_block_read_start(uint_fast8_t port, size_t buffer_size, acc_device_uart_rx_event_func_t *event)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		return acc_driver_usb_cdc_same70_block_read_start(buffer_size, event);
+	}
+
+	return uart_driver.block_read_start != NULL && uart_driver.block_read_start(port, buffer_size, event);
+}
+
+
+static size_t uart_block_read(uint_fast8_t port, uint8_t *data, size_t max_length)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		return acc_driver_usb_cdc_same70_block_read(data, max_length);
+	}
+
+	return uart_driver.block_read != NULL ? uart_driver.block_read(port, data, max_length) : 0;
+}
+
+
+static uint32_t uart_get_max_baudrate(uint_fast8_t port)
+{
+	if (port == ACC_DRIVER_USB_CDC_SAME70_PORT)
+	{
+		// There is no baudrate to negotiate
+		return 0;
+	}
+
+	return uart_driver.get_max_baudrate != NULL ? uart_driver.get_max_baudrate(port) : 0;
+}
+
+
+void acc_driver_usb_cdc_same70_register(void)
+{
+	if (acc_device_uart_init_func == uart_init)
+	{
+		return;
+	}
+
+	uart_driver.init             = acc_device_uart_init_func;
+	uart_driver.write            = acc_device_uart_write_func;
+	uart_driver.register_read    = acc_device_uart_register_read_func;
+	uart_driver.get_error_count  = acc_device_uart_get_error_count_func;
+	uart_driver.deinit           = acc_device_uart_deinit_func;
+	uart_driver.block_read_start = acc_device_uart_block_read_start_func;
+	uart_driver.block_read       = acc_device_uart_block_read_func;
+	uart_driver.get_max_baudrate = acc_device_uart_get_max_baudrate_func;
+
+	acc_device_uart_init_func             = uart_init;
+	acc_device_uart_write_func            = uart_write;
+	acc_device_uart_register_read_func    = uart_register_read;
+	acc_device_uart_get_error_count_func  = uart_get_error_count;
+	acc_device_uart_deinit_func           = uart_deinit;
+	acc_device_uart_block_read_start_func = uart_block_read_start;
+	acc_device_uart_block_read_func       = uart_block_read;
+	acc_device_uart_get_max_baudrate_func = uart_get_max_baudrate;
+}
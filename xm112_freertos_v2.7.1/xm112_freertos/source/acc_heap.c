@@ -9,12 +9,32 @@
 
 #include "FreeRTOS.h"
 
+#include "acc_tcm.h"
+
 
 /**
  * @brief Allocate heap to be used by FreeRTOS
+ *
+ * With ACC_CFG_TCM_HEAP part of the heap is taken from DTCM. The regions must be
+ * in address order, and DTCM is below SRAM.
  */
+#if ACC_TCM_ENABLED
+_Static_assert(configTOTAL_HEAP_SIZE - ACC_TCM_HEAP_SIZE <= ACC_TCM_SRAM_SIZE,
+               "The heap does not fit in the SRAM left by ACC_CFG_TCM, increase ACC_CFG_TCM_HEAP");
+#endif
+
+#if ACC_TCM_HEAP_SIZE > 0
+ACC_TCM_BSS static uint8_t tcm_heap[ACC_TCM_HEAP_SIZE] __attribute__((aligned(8)));
+static uint8_t primary_heap[configTOTAL_HEAP_SIZE - ACC_TCM_HEAP_SIZE];
+HeapRegion_t xHeapRegions[] = {
+	{ tcm_heap, sizeof(tcm_heap) },
+	{ primary_heap, sizeof(primary_heap) },
+	{ NULL, 0 }
+};
+#else
 static uint8_t primary_heap[configTOTAL_HEAP_SIZE];
 HeapRegion_t xHeapRegions[] = {
 	{ primary_heap, sizeof(primary_heap) },
 	{ NULL, 0 }
 };
+#endif
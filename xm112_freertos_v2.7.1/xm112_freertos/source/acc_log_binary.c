@@ -0,0 +1,393 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_log_binary.h"
+
+#include "acc_console.h"
+#include "acc_device_os.h"
+
+
+static bool binary_enabled;
+
+
+/**
+ * @brief Write data to output device, implemented by the start file
+ */
+int _write(int file, const char *ptr, int len);
+
+
+typedef struct
+{
+	uint8_t *buffer;
+	size_t  size;
+	bool    full;
+} record_writer_t;
+
+
+static void put(record_writer_t *writer, const void *data, size_t size)
+{
+	if (writer->full || writer->size + size > ACC_LOG_BINARY_RECORD_MAX_SIZE)
+	{
+		writer->full = true;
+		return;
+	}
+
+	memcpy(&writer->buffer[writer->size], data, size);
+	writer->size += size;
+}
+
+
+static void put_u32(record_writer_t *writer, uint32_t value)
+{
+	put(writer, &value, sizeof(value));
+}
+
+
+static void put_u64(record_writer_t *writer, uint64_t value)
+{
+	put(writer, &value, sizeof(value));
+}
+
+
+static void put_string(record_writer_t *writer, const char *string)
+{
+	static const uint8_t padding[3] = {0};
+
+	if (string == NULL)
+	{
+		string = "(null)";
+	}
+
+	size_t length = 0;
+
+	while (length < ACC_LOG_BINARY_STRING_MAX_LENGTH && string[length] != '\0')
+	{
+		length++;
+	}
+
+	size_t size = sizeof(uint16_t) + length;
+
+	if (writer->full || writer->size + ((size + 3) & ~(size_t)3) > ACC_LOG_BINARY_RECORD_MAX_SIZE)
+	{
+		writer->full = true;
+		return;
+	}
+
+	uint16_t length_u16 = (uint16_t)length;
+
+	put(writer, &length_u16, sizeof(length_u16));
+	put(writer, string, length);
+	put(writer, padding, (4 - (size & 3)) & 3);
+}
+
+
+static int64_t get_signed(acc_log_binary_length_t length, va_list *ap)
+{
+	switch (length)
+	{
+		case ACC_LOG_BINARY_LENGTH_L:
+			return va_arg(*ap, long);
+		case ACC_LOG_BINARY_LENGTH_LL:
+			return va_arg(*ap, long long);
+		case ACC_LOG_BINARY_LENGTH_J:
+			return va_arg(*ap, intmax_t);
+		case ACC_LOG_BINARY_LENGTH_Z:
+			return (int64_t)va_arg(*ap, size_t);
+		case ACC_LOG_BINARY_LENGTH_T:
+			return va_arg(*ap, ptrdiff_t);
+		default:
+			return va_arg(*ap, int);
+	}
+}
+
+
+static uint64_t get_unsigned(acc_log_binary_length_t length, va_list *ap)
+{
+	switch (length)
+	{
+		case ACC_LOG_BINARY_LENGTH_L:
+			return va_arg(*ap, unsigned long);
+		case ACC_LOG_BINARY_LENGTH_LL:
+			return va_arg(*ap, unsigned long long);
+		case ACC_LOG_BINARY_LENGTH_J:
+			return va_arg(*ap, uintmax_t);
+		case ACC_LOG_BINARY_LENGTH_Z:
+			return va_arg(*ap, size_t);
+		case ACC_LOG_BINARY_LENGTH_T:
+			return (uint64_t)va_arg(*ap, ptrdiff_t);
+		default:
+			return va_arg(*ap, unsigned int);
+	}
+}
+
+
+static void put_argument(record_writer_t *writer, const acc_log_binary_conversion_t *conversion, va_list *ap)
+{
+	if (conversion->width_arg)
+	{
+		put_u32(writer, (uint32_t)va_arg(*ap, int));
+	}
+
+	if (conversion->precision_arg)
+	{
+		put_u32(writer, (uint32_t)va_arg(*ap, int));
+	}
+
+	switch (conversion->arg)
+	{
+		case ACC_LOG_BINARY_ARG_INT:
+			put_u32(writer, (uint32_t)va_arg(*ap, unsigned int));
+			break;
+		case ACC_LOG_BINARY_ARG_LONG:
+			if (conversion->is_signed)
+			{
+				put_u64(writer, (uint64_t)get_signed(conversion->length, ap));
+			}
+			else
+			{
+				put_u64(writer, get_unsigned(conversion->length, ap));
+			}
+
+			break;
+		case ACC_LOG_BINARY_ARG_DOUBLE:
+		{
+			double value;
+
+			if (conversion->length == ACC_LOG_BINARY_LENGTH_BIG_L)
+			{
+				value = (double)va_arg(*ap, long double);
+			}
+			else
+			{
+				value = va_arg(*ap, double);
+			}
+
+			put(writer, &value, sizeof(value));
+			break;
+		}
+		case ACC_LOG_BINARY_ARG_POINTER:
+			put_u64(writer, (uintptr_t)va_arg(*ap, void *));
+			break;
+		case ACC_LOG_BINARY_ARG_STRING:
+			put_string(writer, va_arg(*ap, const char *));
+			break;
+		default:
+			break;
+	}
+}
+
+
+void acc_log_binary_enable(bool enable)
+{
+	binary_enabled = enable;
+}
+
+
+bool acc_log_binary_is_enabled(void)
+{
+	return binary_enabled;
+}
+
+
+void acc_log_binary_write(acc_log_level_t level, const char *module, const char *format, va_list ap)
+{
+	uint8_t record[ACC_LOG_BINARY_RECORD_MAX_SIZE];
+	size_t  size = acc_log_binary_encode(record, level, acc_os_get_time(), (uint32_t)acc_os_get_thread_id(),
+	                                     module, format, ap);
+
+	if (acc_console_is_buffered())
+	{
+		acc_console_write(record, size);
+	}
+	else
+	{
+		_write(0, (const char *)record, (int)size);
+	}
+}
+
+
+size_t acc_log_binary_encode(uint8_t *record, acc_log_level_t level, uint32_t time_ms, uint32_t thread_id,
+                             const char *module, const char *format, va_list ap)
+{
+	record_writer_t         writer = { .buffer = record, .size = sizeof(acc_log_binary_header_t), .full = false };
+	acc_log_binary_header_t header;
+	va_list                 ap_copy;
+
+	memset(&header, 0, sizeof(header));
+	header.sync[0]   = ACC_LOG_BINARY_SYNC_0;
+	header.sync[1]   = ACC_LOG_BINARY_SYNC_1;
+	header.level     = (uint8_t)level;
+	header.time_ms   = time_ms;
+	header.thread_id = thread_id;
+	header.format    = (uintptr_t)format;
+	header.module    = (uintptr_t)module;
+
+	acc_log_binary_conversion_t conversion;
+	const char                  *position = format;
+
+	va_copy(ap_copy, ap);
+
+	while (!writer.full && acc_log_binary_next_conversion(&position, &conversion))
+	{
+		put_argument(&writer, &conversion, &ap_copy);
+	}
+
+	va_end(ap_copy);
+
+	header.length = (uint16_t)writer.size;
+	memcpy(record, &header, sizeof(header));
+
+	return writer.size;
+}
+
+
+bool acc_log_binary_next_conversion(const char **format, acc_log_binary_conversion_t *conversion)
+{
+	const char *p = strchr(*format, '%');
+
+	if (p == NULL)
+	{
+		*format += strlen(*format);
+		return false;
+	}
+
+	memset(conversion, 0, sizeof(*conversion));
+	conversion->start = p++;
+
+	while (*p != '\0' && strchr("-+ #0", *p) != NULL)
+	{
+		p++;
+	}
+
+	if (*p == '*')
+	{
+		conversion->width_arg = true;
+		p++;
+	}
+
+	while (*p >= '0' && *p <= '9')
+	{
+		p++;
+	}
+
+	if (*p == '.')
+	{
+		p++;
+
+		if (*p == '*')
+		{
+			conversion->precision_arg = true;
+			p++;
+		}
+
+		while (*p >= '0' && *p <= '9')
+		{
+			p++;
+		}
+	}
+
+	switch (*p)
+	{
+		case 'h':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_H;
+			if (*p == 'h')
+			{
+				p++;
+				conversion->length = ACC_LOG_BINARY_LENGTH_HH;
+			}
+
+			break;
+		case 'l':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_L;
+			if (*p == 'l')
+			{
+				p++;
+				conversion->length = ACC_LOG_BINARY_LENGTH_LL;
+			}
+
+			break;
+		case 'j':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_J;
+			break;
+		case 'z':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_Z;
+			break;
+		case 't':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_T;
+			break;
+		case 'L':
+			p++;
+			conversion->length = ACC_LOG_BINARY_LENGTH_BIG_L;
+			break;
+		default:
+			break;
+	}
+
+	conversion->conversion = *p;
+
+	switch (*p)
+	{
+		case 'd':
+		case 'i':
+			conversion->is_signed = true;
+		// fall through
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			conversion->arg = ACC_LOG_BINARY_ARG_INT;
+			if (conversion->length >= ACC_LOG_BINARY_LENGTH_L && conversion->length <= ACC_LOG_BINARY_LENGTH_T)
+			{
+				conversion->arg = ACC_LOG_BINARY_ARG_LONG;
+			}
+
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			conversion->arg = ACC_LOG_BINARY_ARG_DOUBLE;
+			break;
+		case 'p':
+			conversion->arg = ACC_LOG_BINARY_ARG_POINTER;
+			break;
+		case 's':
+			conversion->arg = ACC_LOG_BINARY_ARG_STRING;
+			break;
+		case 'n':
+			// Nothing is written for %n, only its argument is skipped
+			conversion->arg = ACC_LOG_BINARY_ARG_POINTER;
+			break;
+		default:
+			break;
+	}
+
+	if (*p != '\0')
+	{
+		p++;
+	}
+
+	conversion->size = (size_t)(p - conversion->start);
+	*format          = p;
+
+	return true;
+}
@@ -0,0 +1,247 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_log_filter.h"
+
+#include "acc_device_os.h"
+
+
+/**
+ * @brief Default number of messages a module may log at once
+ */
+#define DEFAULT_RATE_LIMIT_BURST 50
+
+/**
+ * @brief Default number of messages per second a module may log over time
+ */
+#define DEFAULT_RATE_LIMIT_PER_SECOND 50
+
+/**
+ * @brief Tokens are counted in thousandths of a message so they refill every millisecond
+ */
+#define TOKENS_PER_MESSAGE 1000
+
+/**
+ * @brief Module of a rate limit slot that is being initialized
+ *
+ * Other callers skip the slot rather than wait for it. Two callers logging the
+ * first message of a module at once may then give it two slots, which is harmless.
+ */
+#define RATE_LIMIT_CLAIMED ((const char *)&rate_limits)
+
+
+typedef struct
+{
+	const char      *module;
+	acc_log_level_t level;
+} module_level_t;
+
+
+typedef struct
+{
+	const char *module;
+	uint32_t   tokens;
+	uint32_t   last_time_ms;
+	uint32_t   suppressed;
+} rate_limit_t;
+
+
+acc_log_level_t acc_log_level_limit = ACC_LOG_LEVEL_INFO;
+
+static acc_log_level_t log_level = ACC_LOG_LEVEL_INFO;
+static module_level_t  module_levels[ACC_LOG_MODULE_LEVEL_MAX_COUNT];
+static uint32_t        module_level_count;
+
+static uint32_t     rate_limit_burst      = DEFAULT_RATE_LIMIT_BURST;
+static uint32_t     rate_limit_per_second = DEFAULT_RATE_LIMIT_PER_SECOND;
+static rate_limit_t rate_limits[ACC_LOG_RATE_LIMIT_MODULE_MAX_COUNT];
+
+
+static void update_limit(void)
+{
+	acc_log_level_t limit = log_level;
+
+	for (uint32_t i = 0; i < module_level_count; i++)
+	{
+		if (module_levels[i].level > limit)
+		{
+			limit = module_levels[i].level;
+		}
+	}
+
+	acc_log_level_limit = limit;
+}
+
+
+static module_level_t *find_module_level(const char *module)
+{
+	// Module names are string literals, the same pointer is usually used for all calls
+	for (uint32_t i = 0; i < module_level_count; i++)
+	{
+		if (module_levels[i].module == module)
+		{
+			return &module_levels[i];
+		}
+	}
+
+	for (uint32_t i = 0; i < module_level_count; i++)
+	{
+		if (strcmp(module_levels[i].module, module) == 0)
+		{
+			return &module_levels[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+static rate_limit_t *find_rate_limit(const char *module, uint32_t now)
+{
+	for (uint32_t i = 0; i < ACC_LOG_RATE_LIMIT_MODULE_MAX_COUNT; i++)
+	{
+		const char *slot_module = __atomic_load_n(&rate_limits[i].module, __ATOMIC_ACQUIRE);
+
+		if (slot_module == module)
+		{
+			return &rate_limits[i];
+		}
+
+		if (slot_module == NULL)
+		{
+			const char *expected = NULL;
+
+			// Claim the slot and initialize it before the module is published, so
+			// that other callers never see the module with an empty bucket
+			if (__atomic_compare_exchange_n(&rate_limits[i].module, &expected, RATE_LIMIT_CLAIMED, false, __ATOMIC_ACQUIRE,
+			                                __ATOMIC_ACQUIRE))
+			{
+				// A new module starts with a full burst
+				rate_limits[i].tokens       = rate_limit_burst * TOKENS_PER_MESSAGE;
+				rate_limits[i].last_time_ms = now;
+				rate_limits[i].suppressed   = 0;
+				__atomic_store_n(&rate_limits[i].module, module, __ATOMIC_RELEASE);
+				return &rate_limits[i];
+			}
+
+			if (expected == module)
+			{
+				return &rate_limits[i];
+			}
+		}
+	}
+
+	// All slots are used, the remaining modules share the last one
+	return &rate_limits[ACC_LOG_RATE_LIMIT_MODULE_MAX_COUNT - 1];
+}
+
+
+void acc_log_level_set(acc_log_level_t level)
+{
+	log_level = level;
+	update_limit();
+}
+
+
+bool acc_log_module_level_set(const char *module, acc_log_level_t level)
+{
+	module_level_t *module_level = find_module_level(module);
+
+	if (module_level == NULL)
+	{
+		if (module_level_count >= ACC_LOG_MODULE_LEVEL_MAX_COUNT)
+		{
+			return false;
+		}
+
+		module_level         = &module_levels[module_level_count];
+		module_level->module = module;
+		module_level->level  = level;
+		module_level_count++;
+	}
+	else
+	{
+		module_level->level = level;
+	}
+
+	update_limit();
+
+	return true;
+}
+
+
+void acc_log_module_level_reset(void)
+{
+	module_level_count = 0;
+	update_limit();
+}
+
+
+bool acc_log_is_enabled(acc_log_level_t level, const char *module)
+{
+	if (level > ACC_LOG_LEVEL_MAX || level > acc_log_level_limit)
+	{
+		return false;
+	}
+
+	if (module_level_count > 0)
+	{
+		module_level_t *module_level = find_module_level(module);
+
+		if (module_level != NULL)
+		{
+			return level <= module_level->level;
+		}
+	}
+
+	return level <= log_level;
+}
+
+
+void acc_log_rate_limit_set(uint32_t burst, uint32_t messages_per_second)
+{
+	rate_limit_burst      = burst;
+	rate_limit_per_second = messages_per_second;
+	memset(rate_limits, 0, sizeof(rate_limits));
+}
+
+
+bool acc_log_rate_limit_check(const char *module, uint32_t *suppressed)
+{
+	*suppressed = 0;
+
+	if (rate_limit_burst == 0)
+	{
+		return true;
+	}
+
+	// The state is updated without locking, concurrent calls from the same
+	// module may let an extra message through, which is harmless
+	uint32_t     now         = acc_os_get_time();
+	uint32_t     max_tokens  = rate_limit_burst * TOKENS_PER_MESSAGE;
+	rate_limit_t *rate_limit = find_rate_limit(module, now);
+	uint64_t     tokens      = rate_limit->tokens + (uint64_t)(now - rate_limit->last_time_ms) * rate_limit_per_second;
+
+	rate_limit->tokens       = tokens > max_tokens ? max_tokens : (uint32_t)tokens;
+	rate_limit->last_time_ms = now;
+
+	if (rate_limit->tokens < TOKENS_PER_MESSAGE)
+	{
+		rate_limit->suppressed++;
+		return false;
+	}
+
+	rate_limit->tokens    -= TOKENS_PER_MESSAGE;
+	*suppressed            = rate_limit->suppressed;
+	rate_limit->suppressed = 0;
+
+	return true;
+}
@@ -4,54 +4,152 @@
 // 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
 // of this source code package.
 
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "acc_log_integration.h"
 
 #include "acc_app_integration.h"
 #include "acc_device_os.h"
 #include "acc_hal_definitions.h"
+#include "acc_log_binary.h"
+#include "acc_log_filter.h"
 
 
-#define LOG_FORMAT "%02u:%02u:%02u.%03u [%5u] (%c) (%s) %s\n"
+#define LOG_PREFIX_FORMAT_MS "%02u:%02u:%02u.%03u [%5u] (%c) (%s) "
+#define LOG_PREFIX_FORMAT_US "%02u:%02u:%02u.%06u [%5u] (%c) (%s) "
 
-#define LOG_BUFFER_MAX_SIZE 150
+#define LOG_LINE_MAX_SIZE 200
 
 
-void acc_log(acc_log_level_t level, const char *module, const char *format, ...)
+int _write(int file, const char *ptr, int len);
+
+
+/**
+ * @brief Format the timestamp, thread, level and module at the start of the line
+ *
+ * The time is taken from the microsecond counter if there is one, otherwise
+ * from the millisecond OS time.
+ */
+static size_t log_prefix_format(char *line, size_t size, acc_log_level_t level, const char *module)
+{
+	unsigned int thread_id = (unsigned int)acc_os_get_thread_id();
+	char         level_ch  = (level <= ACC_LOG_LEVEL_DEBUG) ? "EWIVD"[level] : '?';
+	uint64_t     time_us;
+	int          length;
+
+	if (acc_os_get_time_us(&time_us))
+	{
+		unsigned int seconds = (unsigned int)(time_us / 1000000U);
+
+		length = snprintf(line, size, LOG_PREFIX_FORMAT_US, seconds / 60 / 60, seconds / 60 % 60, seconds % 60,
+		                  (unsigned int)(time_us % 1000000U), thread_id, level_ch, module);
+	}
+	else
+	{
+		unsigned int time_ms = acc_os_get_time();
+
+		length = snprintf(line, size, LOG_PREFIX_FORMAT_MS, time_ms / 1000 / 60 / 60, time_ms / 1000 / 60 % 60,
+		                  time_ms / 1000 % 60, time_ms % 1000, thread_id, level_ch, module);
+	}
+
+	if (length < 0)
+	{
+		return 0;
+	}
+
+	return (size_t)length < size ? (size_t)length : size - 1;
+}
+
+
+/**
+ * @brief Format the whole line into one buffer and write it with one call
+ */
+static void log_vprint(acc_log_level_t level, const char *module, const char *format, va_list ap)
+{
+	char line[LOG_LINE_MAX_SIZE];
+
+	if (acc_log_binary_is_enabled())
+	{
+		acc_log_binary_write(level, module, format, ap);
+		return;
+	}
+
+	// The last byte is kept for the line break
+	size_t length       = log_prefix_format(line, sizeof(line) - 1, level, module);
+	size_t message_size = sizeof(line) - 1 - length;
+	int    ret          = vsnprintf(&line[length], message_size, format, ap);
+
+	if (ret < 0)
+	{
+		ret = 0;
+	}
+
+	if ((size_t)ret >= message_size)
+	{
+		length = sizeof(line) - 1;
+		memcpy(&line[length - 3], "...", 3);
+	}
+	else
+	{
+		length += (size_t)ret;
+	}
+
+	line[length++] = '\n';
+
+	_write(0, line, (int)length);
+}
+
+
+static void log_print(acc_log_level_t level, const char *module, const char *format, ...) PRINTF_ATTRIBUTE_CHECK(3, 4);
+
+
+static void log_print(acc_log_level_t level, const char *module, const char *format, ...)
 {
-	char    log_buffer[LOG_BUFFER_MAX_SIZE];
 	va_list ap;
 
 	va_start(ap, format);
+	log_vprint(level, module, format, ap);
+	va_end(ap);
+}
+
 
-	int ret = vsnprintf(log_buffer, LOG_BUFFER_MAX_SIZE, format, ap);
-	if (ret >= LOG_BUFFER_MAX_SIZE)
+void acc_log(acc_log_level_t level, const char *module, const char *format, ...)
+{
+	uint32_t suppressed;
+	va_list  ap;
+
+	// The module level is only checked here, the ACC_LOG macros and RSS filter by the limit
+	if (!acc_log_is_enabled(level, module) || !acc_log_rate_limit_check(module, &suppressed))
 	{
-		log_buffer[LOG_BUFFER_MAX_SIZE - 4] = '.';
-		log_buffer[LOG_BUFFER_MAX_SIZE - 3] = '.';
-		log_buffer[LOG_BUFFER_MAX_SIZE - 2] = '.';
-		log_buffer[LOG_BUFFER_MAX_SIZE - 1] = 0;
+		return;
 	}
 
-	acc_app_integration_thread_id_t thread_id = acc_os_get_thread_id();
-	uint32_t                        time_ms = acc_os_get_time();
-	char                            level_ch;
+	if (suppressed > 0)
+	{
+		log_print(ACC_LOG_LEVEL_WARNING, module, "%" PRIu32 " messages suppressed", suppressed);
+	}
 
-	unsigned int timestamp    = time_ms;
-	unsigned int hours        = timestamp / 1000 / 60 / 60;
-	unsigned int minutes      = timestamp / 1000 / 60 % 60;
-	unsigned int seconds      = timestamp / 1000 % 60;
-	unsigned int milliseconds = timestamp % 1000;
+	va_start(ap, format);
+	log_vprint(level, module, format, ap);
+	va_end(ap);
+}
 
-	level_ch = (level <= ACC_LOG_LEVEL_DEBUG) ? "EWIVD"[level] : '?';
 
-	printf(LOG_FORMAT, hours, minutes, seconds, milliseconds, (unsigned int)thread_id, level_ch, module, log_buffer);
+void acc_log_unlimited(acc_log_level_t level, const char *module, const char *format, ...)
+{
+	va_list ap;
 
-	fflush(stdout);
+	if (!acc_log_is_enabled(level, module))
+	{
+		return;
+	}
 
+	va_start(ap, format);
+	log_vprint(level, module, format, ap);
 	va_end(ap);
 }
@@ -0,0 +1,98 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acc_pool.h"
+
+
+/**
+ * @brief The bits of a bitmap word that correspond to objects
+ */
+static uint32_t word_mask(const acc_pool_t *pool, uint32_t word)
+{
+	uint32_t remaining = pool->capacity - word * 32U;
+
+	return remaining >= 32U ? UINT32_MAX : (1U << remaining) - 1U;
+}
+
+
+static void update_peak(acc_pool_t *pool, uint32_t in_use)
+{
+	uint32_t peak = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+
+	while (in_use > peak)
+	{
+		if (__atomic_compare_exchange_n(&pool->peak, &peak, in_use, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		{
+			break;
+		}
+	}
+}
+
+
+void *acc_pool_alloc(acc_pool_t *pool)
+{
+	for (uint32_t word = 0; word < ACC_POOL_BITMAP_WORDS(pool->capacity); word++)
+	{
+		uint32_t mask = word_mask(pool, word);
+		uint32_t used = __atomic_load_n(&pool->used_bitmap[word], __ATOMIC_RELAXED);
+
+		while ((used & mask) != mask)
+		{
+			uint32_t bit = (uint32_t)__builtin_ctz(~used & mask);
+
+			// On failure used is updated with the current value and the search is repeated
+			if (__atomic_compare_exchange_n(&pool->used_bitmap[word], &used, used | (1U << bit), true,
+			                                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			{
+				update_peak(pool, __atomic_add_fetch(&pool->in_use, 1U, __ATOMIC_RELAXED));
+
+				return pool->objects + (word * 32U + bit) * pool->object_size;
+			}
+		}
+	}
+
+	__atomic_add_fetch(&pool->exhausted_count, 1U, __ATOMIC_RELAXED);
+
+	return NULL;
+}
+
+
+void acc_pool_free(acc_pool_t *pool, void *object)
+{
+	if (object == NULL)
+	{
+		return;
+	}
+
+	uint32_t index = (uint32_t)(((uint8_t *)object - pool->objects) / pool->object_size);
+
+	__atomic_fetch_and(&pool->used_bitmap[index / 32U], ~(1U << (index % 32U)), __ATOMIC_RELEASE);
+	__atomic_sub_fetch(&pool->in_use, 1U, __ATOMIC_RELAXED);
+}
+
+
+bool acc_pool_contains(const acc_pool_t *pool, const void *object)
+{
+	uintptr_t address = (uintptr_t)object;
+	uintptr_t start   = (uintptr_t)pool->objects;
+
+	return address >= start && address < start + pool->capacity * pool->object_size &&
+	       (address - start) % pool->object_size == 0U;
+}
+
+
+void acc_pool_get_stats(const acc_pool_t *pool, acc_pool_stats_t *stats)
+{
+	stats->name            = pool->name;
+	stats->capacity        = pool->capacity;
+	stats->in_use          = __atomic_load_n(&pool->in_use, __ATOMIC_RELAXED);
+	stats->peak            = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+	stats->exhausted_count = __atomic_load_n(&pool->exhausted_count, __ATOMIC_RELAXED);
+}
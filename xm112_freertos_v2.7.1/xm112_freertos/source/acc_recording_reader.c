@@ -0,0 +1,176 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "acc_recording_reader.h"
+
+#include "acc_log.h"
+
+
+#define MODULE "recording_reader" /**< module name */
+
+
+/**
+ * @brief Size of the header in the first version, the smallest header a reader accepts
+ */
+#define HEADER_SIZE_V1 sizeof(acc_recording_header_t)
+
+
+struct acc_recording_reader
+{
+	const uint8_t                *mapping;
+	size_t                       mapping_size;
+	const acc_recording_header_t *header;
+	uint32_t                     frame_count;
+};
+
+
+static bool header_valid(const acc_recording_header_t *header, size_t file_size, const char *path)
+{
+	if (header->magic != ACC_RECORDING_MAGIC)
+	{
+		ACC_LOG_ERROR("%s is not a recording", path);
+		return false;
+	}
+
+	if (header->version > ACC_RECORDING_VERSION)
+	{
+		ACC_LOG_ERROR("%s has unsupported version %u", path, (unsigned int)header->version);
+		return false;
+	}
+
+	if (header->header_size < HEADER_SIZE_V1 || header->header_size > file_size ||
+	    header->header_size % ACC_RECORDING_FRAME_ALIGNMENT != 0)
+	{
+		ACC_LOG_ERROR("%s has an invalid header size", path);
+		return false;
+	}
+
+	size_t payload_size = (size_t)header->metadata.data_length * header->sample_size;
+
+	if (header->sample_size == 0 || header->frame_record_size < sizeof(acc_recording_frame_header_t) + payload_size ||
+	    header->frame_record_size % ACC_RECORDING_FRAME_ALIGNMENT != 0)
+	{
+		ACC_LOG_ERROR("%s has an invalid frame size", path);
+		return false;
+	}
+
+	return true;
+}
+
+
+acc_recording_reader_t acc_recording_reader_open(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+	{
+		ACC_LOG_ERROR("Unable to open %s", path);
+		return NULL;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < HEADER_SIZE_V1)
+	{
+		ACC_LOG_ERROR("%s is not a recording", path);
+		close(fd);
+		return NULL;
+	}
+
+	size_t mapping_size = (size_t)file_stat.st_size;
+	void   *mapping     = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	// The mapping keeps the file open
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+	{
+		ACC_LOG_ERROR("Unable to map %s", path);
+		return NULL;
+	}
+
+	const acc_recording_header_t *header = mapping;
+
+	if (!header_valid(header, mapping_size, path))
+	{
+		munmap(mapping, mapping_size);
+		return NULL;
+	}
+
+	acc_recording_reader_t reader = malloc(sizeof(*reader));
+
+	if (reader == NULL)
+	{
+		munmap(mapping, mapping_size);
+		return NULL;
+	}
+
+	reader->mapping      = mapping;
+	reader->mapping_size = mapping_size;
+	reader->header       = header;
+	reader->frame_count  = (uint32_t)((mapping_size - header->header_size) / header->frame_record_size);
+
+	// Frames are usually processed in order
+	posix_madvise(mapping, mapping_size, POSIX_MADV_SEQUENTIAL);
+
+	return reader;
+}
+
+
+void acc_recording_reader_close(acc_recording_reader_t *reader)
+{
+	if (reader == NULL || *reader == NULL)
+	{
+		return;
+	}
+
+	munmap((void *)(uintptr_t)(*reader)->mapping, (*reader)->mapping_size);
+	free(*reader);
+	*reader = NULL;
+}
+
+
+const acc_recording_header_t *acc_recording_reader_header_get(acc_recording_reader_t reader)
+{
+	return reader->header;
+}
+
+
+uint32_t acc_recording_reader_frame_count(acc_recording_reader_t reader)
+{
+	return reader->frame_count;
+}
+
+
+const acc_recording_frame_header_t *acc_recording_reader_frame_get(acc_recording_reader_t reader, uint32_t index,
+                                                                   const void **data)
+{
+	if (index >= reader->frame_count)
+	{
+		return NULL;
+	}
+
+	const uint8_t *record = reader->mapping + reader->header->header_size +
+	                        (size_t)index * reader->header->frame_record_size;
+
+	if (data != NULL)
+	{
+		*data = record + sizeof(acc_recording_frame_header_t);
+	}
+
+	return (const acc_recording_frame_header_t *)(const void *)record;
+}
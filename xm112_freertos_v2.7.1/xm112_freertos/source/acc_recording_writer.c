@@ -0,0 +1,480 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_recording_writer.h"
+
+#include "acc_definitions.h"
+#include "acc_device_os.h"
+#include "acc_log.h"
+
+
+#define MODULE "recording_writer" /**< module name */
+
+
+static acc_recording_writer_t *distance_writer;
+
+
+static uint32_t sample_size(acc_recording_service_type_t service_type)
+{
+	if (service_type == ACC_RECORDING_SERVICE_TYPE_IQ)
+	{
+		return sizeof(acc_int16_complex_t);
+	}
+
+	return sizeof(uint16_t);
+}
+
+
+static uint32_t frame_record_size(uint32_t payload_size)
+{
+	uint32_t size = sizeof(acc_recording_frame_header_t) + payload_size;
+
+	return (size + ACC_RECORDING_FRAME_ALIGNMENT - 1) & ~(ACC_RECORDING_FRAME_ALIGNMENT - 1);
+}
+
+
+static void configuration_fill(acc_service_configuration_t service_configuration, acc_recording_configuration_t *configuration)
+{
+	memset(configuration, 0, sizeof(*configuration));
+
+	if (service_configuration == NULL)
+	{
+		return;
+	}
+
+	acc_base_configuration_t base = acc_service_get_base_configuration(service_configuration);
+
+	configuration->sensor_id                      = acc_base_configuration_sensor_get(base);
+	configuration->requested_start_m              = acc_base_configuration_requested_start_get(base);
+	configuration->requested_length_m             = acc_base_configuration_requested_length_get(base);
+	configuration->receiver_gain                  = acc_base_configuration_receiver_gain_get(base);
+	configuration->power_save_mode                = acc_base_configuration_power_save_mode_get(base);
+	configuration->hw_accelerated_average_samples = acc_base_configuration_hw_accelerated_average_samples_get(base);
+	configuration->profile                        = acc_service_profile_get(service_configuration);
+
+	if (acc_base_configuration_tx_disable_get(base))
+	{
+		configuration->flags |= ACC_RECORDING_CONFIGURATION_TX_DISABLE;
+	}
+
+	if (acc_service_asynchronous_measurement_get(service_configuration))
+	{
+		configuration->flags |= ACC_RECORDING_CONFIGURATION_ASYNCHRONOUS_MEASUREMENT;
+	}
+
+	if (acc_service_maximize_signal_attenuation_get(service_configuration))
+	{
+		configuration->flags |= ACC_RECORDING_CONFIGURATION_MAXIMIZE_SIGNAL_ATTENUATION;
+	}
+}
+
+
+void acc_recording_writer_init(acc_recording_writer_t *writer, acc_recording_writer_output_t output, void *client_reference)
+{
+	memset(writer, 0, sizeof(*writer));
+
+	writer->output           = output;
+	writer->client_reference = client_reference;
+}
+
+
+bool acc_recording_writer_start(acc_recording_writer_t              *writer,
+                                acc_recording_service_type_t        service_type,
+                                const acc_recording_metadata_t      *metadata,
+                                const acc_recording_configuration_t *configuration)
+{
+	if (writer == NULL || writer->output == NULL)
+	{
+		ACC_LOG_ERROR("Writer not initialized");
+		return false;
+	}
+
+	if (service_type < ACC_RECORDING_SERVICE_TYPE_ENVELOPE || service_type > ACC_RECORDING_SERVICE_TYPE_POWER_BINS)
+	{
+		ACC_LOG_ERROR("Invalid service type %" PRIu32, service_type);
+		return false;
+	}
+
+	acc_recording_header_t *header = &writer->header;
+
+	memset(header, 0, sizeof(*header));
+
+	header->magic        = ACC_RECORDING_MAGIC;
+	header->version      = ACC_RECORDING_VERSION;
+	header->header_size  = sizeof(*header);
+	header->service_type = service_type;
+	header->sample_size  = sample_size(service_type);
+
+	if (metadata != NULL)
+	{
+		header->metadata = *metadata;
+	}
+
+	if (configuration != NULL)
+	{
+		header->configuration = *configuration;
+	}
+
+	header->frame_record_size = frame_record_size(header->metadata.data_length * header->sample_size);
+
+	writer->started             = true;
+	writer->header_written      = false;
+	writer->failed              = false;
+	writer->sequence_number     = 0;
+	writer->dropped_frame_count = 0;
+
+	return true;
+}
+
+
+void acc_recording_writer_describe_envelope(const acc_service_envelope_metadata_t *metadata,
+                                            acc_service_configuration_t           configuration,
+                                            acc_recording_metadata_t              *recording_metadata,
+                                            acc_recording_configuration_t         *recording_configuration)
+{
+	memset(recording_metadata, 0, sizeof(*recording_metadata));
+	recording_metadata->start_m       = metadata->start_m;
+	recording_metadata->length_m      = metadata->length_m;
+	recording_metadata->step_length_m = metadata->step_length_m;
+	recording_metadata->data_length   = metadata->data_length;
+	recording_metadata->stitch_count  = metadata->stitch_count;
+
+	configuration_fill(configuration, recording_configuration);
+
+	if (configuration != NULL)
+	{
+		recording_configuration->downsampling_factor    = acc_service_envelope_downsampling_factor_get(configuration);
+		recording_configuration->running_average_factor = acc_service_envelope_running_average_factor_get(configuration);
+
+		if (acc_service_envelope_noise_level_normalization_get(configuration))
+		{
+			recording_configuration->flags |= ACC_RECORDING_CONFIGURATION_NOISE_LEVEL_NORMALIZATION;
+		}
+	}
+}
+
+
+bool acc_recording_writer_start_envelope(acc_recording_writer_t                *writer,
+                                         const acc_service_envelope_metadata_t *metadata,
+                                         acc_service_configuration_t           configuration)
+{
+	acc_recording_metadata_t      recording_metadata;
+	acc_recording_configuration_t recording_configuration;
+
+	acc_recording_writer_describe_envelope(metadata, configuration, &recording_metadata, &recording_configuration);
+
+	return acc_recording_writer_start(writer, ACC_RECORDING_SERVICE_TYPE_ENVELOPE, &recording_metadata, &recording_configuration);
+}
+
+
+void acc_recording_writer_describe_iq(const acc_service_iq_metadata_t *metadata,
+                                      acc_service_configuration_t     configuration,
+                                      acc_recording_metadata_t        *recording_metadata,
+                                      acc_recording_configuration_t   *recording_configuration)
+{
+	memset(recording_metadata, 0, sizeof(*recording_metadata));
+	recording_metadata->start_m                    = metadata->start_m;
+	recording_metadata->length_m                   = metadata->length_m;
+	recording_metadata->step_length_m              = metadata->step_length_m;
+	recording_metadata->depth_lowpass_cutoff_ratio = metadata->depth_lowpass_cutoff_ratio;
+	recording_metadata->data_length                = metadata->data_length;
+	recording_metadata->stitch_count               = metadata->stitch_count;
+
+	configuration_fill(configuration, recording_configuration);
+
+	if (configuration != NULL)
+	{
+		recording_configuration->downsampling_factor = acc_service_iq_downsampling_factor_get(configuration);
+		recording_configuration->mode                = acc_service_iq_output_format_get(configuration);
+
+		if (acc_service_iq_noise_level_normalization_get(configuration))
+		{
+			recording_configuration->flags |= ACC_RECORDING_CONFIGURATION_NOISE_LEVEL_NORMALIZATION;
+		}
+	}
+}
+
+
+bool acc_recording_writer_start_iq(acc_recording_writer_t          *writer,
+                                   const acc_service_iq_metadata_t *metadata,
+                                   acc_service_configuration_t     configuration)
+{
+	acc_recording_metadata_t      recording_metadata;
+	acc_recording_configuration_t recording_configuration;
+
+	acc_recording_writer_describe_iq(metadata, configuration, &recording_metadata, &recording_configuration);
+
+	return acc_recording_writer_start(writer, ACC_RECORDING_SERVICE_TYPE_IQ, &recording_metadata, &recording_configuration);
+}
+
+
+void acc_recording_writer_describe_sparse(const acc_service_sparse_metadata_t *metadata,
+                                          acc_service_configuration_t         configuration,
+                                          acc_recording_metadata_t            *recording_metadata,
+                                          acc_recording_configuration_t       *recording_configuration)
+{
+	memset(recording_metadata, 0, sizeof(*recording_metadata));
+	recording_metadata->start_m       = metadata->start_m;
+	recording_metadata->length_m      = metadata->length_m;
+	recording_metadata->step_length_m = metadata->step_length_m;
+	recording_metadata->sweep_rate    = metadata->sweep_rate;
+	recording_metadata->data_length   = metadata->data_length;
+
+	configuration_fill(configuration, recording_configuration);
+
+	if (configuration != NULL)
+	{
+		recording_metadata->sweeps_per_frame         = acc_service_sparse_configuration_sweeps_per_frame_get(configuration);
+		recording_configuration->downsampling_factor = acc_service_sparse_downsampling_factor_get(configuration);
+		recording_configuration->mode                = acc_service_sparse_sampling_mode_get(configuration);
+	}
+}
+
+
+bool acc_recording_writer_start_sparse(acc_recording_writer_t              *writer,
+                                       const acc_service_sparse_metadata_t *metadata,
+                                       acc_service_configuration_t         configuration)
+{
+	acc_recording_metadata_t      recording_metadata;
+	acc_recording_configuration_t recording_configuration;
+
+	acc_recording_writer_describe_sparse(metadata, configuration, &recording_metadata, &recording_configuration);
+
+	return acc_recording_writer_start(writer, ACC_RECORDING_SERVICE_TYPE_SPARSE, &recording_metadata, &recording_configuration);
+}
+
+
+void acc_recording_writer_describe_power_bins(const acc_service_power_bins_metadata_t *metadata,
+                                              acc_service_configuration_t             configuration,
+                                              acc_recording_metadata_t                *recording_metadata,
+                                              acc_recording_configuration_t           *recording_configuration)
+{
+	memset(recording_metadata, 0, sizeof(*recording_metadata));
+	recording_metadata->start_m       = metadata->start_m;
+	recording_metadata->length_m      = metadata->length_m;
+	recording_metadata->step_length_m = metadata->step_length_m;
+	recording_metadata->data_length   = metadata->bin_count;
+	recording_metadata->stitch_count  = metadata->stitch_count;
+
+	configuration_fill(configuration, recording_configuration);
+
+	if (configuration != NULL)
+	{
+		recording_configuration->downsampling_factor = acc_service_power_bins_downsampling_factor_get(configuration);
+
+		if (acc_service_power_bins_noise_level_normalization_get(configuration))
+		{
+			recording_configuration->flags |= ACC_RECORDING_CONFIGURATION_NOISE_LEVEL_NORMALIZATION;
+		}
+	}
+}
+
+
+bool acc_recording_writer_start_power_bins(acc_recording_writer_t                  *writer,
+                                           const acc_service_power_bins_metadata_t *metadata,
+                                           acc_service_configuration_t             configuration)
+{
+	acc_recording_metadata_t      recording_metadata;
+	acc_recording_configuration_t recording_configuration;
+
+	acc_recording_writer_describe_power_bins(metadata, configuration, &recording_metadata, &recording_configuration);
+
+	return acc_recording_writer_start(writer, ACC_RECORDING_SERVICE_TYPE_POWER_BINS, &recording_metadata, &recording_configuration);
+}
+
+
+void acc_recording_writer_update_rate_set(acc_recording_writer_t *writer, float update_rate)
+{
+	if (writer->header_written)
+	{
+		ACC_LOG_WARNING("Recording header already written");
+		return;
+	}
+
+	writer->header.configuration.update_rate = update_rate;
+}
+
+
+static bool writer_output(acc_recording_writer_t *writer, const void *data, size_t size)
+{
+	if (!writer->output(data, size, writer->client_reference))
+	{
+		ACC_LOG_ERROR("Recording output failed, recording stopped");
+		writer->failed = true;
+		return false;
+	}
+
+	return true;
+}
+
+
+bool acc_recording_writer_write_frame(acc_recording_writer_t *writer, const void *data, uint16_t data_length,
+                                      uint16_t result_info, uint16_t proximity_power)
+{
+	static const uint8_t padding[ACC_RECORDING_FRAME_ALIGNMENT] = { 0 };
+
+	if (writer == NULL || !writer->started || writer->failed)
+	{
+		return false;
+	}
+
+	acc_recording_header_t *header = &writer->header;
+
+	if (!writer->header_written)
+	{
+		if (header->metadata.data_length == 0)
+		{
+			header->metadata.data_length = data_length;
+			header->frame_record_size    = frame_record_size(data_length * header->sample_size);
+		}
+
+		if (!writer_output(writer, header, sizeof(*header)))
+		{
+			return false;
+		}
+
+		writer->header_written = true;
+	}
+
+	if (data_length != header->metadata.data_length)
+	{
+		if (writer->dropped_frame_count == 0)
+		{
+			ACC_LOG_WARNING("Frame length %u does not match recording length %u, frame dropped",
+			                (unsigned int)data_length, (unsigned int)header->metadata.data_length);
+		}
+
+		writer->dropped_frame_count++;
+		return false;
+	}
+
+	acc_recording_frame_header_t frame_header = {0};
+	size_t                       payload_size = (size_t)data_length * header->sample_size;
+
+	frame_header.sequence_number = writer->sequence_number;
+	frame_header.timestamp_ms    = acc_os_get_time();
+	frame_header.result_info     = result_info;
+	frame_header.proximity_power = proximity_power;
+
+	if (!writer_output(writer, &frame_header, sizeof(frame_header)) ||
+	    !writer_output(writer, data, payload_size))
+	{
+		return false;
+	}
+
+	size_t padding_size = header->frame_record_size - sizeof(frame_header) - payload_size;
+
+	if (padding_size > 0 && !writer_output(writer, padding, padding_size))
+	{
+		return false;
+	}
+
+	writer->sequence_number++;
+
+	return true;
+}
+
+
+static uint16_t result_info_flags(bool missed_data, bool sensor_communication_error, bool data_saturated,
+                                  bool data_quality_warning)
+{
+	uint16_t flags = 0;
+
+	if (missed_data)
+	{
+		flags |= ACC_RECORDING_RESULT_INFO_MISSED_DATA;
+	}
+
+	if (sensor_communication_error)
+	{
+		flags |= ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR;
+	}
+
+	if (data_saturated)
+	{
+		flags |= ACC_RECORDING_RESULT_INFO_DATA_SATURATED;
+	}
+
+	if (data_quality_warning)
+	{
+		flags |= ACC_RECORDING_RESULT_INFO_DATA_QUALITY_WARNING;
+	}
+
+	return flags;
+}
+
+
+uint16_t acc_recording_writer_envelope_result_info(const acc_service_envelope_result_info_t *result_info)
+{
+	if (result_info == NULL)
+	{
+		return 0;
+	}
+
+	return result_info_flags(result_info->missed_data, result_info->sensor_communication_error,
+	                         result_info->data_saturated, result_info->data_quality_warning);
+}
+
+
+uint16_t acc_recording_writer_iq_result_info(const acc_service_iq_result_info_t *result_info)
+{
+	if (result_info == NULL)
+	{
+		return 0;
+	}
+
+	return result_info_flags(result_info->missed_data, result_info->sensor_communication_error,
+	                         result_info->data_saturated, result_info->data_quality_warning);
+}
+
+
+uint16_t acc_recording_writer_sparse_result_info(const acc_service_sparse_result_info_t *result_info)
+{
+	if (result_info == NULL)
+	{
+		return 0;
+	}
+
+	return result_info_flags(result_info->missed_data, result_info->sensor_communication_error,
+	                         result_info->data_saturated, false);
+}
+
+
+uint16_t acc_recording_writer_power_bins_result_info(const acc_service_power_bins_result_info_t *result_info)
+{
+	if (result_info == NULL)
+	{
+		return 0;
+	}
+
+	return result_info_flags(result_info->missed_data, result_info->sensor_communication_error,
+	                         result_info->data_saturated, result_info->data_quality_warning);
+}
+
+
+void acc_recording_writer_presence_service_data_callback(const uint16_t *data, size_t data_size, void *client_reference)
+{
+	acc_recording_writer_t *writer = client_reference;
+
+	acc_recording_writer_write_frame(writer, data, (uint16_t)(data_size / sizeof(uint16_t)), 0, 0);
+}
+
+
+void acc_recording_writer_distance_set(acc_recording_writer_t *writer)
+{
+	distance_writer = writer;
+}
+
+
+void acc_recording_writer_distance_service_data_callback(const uint16_t *data, uint16_t data_length)
+{
+	acc_recording_writer_write_frame(distance_writer, data, data_length, 0, 0);
+}
@@ -0,0 +1,2041 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <complex.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "acc_base_configuration.h"
+#include "acc_definitions.h"
+#include "acc_device_os.h"
+#include "acc_hal_definitions.h"
+#include "acc_log.h"
+#include "acc_recording.h"
+#include "acc_recording_reader.h"
+#include "acc_rss.h"
+#include "acc_rss_emulator.h"
+#include "acc_service.h"
+#include "acc_service_envelope.h"
+#include "acc_service_iq.h"
+#include "acc_service_power_bins.h"
+#include "acc_service_sparse.h"
+#include "acc_version.h"
+
+
+/**
+ * @brief The module name
+ */
+#define MODULE "rss_emulator"
+
+
+#define EMULATOR_VERSION "v2.7.1-emulator"
+
+/**
+ * @brief Distance between two points with downsampling factor 1
+ */
+#define ENVELOPE_BASE_STEP_LENGTH_M (0.000484f)
+#define SPARSE_BASE_STEP_LENGTH_M   (0.06f)
+
+/**
+ * @brief Longest range measured without stitching, approximation of the sensor behaviour
+ */
+#define STITCH_LENGTH_M (0.3f)
+
+#define MIN_START_M  (-0.7f)
+#define MAX_RANGE_M  (7.0f)
+
+/**
+ * @brief Time to sample one sparse point once, used to estimate the maximum sweep rate
+ */
+#define SPARSE_SAMPLE_TIME_US (1.0f)
+
+#define SPARSE_MAX_SWEEPS_PER_FRAME_MODE_B 64
+
+#define WAVELENGTH_M (0.005f)
+
+#define DEFAULT_SEED 0xacc0acc0U
+
+#define PI_F (3.14159265f)
+
+
+typedef enum
+{
+	SERVICE_TYPE_ENVELOPE,
+	SERVICE_TYPE_IQ,
+	SERVICE_TYPE_SPARSE,
+	SERVICE_TYPE_POWER_BINS,
+} service_type_t;
+
+
+struct acc_base_configuration
+{
+	acc_sensor_id_t       sensor_id;
+	float                 requested_start_m;
+	float                 requested_length_m;
+	bool                  streaming;
+	float                 update_rate;
+	acc_power_save_mode_t power_save_mode;
+	float                 receiver_gain;
+	bool                  tx_disable;
+	uint8_t               hw_accelerated_average_samples;
+	bool                  asynchronous_measurement;
+	acc_service_profile_t profile;
+	bool                  maximize_signal_attenuation;
+};
+
+
+struct acc_service_configuration
+{
+	service_type_t                     type;
+	struct acc_base_configuration      base;
+	uint16_t                           downsampling_factor;
+	bool                               noise_level_normalization;
+	float                              running_average_factor;
+	bool                               depth_lowpass_cutoff_ratio_override;
+	float                              depth_lowpass_cutoff_ratio;
+	bool                               proximity_power;
+	acc_service_iq_output_format_t     output_format;
+	uint16_t                           sweeps_per_frame;
+	float                              sweep_rate;
+	acc_service_sparse_sampling_mode_t sampling_mode;
+	uint16_t                           min_service_memory_size;
+	uint16_t                           requested_bin_count;
+};
+
+
+struct acc_service_handle
+{
+	struct acc_service_configuration configuration;
+
+	float    start_m;
+	float    length_m;
+	float    step_length_m;
+	float    sweep_rate;
+	float    depth_lowpass_cutoff_ratio;
+	uint16_t data_length;
+	uint16_t stitch_count;
+	uint16_t points_per_sweep;
+
+	bool     active;
+	int      fd;
+	off_t    file_size;
+	off_t    file_offset;
+	uint32_t random_state;
+	uint32_t frame_index;
+
+	acc_recording_reader_t recording;
+	uint32_t               recording_frame;
+	uint16_t               proximity_power;
+
+	uint32_t frame_period_us;
+	uint64_t next_frame_time_us;
+	uint64_t frame_returned_time_us;
+
+	acc_rss_emulator_statistics_t statistics;
+
+	size_t   frame_size;
+	uint8_t  *frame;
+};
+
+
+static const acc_hal_t *rss_hal;
+
+static acc_log_level_t rss_log_level = ACC_LOG_LEVEL_INFO;
+
+static bool sensor_id_check_override;
+
+static bool sensor_in_use[ACC_SENSOR_ID_MAX];
+
+static bool                      calibration_valid[ACC_SENSOR_ID_MAX];
+static acc_calibration_context_t calibration_context[ACC_SENSOR_ID_MAX];
+
+static const char *source_path[ACC_SENSOR_ID_MAX];
+
+static bool     pacing_enabled = true;
+static uint32_t synthetic_seed = DEFAULT_SEED;
+
+
+static uint64_t get_time_us(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+
+static uint32_t random_next(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+
+static bool sensor_id_valid(acc_sensor_id_t sensor_id)
+{
+	return rss_hal != NULL && sensor_id >= 1 && sensor_id <= rss_hal->properties.sensor_count && sensor_id <= ACC_SENSOR_ID_MAX;
+}
+
+
+static void *emulator_alloc(size_t size)
+{
+	void *ptr = rss_hal->os.mem_alloc(size);
+
+	if (ptr != NULL)
+	{
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+
+static const char *source_path_get(acc_sensor_id_t sensor_id)
+{
+	const char *path = source_path[sensor_id - 1];
+
+	if (path == NULL)
+	{
+		path = getenv("ACC_RSS_EMULATOR_SOURCE");
+	}
+
+	return path;
+}
+
+
+//-----------------------------
+// RSS
+//-----------------------------
+
+
+const char *acc_version_get(void)
+{
+	return EMULATOR_VERSION;
+}
+
+
+bool acc_rss_activate(const acc_hal_t *hal)
+{
+	if (rss_hal != NULL)
+	{
+		ACC_LOG_ERROR("RSS already activated");
+		return false;
+	}
+
+	if (hal == NULL || hal->os.mem_alloc == NULL || hal->os.mem_free == NULL || hal->properties.sensor_count == 0)
+	{
+		ACC_LOG_ERROR("Invalid HAL");
+		return false;
+	}
+
+	const char *free_run = getenv("ACC_RSS_EMULATOR_FREE_RUN");
+
+	if (free_run != NULL && strcmp(free_run, "1") == 0)
+	{
+		pacing_enabled = false;
+	}
+
+	rss_log_level = hal->log.log_level;
+	rss_hal       = hal;
+
+	return true;
+}
+
+
+void acc_rss_deactivate(void)
+{
+	memset(sensor_in_use, 0, sizeof(sensor_in_use));
+	memset(calibration_valid, 0, sizeof(calibration_valid));
+	rss_hal = NULL;
+}
+
+
+bool acc_rss_calibration_context_get(acc_sensor_id_t sensor_id, acc_calibration_context_t *context)
+{
+	if (!sensor_id_valid(sensor_id) || context == NULL || !calibration_valid[sensor_id - 1])
+	{
+		return false;
+	}
+
+	*context = calibration_context[sensor_id - 1];
+
+	return true;
+}
+
+
+bool acc_rss_calibration_context_set(acc_sensor_id_t sensor_id, acc_calibration_context_t *context)
+{
+	if (!sensor_id_valid(sensor_id) || context == NULL || calibration_valid[sensor_id - 1])
+	{
+		return false;
+	}
+
+	calibration_context[sensor_id - 1] = *context;
+	calibration_valid[sensor_id - 1]   = true;
+
+	return true;
+}
+
+
+bool acc_rss_calibration_context_forced_set(acc_sensor_id_t sensor_id, acc_calibration_context_t *context)
+{
+	if (!sensor_id_valid(sensor_id) || context == NULL)
+	{
+		return false;
+	}
+
+	calibration_context[sensor_id - 1] = *context;
+	calibration_valid[sensor_id - 1]   = true;
+
+	return true;
+}
+
+
+bool acc_rss_calibration_reset(acc_sensor_id_t sensor_id)
+{
+	if (!sensor_id_valid(sensor_id) || sensor_in_use[sensor_id - 1])
+	{
+		return false;
+	}
+
+	calibration_valid[sensor_id - 1] = false;
+
+	return true;
+}
+
+
+void acc_rss_override_sensor_id_check_at_creation(bool enable_override)
+{
+	sensor_id_check_override = enable_override;
+}
+
+
+void acc_rss_log_level_set(acc_log_level_t level)
+{
+	rss_log_level = level;
+}
+
+
+//-----------------------------
+// Emulator control
+//-----------------------------
+
+
+bool acc_rss_emulator_source_set(acc_sensor_id_t sensor_id, const char *path)
+{
+	if (sensor_id < 1 || sensor_id > ACC_SENSOR_ID_MAX)
+	{
+		return false;
+	}
+
+	source_path[sensor_id - 1] = path;
+
+	return true;
+}
+
+
+void acc_rss_emulator_pacing_set(bool enable)
+{
+	pacing_enabled = enable;
+}
+
+
+void acc_rss_emulator_seed_set(uint32_t seed)
+{
+	synthetic_seed = seed != 0 ? seed : DEFAULT_SEED;
+}
+
+
+void acc_rss_emulator_statistics_get(acc_service_handle_t handle, acc_rss_emulator_statistics_t *statistics)
+{
+	if (handle != NULL && statistics != NULL)
+	{
+		*statistics = handle->statistics;
+	}
+}
+
+
+//-----------------------------
+// Base configuration
+//-----------------------------
+
+
+acc_sensor_id_t acc_base_configuration_sensor_get(acc_base_configuration_t configuration)
+{
+	return configuration->sensor_id;
+}
+
+
+void acc_base_configuration_sensor_set(acc_base_configuration_t configuration, acc_sensor_id_t sensor_id)
+{
+	configuration->sensor_id = sensor_id;
+}
+
+
+float acc_base_configuration_requested_start_get(acc_base_configuration_t configuration)
+{
+	return configuration->requested_start_m;
+}
+
+
+void acc_base_configuration_requested_start_set(acc_base_configuration_t configuration, float start_m)
+{
+	configuration->requested_start_m = start_m;
+}
+
+
+float acc_base_configuration_requested_length_get(acc_base_configuration_t configuration)
+{
+	return configuration->requested_length_m;
+}
+
+
+void acc_base_configuration_requested_length_set(acc_base_configuration_t configuration, float length_m)
+{
+	configuration->requested_length_m = length_m;
+}
+
+
+void acc_base_configuration_repetition_mode_on_demand_set(acc_base_configuration_t configuration)
+{
+	configuration->streaming   = false;
+	configuration->update_rate = 0.0f;
+}
+
+
+void acc_base_configuration_repetition_mode_streaming_set(acc_base_configuration_t configuration, float update_rate)
+{
+	configuration->streaming   = true;
+	configuration->update_rate = update_rate;
+}
+
+
+acc_power_save_mode_t acc_base_configuration_power_save_mode_get(acc_base_configuration_t configuration)
+{
+	return configuration->power_save_mode;
+}
+
+
+void acc_base_configuration_power_save_mode_set(acc_base_configuration_t configuration,
+                                                acc_power_save_mode_t    power_save_mode)
+{
+	configuration->power_save_mode = power_save_mode;
+}
+
+
+float acc_base_configuration_receiver_gain_get(acc_base_configuration_t configuration)
+{
+	return configuration->receiver_gain;
+}
+
+
+void acc_base_configuration_receiver_gain_set(acc_base_configuration_t configuration, float gain)
+{
+	configuration->receiver_gain = gain;
+}
+
+
+bool acc_base_configuration_tx_disable_get(acc_base_configuration_t configuration)
+{
+	return configuration->tx_disable;
+}
+
+
+void acc_base_configuration_tx_disable_set(acc_base_configuration_t configuration, bool tx_disable)
+{
+	configuration->tx_disable = tx_disable;
+}
+
+
+uint8_t acc_base_configuration_hw_accelerated_average_samples_get(acc_base_configuration_t configuration)
+{
+	return configuration->hw_accelerated_average_samples;
+}
+
+
+void acc_base_configuration_hw_accelerated_average_samples_set(acc_base_configuration_t configuration, uint8_t samples)
+{
+	configuration->hw_accelerated_average_samples = samples;
+}
+
+
+//-----------------------------
+// Generic service configuration
+//-----------------------------
+
+
+static acc_service_configuration_t configuration_create(service_type_t type)
+{
+	if (rss_hal == NULL)
+	{
+		ACC_LOG_ERROR("RSS not activated");
+		return NULL;
+	}
+
+	acc_service_configuration_t configuration = emulator_alloc(sizeof(*configuration));
+
+	if (configuration == NULL)
+	{
+		return NULL;
+	}
+
+	configuration->type = type;
+
+	configuration->base.sensor_id                      = 1;
+	configuration->base.requested_start_m              = 0.2f;
+	configuration->base.requested_length_m             = 0.4f;
+	configuration->base.streaming                      = false;
+	configuration->base.update_rate                    = 0.0f;
+	configuration->base.power_save_mode                = ACC_POWER_SAVE_MODE_ACTIVE;
+	configuration->base.receiver_gain                  = 0.7f;
+	configuration->base.tx_disable                     = false;
+	configuration->base.hw_accelerated_average_samples = 10;
+	configuration->base.asynchronous_measurement       = true;
+	configuration->base.profile                        = ACC_SERVICE_PROFILE_2;
+	configuration->base.maximize_signal_attenuation    = false;
+
+	configuration->downsampling_factor       = 1;
+	configuration->noise_level_normalization = true;
+	configuration->running_average_factor    = 0.7f;
+	configuration->output_format             = ACC_SERVICE_IQ_OUTPUT_FORMAT_FLOAT_COMPLEX;
+	configuration->sweeps_per_frame          = 16;
+	configuration->sweep_rate                = 0.0f;
+	configuration->sampling_mode             = ACC_SERVICE_SPARSE_SAMPLING_MODE_A;
+	configuration->min_service_memory_size   = 4096;
+	configuration->requested_bin_count       = 5;
+
+	if (type == SERVICE_TYPE_SPARSE)
+	{
+		configuration->base.profile = ACC_SERVICE_PROFILE_3;
+	}
+
+	return configuration;
+}
+
+
+static void configuration_destroy(acc_service_configuration_t *configuration, service_type_t type)
+{
+	if (configuration == NULL || *configuration == NULL)
+	{
+		return;
+	}
+
+	if ((*configuration)->type != type)
+	{
+		ACC_LOG_ERROR("Wrong configuration type");
+		return;
+	}
+
+	rss_hal->os.mem_free(*configuration);
+	*configuration = NULL;
+}
+
+
+acc_base_configuration_t acc_service_get_base_configuration(acc_service_configuration_t service_configuration)
+{
+	if (service_configuration == NULL)
+	{
+		return NULL;
+	}
+
+	return &service_configuration->base;
+}
+
+
+acc_sensor_id_t acc_service_sensor_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_sensor_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_sensor_set(acc_service_configuration_t configuration, acc_sensor_id_t sensor_id)
+{
+	acc_base_configuration_sensor_set(acc_service_get_base_configuration(configuration), sensor_id);
+}
+
+
+float acc_service_requested_start_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_requested_start_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_requested_start_set(acc_service_configuration_t configuration, float start_m)
+{
+	acc_base_configuration_requested_start_set(acc_service_get_base_configuration(configuration), start_m);
+}
+
+
+float acc_service_requested_length_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_requested_length_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_requested_length_set(acc_service_configuration_t configuration, float length_m)
+{
+	acc_base_configuration_requested_length_set(acc_service_get_base_configuration(configuration), length_m);
+}
+
+
+void acc_service_repetition_mode_on_demand_set(acc_service_configuration_t configuration)
+{
+	acc_base_configuration_repetition_mode_on_demand_set(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_repetition_mode_streaming_set(acc_service_configuration_t configuration, float update_rate)
+{
+	acc_base_configuration_repetition_mode_streaming_set(acc_service_get_base_configuration(configuration), update_rate);
+}
+
+
+acc_power_save_mode_t acc_service_power_save_mode_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_power_save_mode_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_power_save_mode_set(acc_service_configuration_t configuration,
+                                     acc_power_save_mode_t       power_save_mode)
+{
+	acc_base_configuration_power_save_mode_set(acc_service_get_base_configuration(configuration), power_save_mode);
+}
+
+
+float acc_service_receiver_gain_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_receiver_gain_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_receiver_gain_set(acc_service_configuration_t configuration, float gain)
+{
+	acc_base_configuration_receiver_gain_set(acc_service_get_base_configuration(configuration), gain);
+}
+
+
+bool acc_service_tx_disable_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_tx_disable_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_tx_disable_set(acc_service_configuration_t configuration, bool tx_disable)
+{
+	acc_base_configuration_tx_disable_set(acc_service_get_base_configuration(configuration), tx_disable);
+}
+
+
+uint8_t acc_service_hw_accelerated_average_samples_get(acc_service_configuration_t configuration)
+{
+	return acc_base_configuration_hw_accelerated_average_samples_get(acc_service_get_base_configuration(configuration));
+}
+
+
+void acc_service_hw_accelerated_average_samples_set(acc_service_configuration_t configuration, uint8_t samples)
+{
+	acc_base_configuration_hw_accelerated_average_samples_set(acc_service_get_base_configuration(configuration), samples);
+}
+
+
+bool acc_service_asynchronous_measurement_get(acc_service_configuration_t configuration)
+{
+	return configuration->base.asynchronous_measurement;
+}
+
+
+void acc_service_asynchronous_measurement_set(acc_service_configuration_t configuration, bool asynchronous_measurement)
+{
+	configuration->base.asynchronous_measurement = asynchronous_measurement;
+}
+
+
+acc_service_profile_t acc_service_profile_get(acc_service_configuration_t service_configuration)
+{
+	if (service_configuration == NULL)
+	{
+		return 0;
+	}
+
+	return service_configuration->base.profile;
+}
+
+
+void acc_service_profile_set(acc_service_configuration_t service_configuration,
+                             acc_service_profile_t       profile)
+{
+	service_configuration->base.profile = profile;
+}
+
+
+bool acc_service_maximize_signal_attenuation_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->base.maximize_signal_attenuation;
+}
+
+
+void acc_service_maximize_signal_attenuation_set(acc_service_configuration_t service_configuration,
+                                                 bool                        maximize_signal_attenuation)
+{
+	service_configuration->base.maximize_signal_attenuation = maximize_signal_attenuation;
+}
+
+
+//-----------------------------
+// Generic service
+//-----------------------------
+
+
+static bool configuration_valid(const struct acc_service_configuration *configuration)
+{
+	const struct acc_base_configuration *base = &configuration->base;
+
+	if (!sensor_id_valid(base->sensor_id))
+	{
+		ACC_LOG_ERROR("Invalid sensor id %" PRIsensor_id, base->sensor_id);
+		return false;
+	}
+
+	if (base->requested_length_m <= 0.0f || base->requested_start_m < MIN_START_M ||
+	    base->requested_start_m + base->requested_length_m > MAX_RANGE_M)
+	{
+		ACC_LOG_ERROR("Invalid range");
+		return false;
+	}
+
+	if (base->streaming && base->update_rate <= 0.0f)
+	{
+		ACC_LOG_ERROR("Invalid update rate");
+		return false;
+	}
+
+	if (base->hw_accelerated_average_samples < 1 || base->hw_accelerated_average_samples > 63)
+	{
+		ACC_LOG_ERROR("Invalid hardware accelerated average samples");
+		return false;
+	}
+
+	if (base->receiver_gain < 0.0f || base->receiver_gain > 1.0f)
+	{
+		ACC_LOG_ERROR("Invalid receiver gain");
+		return false;
+	}
+
+	if (base->profile < ACC_SERVICE_PROFILE_1 || base->profile > ACC_SERVICE_PROFILE_5)
+	{
+		ACC_LOG_ERROR("Invalid profile");
+		return false;
+	}
+
+	uint16_t downsampling_factor = configuration->downsampling_factor;
+
+	switch (configuration->type)
+	{
+		case SERVICE_TYPE_ENVELOPE:
+		case SERVICE_TYPE_IQ:
+		case SERVICE_TYPE_POWER_BINS:
+			if (downsampling_factor != 1 && downsampling_factor != 2 && downsampling_factor != 4)
+			{
+				ACC_LOG_ERROR("Invalid downsampling factor");
+				return false;
+			}
+
+			break;
+		case SERVICE_TYPE_SPARSE:
+			if (downsampling_factor < 1)
+			{
+				ACC_LOG_ERROR("Invalid downsampling factor");
+				return false;
+			}
+
+			if (configuration->sweeps_per_frame < 1 ||
+			    (configuration->sampling_mode == ACC_SERVICE_SPARSE_SAMPLING_MODE_B &&
+			     configuration->sweeps_per_frame > SPARSE_MAX_SWEEPS_PER_FRAME_MODE_B))
+			{
+				ACC_LOG_ERROR("Invalid sweeps per frame");
+				return false;
+			}
+
+			break;
+	}
+
+	if (configuration->type == SERVICE_TYPE_POWER_BINS && configuration->requested_bin_count < 1)
+	{
+		ACC_LOG_ERROR("Invalid bin count");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Derive the metadata of a service from its configuration
+ */
+static bool calculate_metadata(acc_service_handle_t handle)
+{
+	const struct acc_service_configuration *configuration = &handle->configuration;
+	float                                  base_step_length;
+
+	if (configuration->type == SERVICE_TYPE_SPARSE)
+	{
+		base_step_length = SPARSE_BASE_STEP_LENGTH_M;
+	}
+	else
+	{
+		base_step_length = ENVELOPE_BASE_STEP_LENGTH_M;
+	}
+
+	float step_length = base_step_length * configuration->downsampling_factor;
+	float start_point = roundf(configuration->base.requested_start_m / base_step_length);
+	float points      = ceilf(configuration->base.requested_length_m / step_length);
+
+	if (points < 1.0f)
+	{
+		points = 1.0f;
+	}
+
+	handle->start_m          = start_point * base_step_length;
+	handle->length_m         = points * step_length;
+	handle->step_length_m    = step_length;
+	handle->points_per_sweep = (uint16_t)points;
+	handle->stitch_count     = 0;
+
+	if (configuration->type != SERVICE_TYPE_SPARSE)
+	{
+		handle->stitch_count = (uint16_t)ceilf(handle->length_m / STITCH_LENGTH_M) - 1;
+	}
+
+	if (handle->stitch_count > 0 && configuration->base.streaming)
+	{
+		ACC_LOG_ERROR("Stitching requires on demand repetition mode");
+		return false;
+	}
+
+	uint32_t data_length = handle->points_per_sweep;
+
+	switch (configuration->type)
+	{
+		case SERVICE_TYPE_ENVELOPE:
+			handle->frame_size = data_length * sizeof(uint16_t);
+			break;
+		case SERVICE_TYPE_IQ:
+			handle->frame_size = data_length * sizeof(acc_int16_complex_t);
+
+			if (configuration->depth_lowpass_cutoff_ratio_override)
+			{
+				handle->depth_lowpass_cutoff_ratio = configuration->depth_lowpass_cutoff_ratio;
+			}
+			else
+			{
+				handle->depth_lowpass_cutoff_ratio = 0.5f / configuration->downsampling_factor;
+			}
+
+			break;
+		case SERVICE_TYPE_SPARSE:
+			data_length *= configuration->sweeps_per_frame;
+			handle->frame_size = data_length * sizeof(uint16_t);
+
+			if (configuration->sweep_rate > 0.0f)
+			{
+				handle->sweep_rate = configuration->sweep_rate;
+			}
+			else
+			{
+				float sweep_time_us = handle->points_per_sweep * configuration->base.hw_accelerated_average_samples *
+				                      SPARSE_SAMPLE_TIME_US;
+				handle->sweep_rate = 1000000.0f / sweep_time_us;
+			}
+
+			break;
+		case SERVICE_TYPE_POWER_BINS:
+			data_length            = configuration->requested_bin_count;
+			handle->frame_size     = data_length * sizeof(uint16_t);
+			handle->step_length_m  = handle->length_m / data_length;
+			break;
+	}
+
+	if (data_length > UINT16_MAX)
+	{
+		ACC_LOG_ERROR("Too much data");
+		return false;
+	}
+
+	handle->data_length = data_length;
+
+	return true;
+}
+
+
+static acc_recording_service_type_t recording_service_type(service_type_t type)
+{
+	switch (type)
+	{
+		case SERVICE_TYPE_ENVELOPE:
+			return ACC_RECORDING_SERVICE_TYPE_ENVELOPE;
+		case SERVICE_TYPE_IQ:
+			return ACC_RECORDING_SERVICE_TYPE_IQ;
+		case SERVICE_TYPE_SPARSE:
+			return ACC_RECORDING_SERVICE_TYPE_SPARSE;
+		case SERVICE_TYPE_POWER_BINS:
+			return ACC_RECORDING_SERVICE_TYPE_POWER_BINS;
+	}
+
+	return 0;
+}
+
+
+static bool is_recording(const char *path)
+{
+	uint32_t magic = 0;
+	int      fd    = open(path, O_RDONLY);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	ssize_t length = pread(fd, &magic, sizeof(magic), 0);
+
+	close(fd);
+
+	return length == (ssize_t)sizeof(magic) && magic == ACC_RECORDING_MAGIC;
+}
+
+
+/**
+ * @brief Use a recording as source, the metadata is taken from the recording
+ */
+static bool recording_open(acc_service_handle_t handle, const char *path)
+{
+	handle->recording = acc_recording_reader_open(path);
+
+	if (handle->recording == NULL)
+	{
+		return false;
+	}
+
+	const acc_recording_header_t *header = acc_recording_reader_header_get(handle->recording);
+
+	if (header->service_type != recording_service_type(handle->configuration.type))
+	{
+		ACC_LOG_ERROR("%s was recorded with another service type", path);
+		acc_recording_reader_close(&handle->recording);
+		return false;
+	}
+
+	if (acc_recording_reader_frame_count(handle->recording) == 0)
+	{
+		ACC_LOG_ERROR("%s does not contain any frames", path);
+		acc_recording_reader_close(&handle->recording);
+		return false;
+	}
+
+	const acc_recording_metadata_t *metadata = &header->metadata;
+
+	handle->start_m                    = metadata->start_m;
+	handle->length_m                   = metadata->length_m;
+	handle->step_length_m              = metadata->step_length_m;
+	handle->sweep_rate                 = metadata->sweep_rate;
+	handle->depth_lowpass_cutoff_ratio = metadata->depth_lowpass_cutoff_ratio;
+	handle->data_length                = metadata->data_length;
+	handle->stitch_count               = metadata->stitch_count;
+	handle->frame_size                 = (size_t)metadata->data_length * header->sample_size;
+
+	return true;
+}
+
+
+acc_service_handle_t acc_service_create(acc_service_configuration_t configuration)
+{
+	if (rss_hal == NULL)
+	{
+		ACC_LOG_ERROR("RSS not activated");
+		return NULL;
+	}
+
+	if (configuration == NULL || !configuration_valid(configuration))
+	{
+		return NULL;
+	}
+
+	acc_sensor_id_t sensor_id = configuration->base.sensor_id;
+
+	if (sensor_in_use[sensor_id - 1] && !sensor_id_check_override)
+	{
+		ACC_LOG_ERROR("Sensor %" PRIsensor_id " already in use", sensor_id);
+		return NULL;
+	}
+
+	acc_service_handle_t handle = emulator_alloc(sizeof(*handle));
+
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	handle->configuration = *configuration;
+	handle->fd            = -1;
+
+	if (!calculate_metadata(handle))
+	{
+		rss_hal->os.mem_free(handle);
+		return NULL;
+	}
+
+	const char *path = source_path_get(sensor_id);
+
+	if (path != NULL && is_recording(path) && !recording_open(handle, path))
+	{
+		rss_hal->os.mem_free(handle);
+		return NULL;
+	}
+
+	handle->frame = emulator_alloc(handle->frame_size);
+
+	if (handle->frame == NULL)
+	{
+		acc_recording_reader_close(&handle->recording);
+		rss_hal->os.mem_free(handle);
+		return NULL;
+	}
+
+	sensor_in_use[sensor_id - 1] = true;
+
+	return handle;
+}
+
+
+static bool source_open(acc_service_handle_t handle)
+{
+	acc_sensor_id_t sensor_id = handle->configuration.base.sensor_id;
+	const char      *path     = source_path_get(sensor_id);
+
+	handle->random_state    = synthetic_seed + sensor_id;
+	handle->frame_index     = 0;
+	handle->file_offset     = 0;
+	handle->recording_frame = 0;
+
+	if (path == NULL || handle->recording != NULL)
+	{
+		return true;
+	}
+
+	handle->fd = open(path, O_RDONLY);
+
+	if (handle->fd < 0)
+	{
+		ACC_LOG_ERROR("Unable to open %s", path);
+		return false;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(handle->fd, &file_stat) != 0 || (size_t)file_stat.st_size < handle->frame_size)
+	{
+		ACC_LOG_ERROR("%s does not contain a frame of %u bytes", path, (unsigned int)handle->frame_size);
+		close(handle->fd);
+		handle->fd = -1;
+		return false;
+	}
+
+	if ((size_t)file_stat.st_size % handle->frame_size != 0)
+	{
+		ACC_LOG_WARNING("Size of %s is not a multiple of the frame size", path);
+	}
+
+	handle->file_size = file_stat.st_size;
+
+	return true;
+}
+
+
+static void source_close(acc_service_handle_t handle)
+{
+	if (handle->fd >= 0)
+	{
+		close(handle->fd);
+		handle->fd = -1;
+	}
+}
+
+
+bool acc_service_activate(acc_service_handle_t service_handle)
+{
+	if (service_handle == NULL || service_handle->active)
+	{
+		return false;
+	}
+
+	if (!source_open(service_handle))
+	{
+		return false;
+	}
+
+	acc_sensor_id_t sensor_id = service_handle->configuration.base.sensor_id;
+
+	if (!calibration_valid[sensor_id - 1])
+	{
+		// Produce a context that identifies the sensor
+		for (size_t i = 0; i < sizeof(calibration_context[0].data); i++)
+		{
+			calibration_context[sensor_id - 1].data[i] = (uint8_t)(sensor_id + i);
+		}
+
+		calibration_valid[sensor_id - 1] = true;
+	}
+
+	memset(&service_handle->statistics, 0, sizeof(service_handle->statistics));
+
+	service_handle->frame_period_us = 0;
+	if (service_handle->configuration.base.streaming)
+	{
+		service_handle->frame_period_us = (uint32_t)(1000000.0f / service_handle->configuration.base.update_rate);
+	}
+
+	service_handle->next_frame_time_us = get_time_us() + service_handle->frame_period_us;
+	service_handle->active             = true;
+
+	return true;
+}
+
+
+bool acc_service_deactivate(acc_service_handle_t service_handle)
+{
+	if (service_handle == NULL || !service_handle->active)
+	{
+		return false;
+	}
+
+	source_close(service_handle);
+	service_handle->active = false;
+
+	const acc_rss_emulator_statistics_t *statistics = &service_handle->statistics;
+
+	if (rss_log_level >= ACC_LOG_LEVEL_INFO && statistics->frame_count > 1)
+	{
+		uint32_t average_us = (uint32_t)(statistics->processing_time_us / (statistics->frame_count - 1));
+
+		ACC_LOG_INFO("%" PRIu32 " frames, %" PRIu32 " missed, processing time %" PRIu32 " us average %" PRIu32 " us max, frame period %" PRIu32 " us",
+		             statistics->frame_count, statistics->missed_frame_count, average_us, statistics->max_processing_time_us,
+		             service_handle->frame_period_us);
+	}
+
+	return true;
+}
+
+
+void acc_service_destroy(acc_service_handle_t *service_handle)
+{
+	if (service_handle == NULL || *service_handle == NULL)
+	{
+		return;
+	}
+
+	if ((*service_handle)->active)
+	{
+		acc_service_deactivate(*service_handle);
+	}
+
+	sensor_in_use[(*service_handle)->configuration.base.sensor_id - 1] = false;
+
+	acc_recording_reader_close(&(*service_handle)->recording);
+	rss_hal->os.mem_free((*service_handle)->frame);
+	rss_hal->os.mem_free(*service_handle);
+	*service_handle = NULL;
+}
+
+
+//-----------------------------
+// Frame production
+//-----------------------------
+
+
+/**
+ * @brief Distance to the emulated reflector, which moves slowly back and forth within the range
+ */
+static float reflector_distance(acc_service_handle_t handle)
+{
+	float phase = 2.0f * PI_F * (float)(handle->frame_index % 200) / 200.0f;
+
+	return handle->start_m + handle->length_m * (0.5f + 0.25f * sinf(phase));
+}
+
+
+static float reflector_amplitude(float distance, float reflector, float width)
+{
+	float x = (distance - reflector) / width;
+
+	return expf(-x * x);
+}
+
+
+static uint16_t random_noise(acc_service_handle_t handle, uint16_t range)
+{
+	return (uint16_t)(random_next(&handle->random_state) % range);
+}
+
+
+static void generate_frame(acc_service_handle_t handle)
+{
+	const struct acc_service_configuration *configuration = &handle->configuration;
+	float                                  reflector      = reflector_distance(handle);
+	float                                  gain           = configuration->base.tx_disable ? 0.0f : configuration->base.receiver_gain;
+	uint16_t                               *data          = (uint16_t *)handle->frame;
+
+	switch (configuration->type)
+	{
+		case SERVICE_TYPE_ENVELOPE:
+		case SERVICE_TYPE_POWER_BINS:
+			for (uint16_t i = 0; i < handle->data_length; i++)
+			{
+				float distance  = handle->start_m + (i + 0.5f) * handle->step_length_m;
+				float amplitude = 2000.0f * gain * reflector_amplitude(distance, reflector, 0.03f);
+
+				data[i] = (uint16_t)(200.0f + amplitude) + random_noise(handle, 64);
+			}
+
+			break;
+		case SERVICE_TYPE_IQ:
+		{
+			acc_int16_complex_t *iq = (acc_int16_complex_t *)handle->frame;
+
+			for (uint16_t i = 0; i < handle->data_length; i++)
+			{
+				float distance  = handle->start_m + i * handle->step_length_m;
+				float amplitude = 2000.0f * gain * reflector_amplitude(distance, reflector, 0.03f);
+				float phase     = 4.0f * PI_F * (distance - reflector) / WAVELENGTH_M;
+
+				iq[i].real = (int16_t)(amplitude * cosf(phase)) + (int16_t)random_noise(handle, 33) - 16;
+				iq[i].imag = (int16_t)(amplitude * sinf(phase)) + (int16_t)random_noise(handle, 33) - 16;
+			}
+
+			break;
+		}
+		case SERVICE_TYPE_SPARSE:
+			for (uint16_t sweep = 0; sweep < configuration->sweeps_per_frame; sweep++)
+			{
+				float time = (float)((uint32_t)handle->frame_index * configuration->sweeps_per_frame + sweep) / handle->sweep_rate;
+
+				for (uint16_t i = 0; i < handle->points_per_sweep; i++)
+				{
+					float distance  = handle->start_m + i * handle->step_length_m;
+					float amplitude = 500.0f * gain * reflector_amplitude(distance, reflector, 0.1f);
+					float phase     = 2.0f * PI_F * time + 4.0f * PI_F * distance / WAVELENGTH_M;
+
+					data[sweep * handle->points_per_sweep + i] =
+						(uint16_t)(32768.0f + amplitude * sinf(phase)) + random_noise(handle, 128) - 64;
+				}
+			}
+
+			break;
+	}
+}
+
+
+static bool read_frame(acc_service_handle_t handle)
+{
+	if (handle->file_offset + (off_t)handle->frame_size > handle->file_size)
+	{
+		handle->file_offset = 0;
+	}
+
+	ssize_t length = pread(handle->fd, handle->frame, handle->frame_size, handle->file_offset);
+
+	if (length != (ssize_t)handle->frame_size)
+	{
+		ACC_LOG_ERROR("Failed to read frame");
+		return false;
+	}
+
+	handle->file_offset += handle->frame_size;
+
+	return true;
+}
+
+
+static uint16_t read_recording_frame(acc_service_handle_t handle)
+{
+	const void                         *data;
+	const acc_recording_frame_header_t *frame_header =
+		acc_recording_reader_frame_get(handle->recording, handle->recording_frame, &data);
+
+	memcpy(handle->frame, data, handle->frame_size);
+	handle->proximity_power = frame_header->proximity_power;
+	handle->recording_frame = (handle->recording_frame + 1) % acc_recording_reader_frame_count(handle->recording);
+
+	return frame_header->result_info;
+}
+
+
+/**
+ * @brief Skip frames that were produced while the application was busy
+ */
+static void skip_frames(acc_service_handle_t handle, uint32_t frames)
+{
+	handle->frame_index += frames;
+
+	if (handle->recording != NULL)
+	{
+		uint32_t frame_count = acc_recording_reader_frame_count(handle->recording);
+
+		handle->recording_frame = (uint32_t)(((uint64_t)handle->recording_frame + frames) % frame_count);
+	}
+	else if (handle->fd >= 0)
+	{
+		off_t frame_count = handle->file_size / (off_t)handle->frame_size;
+		off_t frame       = (handle->file_offset / (off_t)handle->frame_size + frames) % frame_count;
+
+		handle->file_offset = frame * (off_t)handle->frame_size;
+	}
+}
+
+
+/**
+ * @brief Wait until the next frame is due and produce it in the frame buffer
+ *
+ * The result info of the frame is returned as ACC_RECORDING_RESULT_INFO_* flags.
+ */
+static bool next_frame(acc_service_handle_t handle, uint16_t *result_info)
+{
+	*result_info = 0;
+
+	if (!handle->active)
+	{
+		ACC_LOG_ERROR("Service not active");
+		return false;
+	}
+
+	uint64_t now = get_time_us();
+
+	if (handle->statistics.frame_count > 0)
+	{
+		uint64_t processing_time = now - handle->frame_returned_time_us;
+
+		handle->statistics.processing_time_us += processing_time;
+		if (processing_time > handle->statistics.max_processing_time_us)
+		{
+			handle->statistics.max_processing_time_us = (uint32_t)processing_time;
+		}
+	}
+
+	if (pacing_enabled && handle->frame_period_us > 0)
+	{
+		uint64_t period = handle->frame_period_us;
+
+		if (now >= handle->next_frame_time_us + period)
+		{
+			// The sensor kept producing frames that the application did not fetch in time
+			uint32_t skipped = (uint32_t)((now - handle->next_frame_time_us) / period);
+
+			handle->next_frame_time_us += skipped * period;
+			handle->statistics.missed_frame_count += skipped;
+			skip_frames(handle, skipped);
+			*result_info |= ACC_RECORDING_RESULT_INFO_MISSED_DATA;
+		}
+
+		if (now < handle->next_frame_time_us)
+		{
+			uint64_t wait_time = handle->next_frame_time_us - now;
+
+			acc_os_sleep_ms((uint32_t)((wait_time + 999) / 1000));
+			handle->statistics.wait_time_us += wait_time;
+		}
+
+		handle->next_frame_time_us += period;
+	}
+
+	if (handle->recording != NULL)
+	{
+		*result_info |= read_recording_frame(handle);
+	}
+	else if (handle->fd >= 0)
+	{
+		if (!read_frame(handle))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		generate_frame(handle);
+	}
+
+	handle->frame_index++;
+	handle->statistics.frame_count++;
+	handle->frame_returned_time_us = get_time_us();
+
+	return true;
+}
+
+
+static bool handle_valid(acc_service_handle_t handle, service_type_t type)
+{
+	if (handle == NULL || handle->configuration.type != type)
+	{
+		ACC_LOG_ERROR("Invalid service handle");
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool copy_frame(acc_service_handle_t handle, void *data, uint16_t data_length)
+{
+	if (data == NULL || data_length < handle->data_length)
+	{
+		ACC_LOG_ERROR("Data buffer too small");
+		return false;
+	}
+
+	memcpy(data, handle->frame, handle->frame_size);
+
+	return true;
+}
+
+
+static bool execute_once(acc_service_handle_t handle, uint16_t *result_info)
+{
+	if (!acc_service_activate(handle))
+	{
+		return false;
+	}
+
+	bool success = next_frame(handle, result_info);
+
+	acc_service_deactivate(handle);
+
+	return success;
+}
+
+
+//-----------------------------
+// Envelope
+//-----------------------------
+
+
+acc_service_configuration_t acc_service_envelope_configuration_create(void)
+{
+	return configuration_create(SERVICE_TYPE_ENVELOPE);
+}
+
+
+void acc_service_envelope_configuration_destroy(acc_service_configuration_t *service_configuration)
+{
+	configuration_destroy(service_configuration, SERVICE_TYPE_ENVELOPE);
+}
+
+
+uint16_t acc_service_envelope_downsampling_factor_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->downsampling_factor;
+}
+
+
+void acc_service_envelope_downsampling_factor_set(acc_service_configuration_t service_configuration, uint16_t downsampling_factor)
+{
+	service_configuration->downsampling_factor = downsampling_factor;
+}
+
+
+float acc_service_envelope_running_average_factor_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->running_average_factor;
+}
+
+
+void acc_service_envelope_running_average_factor_set(acc_service_configuration_t service_configuration, float factor)
+{
+	service_configuration->running_average_factor = factor;
+}
+
+
+bool acc_service_envelope_noise_level_normalization_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->noise_level_normalization;
+}
+
+
+void acc_service_envelope_noise_level_normalization_set(acc_service_configuration_t service_configuration, bool noise_level_normalization)
+{
+	service_configuration->noise_level_normalization = noise_level_normalization;
+}
+
+
+void acc_service_envelope_get_metadata(acc_service_handle_t handle, acc_service_envelope_metadata_t *metadata)
+{
+	if (!handle_valid(handle, SERVICE_TYPE_ENVELOPE))
+	{
+		return;
+	}
+
+	metadata->start_m       = handle->start_m;
+	metadata->length_m      = handle->length_m;
+	metadata->data_length   = handle->data_length;
+	metadata->stitch_count  = handle->stitch_count;
+	metadata->step_length_m = handle->step_length_m;
+}
+
+
+static void envelope_result_info_set(acc_service_envelope_result_info_t *result_info, uint16_t flags)
+{
+	if (result_info != NULL)
+	{
+		memset(result_info, 0, sizeof(*result_info));
+		result_info->missed_data                = (flags & ACC_RECORDING_RESULT_INFO_MISSED_DATA) != 0;
+		result_info->sensor_communication_error = (flags & ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR) != 0;
+		result_info->data_saturated             = (flags & ACC_RECORDING_RESULT_INFO_DATA_SATURATED) != 0;
+		result_info->data_quality_warning       = (flags & ACC_RECORDING_RESULT_INFO_DATA_QUALITY_WARNING) != 0;
+	}
+}
+
+
+bool acc_service_envelope_get_next(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                   acc_service_envelope_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_ENVELOPE) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	envelope_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
+
+
+bool acc_service_envelope_get_next_by_reference(acc_service_handle_t handle, uint16_t **data,
+                                                acc_service_envelope_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_ENVELOPE) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	envelope_result_info_set(result_info, flags);
+	*data = (uint16_t *)handle->frame;
+
+	return true;
+}
+
+
+bool acc_service_envelope_execute_once(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                       acc_service_envelope_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_ENVELOPE) || !execute_once(handle, &flags))
+	{
+		return false;
+	}
+
+	envelope_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
+
+
+//-----------------------------
+// IQ
+//-----------------------------
+
+
+acc_service_configuration_t acc_service_iq_configuration_create(void)
+{
+	return configuration_create(SERVICE_TYPE_IQ);
+}
+
+
+void acc_service_iq_configuration_destroy(acc_service_configuration_t *service_configuration)
+{
+	configuration_destroy(service_configuration, SERVICE_TYPE_IQ);
+}
+
+
+void acc_service_iq_depth_lowpass_cutoff_ratio_get(acc_service_configuration_t service_configuration, bool *override, float *cutoff_ratio)
+{
+	*override     = service_configuration->depth_lowpass_cutoff_ratio_override;
+	*cutoff_ratio = service_configuration->depth_lowpass_cutoff_ratio;
+}
+
+
+void acc_service_iq_depth_lowpass_cutoff_ratio_set(acc_service_configuration_t service_configuration,
+                                                   bool                        override,
+                                                   float                       cutoff_ratio)
+{
+	service_configuration->depth_lowpass_cutoff_ratio_override = override;
+	service_configuration->depth_lowpass_cutoff_ratio          = cutoff_ratio;
+}
+
+
+uint16_t acc_service_iq_downsampling_factor_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->downsampling_factor;
+}
+
+
+void acc_service_iq_downsampling_factor_set(acc_service_configuration_t service_configuration, uint16_t downsampling_factor)
+{
+	service_configuration->downsampling_factor = downsampling_factor;
+}
+
+
+bool acc_service_iq_noise_level_normalization_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->noise_level_normalization;
+}
+
+
+void acc_service_iq_noise_level_normalization_set(acc_service_configuration_t service_configuration, bool noise_level_normalization)
+{
+	service_configuration->noise_level_normalization = noise_level_normalization;
+}
+
+
+bool acc_service_iq_proximity_power_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->proximity_power;
+}
+
+
+void acc_service_iq_proximity_power_set(acc_service_configuration_t service_configuration, bool enable)
+{
+	service_configuration->proximity_power = enable;
+}
+
+
+void acc_service_iq_output_format_set(acc_service_configuration_t    service_configuration,
+                                      acc_service_iq_output_format_t format)
+{
+	service_configuration->output_format = format;
+}
+
+
+acc_service_iq_output_format_t acc_service_iq_output_format_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->output_format;
+}
+
+
+void acc_service_iq_get_metadata(acc_service_handle_t handle, acc_service_iq_metadata_t *metadata)
+{
+	if (!handle_valid(handle, SERVICE_TYPE_IQ))
+	{
+		return;
+	}
+
+	metadata->start_m                    = handle->start_m;
+	metadata->length_m                   = handle->length_m;
+	metadata->data_length                = handle->data_length;
+	metadata->stitch_count               = handle->stitch_count;
+	metadata->step_length_m              = handle->step_length_m;
+	metadata->depth_lowpass_cutoff_ratio = handle->depth_lowpass_cutoff_ratio;
+}
+
+
+static void iq_result_info_set(acc_service_handle_t handle, acc_service_iq_result_info_t *result_info, uint16_t flags)
+{
+	if (result_info != NULL)
+	{
+		memset(result_info, 0, sizeof(*result_info));
+		result_info->missed_data                = (flags & ACC_RECORDING_RESULT_INFO_MISSED_DATA) != 0;
+		result_info->sensor_communication_error = (flags & ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR) != 0;
+		result_info->data_saturated             = (flags & ACC_RECORDING_RESULT_INFO_DATA_SATURATED) != 0;
+		result_info->data_quality_warning       = (flags & ACC_RECORDING_RESULT_INFO_DATA_QUALITY_WARNING) != 0;
+
+		if (handle->recording != NULL)
+		{
+			result_info->proximity_power = handle->proximity_power;
+		}
+		else if (handle->configuration.proximity_power)
+		{
+			const acc_int16_complex_t *iq = (const acc_int16_complex_t *)handle->frame;
+
+			result_info->proximity_power = (uint16_t)(abs(iq[0].real) + abs(iq[0].imag));
+		}
+	}
+}
+
+
+static bool iq_copy_frame(acc_service_handle_t handle, void *data, uint16_t data_length)
+{
+	if (handle->configuration.output_format == ACC_SERVICE_IQ_OUTPUT_FORMAT_INT16_COMPLEX)
+	{
+		return copy_frame(handle, data, data_length);
+	}
+
+	if (data == NULL || data_length < handle->data_length)
+	{
+		ACC_LOG_ERROR("Data buffer too small");
+		return false;
+	}
+
+	const acc_int16_complex_t *iq     = (const acc_int16_complex_t *)handle->frame;
+	float complex             *output = data;
+
+	for (uint16_t i = 0; i < handle->data_length; i++)
+	{
+		output[i] = (float)iq[i].real + (float)iq[i].imag * I;
+	}
+
+	return true;
+}
+
+
+bool acc_service_iq_get_next(acc_service_handle_t handle, void *data, uint16_t data_length,
+                             acc_service_iq_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_IQ) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	iq_result_info_set(handle, result_info, flags);
+
+	return iq_copy_frame(handle, data, data_length);
+}
+
+
+bool acc_service_iq_get_next_by_reference(acc_service_handle_t handle, acc_int16_complex_t **data,
+                                          acc_service_iq_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_IQ) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	iq_result_info_set(handle, result_info, flags);
+	*data = (acc_int16_complex_t *)handle->frame;
+
+	return true;
+}
+
+
+bool acc_service_iq_execute_once(acc_service_handle_t handle, void *data, uint16_t data_length,
+                                 acc_service_iq_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_IQ) || !execute_once(handle, &flags))
+	{
+		return false;
+	}
+
+	iq_result_info_set(handle, result_info, flags);
+
+	return iq_copy_frame(handle, data, data_length);
+}
+
+
+//-----------------------------
+// Sparse
+//-----------------------------
+
+
+acc_service_configuration_t acc_service_sparse_configuration_create(void)
+{
+	return configuration_create(SERVICE_TYPE_SPARSE);
+}
+
+
+void acc_service_sparse_configuration_destroy(acc_service_configuration_t *service_configuration)
+{
+	configuration_destroy(service_configuration, SERVICE_TYPE_SPARSE);
+}
+
+
+uint16_t acc_service_sparse_configuration_sweeps_per_frame_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->sweeps_per_frame;
+}
+
+
+void acc_service_sparse_configuration_sweeps_per_frame_set(acc_service_configuration_t service_configuration, uint16_t sweeps)
+{
+	service_configuration->sweeps_per_frame = sweeps;
+}
+
+
+float acc_service_sparse_configuration_sweep_rate_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->sweep_rate;
+}
+
+
+void acc_service_sparse_configuration_sweep_rate_set(acc_service_configuration_t service_configuration, float sweep_rate)
+{
+	service_configuration->sweep_rate = sweep_rate;
+}
+
+
+acc_service_sparse_sampling_mode_t acc_service_sparse_sampling_mode_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->sampling_mode;
+}
+
+
+void acc_service_sparse_sampling_mode_set(acc_service_configuration_t service_configuration, acc_service_sparse_sampling_mode_t sampling_mode)
+{
+	service_configuration->sampling_mode = sampling_mode;
+}
+
+
+uint16_t acc_service_sparse_downsampling_factor_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->downsampling_factor;
+}
+
+
+void acc_service_sparse_downsampling_factor_set(acc_service_configuration_t service_configuration, uint16_t downsampling_factor)
+{
+	service_configuration->downsampling_factor = downsampling_factor;
+}
+
+
+uint16_t acc_service_sparse_min_service_memory_size_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->min_service_memory_size;
+}
+
+
+void acc_service_sparse_min_service_memory_size_set(acc_service_configuration_t service_configuration, uint16_t min_service_memory_size)
+{
+	service_configuration->min_service_memory_size = min_service_memory_size;
+}
+
+
+void acc_service_sparse_get_metadata(acc_service_handle_t handle, acc_service_sparse_metadata_t *metadata)
+{
+	if (!handle_valid(handle, SERVICE_TYPE_SPARSE))
+	{
+		return;
+	}
+
+	metadata->start_m       = handle->start_m;
+	metadata->length_m      = handle->length_m;
+	metadata->data_length   = handle->data_length;
+	metadata->sweep_rate    = handle->sweep_rate;
+	metadata->step_length_m = handle->step_length_m;
+}
+
+
+static void sparse_result_info_set(acc_service_sparse_result_info_t *result_info, uint16_t flags)
+{
+	if (result_info != NULL)
+	{
+		memset(result_info, 0, sizeof(*result_info));
+		result_info->missed_data                = (flags & ACC_RECORDING_RESULT_INFO_MISSED_DATA) != 0;
+		result_info->sensor_communication_error = (flags & ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR) != 0;
+		result_info->data_saturated             = (flags & ACC_RECORDING_RESULT_INFO_DATA_SATURATED) != 0;
+	}
+}
+
+
+bool acc_service_sparse_get_next(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                 acc_service_sparse_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_SPARSE) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	sparse_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
+
+
+bool acc_service_sparse_get_next_by_reference(acc_service_handle_t handle, uint16_t **data,
+                                              acc_service_sparse_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_SPARSE) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	sparse_result_info_set(result_info, flags);
+	*data = (uint16_t *)handle->frame;
+
+	return true;
+}
+
+
+bool acc_service_sparse_execute_once(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                     acc_service_sparse_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_SPARSE) || !execute_once(handle, &flags))
+	{
+		return false;
+	}
+
+	sparse_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
+
+
+//-----------------------------
+// Power bins
+//-----------------------------
+
+
+acc_service_configuration_t acc_service_power_bins_configuration_create(void)
+{
+	return configuration_create(SERVICE_TYPE_POWER_BINS);
+}
+
+
+void acc_service_power_bins_configuration_destroy(acc_service_configuration_t *service_configuration)
+{
+	configuration_destroy(service_configuration, SERVICE_TYPE_POWER_BINS);
+}
+
+
+uint16_t acc_service_power_bins_downsampling_factor_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->downsampling_factor;
+}
+
+
+void acc_service_power_bins_downsampling_factor_set(acc_service_configuration_t service_configuration, uint16_t downsampling_factor)
+{
+	service_configuration->downsampling_factor = downsampling_factor;
+}
+
+
+uint16_t acc_service_power_bins_requested_bin_count_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->requested_bin_count;
+}
+
+
+void acc_service_power_bins_requested_bin_count_set(acc_service_configuration_t service_configuration,
+                                                    uint16_t                    requested_bin_count)
+{
+	service_configuration->requested_bin_count = requested_bin_count;
+}
+
+
+bool acc_service_power_bins_noise_level_normalization_get(acc_service_configuration_t service_configuration)
+{
+	return service_configuration->noise_level_normalization;
+}
+
+
+void acc_service_power_bins_noise_level_normalization_set(acc_service_configuration_t service_configuration, bool noise_level_normalization)
+{
+	service_configuration->noise_level_normalization = noise_level_normalization;
+}
+
+
+void acc_service_power_bins_get_metadata(acc_service_handle_t handle, acc_service_power_bins_metadata_t *metadata)
+{
+	if (!handle_valid(handle, SERVICE_TYPE_POWER_BINS))
+	{
+		return;
+	}
+
+	metadata->start_m       = handle->start_m;
+	metadata->length_m      = handle->length_m;
+	metadata->bin_count     = handle->data_length;
+	metadata->stitch_count  = handle->stitch_count;
+	metadata->step_length_m = handle->step_length_m;
+}
+
+
+static void power_bins_result_info_set(acc_service_power_bins_result_info_t *result_info, uint16_t flags)
+{
+	if (result_info != NULL)
+	{
+		memset(result_info, 0, sizeof(*result_info));
+		result_info->missed_data                = (flags & ACC_RECORDING_RESULT_INFO_MISSED_DATA) != 0;
+		result_info->sensor_communication_error = (flags & ACC_RECORDING_RESULT_INFO_SENSOR_COMMUNICATION_ERROR) != 0;
+		result_info->data_saturated             = (flags & ACC_RECORDING_RESULT_INFO_DATA_SATURATED) != 0;
+		result_info->data_quality_warning       = (flags & ACC_RECORDING_RESULT_INFO_DATA_QUALITY_WARNING) != 0;
+	}
+}
+
+
+bool acc_service_power_bins_get_next(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                     acc_service_power_bins_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_POWER_BINS) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	power_bins_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
+
+
+bool acc_service_power_bins_get_next_by_reference(acc_service_handle_t handle, uint16_t **data,
+                                                  acc_service_power_bins_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_POWER_BINS) || !next_frame(handle, &flags))
+	{
+		return false;
+	}
+
+	power_bins_result_info_set(result_info, flags);
+	*data = (uint16_t *)handle->frame;
+
+	return true;
+}
+
+
+bool acc_service_power_bins_execute_once(acc_service_handle_t handle, uint16_t *data, uint16_t data_length,
+                                         acc_service_power_bins_result_info_t *result_info)
+{
+	uint16_t flags;
+
+	if (!handle_valid(handle, SERVICE_TYPE_POWER_BINS) || !execute_once(handle, &flags))
+	{
+		return false;
+	}
+
+	power_bins_result_info_set(result_info, flags);
+
+	return copy_frame(handle, data, data_length);
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_spi_autotune.h"
+
+#include "acc_device_spi.h"
+#include "acc_driver_hal.h"
+#include "acc_log.h"
+#include "acc_rss.h"
+#include "acc_service.h"
+
+
+/**
+ * @brief The module name
+ *
+ * Must exist if acc_log.h is used.
+ */
+#define MODULE "spi_autotune"
+
+
+static bool measure(acc_service_configuration_t configuration,
+                    acc_spi_autotune_get_next_t get_next,
+                    uint_fast8_t                bus,
+                    uint32_t                    frame_count,
+                    acc_spi_autotune_result_t   *result)
+{
+	// The maximum transfer size is read by RSS at activation
+	if (!acc_rss_activate(acc_driver_hal_get_implementation()))
+	{
+		ACC_LOG_ERROR("acc_rss_activate() failed");
+		return false;
+	}
+
+	acc_service_handle_t handle = acc_service_create(configuration);
+
+	if (handle == NULL)
+	{
+		ACC_LOG_ERROR("acc_service_create() failed");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	if (!acc_service_activate(handle))
+	{
+		ACC_LOG_ERROR("acc_service_activate() failed");
+		acc_service_destroy(&handle);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	acc_device_spi_telemetry_t telemetry;
+	bool                       success = true;
+
+	acc_device_spi_telemetry_get(bus, &telemetry, true);
+	acc_device_spi_telemetry_enable(true);
+
+	for (uint32_t frame = 0; frame < frame_count && success; frame++)
+	{
+		success = get_next(handle);
+	}
+
+	acc_device_spi_telemetry_enable(false);
+	acc_device_spi_telemetry_get(bus, &telemetry, true);
+
+	success = acc_service_deactivate(handle) && success;
+	acc_service_destroy(&handle);
+	acc_rss_deactivate();
+
+	if (!success)
+	{
+		ACC_LOG_ERROR("Reading frames failed");
+		return false;
+	}
+
+	result->bytes            = telemetry.bytes;
+	result->transfer_time_us = telemetry.transfer_time_us;
+	result->kb_per_s         = 0;
+
+	if (telemetry.transfer_time_us > 0)
+	{
+		result->kb_per_s = (uint32_t)(telemetry.bytes * 1000 / telemetry.transfer_time_us);
+	}
+
+	return true;
+}
+
+
+size_t acc_spi_autotune_select(const acc_spi_autotune_result_t *results, size_t result_count, uint32_t tolerance_percent)
+{
+	uint32_t peak = 0;
+
+	for (size_t i = 0; i < result_count; i++)
+	{
+		if (results[i].kb_per_s > peak)
+		{
+			peak = results[i].kb_per_s;
+		}
+	}
+
+	uint64_t limit = (uint64_t)peak * (100 - (tolerance_percent < 100 ? tolerance_percent : 100)) / 100;
+
+	for (size_t i = 0; i < result_count; i++)
+	{
+		if (results[i].kb_per_s >= limit)
+		{
+			return i;
+		}
+	}
+
+	return result_count - 1;
+}
+
+
+bool acc_spi_autotune(acc_service_configuration_t        configuration,
+                      acc_spi_autotune_get_next_t        get_next,
+                      acc_device_handle_t                spi_handle,
+                      acc_spi_autotune_buffer_size_set_t buffer_size_set,
+                      const size_t                       *candidates,
+                      acc_spi_autotune_result_t          *results,
+                      size_t                             candidate_count,
+                      uint32_t                           frame_count,
+                      uint32_t                           tolerance_percent,
+                      size_t                             *buffer_size)
+{
+	if (candidate_count == 0)
+	{
+		return false;
+	}
+
+	uint_fast8_t bus = acc_device_spi_get_bus(spi_handle);
+
+	for (size_t i = 0; i < candidate_count; i++)
+	{
+		memset(&results[i], 0, sizeof(results[i]));
+		results[i].buffer_size = candidates[i];
+
+		if (!buffer_size_set(spi_handle, candidates[i]))
+		{
+			ACC_LOG_ERROR("Unable to set SPI buffer size %u", (unsigned int)candidates[i]);
+			return false;
+		}
+
+		if (!measure(configuration, get_next, bus, frame_count, &results[i]))
+		{
+			return false;
+		}
+
+		ACC_LOG_INFO("SPI buffer size %u: %" PRIu32 " kB/s", (unsigned int)candidates[i], results[i].kb_per_s);
+	}
+
+	size_t selected = acc_spi_autotune_select(results, candidate_count, tolerance_percent);
+
+	if (!buffer_size_set(spi_handle, candidates[selected]))
+	{
+		ACC_LOG_ERROR("Unable to set SPI buffer size %u", (unsigned int)candidates[selected]);
+		return false;
+	}
+
+	*buffer_size = candidates[selected];
+
+	return true;
+}
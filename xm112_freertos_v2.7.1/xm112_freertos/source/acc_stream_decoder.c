@@ -0,0 +1,247 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_stream_decoder.h"
+
+#include "acc_crc32.h"
+
+
+/**
+ * @brief Decode a COBS block sequence in place
+ *
+ * @param[in, out] buffer The encoded data, without the delimiter, replaced by the decoded data
+ * @param[in] size The size of the encoded data
+ * @param[out] decoded_size The size of the decoded data
+ * @return True if the encoding was valid
+ */
+static bool cobs_decode(uint8_t *buffer, size_t size, size_t *decoded_size)
+{
+	size_t read  = 0;
+	size_t write = 0;
+
+	while (read < size)
+	{
+		uint8_t code = buffer[read++];
+
+		if (code == 0 || read + code - 1 > size)
+		{
+			return false;
+		}
+
+		// The decoded data is always behind the encoded data, memmove handles the overlap
+		memmove(&buffer[write], &buffer[read], code - 1U);
+		read  += code - 1U;
+		write += code - 1U;
+
+		if (code < 0xFF && read < size)
+		{
+			buffer[write++] = 0;
+		}
+	}
+
+	*decoded_size = write;
+
+	return true;
+}
+
+
+static void decode_message(acc_stream_decoder_t *decoder)
+{
+	size_t size;
+
+	if (!cobs_decode(decoder->buffer, decoder->length, &size) ||
+	    size < sizeof(acc_stream_message_header_t) + ACC_STREAM_CRC_SIZE)
+	{
+		decoder->statistics.framing_error_count++;
+		return;
+	}
+
+	uint32_t crc;
+
+	memcpy(&crc, &decoder->buffer[size - ACC_STREAM_CRC_SIZE], sizeof(crc));
+
+	if (acc_crc32(decoder->buffer, size - ACC_STREAM_CRC_SIZE) != crc)
+	{
+		decoder->statistics.crc_error_count++;
+		return;
+	}
+
+	acc_stream_message_header_t header;
+
+	memcpy(&header, decoder->buffer, sizeof(header));
+
+	if (header.version != ACC_STREAM_VERSION)
+	{
+		decoder->statistics.framing_error_count++;
+		return;
+	}
+
+	if (decoder->sequence_number_valid)
+	{
+		decoder->statistics.lost_message_count += (uint16_t)(header.sequence_number - decoder->next_sequence_number);
+	}
+
+	decoder->sequence_number_valid = true;
+	decoder->next_sequence_number  = header.sequence_number + 1U;
+	decoder->statistics.message_count++;
+
+	acc_stream_message_t message;
+
+	message.type            = header.type;
+	message.sequence_number = header.sequence_number;
+	message.payload         = &decoder->buffer[sizeof(header)];
+	message.payload_size    = size - sizeof(header) - ACC_STREAM_CRC_SIZE;
+
+	decoder->callback(&message, decoder->client_reference);
+}
+
+
+void acc_stream_decoder_init(acc_stream_decoder_t          *decoder,
+                             acc_stream_decoder_callback_t callback,
+                             void                          *client_reference,
+                             uint8_t                       *buffer,
+                             size_t                        buffer_size)
+{
+	memset(decoder, 0, sizeof(*decoder));
+
+	decoder->callback         = callback;
+	decoder->client_reference = client_reference;
+	decoder->buffer           = buffer;
+	decoder->buffer_size      = buffer_size;
+}
+
+
+void acc_stream_decoder_feed(acc_stream_decoder_t *decoder, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	while (size > 0)
+	{
+		const uint8_t *delimiter = memchr(bytes, ACC_STREAM_DELIMITER, size);
+		size_t        chunk      = delimiter != NULL ? (size_t)(delimiter - bytes) : size;
+
+		if (!decoder->overflow)
+		{
+			if (chunk > decoder->buffer_size - decoder->length)
+			{
+				decoder->overflow = true;
+			}
+			else
+			{
+				memcpy(&decoder->buffer[decoder->length], bytes, chunk);
+				decoder->length += chunk;
+			}
+		}
+
+		if (delimiter == NULL)
+		{
+			return;
+		}
+
+		if (decoder->overflow)
+		{
+			decoder->statistics.framing_error_count++;
+		}
+		else if (decoder->length > 0)
+		{
+			decode_message(decoder);
+		}
+
+		decoder->length   = 0;
+		decoder->overflow = false;
+
+		bytes += chunk + 1;
+		size  -= chunk + 1;
+	}
+}
+
+
+bool acc_stream_decoder_metadata_get(const acc_stream_message_t *message, acc_stream_metadata_t *metadata)
+{
+	if (message->type != ACC_STREAM_MESSAGE_METADATA || message->payload_size < sizeof(*metadata))
+	{
+		return false;
+	}
+
+	memcpy(metadata, message->payload, sizeof(*metadata));
+
+	return true;
+}
+
+
+bool acc_stream_decoder_frame_get(const acc_stream_message_t *message, uint32_t sample_size,
+                                  acc_stream_frame_header_t *frame_header, const void **data)
+{
+	if (message->type != ACC_STREAM_MESSAGE_FRAME || message->payload_size < sizeof(*frame_header))
+	{
+		return false;
+	}
+
+	memcpy(frame_header, message->payload, sizeof(*frame_header));
+
+	if (message->payload_size - sizeof(*frame_header) != (size_t)frame_header->data_length * sample_size)
+	{
+		return false;
+	}
+
+	*data = &message->payload[sizeof(*frame_header)];
+
+	return true;
+}
+
+
+bool acc_stream_decoder_compressed_frame_get(const acc_stream_message_t *message, acc_stream_frame_header_t *frame_header,
+                                             const uint8_t **compressed, size_t *compressed_size)
+{
+	if (message->type != ACC_STREAM_MESSAGE_COMPRESSED_FRAME || message->payload_size < sizeof(*frame_header))
+	{
+		return false;
+	}
+
+	memcpy(frame_header, message->payload, sizeof(*frame_header));
+
+	*compressed      = &message->payload[sizeof(*frame_header)];
+	*compressed_size = message->payload_size - sizeof(*frame_header);
+
+	return true;
+}
+
+
+bool acc_stream_decoder_result_info_get(const acc_stream_message_t *message, acc_stream_result_info_t *result_info)
+{
+	if (message->type != ACC_STREAM_MESSAGE_RESULT_INFO || message->payload_size < sizeof(*result_info))
+	{
+		return false;
+	}
+
+	memcpy(result_info, message->payload, sizeof(*result_info));
+
+	return true;
+}
+
+
+bool acc_stream_decoder_detector_result_get(const acc_stream_message_t          *message,
+                                            acc_stream_detector_result_header_t *result_header,
+                                            const void                          **result,
+                                            size_t                              *result_size)
+{
+	if (message->type != ACC_STREAM_MESSAGE_DETECTOR_RESULT || message->payload_size < sizeof(*result_header))
+	{
+		return false;
+	}
+
+	memcpy(result_header, message->payload, sizeof(*result_header));
+
+	*result      = &message->payload[sizeof(*result_header)];
+	*result_size = message->payload_size - sizeof(*result_header);
+
+	return true;
+}
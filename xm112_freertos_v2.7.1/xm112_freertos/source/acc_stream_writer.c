@@ -0,0 +1,284 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_stream_writer.h"
+
+#include "acc_crc32.h"
+#include "acc_definitions.h"
+#include "acc_device_os.h"
+#include "acc_device_uart.h"
+#include "acc_log.h"
+
+
+#define MODULE "stream_writer" /**< module name */
+
+
+/**
+ * @brief Largest number of parts a message payload is made of
+ */
+#define PAYLOAD_PART_MAX_COUNT 2
+
+
+typedef struct
+{
+	const void *data;
+	size_t     size;
+} part_t;
+
+
+/**
+ * @brief COBS encoder state
+ *
+ * Every block starts with a code byte telling the distance to the next zero
+ * byte, the code is filled in when the block ends.
+ */
+typedef struct
+{
+	uint8_t *buffer;
+	size_t  size;
+	size_t  code_index;
+	uint8_t code;
+} cobs_encoder_t;
+
+
+static void cobs_start(cobs_encoder_t *encoder, uint8_t *buffer)
+{
+	// A leading delimiter ends any text written to the link since the last message
+	buffer[0] = ACC_STREAM_DELIMITER;
+
+	encoder->buffer     = buffer;
+	encoder->size       = 2;
+	encoder->code_index = 1;
+	encoder->code       = 1;
+}
+
+
+static void cobs_end_block(cobs_encoder_t *encoder)
+{
+	encoder->buffer[encoder->code_index] = encoder->code;
+	encoder->code_index                  = encoder->size++;
+	encoder->code                        = 1;
+}
+
+
+static void cobs_encode(cobs_encoder_t *encoder, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (bytes[i] == 0)
+		{
+			cobs_end_block(encoder);
+			continue;
+		}
+
+		encoder->buffer[encoder->size++] = bytes[i];
+		encoder->code++;
+
+		if (encoder->code == 0xFF)
+		{
+			cobs_end_block(encoder);
+		}
+	}
+}
+
+
+static size_t cobs_finish(cobs_encoder_t *encoder)
+{
+	encoder->buffer[encoder->code_index] = encoder->code;
+	encoder->buffer[encoder->size++]     = ACC_STREAM_DELIMITER;
+
+	return encoder->size;
+}
+
+
+static bool send_parts(acc_stream_writer_t *writer, acc_stream_message_type_t type, const part_t *parts, size_t part_count)
+{
+	size_t payload_size = 0;
+
+	for (size_t i = 0; i < part_count; i++)
+	{
+		payload_size += parts[i].size;
+	}
+
+	if (ACC_STREAM_ENCODED_SIZE(payload_size) > writer->buffer_size)
+	{
+		if (writer->failed_message_count++ == 0)
+		{
+			ACC_LOG_WARNING("Message of %u bytes does not fit the stream buffer", (unsigned int)payload_size);
+		}
+
+		return false;
+	}
+
+	acc_stream_message_header_t header;
+	cobs_encoder_t              encoder;
+
+	header.version         = ACC_STREAM_VERSION;
+	header.type            = (uint8_t)type;
+	header.sequence_number = writer->sequence_number++;
+
+	uint32_t crc = acc_crc32_update(ACC_CRC32_INIT, &header, sizeof(header));
+
+	cobs_start(&encoder, writer->buffer);
+	cobs_encode(&encoder, &header, sizeof(header));
+
+	for (size_t i = 0; i < part_count; i++)
+	{
+		crc = acc_crc32_update(crc, parts[i].data, parts[i].size);
+		cobs_encode(&encoder, parts[i].data, parts[i].size);
+	}
+
+	crc = acc_crc32_final(crc);
+	cobs_encode(&encoder, &crc, sizeof(crc));
+
+	size_t size = cobs_finish(&encoder);
+
+	if (!writer->output(writer->buffer, size, writer->client_reference))
+	{
+		writer->failed_message_count++;
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool send_frame(acc_stream_writer_t *writer, acc_stream_message_type_t type, const void *data, size_t data_size,
+                       uint16_t data_length, uint16_t result_info, uint16_t proximity_power)
+{
+	acc_stream_frame_header_t frame_header;
+	part_t                    parts[PAYLOAD_PART_MAX_COUNT];
+
+	frame_header.timestamp_ms = acc_os_get_time();
+	frame_header.data_length  = data_length;
+	frame_header.reserved     = 0;
+
+	parts[0].data = &frame_header;
+	parts[0].size = sizeof(frame_header);
+	parts[1].data = data;
+	parts[1].size = data_size;
+
+	if (!send_parts(writer, type, parts, PAYLOAD_PART_MAX_COUNT))
+	{
+		return false;
+	}
+
+	if (result_info == 0 && proximity_power == 0)
+	{
+		return true;
+	}
+
+	acc_stream_result_info_t stream_result_info;
+
+	stream_result_info.result_info     = result_info;
+	stream_result_info.proximity_power = proximity_power;
+
+	return acc_stream_writer_send(writer, ACC_STREAM_MESSAGE_RESULT_INFO, &stream_result_info, sizeof(stream_result_info));
+}
+
+
+void acc_stream_writer_init(acc_stream_writer_t        *writer,
+                            acc_stream_writer_output_t output,
+                            void                       *client_reference,
+                            uint8_t                    *buffer,
+                            size_t                     buffer_size)
+{
+	memset(writer, 0, sizeof(*writer));
+
+	writer->output           = output;
+	writer->client_reference = client_reference;
+	writer->buffer           = buffer;
+	writer->buffer_size      = buffer_size;
+	writer->sample_size      = sizeof(uint16_t);
+}
+
+
+static bool uart_output(const void *data, size_t size, void *client_reference)
+{
+	uint_fast8_t port = (uint_fast8_t)(uintptr_t)client_reference;
+
+	return acc_device_uart_write_buffer(port, data, size);
+}
+
+
+void acc_stream_writer_init_uart(acc_stream_writer_t *writer, uint_fast8_t port, uint8_t *buffer, size_t buffer_size)
+{
+	acc_stream_writer_init(writer, uart_output, (void *)(uintptr_t)port, buffer, buffer_size);
+}
+
+
+bool acc_stream_writer_send(acc_stream_writer_t *writer, acc_stream_message_type_t type, const void *payload, size_t payload_size)
+{
+	part_t part = { .data = payload, .size = payload_size };
+
+	return send_parts(writer, type, &part, 1);
+}
+
+
+bool acc_stream_writer_send_metadata(acc_stream_writer_t                 *writer,
+                                     acc_recording_service_type_t        service_type,
+                                     const acc_recording_metadata_t      *metadata,
+                                     const acc_recording_configuration_t *configuration)
+{
+	acc_stream_metadata_t stream_metadata;
+
+	memset(&stream_metadata, 0, sizeof(stream_metadata));
+
+	writer->service_type = service_type;
+	writer->sample_size  = service_type == ACC_RECORDING_SERVICE_TYPE_IQ ? sizeof(acc_int16_complex_t) : sizeof(uint16_t);
+
+	stream_metadata.service_type = service_type;
+	stream_metadata.sample_size  = writer->sample_size;
+	stream_metadata.metadata     = *metadata;
+
+	if (configuration != NULL)
+	{
+		stream_metadata.configuration = *configuration;
+	}
+
+	return acc_stream_writer_send(writer, ACC_STREAM_MESSAGE_METADATA, &stream_metadata, sizeof(stream_metadata));
+}
+
+
+bool acc_stream_writer_send_frame(acc_stream_writer_t *writer, const void *data, uint16_t data_length,
+                                  uint16_t result_info, uint16_t proximity_power)
+{
+	return send_frame(writer, ACC_STREAM_MESSAGE_FRAME, data, (size_t)data_length * writer->sample_size, data_length,
+	                  result_info, proximity_power);
+}
+
+
+bool acc_stream_writer_send_compressed_frame(acc_stream_writer_t *writer, const void *compressed, size_t compressed_size,
+                                             uint16_t data_length, uint16_t result_info, uint16_t proximity_power)
+{
+	return send_frame(writer, ACC_STREAM_MESSAGE_COMPRESSED_FRAME, compressed, compressed_size, data_length, result_info,
+	                  proximity_power);
+}
+
+
+bool acc_stream_writer_send_detector_result(acc_stream_writer_t *writer, uint32_t detector_type, const void *result,
+                                            size_t result_size)
+{
+	acc_stream_detector_result_header_t result_header;
+	part_t                              parts[PAYLOAD_PART_MAX_COUNT];
+
+	result_header.detector_type = detector_type;
+	result_header.timestamp_ms  = acc_os_get_time();
+
+	parts[0].data = &result_header;
+	parts[0].size = sizeof(result_header);
+	parts[1].data = result;
+	parts[1].size = result_size;
+
+	return send_parts(writer, ACC_STREAM_MESSAGE_DETECTOR_RESULT, parts, PAYLOAD_PART_MAX_COUNT);
+}
@@ -0,0 +1,607 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_tlsf.h"
+
+
+#define ALIGNMENT_LOG2 3U
+
+/**
+ * @brief Sizes below SMALL_BLOCK_SIZE are all in first level 0, split linearly in ACC_TLSF_ALIGNMENT steps
+ */
+#define FIRST_LEVEL_SHIFT (ACC_TLSF_SECOND_LEVEL_COUNT_LOG2 + ALIGNMENT_LOG2)
+#define FIRST_LEVEL_COUNT (ACC_TLSF_FIRST_LEVEL_MAX_LOG2 - FIRST_LEVEL_SHIFT + 1U)
+#define SMALL_BLOCK_SIZE  ((size_t)1U << FIRST_LEVEL_SHIFT)
+
+#define REGION_COUNT_MAX 4U
+
+/**
+ * @brief Bit in the size of a block set when the block is free
+ */
+#define BLOCK_FREE 1U
+
+#define BLOCK_HEADER_SIZE offsetof(block_header_t, next_free)
+#define BLOCK_SIZE_MIN    (sizeof(block_header_t) - BLOCK_HEADER_SIZE)
+#define BLOCK_SIZE_MAX    (((size_t)1U << ACC_TLSF_FIRST_LEVEL_MAX_LOG2) - ACC_TLSF_ALIGNMENT)
+
+
+/**
+ * @brief Header before every block
+ *
+ * The blocks of a region follow each other in memory and end with a used
+ * block of size 0. The free list pointers are only valid in free blocks,
+ * they are stored in the payload. The header size is a multiple of
+ * ACC_TLSF_ALIGNMENT for both 32-bit and 64-bit pointers.
+ */
+typedef struct block_header
+{
+	struct block_header *prev_physical;
+	size_t              size;
+	struct block_header *next_free;
+	struct block_header *prev_free;
+} block_header_t;
+
+
+struct acc_tlsf
+{
+	uint32_t       first_level_bitmap;
+	uint32_t       second_level_bitmap[FIRST_LEVEL_COUNT];
+	block_header_t *free_lists[FIRST_LEVEL_COUNT][ACC_TLSF_SECOND_LEVEL_COUNT];
+
+	block_header_t *regions[REGION_COUNT_MAX];
+	uint32_t       region_count;
+
+	acc_tlsf_cycle_counter_func_t *cycle_counter;
+
+	size_t   total_size;
+	size_t   free_size;
+	size_t   min_ever_free_size;
+	uint32_t free_block_count;
+	uint32_t alloc_count;
+	uint32_t free_count;
+	uint32_t failed_alloc_count;
+	uint32_t max_alloc_cycles;
+	uint32_t max_free_cycles;
+};
+
+
+static size_t align_up(size_t value)
+{
+	return (value + ACC_TLSF_ALIGNMENT - 1U) & ~(size_t)(ACC_TLSF_ALIGNMENT - 1U);
+}
+
+
+static size_t align_down(size_t value)
+{
+	return value & ~(size_t)(ACC_TLSF_ALIGNMENT - 1U);
+}
+
+
+/**
+ * @brief Index of the most significant bit, value must not be 0
+ */
+static uint32_t bit_last(uint32_t value)
+{
+	return 31U - (uint32_t)__builtin_clz(value);
+}
+
+
+/**
+ * @brief Index of the least significant bit, value must not be 0
+ */
+static uint32_t bit_first(uint32_t value)
+{
+	return (uint32_t)__builtin_ctz(value);
+}
+
+
+static size_t block_size(const block_header_t *block)
+{
+	return block->size & ~(size_t)BLOCK_FREE;
+}
+
+
+static bool block_is_free(const block_header_t *block)
+{
+	return (block->size & BLOCK_FREE) != 0U;
+}
+
+
+static uint8_t *block_payload(const block_header_t *block)
+{
+	return (uint8_t *)((uintptr_t)block + BLOCK_HEADER_SIZE);
+}
+
+
+static block_header_t *block_from_payload(const void *ptr)
+{
+	return (block_header_t *)((uintptr_t)ptr - BLOCK_HEADER_SIZE);
+}
+
+
+static block_header_t *block_next_physical(const block_header_t *block)
+{
+	return (block_header_t *)(block_payload(block) + block_size(block));
+}
+
+
+/**
+ * @brief The free list that a block of the size is kept in
+ */
+static void mapping_insert(size_t size, uint32_t *first_level, uint32_t *second_level)
+{
+	if (size < SMALL_BLOCK_SIZE)
+	{
+		*first_level  = 0U;
+		*second_level = (uint32_t)(size / (SMALL_BLOCK_SIZE / ACC_TLSF_SECOND_LEVEL_COUNT));
+	}
+	else
+	{
+		uint32_t last = bit_last((uint32_t)size);
+
+		*second_level = (uint32_t)(size >> (last - ACC_TLSF_SECOND_LEVEL_COUNT_LOG2)) - ACC_TLSF_SECOND_LEVEL_COUNT;
+		*first_level  = last - FIRST_LEVEL_SHIFT + 1U;
+	}
+}
+
+
+/**
+ * @brief The first free list where every block is at least of the size
+ *
+ * The size is rounded up to the next list so that the head of any list from
+ * there fits without searching the list.
+ */
+static void mapping_search(size_t size, uint32_t *first_level, uint32_t *second_level)
+{
+	if (size >= SMALL_BLOCK_SIZE)
+	{
+		size += ((size_t)1U << (bit_last((uint32_t)size) - ACC_TLSF_SECOND_LEVEL_COUNT_LOG2)) - 1U;
+	}
+
+	mapping_insert(size, first_level, second_level);
+}
+
+
+static block_header_t *find_suitable(const acc_tlsf_t *tlsf, uint32_t *first_level, uint32_t *second_level)
+{
+	if (*first_level >= FIRST_LEVEL_COUNT)
+	{
+		return NULL;
+	}
+
+	uint32_t second_level_map = tlsf->second_level_bitmap[*first_level] & (~0U << *second_level);
+
+	if (second_level_map == 0U)
+	{
+		uint32_t first_level_map = tlsf->first_level_bitmap & (~0U << (*first_level + 1U));
+
+		if (first_level_map == 0U)
+		{
+			return NULL;
+		}
+
+		*first_level     = bit_first(first_level_map);
+		second_level_map = tlsf->second_level_bitmap[*first_level];
+	}
+
+	*second_level = bit_first(second_level_map);
+
+	return tlsf->free_lists[*first_level][*second_level];
+}
+
+
+static void free_list_remove(acc_tlsf_t *tlsf, block_header_t *block, uint32_t first_level, uint32_t second_level)
+{
+	if (block->prev_free != NULL)
+	{
+		block->prev_free->next_free = block->next_free;
+	}
+	else
+	{
+		tlsf->free_lists[first_level][second_level] = block->next_free;
+
+		if (block->next_free == NULL)
+		{
+			tlsf->second_level_bitmap[first_level] &= ~(1U << second_level);
+
+			if (tlsf->second_level_bitmap[first_level] == 0U)
+			{
+				tlsf->first_level_bitmap &= ~(1U << first_level);
+			}
+		}
+	}
+
+	if (block->next_free != NULL)
+	{
+		block->next_free->prev_free = block->prev_free;
+	}
+
+	tlsf->free_block_count--;
+}
+
+
+static void free_list_remove_block(acc_tlsf_t *tlsf, block_header_t *block)
+{
+	uint32_t first_level;
+	uint32_t second_level;
+
+	mapping_insert(block_size(block), &first_level, &second_level);
+	free_list_remove(tlsf, block, first_level, second_level);
+}
+
+
+static void free_list_insert(acc_tlsf_t *tlsf, block_header_t *block)
+{
+	uint32_t first_level;
+	uint32_t second_level;
+
+	mapping_insert(block_size(block), &first_level, &second_level);
+
+	block_header_t *head = tlsf->free_lists[first_level][second_level];
+
+	block->prev_free = NULL;
+	block->next_free = head;
+	if (head != NULL)
+	{
+		head->prev_free = block;
+	}
+
+	tlsf->free_lists[first_level][second_level] = block;
+	tlsf->second_level_bitmap[first_level]     |= 1U << second_level;
+	tlsf->first_level_bitmap                   |= 1U << first_level;
+	tlsf->free_block_count++;
+}
+
+
+/**
+ * @brief Find a free block of at least size bytes and remove it from its free list
+ */
+static block_header_t *block_take(acc_tlsf_t *tlsf, size_t size)
+{
+	uint32_t       first_level;
+	uint32_t       second_level;
+	block_header_t *block;
+
+	mapping_search(size, &first_level, &second_level);
+	block = find_suitable(tlsf, &first_level, &second_level);
+
+	if (block == NULL)
+	{
+		// The rounding in mapping_search skips the list of the size itself, which
+		// may still have a block that fits. Only searched when the heap is nearly
+		// exhausted, so the normal case stays constant time.
+		mapping_insert(size, &first_level, &second_level);
+
+		if (first_level >= FIRST_LEVEL_COUNT)
+		{
+			return NULL;
+		}
+
+		block = tlsf->free_lists[first_level][second_level];
+		while (block != NULL && block_size(block) < size)
+		{
+			block = block->next_free;
+		}
+
+		if (block == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	free_list_remove(tlsf, block, first_level, second_level);
+
+	return block;
+}
+
+
+static void update_cycles(const acc_tlsf_t *tlsf, uint32_t start, uint32_t *max_cycles)
+{
+	if (tlsf->cycle_counter != NULL)
+	{
+		uint32_t cycles = tlsf->cycle_counter() - start;
+
+		if (cycles > *max_cycles)
+		{
+			*max_cycles = cycles;
+		}
+	}
+}
+
+
+acc_tlsf_t *acc_tlsf_create(void *memory, size_t size, acc_tlsf_cycle_counter_func_t *cycle_counter)
+{
+	uintptr_t start = align_up((uintptr_t)memory);
+	size_t    skip  = start - (uintptr_t)memory;
+	size_t    used  = align_up(sizeof(acc_tlsf_t));
+
+	if (memory == NULL || size < skip + used)
+	{
+		return NULL;
+	}
+
+	acc_tlsf_t *tlsf = (acc_tlsf_t *)start;
+
+	memset(tlsf, 0, sizeof(*tlsf));
+	tlsf->cycle_counter = cycle_counter;
+
+	if (!acc_tlsf_add_region(tlsf, (uint8_t *)start + used, size - skip - used))
+	{
+		return NULL;
+	}
+
+	return tlsf;
+}
+
+
+bool acc_tlsf_add_region(acc_tlsf_t *tlsf, void *memory, size_t size)
+{
+	if (tlsf == NULL || memory == NULL || tlsf->region_count >= REGION_COUNT_MAX)
+	{
+		return false;
+	}
+
+	uintptr_t start = align_up((uintptr_t)memory);
+	uintptr_t end   = align_down((uintptr_t)memory + size);
+
+	// Room for the first block and the end block
+	if (end < start || end - start < 2U * BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN)
+	{
+		return false;
+	}
+
+	size_t free_size = end - start - 2U * BLOCK_HEADER_SIZE;
+
+	// Memory beyond the largest block is not used
+	if (free_size > BLOCK_SIZE_MAX)
+	{
+		free_size = BLOCK_SIZE_MAX;
+	}
+
+	block_header_t *block = (block_header_t *)start;
+
+	block->prev_physical = NULL;
+	block->size          = free_size | BLOCK_FREE;
+
+	block_header_t *end_block = block_next_physical(block);
+
+	end_block->prev_physical = block;
+	end_block->size          = 0U;
+
+	free_list_insert(tlsf, block);
+
+	tlsf->regions[tlsf->region_count++] = block;
+	tlsf->total_size                   += free_size;
+	tlsf->free_size                    += free_size;
+	tlsf->min_ever_free_size           += free_size;
+
+	return true;
+}
+
+
+void *acc_tlsf_alloc(acc_tlsf_t *tlsf, size_t size)
+{
+	uint32_t       start = tlsf->cycle_counter != NULL ? tlsf->cycle_counter() : 0U;
+	block_header_t *block = NULL;
+
+	if (size > 0U && size <= BLOCK_SIZE_MAX)
+	{
+		size = align_up(size);
+		if (size < BLOCK_SIZE_MIN)
+		{
+			size = BLOCK_SIZE_MIN;
+		}
+
+		block = block_take(tlsf, size);
+	}
+
+	if (block == NULL)
+	{
+		tlsf->failed_alloc_count++;
+		update_cycles(tlsf, start, &tlsf->max_alloc_cycles);
+		return NULL;
+	}
+
+	// Return the end of the block to the free lists if it can hold a block of its own
+	if (block_size(block) >= size + BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN)
+	{
+		block_header_t *rest = (block_header_t *)(block_payload(block) + size);
+
+		rest->prev_physical = block;
+		rest->size          = (block_size(block) - size - BLOCK_HEADER_SIZE) | BLOCK_FREE;
+		block_next_physical(rest)->prev_physical = rest;
+		block->size = size;
+
+		free_list_insert(tlsf, rest);
+		tlsf->free_size -= BLOCK_HEADER_SIZE;
+	}
+
+	block->size      = block_size(block);
+	tlsf->free_size -= block->size;
+
+	if (tlsf->free_size < tlsf->min_ever_free_size)
+	{
+		tlsf->min_ever_free_size = tlsf->free_size;
+	}
+
+	tlsf->alloc_count++;
+	update_cycles(tlsf, start, &tlsf->max_alloc_cycles);
+
+	return block_payload(block);
+}
+
+
+void acc_tlsf_free(acc_tlsf_t *tlsf, void *ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	uint32_t       start = tlsf->cycle_counter != NULL ? tlsf->cycle_counter() : 0U;
+	block_header_t *block = block_from_payload(ptr);
+	block_header_t *prev  = block->prev_physical;
+	block_header_t *next  = block_next_physical(block);
+
+	tlsf->free_size += block_size(block);
+
+	if (prev != NULL && block_is_free(prev))
+	{
+		free_list_remove_block(tlsf, prev);
+		prev->size       = block_size(prev) + BLOCK_HEADER_SIZE + block_size(block);
+		block            = prev;
+		tlsf->free_size += BLOCK_HEADER_SIZE;
+	}
+
+	if (block_is_free(next))
+	{
+		free_list_remove_block(tlsf, next);
+		block->size      = block_size(block) + BLOCK_HEADER_SIZE + block_size(next);
+		tlsf->free_size += BLOCK_HEADER_SIZE;
+	}
+
+	block->size                              = block_size(block) | BLOCK_FREE;
+	block_next_physical(block)->prev_physical = block;
+
+	free_list_insert(tlsf, block);
+
+	tlsf->free_count++;
+	update_cycles(tlsf, start, &tlsf->max_free_cycles);
+}
+
+
+size_t acc_tlsf_get_allocated_size(const void *ptr)
+{
+	return block_size(block_from_payload(ptr));
+}
+
+
+void acc_tlsf_get_stats(const acc_tlsf_t *tlsf, acc_tlsf_stats_t *stats)
+{
+	size_t largest = 0U;
+
+	// The largest block is in the highest non-empty list, but not necessarily first in it
+	if (tlsf->first_level_bitmap != 0U)
+	{
+		uint32_t first_level  = bit_last(tlsf->first_level_bitmap);
+		uint32_t second_level = bit_last(tlsf->second_level_bitmap[first_level]);
+
+		for (const block_header_t *block = tlsf->free_lists[first_level][second_level]; block != NULL;
+		     block = block->next_free)
+		{
+			if (block_size(block) > largest)
+			{
+				largest = block_size(block);
+			}
+		}
+	}
+
+	stats->total_size             = tlsf->total_size;
+	stats->free_size              = tlsf->free_size;
+	stats->min_ever_free_size     = tlsf->min_ever_free_size;
+	stats->largest_free_block     = largest;
+	stats->free_block_count       = tlsf->free_block_count;
+	stats->fragmentation_permille = 0U;
+	stats->alloc_count            = tlsf->alloc_count;
+	stats->free_count             = tlsf->free_count;
+	stats->failed_alloc_count     = tlsf->failed_alloc_count;
+	stats->max_alloc_cycles       = tlsf->max_alloc_cycles;
+	stats->max_free_cycles        = tlsf->max_free_cycles;
+
+	if (tlsf->free_size > 0U)
+	{
+		stats->fragmentation_permille = 1000U - (uint32_t)(((uint64_t)largest * 1000U) / tlsf->free_size);
+	}
+}
+
+
+static bool free_list_contains(const acc_tlsf_t *tlsf, const block_header_t *block)
+{
+	uint32_t first_level;
+	uint32_t second_level;
+
+	mapping_insert(block_size(block), &first_level, &second_level);
+
+	for (const block_header_t *item = tlsf->free_lists[first_level][second_level]; item != NULL; item = item->next_free)
+	{
+		if (item == block)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool acc_tlsf_check(const acc_tlsf_t *tlsf)
+{
+	size_t   free_size        = 0U;
+	uint32_t free_block_count = 0U;
+
+	for (uint32_t region = 0U; region < tlsf->region_count; region++)
+	{
+		const block_header_t *prev  = NULL;
+		const block_header_t *block = tlsf->regions[region];
+
+		while (block_size(block) > 0U)
+		{
+			const block_header_t *next = block_next_physical(block);
+
+			if (block->prev_physical != prev || next->prev_physical != block)
+			{
+				return false;
+			}
+
+			if (block_is_free(block))
+			{
+				// Free neighbours are always merged
+				if (block_is_free(next) || !free_list_contains(tlsf, block))
+				{
+					return false;
+				}
+
+				free_size += block_size(block);
+				free_block_count++;
+			}
+
+			prev  = block;
+			block = next;
+		}
+
+		if (block_is_free(block))
+		{
+			return false;
+		}
+	}
+
+	for (uint32_t first_level = 0U; first_level < FIRST_LEVEL_COUNT; first_level++)
+	{
+		bool first_level_set = (tlsf->first_level_bitmap & (1U << first_level)) != 0U;
+
+		if (first_level_set != (tlsf->second_level_bitmap[first_level] != 0U))
+		{
+			return false;
+		}
+
+		for (uint32_t second_level = 0U; second_level < ACC_TLSF_SECOND_LEVEL_COUNT; second_level++)
+		{
+			bool second_level_set = (tlsf->second_level_bitmap[first_level] & (1U << second_level)) != 0U;
+
+			if (second_level_set != (tlsf->free_lists[first_level][second_level] != NULL))
+			{
+				return false;
+			}
+		}
+	}
+
+	return free_size == tlsf->free_size && free_block_count == tlsf->free_block_count;
+}
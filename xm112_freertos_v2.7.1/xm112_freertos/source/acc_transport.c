@@ -0,0 +1,472 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_transport.h"
+#include "acc_crc32.h"
+
+
+#define SYNC_0 0xACU
+#define SYNC_1 0xC0U
+
+#define HEADER_OFFSET_FLAGS    2U
+#define HEADER_OFFSET_SEQUENCE 3U
+#define HEADER_OFFSET_LENGTH   4U
+#define HEADER_OFFSET_CREDITS  6U
+#define HEADER_OFFSET_CRC      8U
+
+#define KNOWN_FLAGS (ACC_TRANSPORT_FLAG_DATA | ACC_TRANSPORT_FLAG_FIRST | ACC_TRANSPORT_FLAG_LAST | ACC_TRANSPORT_FLAG_CRC | \
+                     ACC_TRANSPORT_FLAG_REQUEST)
+
+/**
+ * @brief Credits are counted modulo 2^16, a difference above this is a peer that has restarted
+ */
+#define CREDITS_MAX 0x8000U
+
+
+static void put_u16(uint8_t *buffer, uint16_t value)
+{
+	buffer[0] = (uint8_t)value;
+	buffer[1] = (uint8_t)(value >> 8);
+}
+
+
+static void put_u32(uint8_t *buffer, uint32_t value)
+{
+	put_u16(buffer, (uint16_t)value);
+	put_u16(buffer + 2, (uint16_t)(value >> 16));
+}
+
+
+static uint16_t get_u16(const uint8_t *buffer)
+{
+	return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+
+static uint32_t get_u32(const uint8_t *buffer)
+{
+	return get_u16(buffer) | ((uint32_t)get_u16(buffer + 2) << 16);
+}
+
+
+static uint32_t packet_crc(const uint8_t *header, const uint8_t *payload, size_t payload_size)
+{
+	uint32_t crc = acc_crc32_update(ACC_CRC32_INIT, header, HEADER_OFFSET_CRC);
+
+	return acc_crc32_final(acc_crc32_update(crc, payload, payload_size));
+}
+
+
+/**
+ * @brief Grant credits, the peer is told when half of the receive credits are waiting or if forced
+ */
+static void credits_grant(acc_transport_t *transport, uint16_t packets, bool force)
+{
+	uint16_t threshold = transport->config.receive_credits / 2U;
+
+	transport->credits_granted = (uint16_t)(transport->credits_granted + packets);
+
+	if (force || (uint16_t)(transport->credits_granted - transport->credits_advertised) >= threshold)
+	{
+		transport->credits_update = true;
+	}
+}
+
+
+static bool packet_write(acc_transport_t *transport, uint8_t flags, const uint8_t *payload, size_t payload_size)
+{
+	uint8_t *header = transport->send_header;
+
+	if (transport->config.use_crc)
+	{
+		flags |= ACC_TRANSPORT_FLAG_CRC;
+	}
+
+	header[0]                      = SYNC_0;
+	header[1]                      = SYNC_1;
+	header[HEADER_OFFSET_FLAGS]    = flags;
+	header[HEADER_OFFSET_SEQUENCE] = transport->send_sequence;
+	put_u16(&header[HEADER_OFFSET_LENGTH], (uint16_t)payload_size);
+	put_u16(&header[HEADER_OFFSET_CREDITS], transport->credits_granted);
+	put_u32(&header[HEADER_OFFSET_CRC], transport->config.use_crc ? packet_crc(header, payload, payload_size) : 0U);
+
+	transport->write_busy = true;
+
+	if (!transport->config.write(header, ACC_TRANSPORT_HEADER_SIZE, payload, payload_size, transport->config.client_reference))
+	{
+		transport->write_busy = false;
+		return false;
+	}
+
+	transport->credits_advertised = transport->credits_granted;
+	transport->credits_update     = false;
+	transport->credits_request    = false;
+	transport->stats.packets_sent++;
+
+	return true;
+}
+
+
+static bool packet_write_data(acc_transport_t *transport)
+{
+	const acc_transport_frame_t *frame     = &transport->send_queue[transport->send_queue_head];
+	size_t                      remaining  = frame->size - transport->send_offset;
+	size_t                      size       = remaining < transport->config.max_payload_size ?
+	                                         remaining : transport->config.max_payload_size;
+	uint8_t                     flags      = ACC_TRANSPORT_FLAG_DATA;
+	const uint8_t               *payload   = size > 0 ? (const uint8_t *)frame->data + transport->send_offset : NULL;
+
+	if (transport->send_offset == 0)
+	{
+		flags |= ACC_TRANSPORT_FLAG_FIRST;
+	}
+
+	if (size == remaining)
+	{
+		flags |= ACC_TRANSPORT_FLAG_LAST;
+	}
+
+	if (!packet_write(transport, flags, payload, size))
+	{
+		return false;
+	}
+
+	transport->send_offset     += size;
+	transport->send_sequence++;
+	transport->packets_sent++;
+	transport->write_ends_frame = (flags & ACC_TRANSPORT_FLAG_LAST) != 0;
+
+	return true;
+}
+
+
+static void receive_reset(acc_transport_t *transport)
+{
+	transport->receive_header_length  = 0;
+	transport->receive_payload_length = 0;
+	transport->receive_payload_size   = 0;
+}
+
+
+static void packet_received(acc_transport_t *transport)
+{
+	const uint8_t *header = transport->receive_header;
+	uint8_t       flags   = header[HEADER_OFFSET_FLAGS];
+	size_t        size    = transport->receive_payload_size;
+
+	receive_reset(transport);
+
+	bool crc_valid = (flags & ACC_TRANSPORT_FLAG_CRC) != 0 ?
+	                 packet_crc(header, transport->config.receive_buffer, size) == get_u32(&header[HEADER_OFFSET_CRC]) :
+	                 !transport->config.use_crc;
+
+	if (!crc_valid)
+	{
+		transport->stats.crc_errors++;
+		return;
+	}
+
+	transport->peer_credits = get_u16(&header[HEADER_OFFSET_CREDITS]);
+
+	if ((flags & ACC_TRANSPORT_FLAG_REQUEST) != 0)
+	{
+		transport->credits_update = true;
+	}
+
+	uint8_t sequence = header[HEADER_OFFSET_SEQUENCE];
+
+	if (!transport->receive_sequence_valid)
+	{
+		transport->receive_sequence       = sequence;
+		transport->receive_sequence_valid = true;
+	}
+
+	/*
+	 * Every header carries the sequence number of the next data packet, so
+	 * a header without data also shows that the last data packets were lost
+	 */
+	if (sequence != transport->receive_sequence)
+	{
+		// The lost packets were sent on credits that no longer hold any data
+		uint8_t lost = (uint8_t)(sequence - transport->receive_sequence);
+
+		transport->stats.lost_packets += lost;
+		transport->receive_sequence    = sequence;
+		transport->receive_lost        = true;
+		credits_grant(transport, lost, true);
+	}
+
+	if ((flags & ACC_TRANSPORT_FLAG_DATA) == 0)
+	{
+		return;
+	}
+
+	uint8_t callback_flags = flags & (ACC_TRANSPORT_FLAG_FIRST | ACC_TRANSPORT_FLAG_LAST);
+
+	if (transport->receive_lost)
+	{
+		callback_flags         |= ACC_TRANSPORT_FLAG_LOST;
+		transport->receive_lost = false;
+	}
+
+	transport->receive_sequence = (uint8_t)(sequence + 1U);
+	transport->stats.packets_received++;
+
+	transport->config.packet_received(transport->config.receive_buffer, size, callback_flags,
+	                                  transport->config.client_reference);
+
+	if (transport->config.auto_release)
+	{
+		credits_grant(transport, 1, false);
+	}
+}
+
+
+static void receive_byte(acc_transport_t *transport, uint8_t byte);
+
+
+/**
+ * @brief Look for a header in the bytes after the sync of an invalid header
+ */
+static void receive_resync(acc_transport_t *transport)
+{
+	uint8_t bytes[ACC_TRANSPORT_HEADER_SIZE - 1U];
+	size_t  count = transport->receive_header_length - 1U;
+
+	memcpy(bytes, &transport->receive_header[1], count);
+	receive_reset(transport);
+	transport->stats.skipped_bytes++;
+
+	// Fewer bytes than a header, so this does not resync again
+	for (size_t i = 0; i < count; i++)
+	{
+		receive_byte(transport, bytes[i]);
+	}
+}
+
+
+static void receive_header_check(acc_transport_t *transport)
+{
+	const uint8_t *header = transport->receive_header;
+	uint8_t       flags   = header[HEADER_OFFSET_FLAGS];
+	uint16_t      size    = get_u16(&header[HEADER_OFFSET_LENGTH]);
+
+	if ((flags & ~KNOWN_FLAGS) != 0 || size > transport->config.max_payload_size ||
+	    ((flags & ACC_TRANSPORT_FLAG_DATA) == 0 && size != 0))
+	{
+		receive_resync(transport);
+		return;
+	}
+
+	transport->receive_payload_size = size;
+
+	if (size == 0)
+	{
+		packet_received(transport);
+	}
+}
+
+
+static void receive_byte(acc_transport_t *transport, uint8_t byte)
+{
+	size_t header_length = transport->receive_header_length;
+
+	if (header_length == 0)
+	{
+		if (byte == SYNC_0)
+		{
+			transport->receive_header[transport->receive_header_length++] = byte;
+		}
+		else
+		{
+			transport->stats.skipped_bytes++;
+		}
+	}
+	else if (header_length == 1)
+	{
+		if (byte == SYNC_1)
+		{
+			transport->receive_header[transport->receive_header_length++] = byte;
+		}
+		else if (byte != SYNC_0)
+		{
+			transport->receive_header_length = 0;
+			transport->stats.skipped_bytes  += 2U;
+		}
+		else
+		{
+			transport->stats.skipped_bytes++;
+		}
+	}
+	else if (header_length < ACC_TRANSPORT_HEADER_SIZE)
+	{
+		transport->receive_header[transport->receive_header_length++] = byte;
+
+		if (transport->receive_header_length == ACC_TRANSPORT_HEADER_SIZE)
+		{
+			receive_header_check(transport);
+		}
+	}
+	else
+	{
+		transport->config.receive_buffer[transport->receive_payload_length++] = byte;
+
+		if (transport->receive_payload_length == transport->receive_payload_size)
+		{
+			packet_received(transport);
+		}
+	}
+}
+
+
+bool acc_transport_init(acc_transport_t *transport, const acc_transport_config_t *config)
+{
+	if (config->write == NULL || config->packet_received == NULL || config->receive_buffer == NULL ||
+	    config->max_payload_size == 0 || config->receive_credits == 0 || config->receive_credits >= CREDITS_MAX)
+	{
+		return false;
+	}
+
+	memset(transport, 0, sizeof(*transport));
+
+	transport->config          = *config;
+	transport->credits_granted = config->receive_credits;
+	transport->credits_update  = true;
+
+	return true;
+}
+
+
+bool acc_transport_send(acc_transport_t *transport, const void *frame, size_t size)
+{
+	if (transport->send_queue_count == ACC_TRANSPORT_SEND_QUEUE_LENGTH || (frame == NULL && size > 0))
+	{
+		return false;
+	}
+
+	size_t index = (transport->send_queue_head + transport->send_queue_count) % ACC_TRANSPORT_SEND_QUEUE_LENGTH;
+
+	transport->send_queue[index].data = frame;
+	transport->send_queue[index].size = size;
+	transport->send_queue_count++;
+
+	acc_transport_process(transport);
+
+	return true;
+}
+
+
+void acc_transport_write_done(acc_transport_t *transport)
+{
+	transport->write_done = true;
+}
+
+
+void acc_transport_process(acc_transport_t *transport)
+{
+	for (;;)
+	{
+		if (transport->write_done)
+		{
+			transport->write_done = false;
+			transport->write_busy = false;
+
+			if (transport->write_ends_frame)
+			{
+				const void *frame = transport->send_queue[transport->send_queue_head].data;
+
+				transport->write_ends_frame = false;
+				transport->send_queue_head  = (transport->send_queue_head + 1U) % ACC_TRANSPORT_SEND_QUEUE_LENGTH;
+				transport->send_queue_count--;
+				transport->send_offset = 0;
+
+				if (transport->config.frame_sent != NULL)
+				{
+					transport->config.frame_sent(frame, transport->config.client_reference);
+				}
+
+				// The callback may have sent a frame and started a write
+				continue;
+			}
+		}
+
+		if (transport->write_busy)
+		{
+			return;
+		}
+
+		bool written;
+
+		if (transport->send_queue_count > 0 && acc_transport_get_send_credits(transport) > 0)
+		{
+			written = packet_write_data(transport);
+		}
+		else if (transport->credits_update)
+		{
+			written = packet_write(transport, transport->credits_request ? ACC_TRANSPORT_FLAG_REQUEST : 0, NULL, 0);
+		}
+		else
+		{
+			return;
+		}
+
+		if (!written)
+		{
+			return;
+		}
+	}
+}
+
+
+void acc_transport_receive(acc_transport_t *transport, const uint8_t *data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		receive_byte(transport, data[i]);
+	}
+
+	acc_transport_process(transport);
+}
+
+
+void acc_transport_release(acc_transport_t *transport, uint16_t packets)
+{
+	credits_grant(transport, packets, false);
+	acc_transport_process(transport);
+}
+
+
+void acc_transport_announce(acc_transport_t *transport)
+{
+	transport->credits_update  = true;
+	transport->credits_request = transport->send_queue_count > 0 && acc_transport_get_send_credits(transport) == 0;
+	acc_transport_process(transport);
+}
+
+
+uint16_t acc_transport_get_send_credits(const acc_transport_t *transport)
+{
+	uint16_t credits = (uint16_t)(transport->peer_credits - transport->packets_sent);
+
+	return credits < CREDITS_MAX ? credits : 0;
+}
+
+
+bool acc_transport_is_idle(const acc_transport_t *transport)
+{
+	return transport->send_queue_count == 0 && !transport->write_busy;
+}
+
+
+const acc_transport_stats_t *acc_transport_get_stats(const acc_transport_t *transport)
+{
+	return &transport->stats;
+}
@@ -0,0 +1,217 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "acc_uart_rx.h"
+
+#include "acc_device_os.h"
+#include "acc_device_uart.h"
+#include "acc_log.h"
+
+
+#define MODULE "uart_rx" /**< module name */
+
+
+/**
+ * @brief Size of the blocks the receive task reads and passes to the handler
+ */
+#define READ_BLOCK_SIZE 256
+
+/**
+ * @brief Longest time between two reads while data is arriving
+ */
+#define POLL_PERIOD_MAX_MS 5
+
+/**
+ * @brief Bits on the line per byte, 8N1
+ */
+#define BITS_PER_BYTE 10
+
+/**
+ * @brief Number of UART ports, ACC_DEVICE_UART_MAX is the highest port number
+ */
+#define PORT_COUNT (ACC_DEVICE_UART_MAX + 1)
+
+
+typedef struct
+{
+	uint_fast8_t                        port;
+	size_t                              buffer_size;
+	uint32_t                            poll_period_ms;
+	acc_uart_rx_handler_t               handler;
+	void                                *client_reference;
+	acc_app_integration_semaphore_t     event_semaphore;
+	acc_app_integration_thread_handle_t thread;
+	uint32_t                            received_bytes;
+	uint32_t                            burst_count;
+	uint8_t                             block[READ_BLOCK_SIZE];
+} uart_rx_t;
+
+
+static uart_rx_t *uart_rx[PORT_COUNT];
+
+
+/**
+ * @brief Poll period that reads the buffer before it is half full, 0 if the buffer is too small
+ */
+static uint32_t poll_period_get(uint_fast8_t port, uint32_t baudrate, size_t buffer_size)
+{
+	uint32_t poll_period_ms = (uint32_t)((buffer_size / 2) * BITS_PER_BYTE * 1000 / baudrate);
+
+	if (poll_period_ms == 0)
+	{
+		ACC_LOG_ERROR("UART %u buffer of %u bytes is too small for %u baud", (unsigned int)port, (unsigned int)buffer_size,
+		              (unsigned int)baudrate);
+		return 0;
+	}
+
+	return poll_period_ms < POLL_PERIOD_MAX_MS ? poll_period_ms : POLL_PERIOD_MAX_MS;
+}
+
+
+static void rx_event(uint_fast8_t port)
+{
+	if (port < PORT_COUNT && uart_rx[port] != NULL)
+	{
+		acc_os_semaphore_signal_from_interrupt(uart_rx[port]->event_semaphore);
+	}
+}
+
+
+static void rx_task(void *param)
+{
+	uart_rx_t *rx = param;
+
+	while (true)
+	{
+		if (!acc_os_semaphore_wait(rx->event_semaphore, 1000))
+		{
+			continue;
+		}
+
+		rx->burst_count++;
+
+		while (true)
+		{
+			size_t length = acc_device_uart_block_read(rx->port, rx->block, sizeof(rx->block));
+
+			if (length == 0)
+			{
+				// Idle for a poll period, the next byte interrupts again
+				break;
+			}
+
+			rx->received_bytes += length;
+			rx->handler(rx->port, rx->block, length, rx->client_reference);
+
+			if (length < sizeof(rx->block))
+			{
+				acc_os_sleep_ms(rx->poll_period_ms);
+			}
+		}
+	}
+}
+
+
+bool acc_uart_rx_start(uint_fast8_t port, uint32_t baudrate, size_t buffer_size, acc_uart_rx_handler_t handler,
+                       void *client_reference)
+{
+	if (port >= PORT_COUNT || baudrate == 0 || handler == NULL || uart_rx[port] != NULL)
+	{
+		return false;
+	}
+
+	uint32_t poll_period_ms = poll_period_get(port, baudrate, buffer_size);
+
+	if (poll_period_ms == 0)
+	{
+		return false;
+	}
+
+	uart_rx_t *rx = acc_os_mem_alloc(sizeof(*rx));
+	if (rx == NULL)
+	{
+		return false;
+	}
+
+	memset(rx, 0, sizeof(*rx));
+
+	rx->port             = port;
+	rx->buffer_size      = buffer_size;
+	rx->poll_period_ms   = poll_period_ms;
+	rx->handler          = handler;
+	rx->client_reference = client_reference;
+	rx->event_semaphore  = acc_os_semaphore_create();
+
+	if (rx->event_semaphore == NULL)
+	{
+		acc_os_mem_free(rx);
+		return false;
+	}
+
+	uart_rx[port] = rx;
+
+	if (!acc_device_uart_block_read_start(port, buffer_size, rx_event))
+	{
+		ACC_LOG_ERROR("Failed to start block read on UART %u", (unsigned int)port);
+		uart_rx[port] = NULL;
+		acc_os_semaphore_destroy(rx->event_semaphore);
+		acc_os_mem_free(rx);
+		return false;
+	}
+
+	// Events before the task runs are kept by the semaphore
+	rx->thread = acc_os_thread_create(rx_task, rx, "uart_rx");
+	if (rx->thread == NULL)
+	{
+		ACC_LOG_ERROR("Failed to create the UART %u receive task", (unsigned int)port);
+		uart_rx[port] = NULL;
+		acc_os_semaphore_destroy(rx->event_semaphore);
+		acc_os_mem_free(rx);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool acc_uart_rx_baudrate_set(uint_fast8_t port, uint32_t baudrate)
+{
+	if (port >= PORT_COUNT || uart_rx[port] == NULL || baudrate == 0)
+	{
+		return false;
+	}
+
+	uint32_t poll_period_ms = poll_period_get(port, baudrate, uart_rx[port]->buffer_size);
+
+	if (poll_period_ms == 0)
+	{
+		return false;
+	}
+
+	uart_rx[port]->poll_period_ms = poll_period_ms;
+
+	return true;
+}
+
+
+bool acc_uart_rx_get_counters(uint_fast8_t port, acc_uart_rx_counters_t *counters)
+{
+	if (port >= PORT_COUNT || uart_rx[port] == NULL)
+	{
+		return false;
+	}
+
+	counters->received_bytes = uart_rx[port]->received_bytes;
+	counters->burst_count    = uart_rx[port]->burst_count;
+	counters->error_count    = acc_device_uart_get_error_count(port);
+
+	return true;
+}
@@ -30,15 +30,29 @@ typedef struct
 } print_buffer_t;
 
 
-static void out_func(char character, void *arg)
+static void out_func(const char *data, size_t length, void *arg)
 {
 	print_buffer_t *buf = arg;
 
-	buf->buffer[buf->position++] = character;
-	if (buf->position == BUF_SIZE)
+	while (length > 0)
 	{
-		_write(0, buf->buffer, BUF_SIZE);
-		buf->position = 0;
+		size_t copy = BUF_SIZE - buf->position;
+
+		if (copy > length)
+		{
+			copy = length;
+		}
+
+		memcpy(&buf->buffer[buf->position], data, copy);
+		buf->position += copy;
+		data          += copy;
+		length        -= copy;
+
+		if (buf->position == BUF_SIZE)
+		{
+			_write(0, buf->buffer, BUF_SIZE);
+			buf->position = 0;
+		}
 	}
 }
 
@@ -73,7 +87,7 @@ int __wrap_printf(const char *format, ...)
 	va_list        va;
 
 	va_start(va, format);
-	int ret = fctvprintf(out_func, &buf, format, va);
+	int ret = fctvprintf_span(out_func, &buf, format, va);
 	if (buf.position != 0)
 	{
 		_write(0, buf.buffer, buf.position);
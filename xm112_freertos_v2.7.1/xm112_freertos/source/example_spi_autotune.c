@@ -0,0 +1,115 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "acc_board_a1r2_xm112.h"
+#include "acc_driver_hal.h"
+#include "acc_driver_spi_same70.h"
+#include "acc_service.h"
+#include "acc_service_iq.h"
+#include "acc_spi_autotune.h"
+#include "acc_version.h"
+
+
+/** \example example_spi_autotune.c
+ * @brief This is an example on how to select the sensor SPI buffer size
+ * @n
+ * The example executes as follows:
+ *   - Create an IQ service configuration with a long range, which gives large sensor reads
+ *   - For each candidate buffer size, activate Radar System Software (RSS), read a
+ *     number of frames and measure the SPI throughput
+ *   - Select the smallest buffer size within a tolerance of the best throughput
+ *   - Print the measurements and the selected buffer size
+ */
+
+
+#define FRAME_COUNT       50
+#define TOLERANCE_PERCENT 5
+
+
+static const size_t candidates[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+
+#define CANDIDATE_COUNT (sizeof(candidates) / sizeof(candidates[0]))
+
+
+static bool iq_get_next(acc_service_handle_t handle);
+
+
+static bool acc_example_spi_autotune(void);
+
+
+int main(void)
+{
+	if (!acc_driver_hal_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!acc_example_spi_autotune())
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+bool acc_example_spi_autotune(void)
+{
+	printf("Acconeer software version %s\n", acc_version_get());
+
+	acc_service_configuration_t iq_configuration = acc_service_iq_configuration_create();
+
+	if (iq_configuration == NULL)
+	{
+		printf("acc_service_iq_configuration_create() failed\n");
+		return false;
+	}
+
+	acc_service_requested_start_set(iq_configuration, 0.2f);
+	acc_service_requested_length_set(iq_configuration, 1.5f);
+	acc_service_iq_output_format_set(iq_configuration, ACC_SERVICE_IQ_OUTPUT_FORMAT_INT16_COMPLEX);
+
+	acc_spi_autotune_result_t results[CANDIDATE_COUNT];
+	size_t                    buffer_size;
+
+	bool success = acc_spi_autotune(iq_configuration, iq_get_next,
+	                                acc_board_get_spi_master_handle(), acc_driver_spi_same70_buffer_size_set,
+	                                candidates, results, CANDIDATE_COUNT,
+	                                FRAME_COUNT, TOLERANCE_PERCENT, &buffer_size);
+
+	acc_service_iq_configuration_destroy(&iq_configuration);
+
+	if (!success)
+	{
+		printf("acc_spi_autotune() failed\n");
+		return false;
+	}
+
+	for (size_t i = 0; i < CANDIDATE_COUNT; i++)
+	{
+		printf("Buffer size %5u: %u.%02u MB/s\n", (unsigned int)results[i].buffer_size,
+		       (unsigned int)(results[i].kb_per_s / 1000), (unsigned int)((results[i].kb_per_s % 1000) / 10));
+	}
+
+	printf("Selected buffer size: %u\n", (unsigned int)buffer_size);
+
+	return true;
+}
+
+
+bool iq_get_next(acc_service_handle_t handle)
+{
+	acc_int16_complex_t          *data;
+	acc_service_iq_result_info_t result_info;
+
+	return acc_service_iq_get_next_by_reference(handle, &data, &result_info);
+}
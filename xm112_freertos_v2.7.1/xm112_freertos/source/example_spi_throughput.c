@@ -0,0 +1,191 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "acc_board_a1r2_xm112.h"
+#include "acc_device_spi.h"
+#include "acc_driver_hal.h"
+#include "acc_driver_spi_same70.h"
+#include "acc_hal_definitions.h"
+#include "acc_rss.h"
+#include "acc_service.h"
+#include "acc_service_iq.h"
+#include "acc_version.h"
+
+
+/** \example example_spi_throughput.c
+ * @brief This is an example on how to measure the sensor SPI throughput
+ * @n
+ * The example executes as follows:
+ *   - Activate Radar System Software (RSS)
+ *   - Create an IQ service with a long range, which gives large sensor reads
+ *   - Read a number of frames
+ *   - Print the number of bytes transferred, the time spent in SPI transfers and
+ *     the achieved throughput
+ *   - Print the SPI bus telemetry, including the transfer time histogram
+ *   - Deactivate and destroy the IQ service
+ *   - Deactivate Radar System Software (RSS)
+ */
+
+
+#define FRAME_COUNT 500
+
+
+static void update_configuration(acc_service_configuration_t iq_configuration);
+
+
+static void print_statistics(const acc_driver_spi_same70_statistics_t *statistics,
+                             const acc_device_spi_telemetry_t         *telemetry);
+
+
+static bool acc_example_spi_throughput(void);
+
+
+int main(void)
+{
+	if (!acc_driver_hal_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!acc_example_spi_throughput())
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+bool acc_example_spi_throughput(void)
+{
+	printf("Acconeer software version %s\n", acc_version_get());
+
+	const acc_hal_t *hal = acc_driver_hal_get_implementation();
+
+	if (!acc_rss_activate(hal))
+	{
+		printf("acc_rss_activate() failed\n");
+		return false;
+	}
+
+	acc_service_configuration_t iq_configuration = acc_service_iq_configuration_create();
+
+	if (iq_configuration == NULL)
+	{
+		printf("acc_service_iq_configuration_create() failed\n");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	update_configuration(iq_configuration);
+
+	acc_service_handle_t handle = acc_service_create(iq_configuration);
+
+	acc_service_iq_configuration_destroy(&iq_configuration);
+
+	if (handle == NULL)
+	{
+		printf("acc_service_create() failed\n");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	acc_service_iq_metadata_t iq_metadata = { 0 };
+	acc_service_iq_get_metadata(handle, &iq_metadata);
+
+	printf("Data length: %u\n", (unsigned int)(iq_metadata.data_length));
+
+	if (!acc_service_activate(handle))
+	{
+		printf("acc_service_activate() failed\n");
+		acc_service_destroy(&handle);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	acc_device_handle_t                spi_handle = acc_board_get_spi_master_handle();
+	acc_driver_spi_same70_statistics_t statistics;
+	acc_device_spi_telemetry_t         telemetry;
+	bool                               success = true;
+
+	// Only count transfers made while reading frames
+	acc_driver_spi_same70_statistics_get(spi_handle, &statistics, true);
+	acc_device_spi_telemetry_reset();
+	acc_device_spi_telemetry_enable(true);
+
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		acc_int16_complex_t          *data;
+		acc_service_iq_result_info_t result_info;
+
+		success = acc_service_iq_get_next_by_reference(handle, &data, &result_info);
+
+		if (!success)
+		{
+			printf("acc_service_iq_get_next_by_reference() failed\n");
+			break;
+		}
+	}
+
+	acc_driver_spi_same70_statistics_get(spi_handle, &statistics, false);
+	acc_device_spi_telemetry_get(acc_device_spi_get_bus(spi_handle), &telemetry, false);
+	acc_device_spi_telemetry_enable(false);
+
+	bool deactivated = acc_service_deactivate(handle);
+
+	acc_service_destroy(&handle);
+
+	acc_rss_deactivate();
+
+	if (success)
+	{
+		print_statistics(&statistics, &telemetry);
+		acc_device_spi_telemetry_log(acc_device_spi_get_bus(spi_handle));
+	}
+
+	return deactivated && success;
+}
+
+
+void update_configuration(acc_service_configuration_t iq_configuration)
+{
+	float start_m  = 0.2f;
+	float length_m = 1.5f;
+
+	acc_service_requested_start_set(iq_configuration, start_m);
+	acc_service_requested_length_set(iq_configuration, length_m);
+	acc_service_iq_output_format_set(iq_configuration, ACC_SERVICE_IQ_OUTPUT_FORMAT_INT16_COMPLEX);
+}
+
+
+void print_statistics(const acc_driver_spi_same70_statistics_t *statistics,
+                      const acc_device_spi_telemetry_t         *telemetry)
+{
+	uint64_t bytes = statistics->direct_bytes + statistics->bounced_bytes;
+
+	printf("Transfers: %u\n", (unsigned int)statistics->transfer_count);
+	printf("Bytes: %u (%u in place, %u through the driver buffer)\n", (unsigned int)bytes,
+	       (unsigned int)statistics->direct_bytes, (unsigned int)statistics->bounced_bytes);
+	printf("Transfer time: %u us\n", (unsigned int)telemetry->transfer_time_us);
+
+	/*
+	 * The throughput is based on the telemetry, which times each transfer in
+	 * microseconds. The driver statistics only have millisecond resolution per
+	 * transfer, which is too coarse for transfers of a few hundred microseconds.
+	 */
+	if (telemetry->transfer_time_us > 0)
+	{
+		// Bytes per microsecond is MB/s, print with two decimals
+		uint32_t mb_per_s_x100 = (uint32_t)(telemetry->bytes * 100U / telemetry->transfer_time_us);
+
+		printf("Throughput: %u.%02u MB/s\n", (unsigned int)(mb_per_s_x100 / 100U), (unsigned int)(mb_per_s_x100 % 100U));
+	}
+}
@@ -0,0 +1,183 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "acc_driver_hal.h"
+#include "acc_hal_definitions.h"
+#include "acc_recording_writer.h"
+#include "acc_rss.h"
+#include "acc_service.h"
+#include "acc_service_envelope.h"
+#include "acc_stream_writer.h"
+#include "acc_version.h"
+
+
+/** \example example_stream_envelope.c
+ * @brief This is an example on how envelope data can be streamed over a UART
+ * @n
+ * The data is sent in the binary stream format instead of being printed as
+ * text. The stream is written to the debug UART, so the text output of the
+ * application and the log messages are on the same link. The receiver, built
+ * on acc_stream_decoder, discards the text between the messages.
+ * @n
+ * The example executes as follows:
+ *   - Activate Radar System Software (RSS)
+ *   - Create an envelope service configuration
+ *   - Create an envelope service using the previously created configuration
+ *   - Send the metadata and the configuration
+ *   - Destroy the envelope service configuration
+ *   - Activate the envelope service
+ *   - Get the result and send it with the result info 100 times
+ *   - Deactivate and destroy the envelope service
+ *   - Deactivate Radar System Software (RSS)
+ */
+
+
+/**
+ * @brief The debug UART of the XM112
+ */
+#define STREAM_UART_PORT 2U
+
+
+static void update_configuration(acc_service_configuration_t envelope_configuration);
+
+
+static bool acc_example_stream_envelope(void);
+
+
+int main(void)
+{
+	if (!acc_driver_hal_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!acc_example_stream_envelope())
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+bool acc_example_stream_envelope(void)
+{
+	printf("Acconeer software version %s\n", acc_version_get());
+
+	const acc_hal_t *hal = acc_driver_hal_get_implementation();
+
+	if (!acc_rss_activate(hal))
+	{
+		printf("acc_rss_activate() failed\n");
+		return false;
+	}
+
+	acc_service_configuration_t envelope_configuration = acc_service_envelope_configuration_create();
+
+	if (envelope_configuration == NULL)
+	{
+		printf("acc_service_envelope_configuration_create() failed\n");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	update_configuration(envelope_configuration);
+
+	acc_service_handle_t handle = acc_service_create(envelope_configuration);
+
+	if (handle == NULL)
+	{
+		printf("acc_service_create() failed\n");
+		acc_service_envelope_configuration_destroy(&envelope_configuration);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	acc_service_envelope_metadata_t envelope_metadata = { 0 };
+	acc_service_envelope_get_metadata(handle, &envelope_metadata);
+
+	acc_recording_metadata_t      recording_metadata;
+	acc_recording_configuration_t recording_configuration;
+
+	acc_recording_writer_describe_envelope(&envelope_metadata, envelope_configuration, &recording_metadata,
+	                                       &recording_configuration);
+
+	acc_service_envelope_configuration_destroy(&envelope_configuration);
+
+	// The metadata message is the largest unless the frame is longer
+	size_t              frame_size   = sizeof(acc_stream_frame_header_t) + envelope_metadata.data_length * sizeof(uint16_t);
+	size_t              payload_size = frame_size > sizeof(acc_stream_metadata_t) ? frame_size : sizeof(acc_stream_metadata_t);
+	size_t              buffer_size  = ACC_STREAM_ENCODED_SIZE(payload_size);
+	uint8_t             buffer[buffer_size];
+	acc_stream_writer_t writer;
+
+	acc_stream_writer_init_uart(&writer, STREAM_UART_PORT, buffer, buffer_size);
+
+	if (!acc_stream_writer_send_metadata(&writer, ACC_RECORDING_SERVICE_TYPE_ENVELOPE, &recording_metadata,
+	                                     &recording_configuration))
+	{
+		printf("acc_stream_writer_send_metadata() failed\n");
+		acc_service_destroy(&handle);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	if (!acc_service_activate(handle))
+	{
+		printf("acc_service_activate() failed\n");
+		acc_service_destroy(&handle);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	bool                               success    = true;
+	const int                          iterations = 100;
+	uint16_t                           data[envelope_metadata.data_length];
+	acc_service_envelope_result_info_t result_info;
+
+	for (int i = 0; i < iterations; i++)
+	{
+		success = acc_service_envelope_get_next(handle, data, envelope_metadata.data_length, &result_info);
+
+		if (!success)
+		{
+			printf("acc_service_envelope_get_next() failed\n");
+			break;
+		}
+
+		// A frame that fails to send is lost, the receiver sees the gap in the sequence numbers
+		acc_stream_writer_send_frame(&writer, data, envelope_metadata.data_length,
+		                             acc_recording_writer_envelope_result_info(&result_info), 0);
+	}
+
+	bool deactivated = acc_service_deactivate(handle);
+
+	acc_service_destroy(&handle);
+
+	acc_rss_deactivate();
+
+	if (writer.failed_message_count > 0)
+	{
+		printf("%u messages could not be sent\n", (unsigned int)writer.failed_message_count);
+	}
+
+	return deactivated && success;
+}
+
+
+void update_configuration(acc_service_configuration_t envelope_configuration)
+{
+	float start_m  = 0.2f;
+	float length_m = 0.5f;
+
+	acc_service_requested_start_set(envelope_configuration, start_m);
+	acc_service_requested_length_set(envelope_configuration, length_m);
+}
@@ -0,0 +1,296 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "acc_device_os.h"
+#include "acc_driver_hal.h"
+#include "acc_hal_definitions.h"
+#include "acc_ms_system.h"
+#include "acc_rss.h"
+#include "acc_service.h"
+#include "acc_service_envelope.h"
+#include "acc_tcm.h"
+#include "acc_version.h"
+
+#include "mm/l1cache.h"
+#include "peripherals/pmc.h"
+
+
+/** \example example_tcm_latency.c
+ * @brief This is an example on how to measure interrupt latency and frame processing time
+ * @n
+ * Build it without and with tightly coupled memory and compare the results, e.g.
+ * "make" and "make ACC_CFG_TCM=64 ACC_CFG_TCM_HEAP=16".
+ * @n
+ * The example executes as follows:
+ *   - Activate Radar System Software (RSS)
+ *   - Create and activate an envelope service
+ *   - Start a task with a priority above the main task, which waits for a
+ *     semaphore signalled from the sensor interrupt
+ *   - Read a number of frames with warm caches, and the same number of frames
+ *     with the caches cleaned and invalidated before each frame
+ *   - For each frame measure the time from the sensor interrupt until the
+ *     task runs, and until the frame has been read and processed
+ *   - Print minimum, average and maximum of both times in microseconds
+ *   - Deactivate and destroy the envelope service
+ *   - Deactivate Radar System Software (RSS)
+ */
+
+
+#define FRAME_COUNT 200
+
+#define DEMCR              (*(volatile uint32_t *)0xE000EDFCU)
+#define DEMCR_TRCENA       (1U << 24)
+#define DWT_CTRL           (*(volatile uint32_t *)0xE0001000U)
+#define DWT_CTRL_CYCCNTENA 1U
+#define DWT_CYCCNT         (*(volatile uint32_t *)0xE0001004U)
+#define DWT_LAR            (*(volatile uint32_t *)0xE0001FB0U)
+#define DWT_LAR_KEY        0xC5ACCE55U
+
+
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t count;
+} cycle_statistics_t;
+
+
+static volatile uint32_t               interrupt_cycles;
+static volatile uint32_t               latency_cycles;
+static volatile bool                   latency_valid;
+static acc_app_integration_semaphore_t wake_semaphore;
+
+
+static void update_configuration(acc_service_configuration_t envelope_configuration);
+
+
+static bool measure(acc_service_handle_t handle, bool cold_cache, cycle_statistics_t *latency, cycle_statistics_t *processing);
+
+
+static void print_statistics(const char *name, const cycle_statistics_t *statistics);
+
+
+static bool acc_example_tcm_latency(void);
+
+
+int main(void)
+{
+	if (!acc_driver_hal_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!acc_example_tcm_latency())
+	{
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+ACC_TCM_CODE static void sensor_interrupt(void)
+{
+	interrupt_cycles = DWT_CYCCNT;
+	acc_os_semaphore_signal_from_interrupt(wake_semaphore);
+}
+
+
+static void latency_task(void *param)
+{
+	(void)param;
+
+	for (;;)
+	{
+		if (acc_os_semaphore_wait(wake_semaphore, 1000))
+		{
+			latency_cycles = DWT_CYCCNT - interrupt_cycles;
+			latency_valid  = true;
+		}
+	}
+}
+
+
+bool acc_example_tcm_latency(void)
+{
+	printf("Acconeer software version %s\n", acc_version_get());
+	printf("ITCM and DTCM: %u kB each, heap in DTCM: %u kB\n", (unsigned int)(ACC_TCM_SIZE / 1024),
+	       (unsigned int)(ACC_TCM_HEAP_SIZE / 1024));
+
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_LAR   = DWT_LAR_KEY;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+	const acc_hal_t *hal = acc_driver_hal_get_implementation();
+
+	if (!acc_rss_activate(hal))
+	{
+		printf("acc_rss_activate() failed\n");
+		return false;
+	}
+
+	acc_service_configuration_t envelope_configuration = acc_service_envelope_configuration_create();
+
+	if (envelope_configuration == NULL)
+	{
+		printf("acc_service_envelope_configuration_create() failed\n");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	update_configuration(envelope_configuration);
+
+	acc_service_handle_t handle = acc_service_create(envelope_configuration);
+
+	acc_service_envelope_configuration_destroy(&envelope_configuration);
+
+	if (handle == NULL)
+	{
+		printf("acc_service_create() failed\n");
+		acc_rss_deactivate();
+		return false;
+	}
+
+	wake_semaphore = acc_os_semaphore_create();
+
+	TaskHandle_t task_handle = NULL;
+
+	if (wake_semaphore == NULL ||
+	    xTaskCreate(latency_task, "latency", 256, NULL, uxTaskPriorityGet(NULL) + 1, &task_handle) != pdPASS)
+	{
+		printf("Could not start the latency task\n");
+		acc_service_destroy(&handle);
+		acc_rss_deactivate();
+		return false;
+	}
+
+	acc_ms_system_register_sensor_interrupt_callback(sensor_interrupt);
+
+	cycle_statistics_t warm_latency, warm_processing, cold_latency, cold_processing;
+	bool               success = acc_service_activate(handle);
+
+	if (!success)
+	{
+		printf("acc_service_activate() failed\n");
+	}
+	else
+	{
+		success = measure(handle, false, &warm_latency, &warm_processing) &&
+		          measure(handle, true, &cold_latency, &cold_processing);
+
+		success = acc_service_deactivate(handle) && success;
+	}
+
+	acc_ms_system_register_sensor_interrupt_callback(NULL);
+	vTaskDelete(task_handle);
+	acc_os_semaphore_destroy(wake_semaphore);
+
+	acc_service_destroy(&handle);
+
+	acc_rss_deactivate();
+
+	if (success)
+	{
+		print_statistics("Interrupt to task, warm cache", &warm_latency);
+		print_statistics("Interrupt to task, cold cache", &cold_latency);
+		print_statistics("Interrupt to processed frame, warm cache", &warm_processing);
+		print_statistics("Interrupt to processed frame, cold cache", &cold_processing);
+	}
+
+	return success;
+}
+
+
+void update_configuration(acc_service_configuration_t envelope_configuration)
+{
+	float start_m  = 0.2f;
+	float length_m = 0.5f;
+
+	acc_service_requested_start_set(envelope_configuration, start_m);
+	acc_service_requested_length_set(envelope_configuration, length_m);
+}
+
+
+static void statistics_add(cycle_statistics_t *statistics, uint32_t cycles)
+{
+	if (cycles < statistics->min)
+	{
+		statistics->min = cycles;
+	}
+
+	if (cycles > statistics->max)
+	{
+		statistics->max = cycles;
+	}
+
+	statistics->sum += cycles;
+	statistics->count++;
+}
+
+
+bool measure(acc_service_handle_t handle, bool cold_cache, cycle_statistics_t *latency, cycle_statistics_t *processing)
+{
+	*latency    = (cycle_statistics_t){ UINT32_MAX, 0, 0, 0 };
+	*processing = (cycle_statistics_t){ UINT32_MAX, 0, 0, 0 };
+
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		uint16_t                           *data;
+		acc_service_envelope_result_info_t result_info;
+
+		if (cold_cache)
+		{
+			// Like after a sleep where other work has evicted the interrupt path from the caches
+			dcache_clean_invalidate();
+			icache_invalidate();
+		}
+
+		latency_valid = false;
+
+		if (!acc_service_envelope_get_next_by_reference(handle, &data, &result_info))
+		{
+			printf("acc_service_envelope_get_next_by_reference() failed\n");
+			return false;
+		}
+
+		statistics_add(processing, DWT_CYCCNT - interrupt_cycles);
+
+		if (latency_valid)
+		{
+			statistics_add(latency, latency_cycles);
+		}
+	}
+
+	return true;
+}
+
+
+void print_statistics(const char *name, const cycle_statistics_t *statistics)
+{
+	uint32_t cycles_per_us = pmc_get_processor_clock() / 1000000;
+
+	if (statistics->count == 0 || cycles_per_us == 0)
+	{
+		printf("%s: no samples\n", name);
+		return;
+	}
+
+	uint32_t average = (uint32_t)(statistics->sum / statistics->count);
+
+	printf("%s: min %u.%02u us, average %u.%02u us, max %u.%02u us\n", name,
+	       (unsigned int)(statistics->min / cycles_per_us), (unsigned int)((statistics->min % cycles_per_us) * 100 / cycles_per_us),
+	       (unsigned int)(average / cycles_per_us), (unsigned int)((average % cycles_per_us) * 100 / cycles_per_us),
+	       (unsigned int)(statistics->max / cycles_per_us), (unsigned int)((statistics->max % cycles_per_us) * 100 / cycles_per_us));
+}
@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "printf.h"
 
@@ -88,6 +89,21 @@
 #define PRINTF_SUPPORT_LONG_LONG
 #endif
 
+// fast paths: literal text, strings and padded fields are emitted as spans,
+// decimal and hexadecimal integers without '#' (%u, %d, %x, %6u, %-6u, %+5d,
+// %.3u, ...) are converted with a digit-pair table straight into their final
+// field
+// default: activated
+#ifndef PRINTF_DISABLE_FAST_PATHS
+#define PRINTF_FAST_PATHS
+#endif
+
+// largest field width and integer precision handled by the fast paths
+// default: 16 characters
+#ifndef PRINTF_FAST_WIDTH_MAX
+#define PRINTF_FAST_WIDTH_MAX  16U
+#endif
+
 // support for the ptrdiff_t type (%t)
 // ptrdiff_t is normally defined in <stddef.h> as long or long long type
 // default: activated
@@ -121,9 +137,10 @@
 typedef void (*out_fct_type)(char character, void* buffer, size_t idx, size_t maxlen);
 
 
-// wrapper (used as buffer) for output function type
+// wrapper (used as buffer) for output function type, one of fct and span is set
 typedef struct {
   void  (*fct)(char character, void* arg);
+  void  (*span)(const char* data, size_t length, void* arg);
   void* arg;
 } out_fct_wrap_type;
 
@@ -160,9 +177,41 @@ static inline void _out_fct(char character, void* buffer, size_t idx, size_t max
   (void)idx; (void)maxlen;
   if (character) {
     // buffer is the output fct pointer
-    ((out_fct_wrap_type*)buffer)->fct(character, ((out_fct_wrap_type*)buffer)->arg);
+    const out_fct_wrap_type* wrap = (const out_fct_wrap_type*)buffer;
+    if (wrap->fct) {
+      wrap->fct(character, wrap->arg);
+    }
+    else {
+      wrap->span(&character, 1U, wrap->arg);
+    }
+  }
+}
+
+
+#if defined(PRINTF_FAST_PATHS)
+// output a span of characters, in one call when the output supports it
+static size_t _out_span(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* data, size_t len)
+{
+  if (out == _out_buffer) {
+    if (idx < maxlen) {
+      memcpy(&buffer[idx], data, (len < maxlen - idx) ? len : maxlen - idx);
+    }
+    return idx + len;
+  }
+
+  if ((out == _out_fct) && ((const out_fct_wrap_type*)buffer)->span) {
+    if (len) {
+      ((const out_fct_wrap_type*)buffer)->span(data, len, ((const out_fct_wrap_type*)buffer)->arg);
+    }
+    return idx + len;
+  }
+
+  for (size_t i = 0U; i < len; i++) {
+    out(data[i], buffer, idx++, maxlen);
   }
+  return idx;
 }
+#endif  // PRINTF_FAST_PATHS
 
 
 // internal secure strlen
@@ -194,11 +243,49 @@ static unsigned int _atoi(const char** str)
 }
 
 
+#if defined(PRINTF_FAST_PATHS)
+// output count spaces
+static size_t _out_spaces(out_fct_type out, char* buffer, size_t idx, size_t maxlen, size_t count)
+{
+  static const char spaces[] = "                ";
+
+  while (count) {
+    const size_t len = (count < sizeof(spaces) - 1U) ? count : sizeof(spaces) - 1U;
+    idx = _out_span(out, buffer, idx, maxlen, spaces, len);
+    count -= len;
+  }
+  return idx;
+}
+#endif  // PRINTF_FAST_PATHS
+
+
 // output the specified string in reverse, taking care of any zero-padding
 static size_t _out_rev(out_fct_type out, char* buffer, size_t idx, size_t maxlen, const char* buf, size_t len, unsigned int width, unsigned int flags)
 {
   const size_t start_idx = idx;
 
+#if defined(PRINTF_FAST_PATHS)
+  // build the padded field and output it as one span
+  char field[((PRINTF_NTOA_BUFFER_SIZE > PRINTF_FTOA_BUFFER_SIZE) ? PRINTF_NTOA_BUFFER_SIZE : PRINTF_FTOA_BUFFER_SIZE) + PRINTF_FAST_WIDTH_MAX];
+  const size_t pad = ((len < width) && !(!(flags & FLAGS_LEFT) && (flags & FLAGS_ZEROPAD))) ? width - len : 0U;
+
+  if (len + pad <= sizeof(field)) {
+    char* p = field;
+    if (!(flags & FLAGS_LEFT)) {
+      memset(p, ' ', pad);
+      p += pad;
+    }
+    for (size_t i = len; i; i--) {
+      *p++ = buf[i - 1U];
+    }
+    if (flags & FLAGS_LEFT) {
+      memset(p, ' ', pad);
+      p += pad;
+    }
+    return _out_span(out, buffer, idx, maxlen, field, (size_t)(p - field));
+  }
+#endif
+
   // pad spaces up to given width
   if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD)) {
     for (size_t i = len; i < width; i++) {
@@ -326,6 +413,92 @@ static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t
 #endif  // PRINTF_SUPPORT_LONG_LONG
 
 
+#if defined(PRINTF_FAST_PATHS)
+static const char _digit_pairs[200] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+
+// integer without hash, written backwards into its final field and output as
+// one span; left aligned fields have the padding after the digits
+static size_t _ntoa_fast(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long value, bool negative, unsigned int base, unsigned int prec, unsigned int width, unsigned int flags)
+{
+  // digits and the padding before them up to the middle, padding after them from the middle
+  char field[PRINTF_NTOA_BUFFER_SIZE + 2U * PRINTF_FAST_WIDTH_MAX];
+  char* end = field + PRINTF_NTOA_BUFFER_SIZE + PRINTF_FAST_WIDTH_MAX;
+  char* p = end;
+
+  // no digits for a zero value with precision, like _ntoa_long
+  if (!(flags & FLAGS_PRECISION) || value) {
+    if (base == 10U) {
+      while (value >= 100U) {
+        const unsigned long pair = (value % 100U) * 2U;
+        value /= 100U;
+        p -= 2;
+        p[0] = _digit_pairs[pair];
+        p[1] = _digit_pairs[pair + 1U];
+      }
+      if (value >= 10U) {
+        p -= 2;
+        p[0] = _digit_pairs[value * 2U];
+        p[1] = _digit_pairs[value * 2U + 1U];
+      }
+      else {
+        *--p = (char)('0' + value);
+      }
+    }
+    else {
+      const char* digits = (flags & FLAGS_UPPERCASE) ? "0123456789ABCDEF" : "0123456789abcdef";
+      do {
+        *--p = digits[value & 0xFU];
+        value >>= 4U;
+      } while (value);
+    }
+  }
+
+  const char sign = negative ? '-' : (flags & FLAGS_PLUS) ? '+' : (flags & FLAGS_SPACE) ? ' ' : '\0';
+
+  // _ntoa_format ignores the precision and the '0' flag of left aligned fields
+  if (!(flags & FLAGS_LEFT)) {
+    if ((size_t)(end - p) < prec) {
+      const size_t pad = prec - (size_t)(end - p);
+      p -= pad;
+      memset(p, '0', pad);
+    }
+    if ((flags & FLAGS_ZEROPAD) && ((size_t)(end - p) + (sign ? 1U : 0U) < width)) {
+      const size_t pad = width - (size_t)(end - p) - (sign ? 1U : 0U);
+      p -= pad;
+      memset(p, '0', pad);
+    }
+  }
+  if (sign) {
+    *--p = sign;
+  }
+  if ((size_t)(end - p) < width) {
+    const size_t pad = width - (size_t)(end - p);
+    if (flags & FLAGS_LEFT) {
+      memset(end, ' ', pad);
+      end += pad;
+    }
+    else {
+      p -= pad;
+      memset(p, ' ', pad);
+    }
+  }
+
+  return _out_span(out, buffer, idx, maxlen, p, (size_t)(end - p));
+}
+#endif  // PRINTF_FAST_PATHS
+
+
 #if defined(PRINTF_SUPPORT_FLOAT)
 
 #if defined(PRINTF_SUPPORT_EXPONENTIAL)
@@ -588,8 +761,16 @@ static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const
     // format specifier?  %[flags][width][.precision][length]
     if (*format != '%') {
       // no
+#if defined(PRINTF_FAST_PATHS)
+      const char* start = format;
+      while (*format && (*format != '%')) {
+        format++;
+      }
+      idx = _out_span(out, buffer, idx, maxlen, start, (size_t)(format - start));
+#else
       out(*format, buffer, idx++, maxlen);
       format++;
+#endif
       continue;
     }
     else {
@@ -717,6 +898,23 @@ static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const
           flags &= ~FLAGS_ZEROPAD;
         }
 
+#if defined(PRINTF_FAST_PATHS)
+        // decimal and hexadecimal fields of int and long size without hash
+        if (((base == 10U) || (base == 16U)) && !(flags & (FLAGS_LONG_LONG | FLAGS_HASH)) &&
+            (width <= PRINTF_FAST_WIDTH_MAX) && (precision <= PRINTF_FAST_WIDTH_MAX)) {
+          if ((*format == 'i') || (*format == 'd')) {
+            const long value = (flags & FLAGS_LONG) ? va_arg(va, long) : (flags & FLAGS_CHAR) ? (signed char)va_arg(va, int) : (flags & FLAGS_SHORT) ? (short int)va_arg(va, int) : va_arg(va, int);
+            idx = _ntoa_fast(out, buffer, idx, maxlen, (unsigned long)(value > 0 ? value : 0 - value), value < 0, base, precision, width, flags);
+          }
+          else {
+            const unsigned long value = (flags & FLAGS_LONG) ? va_arg(va, unsigned long) : (flags & FLAGS_CHAR) ? (unsigned char)va_arg(va, unsigned int) : (flags & FLAGS_SHORT) ? (unsigned short int)va_arg(va, unsigned int) : va_arg(va, unsigned int);
+            idx = _ntoa_fast(out, buffer, idx, maxlen, value, false, base, precision, width, flags);
+          }
+          format++;
+          break;
+        }
+#endif  // PRINTF_FAST_PATHS
+
         // convert the integer
         if ((*format == 'i') || (*format == 'd')) {
           // signed
@@ -794,6 +992,20 @@ static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const
 
       case 's' : {
         const char* p = va_arg(va, char*);
+#if defined(PRINTF_FAST_PATHS)
+        {
+          const size_t l = (flags & FLAGS_PRECISION) ? _strnlen_s(p, precision) : strlen(p);
+          if (!(flags & FLAGS_LEFT) && (l < width)) {
+            idx = _out_spaces(out, buffer, idx, maxlen, width - l);
+          }
+          idx = _out_span(out, buffer, idx, maxlen, p, l);
+          if ((flags & FLAGS_LEFT) && (l < width)) {
+            idx = _out_spaces(out, buffer, idx, maxlen, width - l);
+          }
+          format++;
+          break;
+        }
+#endif
         unsigned int l = _strnlen_s(p, precision ? precision : (size_t)-1);
         // pre padding
         if (flags & FLAGS_PRECISION) {
@@ -906,7 +1118,7 @@ int fctprintf(void (*out)(char character, void* arg), void* arg, const char* for
 {
   va_list va;
   va_start(va, format);
-  const out_fct_wrap_type out_fct_wrap = { out, arg };
+  const out_fct_wrap_type out_fct_wrap = { out, NULL, arg };
   const int ret = _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
   va_end(va);
   return ret;
@@ -914,6 +1126,24 @@ int fctprintf(void (*out)(char character, void* arg), void* arg, const char* for
 
 int fctvprintf(void (*out)(char character, void* arg), void* arg, const char* format, va_list va)
 {
-  const out_fct_wrap_type out_fct_wrap = { out, arg };
+  const out_fct_wrap_type out_fct_wrap = { out, NULL, arg };
+  return _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+}
+
+
+int fctprintf_span(void (*out)(const char* data, size_t length, void* arg), void* arg, const char* format, ...)
+{
+  va_list va;
+  va_start(va, format);
+  const out_fct_wrap_type out_fct_wrap = { NULL, out, arg };
+  const int ret = _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
+  va_end(va);
+  return ret;
+}
+
+
+int fctvprintf_span(void (*out)(const char* data, size_t length, void* arg), void* arg, const char* format, va_list va)
+{
+  const out_fct_wrap_type out_fct_wrap = { NULL, out, arg };
   return _vsnprintf(_out_fct, (char*)(uintptr_t)&out_fct_wrap, (size_t)-1, format, va);
 }
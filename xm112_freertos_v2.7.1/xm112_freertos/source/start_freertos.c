@@ -14,7 +14,11 @@
 #include "task.h"
 #include "semphr.h"
 
+#if defined(ACC_CFG_ALLOC_TRACKER)
+#include "acc_alloc_tracker.h"
+#endif
 #include "acc_board.h"
+#include "acc_console.h"
 #include "acc_device_uart.h"
 
 
@@ -23,6 +27,8 @@
 
 #define DEBUG_UART_PORT_INVALID (0xFF)
 
+#define MAIN_TASK_STACK_SIZE 14000
+
 // Heap regions defined in MCU specific acc_heap.c file
 extern HeapRegion_t  xHeapRegions[];
 // Debug uart port defined in integration file acc_board_xxx.c
@@ -145,7 +151,11 @@ int _write(int file, char *ptr, int len)
 {
 	(void)file;
 
-	if (acc_debug_uart_port != DEBUG_UART_PORT_INVALID)
+	if (acc_console_is_buffered())
+	{
+		acc_console_write(ptr, len);
+	}
+	else if (acc_debug_uart_port != DEBUG_UART_PORT_INVALID)
 	{
 		xSemaphoreTake(acc_debug_uart_mutex, portMAX_DELAY);
 		acc_device_uart_write_buffer(acc_debug_uart_port, ptr, len);
@@ -188,6 +198,36 @@ void WDT_IRQHandler(void)
 #endif
 
 
+/**
+ * @brief Memory for the idle task, used since configSUPPORT_STATIC_ALLOCATION is 1
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+	static StaticTask_t idle_task;
+	static StackType_t  idle_task_stack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer   = &idle_task;
+	*ppxIdleTaskStackBuffer = idle_task_stack;
+	*pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+
+/**
+ * @brief Memory for the timer task, used since configSUPPORT_STATIC_ALLOCATION is 1
+ */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+	static StaticTask_t timer_task;
+	static StackType_t  timer_task_stack[configTIMER_TASK_STACK_DEPTH];
+
+	*ppxTimerTaskTCBBuffer   = &timer_task;
+	*ppxTimerTaskStackBuffer = timer_task_stack;
+	*pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
+
 /**
  * @brief The real main function to be started as first task
  */
@@ -211,8 +251,17 @@ static void start_main(void *param)
 {
 	(void)param;
 
+#if defined(ACC_CFG_ALLOC_TRACKER)
+	acc_alloc_tracker_checkpoint_t start = acc_alloc_tracker_checkpoint();
+#endif
+
 	call_main();
 
+#if defined(ACC_CFG_ALLOC_TRACKER)
+	acc_alloc_tracker_log_report();
+	acc_alloc_tracker_log_leaks(start, acc_alloc_tracker_checkpoint());
+#endif
+
 	for (;;) ;
 }
 
@@ -229,14 +278,28 @@ void _start(void)
 
 	vPortDefineHeapRegions(xHeapRegions);
 
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	static StaticSemaphore_t debug_uart_mutex_buffer;
+
+	acc_debug_uart_mutex = xSemaphoreCreateMutexStatic(&debug_uart_mutex_buffer);
+#else
 	acc_debug_uart_mutex = xSemaphoreCreateMutex();
+#endif
 	if (acc_debug_uart_mutex == NULL)
 	{
 		SYSTEM_FATAL("Could not create mutex");
 	}
 
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	static StaticTask_t main_task;
+	static StackType_t  main_task_stack[MAIN_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+	xTaskCreateStatic(start_main, "AccTask", MAIN_TASK_STACK_SIZE / sizeof(StackType_t), NULL, tskIDLE_PRIORITY + 1,
+	                  main_task_stack, &main_task);
+#else
 	TaskHandle_t handle;
-	xTaskCreate(start_main, "AccTask", 14000 / sizeof(int), NULL, tskIDLE_PRIORITY + 1, &handle);
+	xTaskCreate(start_main, "AccTask", MAIN_TASK_STACK_SIZE / sizeof(StackType_t), NULL, tskIDLE_PRIORITY + 1, &handle);
+#endif
 
 	vTaskStartScheduler();
 
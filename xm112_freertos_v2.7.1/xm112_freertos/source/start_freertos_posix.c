@@ -0,0 +1,175 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(ACC_CFG_ALLOC_TRACKER)
+#include "acc_alloc_tracker.h"
+#endif
+
+
+#define MODULE	"start"
+
+
+#define MAIN_TASK_STACK_SIZE 14000
+
+// Heap regions defined in MCU specific acc_heap.c file
+extern HeapRegion_t xHeapRegions[];
+
+static int  main_argc;
+static char **main_argv;
+
+
+void system_fatal_error_handler(const char *reason);
+
+
+/**
+ * @brief Write data to output device, used by libwrapprintf
+ *
+ * The host has no debug UART, all output goes to stdout.
+ *
+ * @param[in] file File to write to, ignored
+ * @param[in] ptr Buffer with data to write
+ * @param[in] len Number of bytes to write
+ * @return number of bytes written
+ */
+int _write(int file, const char *ptr, int len)
+{
+	(void)file;
+
+	int written = 0;
+
+	while (written < len)
+	{
+		ssize_t ret = write(STDOUT_FILENO, ptr + written, len - written);
+		if (ret <= 0)
+		{
+			break;
+		}
+
+		written += ret;
+	}
+
+	return len;
+}
+
+
+void system_fatal_error_handler(const char *reason)
+{
+	fprintf(stderr, "Fatal error: %s\n", reason);
+	abort();
+}
+
+
+void vApplicationMallocFailedHook(void)
+{
+	system_fatal_error_handler(__func__);
+}
+
+
+/**
+ * @brief Memory for the idle task, used since configSUPPORT_STATIC_ALLOCATION is 1
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+	static StaticTask_t idle_task;
+	static StackType_t  idle_task_stack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer   = &idle_task;
+	*ppxIdleTaskStackBuffer = idle_task_stack;
+	*pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+
+/**
+ * @brief Memory for the timer task, used since configSUPPORT_STATIC_ALLOCATION is 1
+ */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+	static StaticTask_t timer_task;
+	static StackType_t  timer_task_stack[configTIMER_TASK_STACK_DEPTH];
+
+	*ppxTimerTaskTCBBuffer   = &timer_task;
+	*ppxTimerTaskStackBuffer = timer_task_stack;
+	*pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
+
+/**
+ * @brief The real main function to be started as first task
+ */
+extern int main(int argc, char *argv[]);
+
+
+// Weak default implementation
+int call_main(void) __attribute__ ((weak));
+
+
+int call_main(void)
+{
+	return main(main_argc, main_argv);
+}
+
+
+/**
+ * @brief Call main() using correct arguments, the process exits when it returns
+ */
+static void start_main(void *param)
+{
+	(void)param;
+
+#if defined(ACC_CFG_ALLOC_TRACKER)
+	acc_alloc_tracker_checkpoint_t start = acc_alloc_tracker_checkpoint();
+	int                            result = call_main();
+
+	acc_alloc_tracker_log_report();
+	acc_alloc_tracker_log_leaks(start, acc_alloc_tracker_checkpoint());
+
+	exit(result);
+#else
+	exit(call_main());
+#endif
+}
+
+
+/**
+ * @brief Create main task and start FreeRTOS scheduler
+ *
+ * Runs before the host calls main(), which is instead called from the main task
+ * in the same way as on target. glibc passes the program arguments to constructors.
+ */
+__attribute__ ((constructor)) static void start_scheduler(int argc, char *argv[])
+{
+	main_argc = argc;
+	main_argv = argv;
+
+	vPortDefineHeapRegions(xHeapRegions);
+
+#if defined(ACC_CFG_STATIC_ALLOCATION)
+	static StaticTask_t main_task;
+	static StackType_t  main_task_stack[MAIN_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+	xTaskCreateStatic(start_main, "AccTask", MAIN_TASK_STACK_SIZE / sizeof(StackType_t), NULL, tskIDLE_PRIORITY + 1,
+	                  main_task_stack, &main_task);
+#else
+	TaskHandle_t handle;
+	xTaskCreate(start_main, "AccTask", MAIN_TASK_STACK_SIZE / sizeof(StackType_t), NULL, tskIDLE_PRIORITY + 1, &handle);
+#endif
+
+	vTaskStartScheduler();
+
+	system_fatal_error_handler("Scheduler returned");
+}
@@ -0,0 +1,370 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _XOPEN_SOURCE 600
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "acc_baud_negotiation.h"
+#include "acc_command.h"
+#include "acc_device_os.h"
+
+
+/**
+ * @brief Host test of the baudrate negotiation over a pty pair
+ *
+ * Usage: acc_baud_negotiation_test
+ *
+ * The host side of the negotiation runs on the pty master and the device side
+ * on the pty slave. A pty has no baudrate, so the link is simulated: data
+ * written when the two sides use different baudrates, or a baudrate above
+ * what the simulated cable carries, is garbled the way a receiver at the
+ * wrong baudrate would see it.
+ */
+
+
+/**
+ * @brief Highest baudrate of the SAME70 UART, 150 MHz peripheral clock and 16 times oversampling
+ */
+#define DEVICE_MAX_BAUDRATE 9375000U
+
+#define DEFAULT_BAUDRATE 115200U
+
+/**
+ * @brief Time to run the sides after a negotiation for the device to time out
+ */
+#define SETTLE_TIME_MS (ACC_BAUD_NEGOTIATION_TIMEOUT_MS * 3U)
+
+
+typedef struct link_side link_side_t;
+
+struct link_side
+{
+	const char              *name;
+	int                     fd;
+	uint32_t                baudrate;
+	link_side_t             *peer;
+	uint32_t                *cable_max_baudrate;
+	acc_baud_negotiation_t  negotiation;
+	acc_command_tokenizer_t tokenizer;
+	char                    command[ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 2];
+};
+
+
+typedef struct
+{
+	link_side_t host;
+	link_side_t device;
+	uint32_t    cable_max_baudrate;
+} link_t;
+
+
+static uint32_t time_get(void *client_reference)
+{
+	struct timespec ts;
+
+	(void)client_reference;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+
+static bool line_write(const char *line, size_t length, void *client_reference)
+{
+	link_side_t *side = client_reference;
+	char        data[ACC_BAUD_NEGOTIATION_LINE_MAX_LENGTH + 2];
+
+	if (length > sizeof(data))
+	{
+		return false;
+	}
+
+	memcpy(data, line, length);
+
+	if (side->baudrate != side->peer->baudrate || side->baudrate > *side->cable_max_baudrate)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			data[i] ^= 0x55;
+		}
+	}
+
+	bool success = write(side->fd, data, length) == (ssize_t)length;
+
+	tcdrain(side->fd);
+
+	return success;
+}
+
+
+static bool baudrate_set(uint32_t baudrate, void *client_reference)
+{
+	link_side_t *side = client_reference;
+
+	tcdrain(side->fd);
+	side->baudrate = baudrate;
+
+	return true;
+}
+
+
+static void command_callback(char *command, size_t length, void *client_reference)
+{
+	link_side_t *side = client_reference;
+
+	(void)length;
+
+	// Other lines are noise from a baudrate mismatch
+	acc_baud_negotiation_command(&side->negotiation, command);
+}
+
+
+static bool side_open(link_side_t *side, const char *name, int fd, link_t *link)
+{
+	struct termios tio;
+
+	if (fd < 0 || tcgetattr(fd, &tio) != 0)
+	{
+		return false;
+	}
+
+	// Raw mode, lines are split by the tokenizer
+	tio.c_iflag    &= ~(tcflag_t)(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+	tio.c_oflag    &= ~(tcflag_t)OPOST;
+	tio.c_lflag    &= ~(tcflag_t)(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	tio.c_cflag    &= ~(tcflag_t)(CSIZE | PARENB);
+	tio.c_cflag    |= CS8;
+	tio.c_cc[VMIN]  = 0;
+	tio.c_cc[VTIME] = 0;
+
+	if (tcsetattr(fd, TCSANOW, &tio) != 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+	{
+		return false;
+	}
+
+	side->name               = name;
+	side->fd                 = fd;
+	side->baudrate           = DEFAULT_BAUDRATE;
+	side->cable_max_baudrate = &link->cable_max_baudrate;
+	side->peer               = side == &link->host ? &link->device : &link->host;
+
+	acc_command_tokenizer_init(&side->tokenizer, side->command, sizeof(side->command), "\r\n", command_callback, side);
+
+	acc_baud_negotiation_port_t port = {
+		.write            = line_write,
+		.baudrate_set     = baudrate_set,
+		.time_get         = time_get,
+		.client_reference = side,
+	};
+
+	if (side == &link->host)
+	{
+		acc_baud_negotiation_host_init(&side->negotiation, &port, DEFAULT_BAUDRATE);
+	}
+	else
+	{
+		acc_baud_negotiation_device_init(&side->negotiation, &port, DEVICE_MAX_BAUDRATE, DEFAULT_BAUDRATE);
+	}
+
+	return true;
+}
+
+
+static bool link_open(link_t *link)
+{
+	memset(link, 0, sizeof(*link));
+
+	link->cable_max_baudrate = UINT32_MAX;
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+	{
+		return false;
+	}
+
+	const char *slave_name = ptsname(master);
+	int        slave       = slave_name != NULL ? open(slave_name, O_RDWR | O_NOCTTY) : -1;
+
+	return side_open(&link->host, "host", master, link) && side_open(&link->device, "device", slave, link);
+}
+
+
+static void side_pump(link_side_t *side)
+{
+	uint8_t buffer[256];
+	ssize_t length;
+
+	while ((length = read(side->fd, buffer, sizeof(buffer))) > 0)
+	{
+		acc_command_tokenizer_feed(&side->tokenizer, buffer, (size_t)length);
+	}
+
+	acc_baud_negotiation_poll(&side->negotiation);
+}
+
+
+/**
+ * @brief Run both sides for run_time_ms, or until the host negotiation has ended if until_ended is set
+ */
+static void link_run(link_t *link, uint32_t run_time_ms, bool until_ended)
+{
+	uint32_t start_ms = time_get(NULL);
+
+	while (time_get(NULL) - start_ms < run_time_ms)
+	{
+		side_pump(&link->host);
+		side_pump(&link->device);
+
+		if (until_ended && !acc_baud_negotiation_is_busy(&link->host.negotiation))
+		{
+			break;
+		}
+
+		acc_os_sleep_ms(1);
+	}
+}
+
+
+static bool negotiate(link_t *link, uint32_t baudrate, bool expect_success, uint32_t expected_baudrate)
+{
+	uint32_t start_ms = time_get(NULL);
+
+	if (!acc_baud_negotiation_host_start(&link->host.negotiation, baudrate))
+	{
+		return false;
+	}
+
+	link_run(link, ACC_BAUD_NEGOTIATION_TIMEOUT_MS * 4U, true);
+
+	uint32_t negotiation_ms = time_get(NULL) - start_ms;
+	bool     success        = link->host.negotiation.state == ACC_BAUD_NEGOTIATION_STATE_DONE;
+
+	// Give the device time to fall back before the result is checked
+	link_run(link, SETTLE_TIME_MS, false);
+
+	bool passed = success == expect_success && link->host.baudrate == expected_baudrate &&
+	              link->device.baudrate == expected_baudrate && !acc_baud_negotiation_is_busy(&link->device.negotiation);
+
+	printf("%-6s %9u baud, cable %9u: %-6s in %4u ms, host %9u, device %9u\n", passed ? "PASS" : "FAIL",
+	       (unsigned int)baudrate, (unsigned int)link->cable_max_baudrate, success ? "done" : "failed",
+	       (unsigned int)negotiation_ms, (unsigned int)link->host.baudrate, (unsigned int)link->device.baudrate);
+
+	return passed;
+}
+
+
+static bool query(link_t *link)
+{
+	link->host.negotiation.max_baudrate = 0;
+
+	if (!acc_baud_negotiation_host_query(&link->host.negotiation))
+	{
+		return false;
+	}
+
+	link_run(link, 100, false);
+
+	bool passed = link->host.negotiation.max_baudrate == DEVICE_MAX_BAUDRATE;
+
+	printf("%-6s query at %u baud, max %u\n", passed ? "PASS" : "FAIL", (unsigned int)link->host.baudrate,
+	       (unsigned int)link->host.negotiation.max_baudrate);
+
+	return passed;
+}
+
+
+static bool command_match(link_t *link)
+{
+	static const struct
+	{
+		const char *command;
+		bool       expected;
+	} commands[] = {
+		{ "BAUD?", true },
+		{ "BAUD", true },
+		{ "BAUD DONE 115200", true },
+		{ "BAUD\tCOMMIT", true },
+		{ "BAUDRATE 115200", false },
+		{ "BAUD?X", false },
+		{ "BAU", false },
+	};
+
+	bool passed = true;
+
+	for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+	{
+		char command[32];
+
+		// The device is idle, only negotiation commands are consumed
+		snprintf(command, sizeof(command), "%s", commands[i].command);
+
+		bool consumed = acc_baud_negotiation_command(&link->device.negotiation, command);
+
+		if (consumed != commands[i].expected)
+		{
+			printf("FAIL   command '%s' %s\n", commands[i].command, consumed ? "consumed" : "not consumed");
+			passed = false;
+		}
+	}
+
+	// Let the device answer any BAUD? before the next test
+	link_run(link, 100, false);
+
+	if (passed)
+	{
+		printf("PASS   command matching\n");
+	}
+
+	return passed;
+}
+
+
+int main(void)
+{
+	link_t link;
+	bool   passed = true;
+
+	if (!link_open(&link))
+	{
+		printf("Could not open a pty pair\n");
+		return EXIT_FAILURE;
+	}
+
+	passed = query(&link) && passed;
+	passed = command_match(&link) && passed;
+
+	// 9375000 / 3 differs 4.2 % from 3000000
+	passed = negotiate(&link, 3000000, false, DEFAULT_BAUDRATE) && passed;
+	passed = negotiate(&link, 1875000, true, 1875000) && passed;
+	passed = query(&link) && passed;
+
+	// The device acknowledges but the cable cannot carry the baudrate, both sides fall back
+	link.cable_max_baudrate = 2000000;
+	passed                  = negotiate(&link, 3125000, false, 1875000) && passed;
+	passed                  = query(&link) && passed;
+
+	link.cable_max_baudrate = UINT32_MAX;
+	passed                  = negotiate(&link, 9375000, true, 9375000) && passed;
+	passed                  = negotiate(&link, DEFAULT_BAUDRATE, true, DEFAULT_BAUDRATE) && passed;
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	close(link.host.fd);
+	close(link.device.fd);
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
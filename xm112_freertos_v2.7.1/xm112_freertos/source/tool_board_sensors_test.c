@@ -0,0 +1,582 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+
+#include "acc_board.h"
+#include "acc_board_sensors.h"
+#include "acc_device_gpio.h"
+#include "acc_device_os.h"
+#include "acc_device_spi.h"
+
+
+/**
+ * @brief Host test of the sensor table with mocked GPIO and SPI drivers
+ *
+ * Usage: acc_board_sensors_test
+ *
+ * Four sensors on two SPI buses are set up through the device layer function
+ * pointers. The test checks that transfers go to the chip select of the
+ * addressed sensor, that a GPIO interrupt wakes only the sensor it belongs to,
+ * that a shared power supply stays on while any of its sensors is active, and
+ * that an asynchronous transfer which never completes is aborted.
+ *
+ * GPIO interrupts and SPI completions are delivered as simulated interrupts
+ * of the POSIX port, so the sensor code runs in interrupt context as on target.
+ */
+
+
+#define SPI_BUS_COUNT  2U
+#define SPI_CS_COUNT   4U
+#define GPIO_PIN_COUNT 64U
+
+#define GPIO_INTERRUPT 1U
+#define SPI_INTERRUPT  2U
+
+#define TRANSFER_SIZE 16U
+
+#define INTERRUPT_TIMEOUT_MS 100U
+
+
+typedef struct
+{
+	uint_fast8_t bus;
+	uint_fast8_t chip_select;
+	bool         created;
+} mock_spi_device_t;
+
+
+typedef struct
+{
+	uint_fast8_t          level[GPIO_PIN_COUNT];
+	bool                  input[GPIO_PIN_COUNT];
+	acc_device_gpio_isr_t isr[GPIO_PIN_COUNT];
+	volatile uint32_t     pending_pin;
+} mock_gpio_t;
+
+
+typedef struct
+{
+	mock_spi_device_t                  devices[SPI_BUS_COUNT][SPI_CS_COUNT];
+	const mock_spi_device_t            *last_device;
+	uint32_t                           transfer_count;
+	uint32_t                           async_transfer_count;
+	uint32_t                           abort_count;
+	bool                               async_complete;
+	bool                               async_pending;
+	acc_device_handle_t                async_handle;
+	acc_device_spi_transfer_callback_t async_callback;
+} mock_spi_t;
+
+
+static mock_gpio_t gpio;
+static mock_spi_t  spi;
+
+
+static const acc_board_sensor_config_t sensor_pins[ACC_BOARD_SENSORS_MAX] = {
+	{ .interrupt_pin = 10, .enable_pin = 20, .ps_enable_pin = 30, .transfer_async = false },
+	{ .interrupt_pin = 11, .enable_pin = 21, .ps_enable_pin = 30, .transfer_async = false },
+	{ .interrupt_pin = 12, .enable_pin = 22, .ps_enable_pin = 32, .transfer_async = true },
+	{ .interrupt_pin = 13, .enable_pin = 23, .ps_enable_pin = 33, .transfer_async = true },
+};
+
+static const uint_fast8_t sensor_bus[ACC_BOARD_SENSORS_MAX]         = { 0, 0, 1, 1 };
+static const uint_fast8_t sensor_chip_select[ACC_BOARD_SENSORS_MAX] = { 0, 1, 0, 2 };
+
+static volatile acc_sensor_id_t interrupt_callback_sensor_id;
+static volatile uint32_t        interrupt_callback_count;
+
+
+static bool mock_gpio_set_initial_pull(uint_fast8_t pin, uint_fast8_t level)
+{
+	(void)level;
+
+	return pin < GPIO_PIN_COUNT;
+}
+
+
+static bool mock_gpio_input(uint_fast8_t pin)
+{
+	if (pin >= GPIO_PIN_COUNT)
+	{
+		return false;
+	}
+
+	gpio.input[pin] = true;
+
+	return true;
+}
+
+
+static bool mock_gpio_read(uint_fast8_t pin, uint_fast8_t *level)
+{
+	if (pin >= GPIO_PIN_COUNT)
+	{
+		return false;
+	}
+
+	*level = gpio.level[pin];
+
+	return true;
+}
+
+
+static bool mock_gpio_write(uint_fast8_t pin, uint_fast8_t level)
+{
+	if (pin >= GPIO_PIN_COUNT || gpio.input[pin])
+	{
+		return false;
+	}
+
+	gpio.level[pin] = level;
+
+	return true;
+}
+
+
+static bool mock_gpio_register_isr(uint_fast8_t pin, acc_gpio_edge_t edge, acc_device_gpio_isr_t isr)
+{
+	if (pin >= GPIO_PIN_COUNT || (isr != NULL && edge != ACC_DEVICE_GPIO_EDGE_RISING))
+	{
+		return false;
+	}
+
+	gpio.isr[pin] = isr;
+
+	return true;
+}
+
+
+static uint32_t gpio_interrupt_handler(void)
+{
+	uint32_t pin = gpio.pending_pin;
+
+	if (pin < GPIO_PIN_COUNT && gpio.isr[pin] != NULL)
+	{
+		gpio.isr[pin]();
+	}
+
+	return pdFALSE;
+}
+
+
+/**
+ * @brief Raise the interrupt pin of a sensor
+ */
+static void gpio_interrupt_raise(uint_fast8_t pin)
+{
+	gpio.level[pin]  = 1;
+	gpio.pending_pin = pin;
+	vPortGenerateSimulatedInterrupt(GPIO_INTERRUPT);
+	acc_os_sleep_ms(1);
+	gpio.level[pin] = 0;
+}
+
+
+static acc_device_handle_t mock_spi_create(acc_device_spi_configuration_t *configuration)
+{
+	if (configuration->bus >= SPI_BUS_COUNT || configuration->device >= SPI_CS_COUNT)
+	{
+		return NULL;
+	}
+
+	mock_spi_device_t *device = &spi.devices[configuration->bus][configuration->device];
+
+	device->bus         = configuration->bus;
+	device->chip_select = configuration->device;
+	device->created     = true;
+
+	return device;
+}
+
+
+static void mock_spi_destroy(acc_device_handle_t *handle)
+{
+	mock_spi_device_t *device = *handle;
+
+	device->created = false;
+	*handle         = NULL;
+}
+
+
+static uint8_t mock_spi_get_bus(acc_device_handle_t handle)
+{
+	const mock_spi_device_t *device = handle;
+
+	return device->bus;
+}
+
+
+/**
+ * @brief What the sensor on a chip select sends back, so the test can tell where a transfer went
+ */
+static uint8_t sensor_response(const mock_spi_device_t *device, size_t index)
+{
+	return (uint8_t)((device->bus << 6) | (device->chip_select << 4) | (index & 0x0FU));
+}
+
+
+static void mock_spi_respond(const mock_spi_device_t *device, uint8_t *buffer, size_t buffer_size)
+{
+	for (size_t index = 0; index < buffer_size; index++)
+	{
+		buffer[index] = sensor_response(device, index);
+	}
+}
+
+
+static bool mock_spi_transfer(acc_device_handle_t handle, uint8_t *buffer, size_t buffer_size)
+{
+	const mock_spi_device_t *device = handle;
+
+	if (!device->created)
+	{
+		return false;
+	}
+
+	mock_spi_respond(device, buffer, buffer_size);
+	spi.last_device = device;
+	spi.transfer_count++;
+
+	return true;
+}
+
+
+static uint32_t spi_interrupt_handler(void)
+{
+	if (spi.async_pending)
+	{
+		spi.async_pending = false;
+		spi.async_callback(spi.async_handle, ACC_DEVICE_SPI_TRANSFER_STATUS_OK);
+	}
+
+	return pdFALSE;
+}
+
+
+static bool mock_spi_transfer_async(acc_device_handle_t handle, uint8_t *buffer, bool rx, bool tx, size_t buffer_size,
+                                    acc_device_spi_transfer_callback_t callback)
+{
+	const mock_spi_device_t *device = handle;
+
+	if (!device->created || !rx || !tx)
+	{
+		return false;
+	}
+
+	mock_spi_respond(device, buffer, buffer_size);
+	spi.last_device    = device;
+	spi.async_transfer_count++;
+	spi.async_handle   = handle;
+	spi.async_callback = callback;
+	spi.async_pending  = true;
+
+	if (spi.async_complete)
+	{
+		vPortGenerateSimulatedInterrupt(SPI_INTERRUPT);
+	}
+
+	return true;
+}
+
+
+static bool mock_spi_transfer_abort(acc_device_handle_t handle)
+{
+	(void)handle;
+
+	bool aborted = spi.async_pending;
+
+	spi.async_pending = false;
+	spi.abort_count++;
+
+	return aborted;
+}
+
+
+static void mocks_register(void)
+{
+	acc_device_gpio_set_initial_pull_func = mock_gpio_set_initial_pull;
+	acc_device_gpio_input_func            = mock_gpio_input;
+	acc_device_gpio_read_func             = mock_gpio_read;
+	acc_device_gpio_write_func            = mock_gpio_write;
+	acc_device_gpio_register_isr_func     = mock_gpio_register_isr;
+
+	acc_device_spi_create_func         = mock_spi_create;
+	acc_device_spi_destroy_func        = mock_spi_destroy;
+	acc_device_spi_get_bus_func        = mock_spi_get_bus;
+	acc_device_spi_transfer_func       = mock_spi_transfer;
+	acc_device_spi_transfer_async_func = mock_spi_transfer_async;
+	acc_device_spi_transfer_abort_func = mock_spi_transfer_abort;
+
+	vPortSetInterruptHandler(GPIO_INTERRUPT, gpio_interrupt_handler);
+	vPortSetInterruptHandler(SPI_INTERRUPT, spi_interrupt_handler);
+}
+
+
+static void interrupt_callback(acc_sensor_id_t sensor_id)
+{
+	interrupt_callback_sensor_id = sensor_id;
+	interrupt_callback_count++;
+}
+
+
+static bool check(bool condition, const char *description)
+{
+	if (!condition)
+	{
+		printf("  %s\n", description);
+	}
+
+	return condition;
+}
+
+
+static bool sensors_init(void)
+{
+	acc_board_sensor_config_t configs[ACC_BOARD_SENSORS_MAX];
+
+	for (uint_fast8_t index = 0; index < ACC_BOARD_SENSORS_MAX; index++)
+	{
+		acc_device_spi_configuration_t spi_configuration = {
+			.bus         = sensor_bus[index],
+			.device      = sensor_chip_select[index],
+			.master      = true,
+			.speed       = 1000000,
+			.buffer_size = 256,
+		};
+
+		configs[index]            = sensor_pins[index];
+		configs[index].spi_handle = acc_device_spi_create(&spi_configuration);
+
+		if (configs[index].spi_handle == NULL)
+		{
+			return false;
+		}
+	}
+
+	return acc_board_sensors_init(configs, ACC_BOARD_SENSORS_MAX);
+}
+
+
+static bool test_init(void)
+{
+	bool passed = check(acc_board_sensors_get_count() == ACC_BOARD_SENSORS_MAX, "Wrong sensor count");
+
+	for (uint_fast8_t index = 0; index < ACC_BOARD_SENSORS_MAX; index++)
+	{
+		const acc_board_sensor_config_t *pins = &sensor_pins[index];
+
+		passed = check(gpio.input[pins->interrupt_pin], "SENS_INT not configured as input") && passed;
+		passed = check(gpio.isr[pins->interrupt_pin] != NULL, "No isr registered on SENS_INT") && passed;
+		passed = check(gpio.level[pins->enable_pin] == 0, "ENABLE not low after init") && passed;
+		passed = check(gpio.level[pins->ps_enable_pin] == 0, "PS_ENABLE not low after init") && passed;
+		passed = check(acc_board_sensors_get_spi_handle(index + 1) == &spi.devices[sensor_bus[index]][sensor_chip_select[index]],
+		               "Wrong SPI device") && passed;
+	}
+
+	passed = check(acc_board_sensors_get_spi_handle(ACC_BOARD_SENSORS_MAX + 1) == NULL, "SPI device for invalid sensor id") && passed;
+
+	printf("%-22s %s\n", "init", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+/**
+ * @brief Every sensor must be transferred on its own bus and chip select, blocking or asynchronously as configured
+ */
+static bool test_transfer(void)
+{
+	bool passed = true;
+
+	for (uint_fast8_t index = 0; index < ACC_BOARD_SENSORS_MAX; index++)
+	{
+		const mock_spi_device_t *device         = &spi.devices[sensor_bus[index]][sensor_chip_select[index]];
+		uint32_t                transfer_count  = spi.transfer_count;
+		uint32_t                async_count     = spi.async_transfer_count;
+		uint8_t                 buffer[TRANSFER_SIZE];
+
+		memset(buffer, 0, sizeof(buffer));
+
+		if (!check(acc_board_sensors_transfer(index + 1, buffer, sizeof(buffer)), "Transfer failed"))
+		{
+			passed = false;
+			continue;
+		}
+
+		passed = check(spi.last_device == device, "Transfer went to the wrong chip select") && passed;
+
+		for (size_t i = 0; i < sizeof(buffer); i++)
+		{
+			if (buffer[i] != sensor_response(device, i))
+			{
+				passed = check(false, "Received data of another sensor");
+				break;
+			}
+		}
+
+		if (sensor_pins[index].transfer_async)
+		{
+			passed = check(spi.async_transfer_count == async_count + 1 && spi.transfer_count == transfer_count,
+			               "Asynchronous sensor not transferred asynchronously") && passed;
+		}
+		else
+		{
+			passed = check(spi.transfer_count == transfer_count + 1 && spi.async_transfer_count == async_count,
+			               "Blocking sensor not transferred blocking") && passed;
+		}
+	}
+
+	uint8_t buffer[TRANSFER_SIZE];
+
+	passed = check(!acc_board_sensors_transfer(0, buffer, sizeof(buffer)), "Transfer to sensor id 0") && passed;
+	passed = check(!acc_board_sensors_transfer(ACC_BOARD_SENSORS_MAX + 1, buffer, sizeof(buffer)), "Transfer to invalid sensor id") &&
+	         passed;
+
+	printf("%-22s %s\n", "transfer", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+/**
+ * @brief An interrupt must wake the sensor it belongs to and no other
+ */
+static bool test_interrupt(void)
+{
+	bool passed = true;
+
+	acc_board_sensors_register_interrupt_callback(interrupt_callback);
+
+	for (uint_fast8_t index = 0; index < ACC_BOARD_SENSORS_MAX; index++)
+	{
+		acc_sensor_id_t sensor_id      = index + 1;
+		uint32_t        callback_count = interrupt_callback_count;
+
+		gpio_interrupt_raise(sensor_pins[index].interrupt_pin);
+
+		passed = check(acc_board_sensors_wait_for_interrupt(sensor_id, INTERRUPT_TIMEOUT_MS), "Interrupt not received") && passed;
+		passed = check(interrupt_callback_count == callback_count + 1 && interrupt_callback_sensor_id == sensor_id,
+		               "Interrupt callback not called with the sensor id") && passed;
+
+		for (acc_sensor_id_t other = 1; other <= ACC_BOARD_SENSORS_MAX; other++)
+		{
+			if (other != sensor_id)
+			{
+				passed = check(!acc_board_sensors_wait_for_interrupt(other, 0), "Interrupt received by another sensor") && passed;
+			}
+		}
+	}
+
+	gpio.level[sensor_pins[2].interrupt_pin] = 1;
+	passed = check(acc_board_sensors_is_interrupt_active(3) && !acc_board_sensors_is_interrupt_active(4),
+	               "Interrupt level read from the wrong pin") && passed;
+	gpio.level[sensor_pins[2].interrupt_pin] = 0;
+
+	acc_board_sensors_register_interrupt_callback(NULL);
+
+	printf("%-22s %s\n", "interrupt", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+/**
+ * @brief Sensors 1 and 2 share a power supply, it must stay on while either is active
+ */
+static bool test_power(void)
+{
+	uint_fast8_t shared_ps = sensor_pins[0].ps_enable_pin;
+	bool         passed    = true;
+
+	acc_board_sensors_start(1);
+	passed = check(gpio.level[shared_ps] == 1 && gpio.level[sensor_pins[0].enable_pin] == 1, "Sensor 1 not powered") && passed;
+	passed = check(gpio.level[sensor_pins[1].enable_pin] == 0, "Sensor 2 enabled by sensor 1") && passed;
+
+	acc_board_sensors_start(2);
+	acc_board_sensors_stop(1);
+	passed = check(gpio.level[shared_ps] == 1, "Shared power supply turned off while sensor 2 is active") && passed;
+	passed = check(gpio.level[sensor_pins[0].enable_pin] == 0, "Sensor 1 still enabled") && passed;
+
+	acc_board_sensors_stop(2);
+	passed = check(gpio.level[shared_ps] == 0, "Shared power supply still on") && passed;
+
+	acc_board_sensors_start(3);
+	passed = check(gpio.level[sensor_pins[2].ps_enable_pin] == 1 && gpio.level[shared_ps] == 0,
+	               "Sensor 3 powered through the wrong supply") && passed;
+	acc_board_sensors_stop(3);
+	passed = check(gpio.level[sensor_pins[2].ps_enable_pin] == 0, "Sensor 3 power supply still on") && passed;
+
+	printf("%-22s %s\n", "power", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+/**
+ * @brief An asynchronous transfer that never completes must be aborted, and the next transfer must work
+ */
+static bool test_async_timeout(void)
+{
+	uint8_t buffer[TRANSFER_SIZE];
+	bool    passed = true;
+
+	spi.async_complete = false;
+	passed             = check(!acc_board_sensors_transfer(4, buffer, sizeof(buffer)), "Transfer did not time out") && passed;
+	passed             = check(spi.abort_count == 1 && !spi.async_pending, "Transfer not aborted after timeout") && passed;
+
+	spi.async_complete = true;
+	passed             = check(acc_board_sensors_transfer(4, buffer, sizeof(buffer)), "Transfer after timeout failed") && passed;
+	passed             = check(spi.abort_count == 1, "Completed transfer aborted") && passed;
+
+	printf("%-22s %s\n", "async timeout", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+int main(void)
+{
+	bool passed = true;
+
+	if (!acc_board_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	mocks_register();
+	spi.async_complete = true;
+
+	if (!sensors_init())
+	{
+		printf("Sensor table init failed\n");
+		return EXIT_FAILURE;
+	}
+
+	passed = test_init() && passed;
+	passed = test_transfer() && passed;
+	passed = test_interrupt() && passed;
+	passed = test_power() && passed;
+	passed = test_async_timeout() && passed;
+
+	acc_board_sensors_deinit();
+
+	for (uint_fast8_t index = 0; index < ACC_BOARD_SENSORS_MAX; index++)
+	{
+		passed = check(gpio.isr[sensor_pins[index].interrupt_pin] == NULL, "Isr still registered after deinit") && passed;
+	}
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,402 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acc_compression.h"
+#include "acc_compression_decoder.h"
+#include "acc_compression_encoder.h"
+#include "acc_driver_hal.h"
+#include "acc_recording.h"
+#include "acc_recording_reader.h"
+#include "acc_rss.h"
+#include "acc_rss_emulator.h"
+#include "acc_service.h"
+#include "acc_service_envelope.h"
+#include "acc_service_sparse.h"
+
+
+/**
+ * @brief Host benchmark of the frame compression
+ *
+ * Usage: acc_compression_benchmark [recording ...]
+ *
+ * Envelope, sparse and power bins recordings are compressed with every
+ * encoder mode and decoded again to check that no data is lost. Without
+ * arguments envelope and sparse frames are taken from the service emulator.
+ * The result is the compression ratio, the number of bits per sample and the
+ * time and host CPU cycles per sample to encode and decode.
+ */
+
+
+#define EMULATOR_FRAME_COUNT 500U
+#define KEY_FRAME_INTERVAL   50U
+
+/**
+ * @brief Number of times the frames are compressed for the timing
+ */
+#define PASS_COUNT 20U
+
+
+typedef struct
+{
+	char     name[64];
+	uint16_t *frames;
+	uint32_t frame_count;
+	uint16_t data_length;
+	uint16_t sweep_length;
+} dataset_t;
+
+
+typedef struct
+{
+	const char             *name;
+	acc_compression_mode_t mode;
+} benchmark_mode_t;
+
+
+static const benchmark_mode_t modes[] = {
+	{ "intra",    ACC_COMPRESSION_MODE_INTRA    },
+	{ "inter",    ACC_COMPRESSION_MODE_INTER    },
+	{ "adaptive", ACC_COMPRESSION_MODE_ADAPTIVE },
+};
+
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+static bool load_recording(const char *path, dataset_t *dataset)
+{
+	acc_recording_reader_t reader = acc_recording_reader_open(path);
+
+	dataset->frames = NULL;
+
+	if (reader == NULL)
+	{
+		printf("Could not open %s\n", path);
+		return false;
+	}
+
+	const acc_recording_header_t *header = acc_recording_reader_header_get(reader);
+
+	if (header->service_type == ACC_RECORDING_SERVICE_TYPE_IQ || header->metadata.data_length == 0)
+	{
+		printf("%s: only envelope, sparse and power bins recordings are supported\n", path);
+		acc_recording_reader_close(&reader);
+		return false;
+	}
+
+	uint16_t sweeps_per_frame = 1;
+
+	if (header->service_type == ACC_RECORDING_SERVICE_TYPE_SPARSE && header->metadata.sweeps_per_frame > 0)
+	{
+		sweeps_per_frame = header->metadata.sweeps_per_frame;
+	}
+
+	snprintf(dataset->name, sizeof(dataset->name), "%s", path);
+	dataset->frame_count  = acc_recording_reader_frame_count(reader);
+	dataset->data_length  = header->metadata.data_length;
+	dataset->sweep_length = dataset->data_length / sweeps_per_frame;
+	dataset->frames       = malloc((size_t)dataset->frame_count * dataset->data_length * sizeof(uint16_t));
+
+	if (dataset->frames == NULL || dataset->data_length % sweeps_per_frame != 0)
+	{
+		free(dataset->frames);
+		dataset->frames = NULL;
+		acc_recording_reader_close(&reader);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < dataset->frame_count; i++)
+	{
+		const void *data;
+
+		acc_recording_reader_frame_get(reader, i, &data);
+		memcpy(&dataset->frames[(size_t)i * dataset->data_length], data, (size_t)dataset->data_length * sizeof(uint16_t));
+	}
+
+	acc_recording_reader_close(&reader);
+
+	return true;
+}
+
+
+static bool generate_frames(bool sparse, dataset_t *dataset)
+{
+	acc_service_configuration_t configuration = sparse ? acc_service_sparse_configuration_create() :
+	                                            acc_service_envelope_configuration_create();
+	uint16_t                    sweeps_per_frame = sparse ? 16U : 1U;
+
+	if (configuration == NULL)
+	{
+		return false;
+	}
+
+	if (sparse)
+	{
+		acc_service_sparse_configuration_sweeps_per_frame_set(configuration, sweeps_per_frame);
+	}
+
+	acc_service_requested_start_set(configuration, 0.2f);
+	acc_service_requested_length_set(configuration, sparse ? 0.6f : 1.0f);
+
+	acc_service_handle_t handle = acc_service_create(configuration);
+
+	if (sparse)
+	{
+		acc_service_sparse_configuration_destroy(&configuration);
+	}
+	else
+	{
+		acc_service_envelope_configuration_destroy(&configuration);
+	}
+
+	if (handle == NULL)
+	{
+		return false;
+	}
+
+	if (sparse)
+	{
+		acc_service_sparse_metadata_t metadata;
+
+		acc_service_sparse_get_metadata(handle, &metadata);
+		dataset->data_length = metadata.data_length;
+	}
+	else
+	{
+		acc_service_envelope_metadata_t metadata;
+
+		acc_service_envelope_get_metadata(handle, &metadata);
+		dataset->data_length = metadata.data_length;
+	}
+
+	snprintf(dataset->name, sizeof(dataset->name), "emulator %s", sparse ? "sparse" : "envelope");
+	dataset->frame_count  = EMULATOR_FRAME_COUNT;
+	dataset->sweep_length = dataset->data_length / sweeps_per_frame;
+	dataset->frames       = malloc((size_t)dataset->frame_count * dataset->data_length * sizeof(uint16_t));
+
+	bool success = dataset->frames != NULL && acc_service_activate(handle);
+
+	for (uint32_t i = 0; success && i < dataset->frame_count; i++)
+	{
+		uint16_t *data = &dataset->frames[(size_t)i * dataset->data_length];
+
+		if (sparse)
+		{
+			acc_service_sparse_result_info_t result_info;
+
+			success = acc_service_sparse_get_next(handle, data, dataset->data_length, &result_info);
+		}
+		else
+		{
+			acc_service_envelope_result_info_t result_info;
+
+			success = acc_service_envelope_get_next(handle, data, dataset->data_length, &result_info);
+		}
+	}
+
+	if (dataset->frames != NULL)
+	{
+		acc_service_deactivate(handle);
+	}
+
+	acc_service_destroy(&handle);
+
+	if (!success)
+	{
+		free(dataset->frames);
+	}
+
+	return success;
+}
+
+
+static bool benchmark(const dataset_t *dataset, const benchmark_mode_t *mode)
+{
+	size_t   max_size       = ACC_COMPRESSION_MAX_SIZE(dataset->data_length);
+	uint8_t  *compressed    = malloc((size_t)dataset->frame_count * max_size);
+	size_t   *sizes         = malloc((size_t)dataset->frame_count * sizeof(size_t));
+	uint16_t *previous      = malloc((size_t)dataset->sweep_length * sizeof(uint16_t));
+	uint16_t *decoded       = malloc((size_t)dataset->data_length * sizeof(uint16_t));
+	uint16_t *last_decoded  = malloc((size_t)dataset->sweep_length * sizeof(uint16_t));
+	uint32_t type_counts[4] = { 0 };
+	size_t   total_size     = 0;
+	double   encode_s       = 0.0;
+	double   decode_s       = 0.0;
+	uint64_t encode_cycles  = 0;
+	uint64_t decode_cycles  = 0;
+	bool     success        = compressed != NULL && sizes != NULL && previous != NULL && decoded != NULL &&
+	                          last_decoded != NULL;
+
+	for (uint32_t pass = 0; success && pass < PASS_COUNT; pass++)
+	{
+		acc_compression_encoder_t encoder;
+		acc_compression_decoder_t decoder;
+
+		acc_compression_encoder_init(&encoder, mode->mode, previous, dataset->sweep_length, KEY_FRAME_INTERVAL);
+
+		double   start_s      = now_s();
+		uint64_t start_cycles = cycles();
+
+		for (uint32_t i = 0; i < dataset->frame_count; i++)
+		{
+			sizes[i] = acc_compression_encode(&encoder, &dataset->frames[(size_t)i * dataset->data_length],
+			                                  dataset->data_length, dataset->sweep_length, &compressed[i * max_size],
+			                                  max_size);
+		}
+
+		encode_cycles += cycles() - start_cycles;
+		encode_s      += now_s() - start_s;
+
+		acc_compression_decoder_init(&decoder, last_decoded, dataset->sweep_length);
+
+		start_s      = now_s();
+		start_cycles = cycles();
+
+		for (uint32_t i = 0; success && i < dataset->frame_count; i++)
+		{
+			uint16_t data_length;
+
+			success = acc_compression_decode(&decoder, &compressed[i * max_size], sizes[i], decoded, dataset->data_length,
+			                                 &data_length, NULL);
+
+			if (pass == 0)
+			{
+				success = success && data_length == dataset->data_length &&
+				          memcmp(decoded, &dataset->frames[(size_t)i * dataset->data_length],
+				                 (size_t)data_length * sizeof(uint16_t)) == 0;
+			}
+		}
+
+		decode_cycles += cycles() - start_cycles;
+		decode_s      += now_s() - start_s;
+	}
+
+	for (uint32_t i = 0; success && i < dataset->frame_count; i++)
+	{
+		acc_compression_header_t header;
+
+		memcpy(&header, &compressed[i * max_size], sizeof(header));
+		type_counts[header.frame_type & 3U]++;
+		total_size += sizes[i];
+	}
+
+	if (success)
+	{
+		double sample_count = (double)dataset->frame_count * dataset->data_length;
+		double raw_size     = sample_count * sizeof(uint16_t);
+
+		printf("%-10s %6.2f %6.2f %8.2f %8.1f %8.2f %8.1f   %u/%u/%u/%u\n", mode->name, raw_size / (double)total_size,
+		       (double)total_size * 8.0 / sample_count, encode_s * 1e9 / (sample_count * PASS_COUNT),
+		       (double)encode_cycles / (sample_count * PASS_COUNT), decode_s * 1e9 / (sample_count * PASS_COUNT),
+		       (double)decode_cycles / (sample_count * PASS_COUNT), (unsigned int)type_counts[ACC_COMPRESSION_FRAME_RAW],
+		       (unsigned int)type_counts[ACC_COMPRESSION_FRAME_INTRA], (unsigned int)type_counts[ACC_COMPRESSION_FRAME_SWEEP],
+		       (unsigned int)type_counts[ACC_COMPRESSION_FRAME_INTER]);
+	}
+	else
+	{
+		printf("%-10s round trip failed\n", mode->name);
+	}
+
+	free(compressed);
+	free(sizes);
+	free(previous);
+	free(decoded);
+	free(last_decoded);
+
+	return success;
+}
+
+
+static bool benchmark_dataset(const dataset_t *dataset)
+{
+	bool success = true;
+
+	printf("\n%s: %u frames of %u samples, %u samples per sweep\n", dataset->name, (unsigned int)dataset->frame_count,
+	       (unsigned int)dataset->data_length, (unsigned int)dataset->sweep_length);
+	printf("%-10s %6s %6s %8s %8s %8s %8s   %s\n", "mode", "ratio", "bits", "enc ns", "enc cyc", "dec ns", "dec cyc",
+	       "raw/intra/sweep/inter");
+
+	for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+	{
+		success = benchmark(dataset, &modes[i]) && success;
+	}
+
+	return success;
+}
+
+
+int main(int argc, char *argv[])
+{
+	bool success = true;
+
+	printf("Per sample: ratio of raw to compressed size, bits, encode and decode time and host cycles\n");
+
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			dataset_t dataset;
+
+			success = load_recording(argv[i], &dataset) && benchmark_dataset(&dataset) && success;
+			free(dataset.frames);
+		}
+
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (!acc_driver_hal_init() || !acc_rss_activate(acc_driver_hal_get_implementation()))
+	{
+		return EXIT_FAILURE;
+	}
+
+	acc_rss_emulator_pacing_set(false);
+
+	for (int sparse = 0; sparse <= 1; sparse++)
+	{
+		dataset_t dataset;
+
+		if (!generate_frames(sparse != 0, &dataset))
+		{
+			printf("Could not generate %s frames\n", sparse != 0 ? "sparse" : "envelope");
+			success = false;
+			continue;
+		}
+
+		success = benchmark_dataset(&dataset) && success;
+		free(dataset.frames);
+	}
+
+	acc_rss_deactivate();
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
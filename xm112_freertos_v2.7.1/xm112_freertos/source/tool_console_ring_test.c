@@ -0,0 +1,441 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acc_console_ring.h"
+
+
+/**
+ * @brief Host test of the console ring with concurrent producers
+ *
+ * Usage: acc_console_ring_test
+ *
+ * Four producer threads write numbered messages of varying length to one
+ * ring while the main thread reads. Every message carries its producer,
+ * length and sequence number, and a payload derived from them, so the
+ * consumer can tell a lost message from a dropped one and notices if the
+ * bytes of two messages are interleaved. The free running indexes start
+ * just below UINT32_MAX so that they wrap around during the test, in
+ * addition to the many wraparounds of the buffer itself.
+ */
+
+
+#define PRODUCER_COUNT 4U
+
+#define MESSAGE_COUNT 20000U
+
+#define HEADER_SIZE        6U
+#define MESSAGE_SIZE_MAX   32U
+#define MESSAGE_SIZE_RANGE (MESSAGE_SIZE_MAX - HEADER_SIZE + 1U)
+
+#define RING_SIZE_BLOCK 256U
+#define RING_SIZE_DROP  128U
+
+/**
+ * @brief Where the free running indexes start, below UINT32_MAX by less than the bytes written by the producers
+ */
+#define INDEX_START (UINT32_MAX - 65536U)
+
+#define READ_SIZE 48U
+
+
+typedef struct
+{
+	acc_console_ring_t     *ring;
+	uint8_t                id;
+	acc_console_overflow_t overflow;
+	uint32_t               dropped_bytes;
+	uint32_t               *done_count;
+} producer_t;
+
+
+typedef struct
+{
+	uint8_t  pending[MESSAGE_SIZE_MAX + READ_SIZE];
+	uint32_t pending_size;
+	uint32_t next_sequence[PRODUCER_COUNT];
+	uint32_t message_count[PRODUCER_COUNT];
+	uint32_t received_bytes;
+	bool     error;
+} consumer_t;
+
+
+static uint32_t message_size(uint32_t sequence)
+{
+	return HEADER_SIZE + (sequence * 7U) % MESSAGE_SIZE_RANGE;
+}
+
+
+static uint8_t payload_byte(uint8_t id, uint32_t sequence, uint32_t index)
+{
+	return (uint8_t)(id * 31U + sequence * 3U + index);
+}
+
+
+static uint32_t message_build(uint8_t *message, uint8_t id, uint32_t sequence)
+{
+	uint32_t size = message_size(sequence);
+
+	message[0] = id;
+	message[1] = (uint8_t)size;
+	memcpy(&message[2], &sequence, sizeof(sequence));
+
+	for (uint32_t index = HEADER_SIZE; index < size; index++)
+	{
+		message[index] = payload_byte(id, sequence, index);
+	}
+
+	return size;
+}
+
+
+static void *producer_run(void *arg)
+{
+	producer_t *producer = arg;
+	uint8_t    message[MESSAGE_SIZE_MAX];
+
+	for (uint32_t sequence = 0; sequence < MESSAGE_COUNT; sequence++)
+	{
+		uint32_t size = message_build(message, producer->id, sequence);
+
+		while (!acc_console_ring_write(producer->ring, message, size, producer->overflow))
+		{
+			if (producer->overflow != ACC_CONSOLE_OVERFLOW_BLOCK)
+			{
+				producer->dropped_bytes += size;
+				break;
+			}
+
+			sched_yield();
+		}
+
+		if ((sequence & 0x0FU) == 0)
+		{
+			sched_yield();
+		}
+	}
+
+	__atomic_add_fetch(producer->done_count, 1U, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Check one complete message, the sequence numbers of a producer must increase, by exactly one if nothing may be dropped
+ */
+static void message_check(consumer_t *consumer, const uint8_t *message, bool gaps_allowed)
+{
+	uint8_t  id = message[0];
+	uint32_t sequence;
+
+	memcpy(&sequence, &message[2], sizeof(sequence));
+
+	if (id >= PRODUCER_COUNT || message[1] != message_size(sequence))
+	{
+		printf("  Corrupt message header, producer %u size %u\n", (unsigned int)id, (unsigned int)message[1]);
+		consumer->error = true;
+		return;
+	}
+
+	if (sequence < consumer->next_sequence[id] || (!gaps_allowed && sequence != consumer->next_sequence[id]))
+	{
+		printf("  Producer %u message %u received, expected %u\n", (unsigned int)id, (unsigned int)sequence,
+		       (unsigned int)consumer->next_sequence[id]);
+		consumer->error = true;
+		return;
+	}
+
+	for (uint32_t index = HEADER_SIZE; index < message[1]; index++)
+	{
+		if (message[index] != payload_byte(id, sequence, index))
+		{
+			printf("  Producer %u message %u interleaved at byte %u\n", (unsigned int)id, (unsigned int)sequence,
+			       (unsigned int)index);
+			consumer->error = true;
+			return;
+		}
+	}
+
+	consumer->next_sequence[id] = sequence + 1U;
+	consumer->message_count[id]++;
+}
+
+
+/**
+ * @brief Read what is available and check every complete message, returns the number of bytes read
+ */
+static uint32_t consumer_read(consumer_t *consumer, acc_console_ring_t *ring, bool gaps_allowed)
+{
+	uint32_t length = acc_console_ring_read(ring, &consumer->pending[consumer->pending_size], READ_SIZE);
+
+	consumer->pending_size   += length;
+	consumer->received_bytes += length;
+
+	uint32_t offset = 0;
+
+	while (!consumer->error && consumer->pending_size - offset >= HEADER_SIZE)
+	{
+		uint32_t size = consumer->pending[offset + 1];
+
+		if (size < HEADER_SIZE || size > MESSAGE_SIZE_MAX)
+		{
+			printf("  Message size %u in the stream\n", (unsigned int)size);
+			consumer->error = true;
+			break;
+		}
+
+		if (consumer->pending_size - offset < size)
+		{
+			break;
+		}
+
+		message_check(consumer, &consumer->pending[offset], gaps_allowed);
+		offset += size;
+	}
+
+	memmove(consumer->pending, &consumer->pending[offset], consumer->pending_size - offset);
+	consumer->pending_size -= offset;
+
+	return length;
+}
+
+
+static void ring_init_wrapping(acc_console_ring_t *ring, uint8_t *buffer, uint32_t size)
+{
+	acc_console_ring_init(ring, buffer, size);
+	ring->reserve = INDEX_START;
+	ring->commit  = INDEX_START;
+	ring->tail    = INDEX_START;
+}
+
+
+/**
+ * @brief Run the producers against a consumer, a slow consumer makes the producers drop or wait
+ */
+static bool producers_run(acc_console_ring_t *ring, acc_console_overflow_t overflow, consumer_t *consumer, producer_t *producers)
+{
+	pthread_t threads[PRODUCER_COUNT];
+	uint32_t  started    = 0;
+	uint32_t  done_count = 0;
+	uint32_t  reads      = 0;
+	bool      slow       = overflow == ACC_CONSOLE_OVERFLOW_DROP;
+
+	memset(consumer, 0, sizeof(*consumer));
+
+	for (uint8_t id = 0; id < PRODUCER_COUNT; id++)
+	{
+		producers[id] = (producer_t){ .ring = ring, .id = id, .overflow = overflow, .done_count = &done_count };
+
+		if (pthread_create(&threads[id], NULL, producer_run, &producers[id]) != 0)
+		{
+			printf("  Could not start producer %u\n", (unsigned int)id);
+			consumer->error = true;
+			break;
+		}
+
+		started++;
+	}
+
+	while (!consumer->error && __atomic_load_n(&done_count, __ATOMIC_ACQUIRE) < started)
+	{
+		if (consumer_read(consumer, ring, slow) == 0)
+		{
+			sched_yield();
+		}
+		else if (slow && (++reads % 256U) == 0)
+		{
+			nanosleep(&(struct timespec){ .tv_nsec = 10000 }, NULL);
+		}
+	}
+
+	for (uint32_t id = 0; id < started; id++)
+	{
+		pthread_join(threads[id], NULL);
+	}
+
+	// All producers are done, drain what is left
+	while (!consumer->error && consumer_read(consumer, ring, slow) > 0)
+	{
+	}
+
+	return !consumer->error;
+}
+
+
+/**
+ * @brief Producers that wait while the ring is full, every message must arrive exactly once and in order
+ */
+static bool test_block(void)
+{
+	static uint8_t     buffer[RING_SIZE_BLOCK];
+	acc_console_ring_t ring;
+	consumer_t         consumer;
+	producer_t         producers[PRODUCER_COUNT];
+
+	ring_init_wrapping(&ring, buffer, sizeof(buffer));
+
+	bool passed = producers_run(&ring, ACC_CONSOLE_OVERFLOW_BLOCK, &consumer, producers);
+
+	for (uint32_t id = 0; id < PRODUCER_COUNT; id++)
+	{
+		if (consumer.message_count[id] != MESSAGE_COUNT)
+		{
+			printf("  Producer %u: %u messages received of %u\n", (unsigned int)id, (unsigned int)consumer.message_count[id],
+			       (unsigned int)MESSAGE_COUNT);
+			passed = false;
+		}
+	}
+
+	if (consumer.pending_size != 0 || ring.dropped_bytes != 0 || ring.written_bytes != consumer.received_bytes)
+	{
+		printf("  %u bytes written, %u received, %u dropped, %u left over\n", (unsigned int)ring.written_bytes,
+		       (unsigned int)consumer.received_bytes, (unsigned int)ring.dropped_bytes, (unsigned int)consumer.pending_size);
+		passed = false;
+	}
+
+	if (ring.reserve >= INDEX_START)
+	{
+		printf("  Indexes did not wrap around\n");
+		passed = false;
+	}
+
+	printf("%-22s %s: %u bytes through a %u byte ring\n", "block", passed ? "passed" : "FAILED",
+	       (unsigned int)consumer.received_bytes, (unsigned int)RING_SIZE_BLOCK);
+
+	return passed;
+}
+
+
+/**
+ * @brief Producers that drop while the ring is full, messages must arrive whole and every dropped byte must be counted
+ */
+static bool test_drop(void)
+{
+	static uint8_t     buffer[RING_SIZE_DROP];
+	acc_console_ring_t ring;
+	consumer_t         consumer;
+	producer_t         producers[PRODUCER_COUNT];
+
+	ring_init_wrapping(&ring, buffer, sizeof(buffer));
+
+	bool     passed        = producers_run(&ring, ACC_CONSOLE_OVERFLOW_DROP, &consumer, producers);
+	uint32_t total_bytes   = 0;
+	uint32_t dropped_bytes = 0;
+	uint32_t messages      = 0;
+
+	for (uint32_t sequence = 0; sequence < MESSAGE_COUNT; sequence++)
+	{
+		total_bytes += PRODUCER_COUNT * message_size(sequence);
+	}
+
+	for (uint32_t id = 0; id < PRODUCER_COUNT; id++)
+	{
+		dropped_bytes += producers[id].dropped_bytes;
+		messages      += consumer.message_count[id];
+	}
+
+	if (ring.dropped_bytes != dropped_bytes || ring.written_bytes + ring.dropped_bytes != total_bytes ||
+	    ring.written_bytes != consumer.received_bytes || consumer.pending_size != 0)
+	{
+		printf("  %u bytes sent, %u written, %u received, %u dropped, %u dropped by the producers, %u left over\n",
+		       (unsigned int)total_bytes, (unsigned int)ring.written_bytes, (unsigned int)consumer.received_bytes,
+		       (unsigned int)ring.dropped_bytes, (unsigned int)dropped_bytes, (unsigned int)consumer.pending_size);
+		passed = false;
+	}
+
+	if (dropped_bytes == 0)
+	{
+		printf("  Nothing dropped, the consumer was not slow enough\n");
+		passed = false;
+	}
+
+	printf("%-22s %s: %u messages received, %u bytes dropped\n", "drop", passed ? "passed" : "FAILED", (unsigned int)messages,
+	       (unsigned int)dropped_bytes);
+
+	return passed;
+}
+
+
+/**
+ * @brief The oldest data is dropped to make room, also when the indexes wrap around
+ */
+static bool test_overwrite(void)
+{
+	uint8_t            buffer[64];
+	uint8_t            data[100];
+	uint8_t            read_data[sizeof(buffer)];
+	acc_console_ring_t ring;
+	bool               passed = true;
+
+	for (uint32_t index = 0; index < sizeof(data); index++)
+	{
+		data[index] = (uint8_t)index;
+	}
+
+	acc_console_ring_init(&ring, buffer, sizeof(buffer));
+	ring.reserve = UINT32_MAX - 20U;
+	ring.commit  = UINT32_MAX - 20U;
+	ring.tail    = UINT32_MAX - 20U;
+
+	for (uint32_t offset = 0; offset < sizeof(data); offset += 10)
+	{
+		passed = acc_console_ring_write(&ring, &data[offset], 10, ACC_CONSOLE_OVERFLOW_OVERWRITE) && passed;
+	}
+
+	uint32_t length = acc_console_ring_read(&ring, read_data, sizeof(read_data));
+
+	if (!passed || length != sizeof(buffer) || memcmp(read_data, &data[sizeof(data) - sizeof(buffer)], length) != 0 ||
+	    ring.dropped_bytes != sizeof(data) - sizeof(buffer) || !acc_console_ring_is_empty(&ring))
+	{
+		printf("  %u bytes read, %u dropped\n", (unsigned int)length, (unsigned int)ring.dropped_bytes);
+		passed = false;
+	}
+
+	// Larger than the ring, only the last part fits
+	passed = acc_console_ring_write(&ring, data, sizeof(data), ACC_CONSOLE_OVERFLOW_OVERWRITE) && passed;
+	length = acc_console_ring_read(&ring, read_data, sizeof(read_data));
+
+	if (length != sizeof(buffer) || memcmp(read_data, &data[sizeof(data) - sizeof(buffer)], length) != 0)
+	{
+		printf("  Oversized write: %u bytes read\n", (unsigned int)length);
+		passed = false;
+	}
+
+	uint32_t dropped = ring.dropped_bytes;
+
+	passed = !acc_console_ring_write(&ring, data, sizeof(data), ACC_CONSOLE_OVERFLOW_DROP) && passed;
+	passed = ring.dropped_bytes == dropped + sizeof(data) && acc_console_ring_is_empty(&ring) && passed;
+
+	printf("%-22s %s\n", "overwrite", passed ? "passed" : "FAILED");
+
+	return passed;
+}
+
+
+int main(void)
+{
+	bool passed = true;
+
+	passed = test_overwrite() && passed;
+	passed = test_block() && passed;
+	passed = test_drop() && passed;
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
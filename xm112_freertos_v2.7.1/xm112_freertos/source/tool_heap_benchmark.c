@@ -0,0 +1,683 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+
+#include "acc_tlsf.h"
+
+
+/**
+ * @brief Host benchmark of the FreeRTOS heaps
+ *
+ * Usage: acc_heap_benchmark [repetitions] [trace file]
+ *
+ * Allocation traces are replayed against heap_4, heap_5 and the TLSF heap,
+ * each with configTOTAL_HEAP_SIZE bytes. The built-in traces model the
+ * create and destroy cycles of the reference applications, a trace file
+ * has one operation per line:
+ *
+ *   a <id> <size>   allocate size bytes as id
+ *   f <id>          free id
+ *
+ * Every trace is replayed several times and the time of an operation is the
+ * fastest of the repetitions, which removes most of the noise from the host
+ * scheduler from the worst case. The fragmentation, 1 - largest free block /
+ * free memory, is sampled after every operation.
+ */
+
+
+#define DEFAULT_REPETITIONS 5U
+#define HEAP_SIZE           configTOTAL_HEAP_SIZE
+#define TRACE_FILE_ID_MAX   100000U
+
+
+void *heap_4_malloc(size_t size);
+void heap_4_free(void *ptr);
+void heap_4_get_free_blocks(size_t *free_size, size_t *largest_free_block, size_t *free_block_count);
+void *heap_5_malloc(size_t size);
+void heap_5_free(void *ptr);
+void heap_5_define_heap_regions(const HeapRegion_t * const regions);
+void heap_5_get_free_blocks(size_t *free_size, size_t *largest_free_block, size_t *free_block_count);
+void heap_benchmark_suspend_all(void);
+BaseType_t heap_benchmark_resume_all(void);
+
+
+typedef struct
+{
+	const char *name;
+	void       *(*alloc)(size_t size);
+	void       (*free)(void *ptr);
+	void       (*get_free_blocks)(size_t *free_size, size_t *largest_free_block, size_t *free_block_count);
+} heap_t;
+
+
+/**
+ * @brief One operation, size 0 frees the id
+ */
+typedef struct
+{
+	uint32_t id;
+	uint32_t size;
+} trace_op_t;
+
+
+typedef struct
+{
+	const char *name;
+	trace_op_t *ops;
+	size_t     op_count;
+	size_t     op_capacity;
+	uint32_t   id_count;
+} trace_t;
+
+
+typedef struct
+{
+	uint32_t alloc_count;
+	uint32_t failed_count;
+	double   alloc_mean_ns;
+	double   alloc_max_ns;
+	double   free_max_ns;
+	size_t   min_free_size;
+	size_t   min_largest_free_block;
+	uint32_t max_free_block_count;
+	double   fragmentation_mean;
+	double   fragmentation_max;
+	bool     corrupted;
+} result_t;
+
+
+static uint8_t     heap_5_memory[HEAP_SIZE];
+static uint8_t     tlsf_memory[HEAP_SIZE];
+static acc_tlsf_t  *tlsf;
+static uint32_t    random_state = 0x12345678U;
+
+
+void heap_benchmark_suspend_all(void)
+{
+}
+
+
+BaseType_t heap_benchmark_resume_all(void)
+{
+	return pdFALSE;
+}
+
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+
+static void *tlsf_malloc(size_t size)
+{
+	return acc_tlsf_alloc(tlsf, size);
+}
+
+
+static void tlsf_free(void *ptr)
+{
+	acc_tlsf_free(tlsf, ptr);
+}
+
+
+static void tlsf_get_free_blocks(size_t *free_size, size_t *largest_free_block, size_t *free_block_count)
+{
+	acc_tlsf_stats_t stats;
+
+	acc_tlsf_get_stats(tlsf, &stats);
+
+	*free_size          = stats.free_size;
+	*largest_free_block = stats.largest_free_block;
+	*free_block_count   = stats.free_block_count;
+}
+
+
+static const heap_t heaps[] = {
+	{ "heap_4", heap_4_malloc, heap_4_free, heap_4_get_free_blocks },
+	{ "heap_5", heap_5_malloc, heap_5_free, heap_5_get_free_blocks },
+	{ "tlsf",   tlsf_malloc,   tlsf_free,   tlsf_get_free_blocks   },
+};
+
+#define HEAP_COUNT (sizeof(heaps) / sizeof(heaps[0]))
+
+
+static uint32_t random_next(void)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+
+	return random_state;
+}
+
+
+static uint32_t random_range(uint32_t min, uint32_t max)
+{
+	return min + random_next() % (max - min + 1U);
+}
+
+
+static void trace_add(trace_t *trace, uint32_t id, uint32_t size)
+{
+	if (trace->op_count == trace->op_capacity)
+	{
+		trace->op_capacity = trace->op_capacity > 0 ? trace->op_capacity * 2U : 1024U;
+		trace->ops         = realloc(trace->ops, trace->op_capacity * sizeof(trace_op_t));
+		if (trace->ops == NULL)
+		{
+			printf("Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	trace->ops[trace->op_count].id   = id;
+	trace->ops[trace->op_count].size = size;
+	trace->op_count++;
+
+	if (id >= trace->id_count)
+	{
+		trace->id_count = id + 1U;
+	}
+}
+
+
+static uint32_t trace_alloc(trace_t *trace, uint32_t size)
+{
+	uint32_t id = trace->id_count;
+
+	trace_add(trace, id, size);
+
+	return id;
+}
+
+
+static void trace_free(trace_t *trace, uint32_t id)
+{
+	trace_add(trace, id, 0);
+}
+
+
+/**
+ * @brief Reconfiguration with wakeups like the smart presence reference application
+ *
+ * Every cycle creates a service and a detector with buffers that depend on
+ * the range, and destroys them again. Small allocations made meanwhile stay
+ * for a number of cycles and split the free memory.
+ */
+static void trace_create_reconfigure(trace_t *trace)
+{
+	uint32_t long_lived[64];
+	uint32_t long_lived_end[64];
+	uint32_t long_lived_count = 0;
+
+	trace->name = "reconfigure";
+
+	// Tasks, queues and semaphores created at start
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		trace_alloc(trace, random_range(64, 600));
+	}
+
+	for (uint32_t cycle = 0; cycle < 400; cycle++)
+	{
+		uint32_t ids[12];
+		uint32_t count       = 0;
+		uint32_t sweep_bytes = random_range(1000, 24000);
+
+		ids[count++] = trace_alloc(trace, random_range(300, 500));
+		ids[count++] = trace_alloc(trace, 1200);
+		ids[count++] = trace_alloc(trace, sweep_bytes);
+		ids[count++] = trace_alloc(trace, 600);
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			ids[count++] = trace_alloc(trace, random_range(sweep_bytes / 2, sweep_bytes));
+		}
+
+		ids[count++] = trace_alloc(trace, random_range(2000, 8000));
+
+		if (long_lived_count < 64 && random_range(0, 9) < 4)
+		{
+			long_lived[long_lived_count]     = trace_alloc(trace, random_range(48, 400));
+			long_lived_end[long_lived_count] = cycle + random_range(2, 40);
+			long_lived_count++;
+		}
+
+		// Detector first, then the service
+		while (count > 0)
+		{
+			trace_free(trace, ids[--count]);
+		}
+
+		for (uint32_t i = 0; i < long_lived_count; )
+		{
+			if (long_lived_end[i] == cycle)
+			{
+				trace_free(trace, long_lived[i]);
+				long_lived_count--;
+				long_lived[i]     = long_lived[long_lived_count];
+				long_lived_end[i] = long_lived_end[long_lived_count];
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Destroy and create of a detector with changing configuration and results kept between cycles
+ */
+static void trace_create_destroy_create(trace_t *trace)
+{
+	uint32_t result = trace_alloc(trace, 256);
+
+	trace->name = "destroy_create";
+
+	for (uint32_t cycle = 0; cycle < 400; cycle++)
+	{
+		uint32_t ids[16];
+		uint32_t count      = 0;
+		uint32_t data_bytes = 2000U * random_range(1, 16);
+
+		ids[count++] = trace_alloc(trace, 800);
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			ids[count++] = trace_alloc(trace, random_range(data_bytes / 4, data_bytes));
+		}
+
+		// The result of the previous cycle is replaced while the detector exists
+		trace_free(trace, result);
+		result = trace_alloc(trace, random_range(64, 1024));
+
+		// Destroy in any order
+		while (count > 0)
+		{
+			uint32_t index = random_range(0, count - 1U);
+
+			trace_free(trace, ids[index]);
+			ids[index] = ids[--count];
+		}
+	}
+}
+
+
+/**
+ * @brief Random sizes and lifetimes with the heap about half full
+ */
+static void trace_create_random(trace_t *trace)
+{
+	uint32_t ids[512];
+	uint32_t sizes[512];
+	uint32_t count      = 0;
+	uint32_t live_bytes = 0;
+
+	trace->name = "random";
+
+	for (uint32_t i = 0; i < 40000; i++)
+	{
+		bool do_alloc = count == 0 || (count < 512 && live_bytes < HEAP_SIZE / 2U && random_range(0, 1) == 0);
+
+		if (do_alloc)
+		{
+			// Log uniform between 16 B and 16 kB
+			uint32_t size = 16U << random_range(0, 9);
+
+			size           = random_range(size, size * 2U);
+			ids[count]     = trace_alloc(trace, size);
+			sizes[count++] = size;
+			live_bytes    += size;
+		}
+		else
+		{
+			uint32_t index = random_range(0, count - 1U);
+
+			trace_free(trace, ids[index]);
+			live_bytes  -= sizes[index];
+			count--;
+			ids[index]   = ids[count];
+			sizes[index] = sizes[count];
+		}
+	}
+}
+
+
+static bool trace_read(trace_t *trace, const char *path)
+{
+	FILE *file = fopen(path, "r");
+	char line[128];
+
+	if (file == NULL)
+	{
+		printf("Could not open %s\n", path);
+		return false;
+	}
+
+	trace->name = path;
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		char          op;
+		unsigned long id;
+		unsigned long size = 0;
+		int           fields = sscanf(line, " %c %lu %lu", &op, &id, &size);
+
+		if (fields < 2 || id >= TRACE_FILE_ID_MAX || (op == 'a' && (fields != 3 || size == 0)) ||
+		    (op != 'a' && op != 'f'))
+		{
+			if (fields > 0 && op != '#')
+			{
+				printf("Invalid line in %s: %s", path, line);
+				fclose(file);
+				return false;
+			}
+
+			continue;
+		}
+
+		trace_add(trace, (uint32_t)id, op == 'a' ? (uint32_t)size : 0U);
+	}
+
+	fclose(file);
+
+	return true;
+}
+
+
+static void fill(void *ptr, uint32_t id, uint32_t size)
+{
+	memset(ptr, (int)(id & 0xffU), size);
+}
+
+
+static bool verify(const void *ptr, uint32_t id, uint32_t size)
+{
+	const uint8_t *bytes = ptr;
+
+	for (uint32_t i = 0; i < size; i++)
+	{
+		if (bytes[i] != (uint8_t)id)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void replay(const heap_t *heap, const trace_t *trace, uint32_t repetitions, result_t *result)
+{
+	void     **pointers = calloc(trace->id_count, sizeof(void *));
+	uint32_t *sizes     = calloc(trace->id_count, sizeof(uint32_t));
+	uint64_t *times     = malloc(trace->op_count * sizeof(uint64_t));
+
+	if (pointers == NULL || sizes == NULL || times == NULL)
+	{
+		printf("Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	memset(result, 0, sizeof(*result));
+	result->min_free_size          = SIZE_MAX;
+	result->min_largest_free_block = SIZE_MAX;
+
+	for (size_t i = 0; i < trace->op_count; i++)
+	{
+		times[i] = UINT64_MAX;
+	}
+
+	for (uint32_t repetition = 0; repetition < repetitions; repetition++)
+	{
+		// The heap contents and fragmentation are checked in the first repetition only
+		bool first = repetition == 0;
+
+		for (size_t i = 0; i < trace->op_count; i++)
+		{
+			const trace_op_t *op = &trace->ops[i];
+			uint64_t         start;
+			uint64_t         time;
+
+			if (op->size > 0)
+			{
+				if (pointers[op->id] != NULL)
+				{
+					continue;
+				}
+
+				start             = now_ns();
+				pointers[op->id]  = heap->alloc(op->size);
+				time              = now_ns() - start;
+				sizes[op->id]     = op->size;
+
+				if (first)
+				{
+					result->alloc_count++;
+					if (pointers[op->id] == NULL)
+					{
+						result->failed_count++;
+					}
+					else
+					{
+						fill(pointers[op->id], op->id, op->size);
+					}
+				}
+			}
+			else
+			{
+				if (pointers[op->id] == NULL)
+				{
+					continue;
+				}
+
+				if (first && !verify(pointers[op->id], op->id, sizes[op->id]))
+				{
+					result->corrupted = true;
+				}
+
+				start = now_ns();
+				heap->free(pointers[op->id]);
+				time             = now_ns() - start;
+				pointers[op->id] = NULL;
+			}
+
+			if (time < times[i])
+			{
+				times[i] = time;
+			}
+
+			if (first)
+			{
+				size_t free_size;
+				size_t largest_free_block;
+				size_t free_block_count;
+
+				heap->get_free_blocks(&free_size, &largest_free_block, &free_block_count);
+
+				double fragmentation = free_size > 0 ? 1.0 - (double)largest_free_block / (double)free_size : 0.0;
+
+				result->fragmentation_mean += fragmentation;
+				if (fragmentation > result->fragmentation_max)
+				{
+					result->fragmentation_max = fragmentation;
+				}
+
+				if (free_size < result->min_free_size)
+				{
+					result->min_free_size = free_size;
+				}
+
+				if (largest_free_block < result->min_largest_free_block)
+				{
+					result->min_largest_free_block = largest_free_block;
+				}
+
+				if (free_block_count > result->max_free_block_count)
+				{
+					result->max_free_block_count = (uint32_t)free_block_count;
+				}
+			}
+		}
+
+		// Leave the heap empty for the next repetition
+		for (uint32_t id = 0; id < trace->id_count; id++)
+		{
+			heap->free(pointers[id]);
+			pointers[id] = NULL;
+		}
+	}
+
+	uint64_t alloc_sum = 0;
+
+	for (size_t i = 0; i < trace->op_count; i++)
+	{
+		if (times[i] == UINT64_MAX)
+		{
+			continue;
+		}
+
+		if (trace->ops[i].size > 0)
+		{
+			alloc_sum += times[i];
+			if ((double)times[i] > result->alloc_max_ns)
+			{
+				result->alloc_max_ns = (double)times[i];
+			}
+		}
+		else if ((double)times[i] > result->free_max_ns)
+		{
+			result->free_max_ns = (double)times[i];
+		}
+	}
+
+	if (result->alloc_count > 0)
+	{
+		result->alloc_mean_ns = (double)alloc_sum / result->alloc_count;
+	}
+
+	result->fragmentation_mean /= trace->op_count > 0 ? (double)trace->op_count : 1.0;
+
+	free(pointers);
+	free(sizes);
+	free(times);
+}
+
+
+static bool run_trace(const trace_t *trace, uint32_t repetitions)
+{
+	bool success = true;
+
+	printf("\n%s: %zu operations\n", trace->name, trace->op_count);
+	printf("%-8s %8s %8s %10s %10s %10s %10s %10s %8s %10s %10s\n", "heap", "allocs", "failed", "alloc ns",
+	       "alloc max", "free max", "min free", "min large", "blocks", "frag mean", "frag max");
+
+	for (size_t i = 0; i < HEAP_COUNT; i++)
+	{
+		result_t result;
+
+		replay(&heaps[i], trace, repetitions, &result);
+
+		printf("%-8s %8u %8u %10.1f %10.0f %10.0f %10zu %10zu %8u %9.1f%% %9.1f%%\n", heaps[i].name,
+		       (unsigned int)result.alloc_count, (unsigned int)result.failed_count, result.alloc_mean_ns,
+		       result.alloc_max_ns, result.free_max_ns, result.min_free_size, result.min_largest_free_block,
+		       (unsigned int)result.max_free_block_count, result.fragmentation_mean * 100.0,
+		       result.fragmentation_max * 100.0);
+
+		if (result.corrupted)
+		{
+			printf("%s: allocated memory was overwritten\n", heaps[i].name);
+			success = false;
+		}
+	}
+
+	if (!acc_tlsf_check(tlsf))
+	{
+		printf("tlsf: inconsistent after the trace\n");
+		success = false;
+	}
+
+	return success;
+}
+
+
+int main(int argc, char *argv[])
+{
+	uint32_t   repetitions = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_REPETITIONS;
+	trace_t    traces[4];
+	size_t     trace_count = 0;
+	bool       success     = true;
+	HeapRegion_t regions[] = {
+		{ heap_5_memory, sizeof(heap_5_memory) },
+		{ NULL, 0 }
+	};
+
+	if (repetitions == 0)
+	{
+		repetitions = 1;
+	}
+
+	memset(traces, 0, sizeof(traces));
+
+	if (argc > 2)
+	{
+		if (!trace_read(&traces[trace_count++], argv[2]))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		trace_create_reconfigure(&traces[trace_count++]);
+		trace_create_destroy_create(&traces[trace_count++]);
+		trace_create_random(&traces[trace_count++]);
+	}
+
+	heap_5_define_heap_regions(regions);
+
+	// Without a cycle counter, the benchmark times all heaps the same way
+	tlsf = acc_tlsf_create(tlsf_memory, sizeof(tlsf_memory), NULL);
+	if (tlsf == NULL)
+	{
+		printf("Could not create the TLSF heap\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("Heap size %u bytes, %u repetitions, times are the fastest of the repetitions\n", (unsigned int)HEAP_SIZE,
+	       (unsigned int)repetitions);
+
+	for (size_t i = 0; i < trace_count; i++)
+	{
+		success = run_trace(&traces[i], repetitions) && success;
+		free(traces[i].ops);
+	}
+
+	acc_tlsf_stats_t stats;
+
+	acc_tlsf_get_stats(tlsf, &stats);
+	printf("\ntlsf reported: %u allocations, %u failed, %u of %u bytes free at least\n",
+	       (unsigned int)stats.alloc_count, (unsigned int)stats.failed_alloc_count,
+	       (unsigned int)stats.min_ever_free_size, (unsigned int)stats.total_size);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
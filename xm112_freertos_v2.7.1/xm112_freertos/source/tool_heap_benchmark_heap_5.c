@@ -0,0 +1,57 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+/**
+ * @brief The FreeRTOS heap_5.c for acc_heap_benchmark
+ *
+ * The public functions get a heap_5_ prefix so that several heaps can be
+ * linked together. The scheduler is never started in the benchmark, so
+ * suspending it is replaced by functions that do nothing.
+ */
+
+#include <stddef.h>
+
+#define pvPortMalloc                    heap_5_malloc
+#define vPortFree                       heap_5_free
+#define xPortGetFreeHeapSize            heap_5_get_free_size
+#define xPortGetMinimumEverFreeHeapSize heap_5_get_minimum_ever_free_size
+#define vPortDefineHeapRegions          heap_5_define_heap_regions
+#define vTaskSuspendAll                 heap_benchmark_suspend_all
+#define xTaskResumeAll                  heap_benchmark_resume_all
+
+#include "heap_5.c"
+
+
+void heap_5_get_free_blocks(size_t *free_size, size_t *largest_free_block, size_t *free_block_count);
+
+
+/**
+ * @brief Walk the free list, the sizes are without the block headers to compare with other heaps
+ */
+void heap_5_get_free_blocks(size_t *free_size, size_t *largest_free_block, size_t *free_block_count)
+{
+	*free_size          = 0;
+	*largest_free_block = 0;
+	*free_block_count   = 0;
+
+	if (pxEnd == NULL)
+	{
+		return;
+	}
+
+	for (const BlockLink_t *block = xStart.pxNextFreeBlock; block != pxEnd; block = block->pxNextFreeBlock)
+	{
+		size_t size = block->xBlockSize - xHeapStructSize;
+
+		*free_size += size;
+		if (size > *largest_free_block)
+		{
+			*largest_free_block = size;
+		}
+
+		(*free_block_count)++;
+	}
+}
@@ -0,0 +1,591 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acc_log_binary.h"
+
+
+/**
+ * @brief Host tool that turns binary log records into text
+ *
+ * Usage: acc_log_decoder <dictionary> [log]
+ *
+ * The dictionary is the Intel HEX file with the read only data of the
+ * application, made by the build next to the .hex file with the extension
+ * .logdict. The log is read from stdin if no file is given. Text between
+ * records is passed through unchanged.
+ */
+
+
+#define LOG_FORMAT "%02u:%02u:%02u.%03u [%5u] (%c) (%s) %s\n"
+
+#define MESSAGE_MAX_SIZE 1024
+
+#define SPEC_MAX_SIZE 64
+
+
+typedef struct
+{
+	uint32_t address;
+	uint32_t size;
+	uint8_t  *data;
+} segment_t;
+
+
+typedef struct
+{
+	segment_t *segments;
+	size_t    count;
+} dictionary_t;
+
+
+typedef struct
+{
+	char   buffer[MESSAGE_MAX_SIZE];
+	size_t length;
+} message_t;
+
+
+int _write(int file, const char *ptr, int len);
+
+
+/**
+ * @brief Write data to output device, used by libwrapprintf
+ *
+ * @param[in] file File to write to, ignored
+ * @param[in] ptr Buffer with data to write
+ * @param[in] len Number of bytes to write
+ * @return number of bytes written
+ */
+int _write(int file, const char *ptr, int len)
+{
+	(void)file;
+
+	return (int)fwrite(ptr, 1, (size_t)len, stdout);
+}
+
+
+static bool dictionary_add(dictionary_t *dictionary, uint32_t address, const uint8_t *data, uint32_t size)
+{
+	segment_t *last = dictionary->count > 0 ? &dictionary->segments[dictionary->count - 1] : NULL;
+
+	if (last == NULL || last->address + last->size != address)
+	{
+		segment_t *segments = realloc(dictionary->segments, (dictionary->count + 1) * sizeof(segment_t));
+
+		if (segments == NULL)
+		{
+			return false;
+		}
+
+		dictionary->segments = segments;
+		last                 = &segments[dictionary->count++];
+		last->address        = address;
+		last->size           = 0;
+		last->data           = NULL;
+	}
+
+	uint8_t *new_data = realloc(last->data, last->size + size);
+
+	if (new_data == NULL)
+	{
+		return false;
+	}
+
+	memcpy(&new_data[last->size], data, size);
+	last->data  = new_data;
+	last->size += size;
+
+	return true;
+}
+
+
+static bool dictionary_load(dictionary_t *dictionary, const char *path)
+{
+	FILE *file = fopen(path, "r");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Unable to open %s\n", path);
+		return false;
+	}
+
+	char     line[600];
+	uint32_t base    = 0;
+	bool     success = true;
+
+	while (success && fgets(line, sizeof(line), file) != NULL)
+	{
+		uint8_t bytes[260];
+		size_t  count = 0;
+
+		if (line[0] != ':')
+		{
+			continue;
+		}
+
+		for (const char *p = &line[1]; count < sizeof(bytes); p += 2)
+		{
+			unsigned int value;
+
+			if (sscanf(p, "%2x", &value) != 1)
+			{
+				break;
+			}
+
+			bytes[count++] = (uint8_t)value;
+		}
+
+		if (count < 5 || count < (size_t)bytes[0] + 5)
+		{
+			fprintf(stderr, "Malformed record in %s\n", path);
+			success = false;
+			break;
+		}
+
+		uint8_t  size    = bytes[0];
+		uint32_t address = ((uint32_t)bytes[1] << 8) | bytes[2];
+		uint8_t  type    = bytes[3];
+
+		switch (type)
+		{
+			case 0x00:
+				success = dictionary_add(dictionary, base + address, &bytes[4], size);
+				break;
+			case 0x02:
+				base = (((uint32_t)bytes[4] << 8) | bytes[5]) << 4;
+				break;
+			case 0x04:
+				base = (((uint32_t)bytes[4] << 8) | bytes[5]) << 16;
+				break;
+			default:
+				break;
+		}
+	}
+
+	fclose(file);
+
+	return success;
+}
+
+
+static const char *dictionary_lookup(const dictionary_t *dictionary, uint64_t address)
+{
+	for (size_t i = 0; i < dictionary->count; i++)
+	{
+		const segment_t *segment = &dictionary->segments[i];
+
+		if (address >= segment->address && address < (uint64_t)segment->address + segment->size)
+		{
+			const uint8_t *string = &segment->data[address - segment->address];
+			size_t        left    = segment->size - (address - segment->address);
+
+			// Only accept strings that end within the segment
+			if (memchr(string, '\0', left) != NULL)
+			{
+				return (const char *)string;
+			}
+
+			return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void message_append(message_t *message, const char *format, ...)
+{
+	va_list ap;
+
+	if (message->length >= sizeof(message->buffer) - 1)
+	{
+		return;
+	}
+
+	va_start(ap, format);
+	int ret = vsnprintf(&message->buffer[message->length], sizeof(message->buffer) - message->length, format, ap);
+	va_end(ap);
+
+	if (ret > 0)
+	{
+		message->length += (size_t)ret;
+
+		if (message->length > sizeof(message->buffer) - 1)
+		{
+			message->length = sizeof(message->buffer) - 1;
+		}
+	}
+}
+
+
+static void message_append_text(message_t *message, const char *text, size_t length)
+{
+	message_append(message, "%.*s", (int)length, text);
+}
+
+
+static bool get_bytes(const uint8_t **args, size_t *left, void *value, size_t size)
+{
+	if (*left < size)
+	{
+		*left = 0;
+		return false;
+	}
+
+	memcpy(value, *args, size);
+	*args += size;
+	*left -= size;
+
+	return true;
+}
+
+
+/**
+ * @brief Build a printf conversion from a logged one
+ *
+ * Width and precision given as arguments are replaced by their values and the
+ * length modifier is replaced by the one matching how the argument was stored.
+ */
+static void build_spec(char *spec, const acc_log_binary_conversion_t *conversion, int32_t width, int32_t precision,
+                       const char *length)
+{
+	size_t modifier_size = 0;
+
+	switch (conversion->length)
+	{
+		case ACC_LOG_BINARY_LENGTH_NONE:
+			break;
+		case ACC_LOG_BINARY_LENGTH_HH:
+		case ACC_LOG_BINARY_LENGTH_LL:
+			modifier_size = 2;
+			break;
+		default:
+			modifier_size = 1;
+			break;
+	}
+
+	const char *end           = conversion->start + conversion->size - 1 - modifier_size;
+	size_t     size           = 0;
+	bool       precision_part = false;
+
+	for (const char *p = conversion->start; p < end && size < SPEC_MAX_SIZE - 16; p++)
+	{
+		if (*p == '.')
+		{
+			precision_part = true;
+
+			if (conversion->precision_arg && precision < 0)
+			{
+				// A negative precision is taken as if it was omitted
+				p++;
+				continue;
+			}
+		}
+
+		if (*p == '*')
+		{
+			size += (size_t)sprintf(&spec[size], "%" PRId32, precision_part ? precision : width);
+			continue;
+		}
+
+		spec[size++] = *p;
+	}
+
+	sprintf(&spec[size], "%s%c", length, conversion->conversion);
+}
+
+
+static void decode_message(message_t *message, const char *format, const uint8_t *args, size_t left)
+{
+	acc_log_binary_conversion_t conversion;
+	const char                  *position = format;
+	const char                  *text     = format;
+
+	while (acc_log_binary_next_conversion(&position, &conversion))
+	{
+		char    spec[SPEC_MAX_SIZE];
+		int32_t width     = 0;
+		int32_t precision = 0;
+
+		message_append_text(message, text, (size_t)(conversion.start - text));
+		text = position;
+
+		if ((conversion.width_arg && !get_bytes(&args, &left, &width, sizeof(width))) ||
+		    (conversion.precision_arg && !get_bytes(&args, &left, &precision, sizeof(precision))))
+		{
+			message_append(message, "<?>");
+			continue;
+		}
+
+		switch (conversion.arg)
+		{
+			case ACC_LOG_BINARY_ARG_INT:
+			{
+				uint32_t value;
+
+				if (!get_bytes(&args, &left, &value, sizeof(value)))
+				{
+					message_append(message, "<?>");
+					break;
+				}
+
+				if (conversion.length == ACC_LOG_BINARY_LENGTH_HH)
+				{
+					value = conversion.is_signed ? (uint32_t)(int32_t)(int8_t)value : (uint8_t)value;
+				}
+				else if (conversion.length == ACC_LOG_BINARY_LENGTH_H)
+				{
+					value = conversion.is_signed ? (uint32_t)(int32_t)(int16_t)value : (uint16_t)value;
+				}
+
+				build_spec(spec, &conversion, width, precision, "");
+
+				if (conversion.is_signed)
+				{
+					message_append(message, spec, (int)(int32_t)value);
+				}
+				else
+				{
+					message_append(message, spec, (unsigned int)value);
+				}
+
+				break;
+			}
+			case ACC_LOG_BINARY_ARG_LONG:
+			{
+				uint64_t value;
+
+				if (!get_bytes(&args, &left, &value, sizeof(value)))
+				{
+					message_append(message, "<?>");
+					break;
+				}
+
+				build_spec(spec, &conversion, width, precision, "ll");
+
+				if (conversion.is_signed)
+				{
+					message_append(message, spec, (long long)(int64_t)value);
+				}
+				else
+				{
+					message_append(message, spec, (unsigned long long)value);
+				}
+
+				break;
+			}
+			case ACC_LOG_BINARY_ARG_DOUBLE:
+			{
+				double value;
+
+				if (!get_bytes(&args, &left, &value, sizeof(value)))
+				{
+					message_append(message, "<?>");
+					break;
+				}
+
+				build_spec(spec, &conversion, width, precision, "");
+				message_append(message, spec, value);
+				break;
+			}
+			case ACC_LOG_BINARY_ARG_POINTER:
+			{
+				uint64_t value;
+
+				if (!get_bytes(&args, &left, &value, sizeof(value)))
+				{
+					message_append(message, "<?>");
+					break;
+				}
+
+				if (conversion.conversion == 'p')
+				{
+					message_append(message, "0x%" PRIx64, value);
+				}
+
+				break;
+			}
+			case ACC_LOG_BINARY_ARG_STRING:
+			{
+				uint16_t length;
+				char     string[ACC_LOG_BINARY_STRING_MAX_LENGTH + 1];
+
+				if (!get_bytes(&args, &left, &length, sizeof(length)) || length > ACC_LOG_BINARY_STRING_MAX_LENGTH ||
+				    !get_bytes(&args, &left, string, length))
+				{
+					message_append(message, "<?>");
+					break;
+				}
+
+				string[length] = '\0';
+
+				size_t padding = (4 - ((sizeof(length) + length) & 3)) & 3;
+				args += padding < left ? padding : left;
+				left -= padding < left ? padding : left;
+
+				build_spec(spec, &conversion, width, precision, "");
+				message_append(message, spec, string);
+				break;
+			}
+			default:
+				if (conversion.conversion == '%')
+				{
+					message_append(message, "%%");
+				}
+				else
+				{
+					message_append_text(message, conversion.start, conversion.size);
+				}
+
+				break;
+		}
+	}
+
+	message_append_text(message, text, strlen(text));
+}
+
+
+static void decode_record(const dictionary_t *dictionary, const acc_log_binary_header_t *header, const uint8_t *args,
+                          size_t args_size)
+{
+	message_t  message;
+	const char *format = dictionary_lookup(dictionary, header->format);
+	const char *module = dictionary_lookup(dictionary, header->module);
+
+	message.length    = 0;
+	message.buffer[0] = '\0';
+
+	if (format != NULL)
+	{
+		decode_message(&message, format, args, args_size);
+	}
+	else
+	{
+		message_append(&message, "<unknown format 0x%" PRIx64 ">", header->format);
+	}
+
+	unsigned int timestamp    = header->time_ms;
+	unsigned int hours        = timestamp / 1000 / 60 / 60;
+	unsigned int minutes      = timestamp / 1000 / 60 % 60;
+	unsigned int seconds      = timestamp / 1000 % 60;
+	unsigned int milliseconds = timestamp % 1000;
+	char         level_ch     = (header->level <= ACC_LOG_LEVEL_DEBUG) ? "EWIVD"[header->level] : '?';
+
+	printf(LOG_FORMAT, hours, minutes, seconds, milliseconds, (unsigned int)header->thread_id, level_ch,
+	       module != NULL ? module : "?", message.buffer);
+}
+
+
+static void decode_stream(const dictionary_t *dictionary, FILE *input)
+{
+	int c;
+
+	while ((c = fgetc(input)) != EOF)
+	{
+		if (c != ACC_LOG_BINARY_SYNC_0)
+		{
+			putchar(c);
+			continue;
+		}
+
+		c = fgetc(input);
+		if (c != ACC_LOG_BINARY_SYNC_1)
+		{
+			putchar(ACC_LOG_BINARY_SYNC_0);
+			if (c == EOF)
+			{
+				break;
+			}
+
+			ungetc(c, input);
+			continue;
+		}
+
+		uint8_t                 record[ACC_LOG_BINARY_RECORD_MAX_SIZE];
+		acc_log_binary_header_t header;
+
+		record[0] = ACC_LOG_BINARY_SYNC_0;
+		record[1] = ACC_LOG_BINARY_SYNC_1;
+
+		if (fread(&record[2], 1, sizeof(header) - 2, input) != sizeof(header) - 2)
+		{
+			fprintf(stderr, "Truncated record at end of log\n");
+			break;
+		}
+
+		memcpy(&header, record, sizeof(header));
+
+		if (header.length < sizeof(header) || header.length > sizeof(record))
+		{
+			fprintf(stderr, "Invalid record length %u\n", (unsigned int)header.length);
+			continue;
+		}
+
+		size_t args_size = header.length - sizeof(header);
+
+		if (fread(&record[sizeof(header)], 1, args_size, input) != args_size)
+		{
+			fprintf(stderr, "Truncated record at end of log\n");
+			break;
+		}
+
+		decode_record(dictionary, &header, &record[sizeof(header)], args_size);
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	dictionary_t dictionary = { .segments = NULL, .count = 0 };
+
+	if (argc < 2 || argc > 3)
+	{
+		fprintf(stderr, "Usage: %s <dictionary> [log]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (!dictionary_load(&dictionary, argv[1]))
+	{
+		return EXIT_FAILURE;
+	}
+
+	FILE *input = stdin;
+
+	if (argc == 3)
+	{
+		input = fopen(argv[2], "rb");
+		if (input == NULL)
+		{
+			fprintf(stderr, "Unable to open %s\n", argv[2]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	decode_stream(&dictionary, input);
+
+	if (input != stdin)
+	{
+		fclose(input);
+	}
+
+	for (size_t i = 0; i < dictionary.count; i++)
+	{
+		free(dictionary.segments[i].data);
+	}
+
+	free(dictionary.segments);
+
+	return EXIT_SUCCESS;
+}
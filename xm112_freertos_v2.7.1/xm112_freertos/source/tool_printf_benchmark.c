@@ -0,0 +1,302 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "printf.h"
+
+// The results of the tool itself are written with the wrapped printf
+#undef printf
+
+
+/**
+ * @brief Host benchmark of the printf.c fast paths
+ *
+ * Usage: acc_printf_benchmark [iterations]
+ *
+ * Every format is checked against printf.c built without the fast paths and
+ * then timed with both, formatting to a buffer and to an output function the
+ * way the printf wrapper does. The result is the time per formatted field.
+ */
+
+
+#define DEFAULT_ITERATIONS 200000U
+
+/**
+ * @brief Size of the output function buffer, the same as in acc_wrap_printf.c
+ */
+#define OUT_BUFFER_SIZE 200
+
+
+int vsnprintf_reference(char *buffer, size_t count, const char *format, va_list va);
+int fctvprintf_reference(void (*out)(char character, void *arg), void *arg, const char *format, va_list va);
+int _write(int file, const char *ptr, int len);
+
+
+typedef struct
+{
+	const char *name;
+	const char *format;
+	/** Number of conversions in the format */
+	unsigned int field_count;
+	bool         is_string;
+} benchmark_format_t;
+
+
+typedef struct
+{
+	char     buffer[OUT_BUFFER_SIZE];
+	size_t   position;
+	uint32_t flush_count;
+} out_buffer_t;
+
+
+static const benchmark_format_t formats[] = {
+	{ "%u",                 "%u",                          1, false },
+	{ "%d",                 "%d",                          1, false },
+	{ "%x",                 "%x",                          1, false },
+	{ "%6u",                "%6u",                         1, false },
+	{ "%02u",               "%02u",                        1, false },
+	{ "%5d",                "%5d",                         1, false },
+	{ "%08X",               "%08X",                        1, false },
+	{ "%lu",                "%lu",                         1, false },
+	{ "%s",                 "%s",                          1, true  },
+	{ "presence line",      "Score: %5d, Distance: %4d\n", 2, false },
+	{ "%-6u",               "%-6u",                        1, false },
+	{ "%+5d",               "%+5d",                        1, false },
+	{ "%#x",                "%#x",                         1, false },
+	{ "%.3u",               "%.3u",                        1, false },
+	{ "%-+6d",              "%-+6d",                       1, false },
+	{ "%+05d",              "%+05d",                       1, false },
+	{ "% .0d",              "% .0d",                       1, false },
+	{ "%8.3x",              "%8.3x",                       1, false },
+	{ "%-08.4u",            "%-08.4u",                     1, false },
+	{ "%8.2f",              "%8.2f",                       1, false },
+	{ "%-16s",              "%-16s",                       1, true  },
+	{ "%20.8s",             "%20.8s",                      1, true  },
+	{ "%.0s",               "%.0s",                        1, true  },
+};
+
+
+static const long check_values[] = {
+	0, 1, 9, 10, 99, 100, 101, 999, 1000, 12345, 65535, 99999, 100000, 1234567, 2147483647,
+	-1, -9, -10, -99, -100, -12345, -2147483647,
+};
+
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * @brief Write data to output device, used by libwrapprintf
+ *
+ * @param[in] file File to write to, ignored
+ * @param[in] ptr Buffer with data to write
+ * @param[in] len Number of bytes to write
+ * @return number of bytes written
+ */
+int _write(int file, const char *ptr, int len)
+{
+	(void)file;
+
+	return (int)fwrite(ptr, 1, (size_t)len, stdout);
+}
+
+
+static void out_char(char character, void *arg)
+{
+	out_buffer_t *out = arg;
+
+	out->buffer[out->position++] = character;
+	if (out->position == OUT_BUFFER_SIZE)
+	{
+		out->position = 0;
+		out->flush_count++;
+	}
+}
+
+
+static void out_span(const char *data, size_t length, void *arg)
+{
+	out_buffer_t *out = arg;
+
+	while (length > 0)
+	{
+		size_t copy = OUT_BUFFER_SIZE - out->position;
+
+		if (copy > length)
+		{
+			copy = length;
+		}
+
+		memcpy(&out->buffer[out->position], data, copy);
+		out->position += copy;
+		data          += copy;
+		length        -= copy;
+
+		if (out->position == OUT_BUFFER_SIZE)
+		{
+			out->position = 0;
+			out->flush_count++;
+		}
+	}
+}
+
+
+static int format_buffer(bool reference, char *buffer, size_t size, const char *format, ...)
+{
+	va_list va;
+
+	va_start(va, format);
+	int ret = reference ? vsnprintf_reference(buffer, size, format, va) : vsnprintf_(buffer, size, format, va);
+	va_end(va);
+
+	return ret;
+}
+
+
+static int format_output(bool reference, out_buffer_t *out, const char *format, ...)
+{
+	va_list va;
+
+	va_start(va, format);
+	int ret = reference ? fctvprintf_reference(out_char, out, format, va) : fctvprintf_span(out_span, out, format, va);
+	va_end(va);
+
+	return ret;
+}
+
+
+static int format_value(bool reference, bool to_buffer, char *buffer, size_t size, out_buffer_t *out,
+                        const benchmark_format_t *format, long value)
+{
+	if (format->is_string)
+	{
+		return to_buffer ? format_buffer(reference, buffer, size, format->format, "Envelope data:") :
+		       format_output(reference, out, format->format, "Envelope data:");
+	}
+
+	if (strchr(format->format, 'f') != NULL)
+	{
+		return to_buffer ? format_buffer(reference, buffer, size, format->format, (double)value / 7) :
+		       format_output(reference, out, format->format, (double)value / 7);
+	}
+
+	if (strchr(format->format, 'l') != NULL)
+	{
+		return to_buffer ? format_buffer(reference, buffer, size, format->format, (unsigned long)value) :
+		       format_output(reference, out, format->format, (unsigned long)value);
+	}
+
+	return to_buffer ? format_buffer(reference, buffer, size, format->format, (int)value, (int)(value / 3)) :
+	       format_output(reference, out, format->format, (int)value, (int)(value / 3));
+}
+
+
+static unsigned int check_format(const benchmark_format_t *format)
+{
+	unsigned int mismatch_count = 0;
+
+	for (size_t i = 0; i < sizeof(check_values) / sizeof(check_values[0]); i++)
+	{
+		char         expected[64];
+		char         actual[64];
+		out_buffer_t out;
+
+		memset(&out, 0, sizeof(out));
+
+		int expected_length = format_value(true, true, expected, sizeof(expected), NULL, format, check_values[i]);
+		int actual_length   = format_value(false, true, actual, sizeof(actual), NULL, format, check_values[i]);
+		int output_length   = format_value(false, false, NULL, 0, &out, format, check_values[i]);
+
+		if (actual_length != expected_length || output_length != expected_length || strcmp(actual, expected) != 0 ||
+		    memcmp(out.buffer, expected, (size_t)expected_length) != 0)
+		{
+			printf("Mismatch for '%s' and %ld: '%s' expected '%s'\n", format->format, check_values[i], actual, expected);
+			mismatch_count++;
+		}
+	}
+
+	// Truncation must match as well
+	char expected[4];
+	char actual[4];
+
+	format_value(true, true, expected, sizeof(expected), NULL, format, 123456);
+	format_value(false, true, actual, sizeof(actual), NULL, format, 123456);
+
+	if (strcmp(actual, expected) != 0)
+	{
+		printf("Truncation mismatch for '%s': '%s' expected '%s'\n", format->format, actual, expected);
+		mismatch_count++;
+	}
+
+	return mismatch_count;
+}
+
+
+static double time_format(bool reference, bool to_buffer, const benchmark_format_t *format, uint32_t iterations)
+{
+	char         buffer[64];
+	out_buffer_t out;
+
+	memset(&out, 0, sizeof(out));
+
+	double start = now_s();
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		format_value(reference, to_buffer, buffer, sizeof(buffer), &out, format, (long)(i * 37U % 100000U));
+	}
+
+	return (now_s() - start) * 1e9 / ((double)iterations * format->field_count);
+}
+
+
+int main(int argc, char *argv[])
+{
+	uint32_t     iterations     = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+	unsigned int mismatch_count = 0;
+
+	if (iterations == 0)
+	{
+		return EXIT_FAILURE;
+	}
+
+	printf("%-18s %12s %12s %12s %12s\n", "ns/field", "buffer old", "buffer new", "output old", "output new");
+
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+	{
+		mismatch_count += check_format(&formats[i]);
+
+		double buffer_reference = time_format(true, true, &formats[i], iterations);
+		double buffer_fast      = time_format(false, true, &formats[i], iterations);
+		double output_reference = time_format(true, false, &formats[i], iterations);
+		double output_fast      = time_format(false, false, &formats[i], iterations);
+
+		printf("%-18s %12.1f %12.1f %12.1f %12.1f\n", formats[i].name, buffer_reference, buffer_fast, output_reference,
+		       output_fast);
+	}
+
+	printf("%u mismatches\n", mismatch_count);
+
+	return mismatch_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
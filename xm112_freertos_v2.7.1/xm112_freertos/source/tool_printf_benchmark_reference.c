@@ -0,0 +1,26 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+/**
+ * @brief printf.c without the fast paths, the baseline for acc_printf_benchmark
+ *
+ * The public functions get a _reference suffix so that they can be linked
+ * together with the normal printf.c.
+ */
+
+#define PRINTF_DISABLE_FAST_PATHS
+
+#define printf_         printf_reference
+#define sprintf_        sprintf_reference
+#define snprintf_       snprintf_reference
+#define vprintf_        vprintf_reference
+#define vsnprintf_      vsnprintf_reference
+#define fctprintf       fctprintf_reference
+#define fctvprintf      fctvprintf_reference
+#define fctprintf_span  fctprintf_span_reference
+#define fctvprintf_span fctvprintf_span_reference
+
+#include "printf.c"
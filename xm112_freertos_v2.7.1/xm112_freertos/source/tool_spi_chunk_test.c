@@ -0,0 +1,342 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acc_driver_spi_chunk.h"
+
+
+/**
+ * @brief Host test of the SPI chunk planner
+ *
+ * Usage: acc_spi_chunk_test
+ *
+ * Transfers are split into chunks the way acc_driver_spi_same70.c does it and
+ * each chunk is handed to a mock of spid_transfer. The mock checks that chunks
+ * transferred in place cover whole cache lines of the transfer buffer, that
+ * bounced chunks fit in the bounce buffer and that no chunk is larger than a
+ * DMA block, and then replaces every byte with what the sensor would send
+ * back. Guard bytes around the transfer buffer catch writes outside of it.
+ */
+
+
+#define CACHE_LINE_SIZE 32U
+
+/**
+ * @brief Largest DMA block, DMA_MAX_BT_SIZE of the SAME70 XDMAC
+ */
+#define DMA_MAX_SIZE 0xFFFFU
+
+#define BOUNCE_BUFFER_SIZE 256U
+
+#define DIRECT_MAX_SIZE (DMA_MAX_SIZE & ~(CACHE_LINE_SIZE - 1U))
+
+#define GUARD_SIZE CACHE_LINE_SIZE
+
+#define TRANSFER_SIZE_MAX 8192U
+
+#define GUARD_BYTE 0xEEU
+
+
+typedef struct
+{
+	const uint8_t *buffer;
+	size_t        buffer_size;
+	bool          direct;
+	uint32_t      transfer_count;
+	uint32_t      errors;
+} mock_spi_t;
+
+
+typedef struct
+{
+	uint32_t chunk_count;
+	size_t   direct_bytes;
+	size_t   bounced_bytes;
+} transfer_result_t;
+
+
+static uint8_t memory[GUARD_SIZE + CACHE_LINE_SIZE + TRANSFER_SIZE_MAX + GUARD_SIZE] __attribute__((aligned(CACHE_LINE_SIZE)));
+static uint8_t bounce_buffer[BOUNCE_BUFFER_SIZE] __attribute__((aligned(CACHE_LINE_SIZE)));
+
+
+static uint8_t tx_byte(size_t index)
+{
+	return (uint8_t)(index * 7U + (index >> 8));
+}
+
+
+static uint8_t rx_byte(uint8_t tx)
+{
+	return (uint8_t)(tx ^ 0xA5U);
+}
+
+
+/**
+ * @brief Mock of spid_transfer for one DMA buffer, full duplex and blocking
+ */
+static int mock_spid_transfer(mock_spi_t *spi, uint8_t *data, size_t size)
+{
+	uintptr_t start = (uintptr_t)data;
+	uintptr_t end   = start + size;
+
+	spi->transfer_count++;
+
+	if (size == 0 || size > DMA_MAX_SIZE)
+	{
+		printf("  DMA block of %u bytes\n", (unsigned int)size);
+		spi->errors++;
+		return -1;
+	}
+
+	if (spi->direct)
+	{
+		// The SPI driver cleans and invalidates the cache lines of the DMA buffer
+		if (start % CACHE_LINE_SIZE != 0 || end % CACHE_LINE_SIZE != 0 ||
+		    start < (uintptr_t)spi->buffer || end > (uintptr_t)spi->buffer + spi->buffer_size)
+		{
+			printf("  In place chunk at offset %d size %u is not whole cache lines of the buffer\n",
+			       (int)(start - (uintptr_t)spi->buffer), (unsigned int)size);
+			spi->errors++;
+			return -1;
+		}
+	}
+	else if (data != bounce_buffer || size > BOUNCE_BUFFER_SIZE)
+	{
+		printf("  Bounced chunk of %u bytes does not fit in the bounce buffer\n", (unsigned int)size);
+		spi->errors++;
+		return -1;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		data[i] = rx_byte(data[i]);
+	}
+
+	return 0;
+}
+
+
+/**
+ * @brief Transfer a buffer chunk by chunk like acc_driver_spi_same70_transfer
+ */
+static bool transfer(uint8_t *buffer, size_t buffer_size, const acc_driver_spi_chunk_limits_t *limits, transfer_result_t *result)
+{
+	mock_spi_t spi = {
+		.buffer      = buffer,
+		.buffer_size = buffer_size,
+	};
+	size_t     offset = 0;
+
+	memset(result, 0, sizeof(*result));
+
+	while (offset < buffer_size)
+	{
+		acc_driver_spi_chunk_t chunk = acc_driver_spi_chunk_next((uintptr_t)buffer, buffer_size, offset, limits);
+
+		if (chunk.offset != offset || chunk.size == 0 || chunk.size > buffer_size - offset)
+		{
+			printf("  Chunk at offset %u size %u does not continue the transfer at offset %u\n",
+			       (unsigned int)chunk.offset, (unsigned int)chunk.size, (unsigned int)offset);
+			return false;
+		}
+
+		spi.direct = chunk.direct;
+
+		if (chunk.direct)
+		{
+			if (mock_spid_transfer(&spi, buffer + offset, chunk.size) != 0)
+			{
+				return false;
+			}
+
+			result->direct_bytes += chunk.size;
+		}
+		else
+		{
+			memcpy(bounce_buffer, buffer + offset, chunk.size);
+
+			if (mock_spid_transfer(&spi, bounce_buffer, chunk.size) != 0)
+			{
+				return false;
+			}
+
+			memcpy(buffer + offset, bounce_buffer, chunk.size);
+			result->bounced_bytes += chunk.size;
+		}
+
+		result->chunk_count++;
+		offset += chunk.size;
+	}
+
+	return spi.errors == 0;
+}
+
+
+/**
+ * @brief Transfer buffer_size bytes at misalignment bytes past a cache line and check the data
+ */
+static bool run(size_t misalignment, size_t buffer_size, const acc_driver_spi_chunk_limits_t *limits, transfer_result_t *result)
+{
+	uint8_t *buffer = memory + GUARD_SIZE + misalignment;
+
+	memset(memory, GUARD_BYTE, sizeof(memory));
+
+	for (size_t i = 0; i < buffer_size; i++)
+	{
+		buffer[i] = tx_byte(i);
+	}
+
+	if (!transfer(buffer, buffer_size, limits, result))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < buffer_size; i++)
+	{
+		if (buffer[i] != rx_byte(tx_byte(i)))
+		{
+			printf("  Byte %u not transferred exactly once\n", (unsigned int)i);
+			return false;
+		}
+	}
+
+	for (uint8_t *p = memory; p < memory + sizeof(memory); p++)
+	{
+		if ((p < buffer || p >= buffer + buffer_size) && *p != GUARD_BYTE)
+		{
+			printf("  Byte at offset %d outside the buffer was written\n", (int)(p - buffer));
+			return false;
+		}
+	}
+
+	if (result->direct_bytes + result->bounced_bytes != buffer_size)
+	{
+		printf("  %u bytes transferred of %u\n", (unsigned int)(result->direct_bytes + result->bounced_bytes),
+		       (unsigned int)buffer_size);
+		return false;
+	}
+
+	return true;
+}
+
+
+typedef struct
+{
+	const char *name;
+	size_t     misalignment;
+	size_t     buffer_size;
+	size_t     direct_max_size;
+	uint32_t   chunk_count;
+	size_t     bounced_bytes;
+} test_case_t;
+
+
+static const test_case_t test_cases[] = {
+	{ "aligned",                  0,  512, DIRECT_MAX_SIZE,  1,    0 },
+	{ "unaligned tail",           0,  530, DIRECT_MAX_SIZE,  2,   18 },
+	{ "unaligned head",          14,  498, DIRECT_MAX_SIZE,  2,   18 },
+	{ "unaligned head and tail",  5,  600, DIRECT_MAX_SIZE,  3,   56 },
+	{ "sub cache line",           3,   20, DIRECT_MAX_SIZE,  1,   20 },
+	{ "crossing one boundary",   10,   40, DIRECT_MAX_SIZE,  1,   40 },
+	{ "head and one cache line", 31,   33, DIRECT_MAX_SIZE,  2,    1 },
+	{ "one cache line",           0,   32, DIRECT_MAX_SIZE,  1,    0 },
+	{ "oversize",                 0, 3000, 1024,             4,   24 },
+	{ "oversize unaligned",       7, 8000, 1024,            10,   32 },
+	{ "bounce only",              0, 1000, 0,                4, 1000 },
+	{ "bounce only oversize",     9, 8192, 0,               32, 8192 },
+	{ "direct max below line",    0,  512, 16,               2,  512 },
+};
+
+
+static bool test_cases_run(void)
+{
+	bool passed = true;
+
+	for (size_t i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++)
+	{
+		const test_case_t             *test_case = &test_cases[i];
+		acc_driver_spi_chunk_limits_t limits     = {
+			.bounce_buffer_size = BOUNCE_BUFFER_SIZE,
+			.alignment          = CACHE_LINE_SIZE,
+			.direct_max_size    = test_case->direct_max_size,
+		};
+		transfer_result_t             result;
+
+		bool case_passed = run(test_case->misalignment, test_case->buffer_size, &limits, &result) &&
+		                   result.chunk_count == test_case->chunk_count &&
+		                   result.bounced_bytes == test_case->bounced_bytes;
+
+		printf("%-26s %s: %u chunks, %u bytes bounced, expected %u chunks, %u bytes bounced\n", test_case->name,
+		       case_passed ? "passed" : "FAILED", (unsigned int)result.chunk_count, (unsigned int)result.bounced_bytes,
+		       (unsigned int)test_case->chunk_count, (unsigned int)test_case->bounced_bytes);
+
+		passed = case_passed && passed;
+	}
+
+	return passed;
+}
+
+
+/**
+ * @brief All misalignments and sizes up to a few bounce buffers, at most one head and one tail may be bounced
+ */
+static bool test_sweep(void)
+{
+	acc_driver_spi_chunk_limits_t limits = {
+		.bounce_buffer_size = BOUNCE_BUFFER_SIZE,
+		.alignment          = CACHE_LINE_SIZE,
+		.direct_max_size    = 512,
+	};
+
+	for (size_t misalignment = 0; misalignment < CACHE_LINE_SIZE; misalignment++)
+	{
+		for (size_t buffer_size = 1; buffer_size <= 4 * BOUNCE_BUFFER_SIZE; buffer_size++)
+		{
+			transfer_result_t result;
+
+			if (!run(misalignment, buffer_size, &limits, &result))
+			{
+				printf("sweep FAILED at misalignment %u size %u\n", (unsigned int)misalignment, (unsigned int)buffer_size);
+				return false;
+			}
+
+			size_t head          = (CACHE_LINE_SIZE - misalignment) % CACHE_LINE_SIZE;
+			size_t tail          = (misalignment + buffer_size) % CACHE_LINE_SIZE;
+			bool   no_whole_line = head + tail >= buffer_size || buffer_size - head - tail < CACHE_LINE_SIZE;
+			size_t expected      = no_whole_line ? buffer_size : head + tail;
+
+			if (result.bounced_bytes != expected)
+			{
+				printf("sweep FAILED at misalignment %u size %u: %u bytes bounced, expected %u\n", (unsigned int)misalignment,
+				       (unsigned int)buffer_size, (unsigned int)result.bounced_bytes, (unsigned int)expected);
+				return false;
+			}
+		}
+	}
+
+	printf("%-26s passed\n", "sweep");
+
+	return true;
+}
+
+
+int main(void)
+{
+	bool passed = true;
+
+	passed = test_cases_run() && passed;
+	passed = test_sweep() && passed;
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acc_driver_hal.h"
+#include "acc_stream_decoder.h"
+#include "acc_stream_writer.h"
+
+
+/**
+ * @brief Host benchmark of the stream protocol against text output
+ *
+ * Usage: acc_stream_benchmark [baudrate] [data_length] [frame_count]
+ *
+ * Envelope frames are written with the stream writer to memory and decoded in
+ * small pieces like data read from a serial port. The same frames are also
+ * formatted as text the way the service examples print them. The result is the
+ * number of bytes per frame and the highest frame rate the link can carry with
+ * each format, and the time spent encoding and decoding.
+ */
+
+
+#define DEFAULT_BAUDRATE    115200U
+#define DEFAULT_DATA_LENGTH 1000U
+#define DEFAULT_FRAME_COUNT 2000U
+
+/**
+ * @brief Size of the pieces the encoded stream is decoded in
+ */
+#define READ_SIZE 64U
+
+/**
+ * @brief Bits on the link per byte, 8N1
+ */
+#define BITS_PER_BYTE 10U
+
+
+typedef struct
+{
+	uint8_t *data;
+	size_t  size;
+	size_t  capacity;
+} memory_output_t;
+
+
+typedef struct
+{
+	const uint16_t *expected;
+	uint16_t       data_length;
+	uint32_t       frame_count;
+	uint32_t       mismatch_count;
+} decode_check_t;
+
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+static bool memory_output(const void *data, size_t size, void *client_reference)
+{
+	memory_output_t *output = client_reference;
+
+	if (output->size + size > output->capacity)
+	{
+		return false;
+	}
+
+	memcpy(&output->data[output->size], data, size);
+	output->size += size;
+
+	return true;
+}
+
+
+static void decode_callback(const acc_stream_message_t *message, void *client_reference)
+{
+	decode_check_t            *check = client_reference;
+	acc_stream_frame_header_t frame_header;
+	const void                *data;
+
+	if (message->type != ACC_STREAM_MESSAGE_FRAME)
+	{
+		return;
+	}
+
+	if (!acc_stream_decoder_frame_get(message, sizeof(uint16_t), &frame_header, &data) ||
+	    frame_header.data_length != check->data_length ||
+	    memcmp(data, check->expected, check->data_length * sizeof(uint16_t)) != 0)
+	{
+		check->mismatch_count++;
+	}
+
+	check->frame_count++;
+}
+
+
+static size_t format_text(char *buffer, size_t buffer_size, const uint16_t *data, uint16_t data_length)
+{
+	size_t length = (size_t)snprintf(buffer, buffer_size, "Envelope data:\n");
+
+	for (uint16_t i = 0; i < data_length; i++)
+	{
+		if ((i > 0) && ((i % 8) == 0))
+		{
+			length += (size_t)snprintf(&buffer[length], buffer_size - length, "\n");
+		}
+
+		length += (size_t)snprintf(&buffer[length], buffer_size - length, "%6u", (unsigned int)data[i]);
+	}
+
+	length += (size_t)snprintf(&buffer[length], buffer_size - length, "\n");
+
+	return length;
+}
+
+
+int main(int argc, char *argv[])
+{
+	uint32_t baudrate    = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_BAUDRATE;
+	uint16_t data_length = argc > 2 ? (uint16_t)strtoul(argv[2], NULL, 0) : DEFAULT_DATA_LENGTH;
+	uint32_t frame_count = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : DEFAULT_FRAME_COUNT;
+
+	if (baudrate == 0 || data_length == 0 || frame_count == 0 || !acc_driver_hal_init())
+	{
+		return EXIT_FAILURE;
+	}
+
+	size_t          message_size = ACC_STREAM_ENCODED_SIZE(sizeof(acc_stream_frame_header_t) + data_length * sizeof(uint16_t));
+	size_t          text_size    = 32 + (size_t)data_length * 8;
+	uint16_t        *data        = malloc(data_length * sizeof(uint16_t));
+	uint8_t         *buffer      = malloc(message_size);
+	uint8_t         *read_buffer = malloc(message_size);
+	char            *text        = malloc(text_size);
+	memory_output_t output       = { .data = malloc(message_size * frame_count), .size = 0, .capacity = message_size * frame_count };
+
+	if (data == NULL || buffer == NULL || read_buffer == NULL || text == NULL || output.data == NULL)
+	{
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	// An envelope like shape with noise, values up to a few thousand
+	uint32_t seed = 1;
+
+	for (uint16_t i = 0; i < data_length; i++)
+	{
+		seed    = seed * 1103515245U + 12345U;
+		data[i] = (uint16_t)(200U + (i % 100U) * (i % 100U) / 5U + ((seed >> 16) & 0xFFU));
+	}
+
+	acc_stream_writer_t      writer;
+	acc_recording_metadata_t metadata;
+
+	memset(&metadata, 0, sizeof(metadata));
+	metadata.data_length = data_length;
+
+	acc_stream_writer_init(&writer, memory_output, &output, buffer, message_size);
+	acc_stream_writer_send_metadata(&writer, ACC_RECORDING_SERVICE_TYPE_ENVELOPE, &metadata, NULL);
+
+	size_t metadata_size = output.size;
+	double start         = now_s();
+
+	for (uint32_t i = 0; i < frame_count; i++)
+	{
+		if (!acc_stream_writer_send_frame(&writer, data, data_length, 0, 0))
+		{
+			printf("Encoding failed\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	double encode_s = now_s() - start;
+
+	acc_stream_decoder_t decoder;
+	decode_check_t       check = { .expected = data, .data_length = data_length, .frame_count = 0, .mismatch_count = 0 };
+
+	acc_stream_decoder_init(&decoder, decode_callback, &check, read_buffer, message_size);
+
+	start = now_s();
+
+	for (size_t offset = 0; offset < output.size; offset += READ_SIZE)
+	{
+		size_t size = output.size - offset < READ_SIZE ? output.size - offset : READ_SIZE;
+
+		acc_stream_decoder_feed(&decoder, &output.data[offset], size);
+	}
+
+	double decode_s = now_s() - start;
+	size_t text_length = 0;
+
+	start = now_s();
+
+	for (uint32_t i = 0; i < frame_count; i++)
+	{
+		text_length = format_text(text, text_size, data, data_length);
+	}
+
+	double format_s = now_s() - start;
+
+	double binary_frame_size = (double)(output.size - metadata_size) / frame_count;
+	double link_bytes_per_s  = (double)baudrate / BITS_PER_BYTE;
+
+	printf("Frames: %u of %u samples, link %u baud\n", (unsigned int)frame_count, (unsigned int)data_length, (unsigned int)baudrate);
+	printf("Text:   %u bytes/frame, max %.1f frames/s, formatting %.1f us/frame\n",
+	       (unsigned int)text_length, link_bytes_per_s / (double)text_length, format_s * 1e6 / frame_count);
+	printf("Binary: %.1f bytes/frame, max %.1f frames/s, encoding %.1f us/frame, decoding %.1f MB/s\n",
+	       binary_frame_size, link_bytes_per_s / binary_frame_size, encode_s * 1e6 / frame_count,
+	       (double)output.size / decode_s / 1e6);
+	printf("Decoded %u frames, %u mismatches, %u lost, %u CRC errors, %u framing errors\n",
+	       (unsigned int)check.frame_count, (unsigned int)check.mismatch_count,
+	       (unsigned int)decoder.statistics.lost_message_count, (unsigned int)decoder.statistics.crc_error_count,
+	       (unsigned int)decoder.statistics.framing_error_count);
+
+	bool success = check.frame_count == frame_count && check.mismatch_count == 0;
+
+	free(output.data);
+	free(text);
+	free(read_buffer);
+	free(buffer);
+	free(data);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,361 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acc_stream_decoder.h"
+#include "acc_stream_writer.h"
+
+
+/**
+ * @brief Host test of the stream decoder on a damaged stream
+ *
+ * Usage: acc_stream_decoder_test
+ *
+ * A few messages are written with the stream writer to memory. Each test case
+ * builds a stream from them the way a serial link could deliver it: with a
+ * byte flipped, bytes or delimiters dropped, text or noise in between or
+ * starting in the middle of a message. The stream is decoded whole, byte by
+ * byte and in pieces of a few bytes, and the messages delivered to the
+ * callback and the decoder statistics are compared with what the damage
+ * should cause. Damaged messages must be rejected without losing the
+ * messages after them.
+ */
+
+
+#define MESSAGE_COUNT 4U
+
+/**
+ * @brief Payload size, long enough that the payload is one COBS block without delimiters
+ */
+#define PAYLOAD_SIZE 200U
+
+#define MESSAGE_SIZE_MAX ACC_STREAM_ENCODED_SIZE(PAYLOAD_SIZE)
+
+#define STREAM_SIZE_MAX (MESSAGE_SIZE_MAX * (MESSAGE_COUNT + 2U))
+
+#define TEXT "Envelope data: 1234 1235 1236\n"
+
+/**
+ * @brief Pieces the stream is decoded in, 0 for the whole stream at once
+ */
+static const size_t feed_sizes[] = { 0, 1, 7 };
+
+
+typedef struct
+{
+	uint8_t data[MESSAGE_SIZE_MAX];
+	size_t  size;
+} encoded_message_t;
+
+
+typedef struct
+{
+	uint8_t data[STREAM_SIZE_MAX];
+	size_t  size;
+} stream_t;
+
+
+typedef struct
+{
+	uint16_t sequence_numbers[MESSAGE_COUNT];
+	uint32_t count;
+	bool     payload_error;
+} received_t;
+
+
+typedef struct
+{
+	const char *name;
+	void       (*build)(stream_t *stream);
+	/** Sequence numbers expected in the callback, terminated by UINT16_MAX */
+	uint16_t   expected[MESSAGE_COUNT + 1U];
+	uint32_t   lost_message_count;
+	/** CRC errors, or UINT32_MAX if a CRC error and a framing error are equally valid */
+	uint32_t   crc_error_count;
+	uint32_t   framing_error_count;
+} test_case_t;
+
+
+static encoded_message_t messages[MESSAGE_COUNT];
+
+
+static uint8_t payload_byte(uint16_t sequence_number, size_t index)
+{
+	// Neither the byte nor its complement is a delimiter
+	return (uint8_t)((sequence_number * 7U + index) % 254U + 1U);
+}
+
+
+static bool encode_output(const void *data, size_t size, void *client_reference)
+{
+	encoded_message_t *message = client_reference;
+
+	if (size > sizeof(message->data))
+	{
+		return false;
+	}
+
+	memcpy(message->data, data, size);
+	message->size = size;
+
+	return true;
+}
+
+
+static bool messages_encode(void)
+{
+	uint8_t             buffer[MESSAGE_SIZE_MAX];
+	uint8_t             payload[PAYLOAD_SIZE];
+	acc_stream_writer_t writer;
+
+	for (uint16_t i = 0; i < MESSAGE_COUNT; i++)
+	{
+		for (size_t j = 0; j < PAYLOAD_SIZE; j++)
+		{
+			payload[j] = payload_byte(i, j);
+		}
+
+		acc_stream_writer_init(&writer, encode_output, &messages[i], buffer, sizeof(buffer));
+		writer.sequence_number = i;
+
+		if (!acc_stream_writer_send(&writer, ACC_STREAM_MESSAGE_DETECTOR_RESULT, payload, sizeof(payload)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void stream_append(stream_t *stream, const void *data, size_t size)
+{
+	memcpy(&stream->data[stream->size], data, size);
+	stream->size += size;
+}
+
+
+static void stream_append_message(stream_t *stream, uint16_t index)
+{
+	stream_append(stream, messages[index].data, messages[index].size);
+}
+
+
+static void build_intact(stream_t *stream)
+{
+	for (uint16_t i = 0; i < MESSAGE_COUNT; i++)
+	{
+		stream_append_message(stream, i);
+	}
+}
+
+
+static void build_flipped_byte(stream_t *stream)
+{
+	build_intact(stream);
+
+	// A byte in the middle of the payload of the second message, not a COBS code byte
+	size_t offset = messages[0].size + messages[1].size / 2U;
+
+	stream->data[offset] ^= 0xFFU;
+}
+
+
+static void build_dropped_bytes(stream_t *stream)
+{
+	stream_append_message(stream, 0);
+	stream_append(stream, messages[1].data, messages[1].size / 2U);
+	stream_append(stream, &messages[1].data[messages[1].size / 2U + 10U], messages[1].size - messages[1].size / 2U - 10U);
+	stream_append_message(stream, 2);
+	stream_append_message(stream, 3);
+}
+
+
+static void build_dropped_message(stream_t *stream)
+{
+	stream_append_message(stream, 0);
+	stream_append_message(stream, 2);
+	stream_append_message(stream, 3);
+}
+
+
+static void build_dropped_delimiters(stream_t *stream)
+{
+	// The delimiters between the second and the third message are lost, merging them
+	stream_append_message(stream, 0);
+	stream_append(stream, messages[1].data, messages[1].size - 1U);
+	stream_append(stream, &messages[2].data[1], messages[2].size - 1U);
+	stream_append_message(stream, 3);
+}
+
+
+static void build_text(stream_t *stream)
+{
+	stream_append_message(stream, 0);
+	stream_append(stream, TEXT, strlen(TEXT));
+	stream_append_message(stream, 1);
+	stream_append_message(stream, 2);
+	stream_append_message(stream, 3);
+}
+
+
+static void build_oversized(stream_t *stream)
+{
+	uint8_t noise[MESSAGE_SIZE_MAX + 1U];
+
+	memset(noise, 0xAA, sizeof(noise));
+
+	stream_append_message(stream, 0);
+	stream_append(stream, noise, sizeof(noise));
+	stream_append_message(stream, 1);
+	stream_append_message(stream, 2);
+	stream_append_message(stream, 3);
+}
+
+
+static void build_mid_message_start(stream_t *stream)
+{
+	stream_append(stream, &messages[0].data[messages[0].size / 2U], messages[0].size - messages[0].size / 2U);
+	stream_append_message(stream, 1);
+	stream_append_message(stream, 2);
+	stream_append_message(stream, 3);
+}
+
+
+static const test_case_t test_cases[] =
+{
+	{ "intact", build_intact, { 0, 1, 2, 3, UINT16_MAX }, 0, 0, 0 },
+	{ "flipped byte", build_flipped_byte, { 0, 2, 3, UINT16_MAX }, 1, 1, 0 },
+	{ "dropped bytes", build_dropped_bytes, { 0, 2, 3, UINT16_MAX }, 1, UINT32_MAX, 0 },
+	{ "dropped message", build_dropped_message, { 0, 2, 3, UINT16_MAX }, 1, 0, 0 },
+	{ "dropped delimiters", build_dropped_delimiters, { 0, 3, UINT16_MAX }, 2, UINT32_MAX, 0 },
+	{ "text between messages", build_text, { 0, 1, 2, 3, UINT16_MAX }, 0, 0, 1 },
+	{ "oversized noise", build_oversized, { 0, 1, 2, 3, UINT16_MAX }, 0, 0, 1 },
+	{ "mid message start", build_mid_message_start, { 1, 2, 3, UINT16_MAX }, 0, UINT32_MAX, 0 },
+};
+
+
+static void decode_callback(const acc_stream_message_t *message, void *client_reference)
+{
+	received_t *received = client_reference;
+
+	if (received->count >= MESSAGE_COUNT || message->payload_size != PAYLOAD_SIZE)
+	{
+		received->payload_error = true;
+		return;
+	}
+
+	for (size_t j = 0; j < PAYLOAD_SIZE; j++)
+	{
+		if (message->payload[j] != payload_byte(message->sequence_number, j))
+		{
+			received->payload_error = true;
+		}
+	}
+
+	received->sequence_numbers[received->count++] = message->sequence_number;
+}
+
+
+static bool test_case_check(const test_case_t *test_case, const received_t *received,
+                            const acc_stream_decoder_statistics_t *statistics)
+{
+	uint32_t expected_count = 0;
+
+	while (test_case->expected[expected_count] != UINT16_MAX)
+	{
+		expected_count++;
+	}
+
+	bool passed = !received->payload_error && received->count == expected_count &&
+	              memcmp(received->sequence_numbers, test_case->expected, expected_count * sizeof(uint16_t)) == 0 &&
+	              statistics->message_count == expected_count &&
+	              statistics->lost_message_count == test_case->lost_message_count;
+
+	if (test_case->crc_error_count == UINT32_MAX)
+	{
+		passed = passed && statistics->crc_error_count + statistics->framing_error_count == 1U;
+	}
+	else
+	{
+		passed = passed && statistics->crc_error_count == test_case->crc_error_count &&
+		         statistics->framing_error_count == test_case->framing_error_count;
+	}
+
+	return passed;
+}
+
+
+static bool test_case_run(const test_case_t *test_case)
+{
+	static stream_t stream;
+	bool            passed = true;
+
+	stream.size = 0;
+	test_case->build(&stream);
+
+	for (size_t i = 0; i < sizeof(feed_sizes) / sizeof(feed_sizes[0]); i++)
+	{
+		uint8_t              buffer[MESSAGE_SIZE_MAX];
+		acc_stream_decoder_t decoder;
+		received_t           received;
+		size_t               feed_size = feed_sizes[i] != 0 ? feed_sizes[i] : stream.size;
+
+		memset(&received, 0, sizeof(received));
+		acc_stream_decoder_init(&decoder, decode_callback, &received, buffer, sizeof(buffer));
+
+		for (size_t offset = 0; offset < stream.size; offset += feed_size)
+		{
+			size_t size = stream.size - offset < feed_size ? stream.size - offset : feed_size;
+
+			acc_stream_decoder_feed(&decoder, &stream.data[offset], size);
+		}
+
+		if (!test_case_check(test_case, &received, &decoder.statistics))
+		{
+			printf("%-22s FAILED in pieces of %u bytes: %u messages, %u lost, %u CRC errors, %u framing errors%s\n",
+			       test_case->name, (unsigned int)feed_size, (unsigned int)decoder.statistics.message_count,
+			       (unsigned int)decoder.statistics.lost_message_count, (unsigned int)decoder.statistics.crc_error_count,
+			       (unsigned int)decoder.statistics.framing_error_count, received.payload_error ? ", payload error" : "");
+			passed = false;
+		}
+	}
+
+	if (passed)
+	{
+		printf("%-22s passed\n", test_case->name);
+	}
+
+	return passed;
+}
+
+
+int main(void)
+{
+	bool passed = messages_encode();
+
+	if (!passed)
+	{
+		printf("Encoding failed\n");
+	}
+	else
+	{
+		for (size_t i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++)
+		{
+			passed = test_case_run(&test_cases[i]) && passed;
+		}
+	}
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,690 @@
+// Copyright (c) Acconeer AB, 2020
+// All rights reserved
+// This file is subject to the terms and conditions defined in the file
+// 'LICENSES/license_acconeer.txt', (BSD 3-Clause License) which is part
+// of this source code package.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acc_transport.h"
+
+
+/**
+ * @brief Host test of the transport packetisation and flow control
+ *
+ * Usage: acc_transport_test
+ *
+ * Two transports are connected back to back by a loopback backend. Writes
+ * complete later, when the test moves the packet to the wire, and the wire
+ * is delivered to the peer in chunks of random size. The backend checks that
+ * every payload points into the frame being sent and that no frame is
+ * reported as sent while any part of it is still being written. The frames
+ * are overwritten when reported as sent so that a late read would show up
+ * as corrupted data.
+ */
+
+
+#define MAX_PAYLOAD_SIZE 256U
+
+#define FRAME_COUNT_MAX 300U
+
+#define FRAME_SIZE_MAX (MAX_PAYLOAD_SIZE * 6U)
+
+#define WIRE_SIZE (1024U * 1024U)
+
+/**
+ * @brief Steps without progress before the link is considered idle, like a receive timeout
+ */
+#define IDLE_STEPS 10U
+
+/**
+ * @brief Announcements in a row without any frame sent before a test is considered deadlocked
+ */
+#define ANNOUNCEMENTS_MAX 100U
+
+
+typedef struct side side_t;
+
+typedef struct
+{
+	uint8_t data[FRAME_SIZE_MAX];
+	size_t  size;
+	bool    queued;
+} frame_t;
+
+struct side
+{
+	const char      *name;
+	acc_transport_t transport;
+	uint8_t         receive_buffer[MAX_PAYLOAD_SIZE];
+	side_t          *peer;
+
+	// Sending
+	frame_t        frames[ACC_TRANSPORT_SEND_QUEUE_LENGTH];
+	uint32_t       frames_to_send;
+	uint32_t       frames_queued;
+	uint32_t       frames_sent;
+	const uint8_t  *write_header;
+	const uint8_t  *write_payload;
+	size_t         write_payload_size;
+	bool           write_pending;
+	uint32_t       writes;
+	uint32_t       zero_copy_errors;
+	uint32_t       credit_stalls;
+	uint32_t       announcements;
+
+	// Wire towards the peer
+	uint8_t        *wire;
+	size_t         wire_length;
+	size_t         wire_position;
+
+	// Receiving
+	uint8_t        frame[FRAME_SIZE_MAX];
+	size_t         frame_length;
+	bool           in_frame;
+	uint32_t       frames_received;
+	uint32_t       frames_broken;
+	uint32_t       frame_errors;
+	uint32_t       packets_held;
+	uint32_t       packets_held_max;
+	uint16_t       receive_credits;
+	bool           auto_release;
+	uint32_t       release_delay;
+	uint32_t       release_countdown;
+};
+
+
+typedef struct
+{
+	uint32_t noise_every;
+	uint32_t corrupt_every;
+	uint32_t corrupt_until;
+} wire_faults_t;
+
+
+static uint32_t random_state = 1;
+
+/**
+ * @brief Frames that carry their index must be at least 4 bytes
+ */
+static size_t frame_size_min = 0;
+
+
+static uint32_t random_next(void)
+{
+	random_state = random_state * 1103515245U + 12345U;
+
+	return random_state >> 8;
+}
+
+
+static size_t frame_size_get(uint32_t index)
+{
+	static const size_t sizes[] = {
+		0, 1, MAX_PAYLOAD_SIZE - 1U, MAX_PAYLOAD_SIZE, MAX_PAYLOAD_SIZE + 1U, FRAME_SIZE_MAX, 4, 1000, 3 * MAX_PAYLOAD_SIZE
+	};
+
+	size_t size = sizes[index % (sizeof(sizes) / sizeof(sizes[0]))];
+
+	return size > frame_size_min ? size : frame_size_min;
+}
+
+
+/**
+ * @brief Frames carry their index in the first bytes, the rest is a pattern given by the index
+ */
+static uint8_t frame_byte(uint32_t index, size_t position)
+{
+	if (position < 4)
+	{
+		return (uint8_t)(index >> (8 * position));
+	}
+
+	return (uint8_t)(index * 31U + position * 7U + (position >> 8));
+}
+
+
+static void frame_fill(frame_t *frame, uint32_t index)
+{
+	frame->size = frame_size_get(index);
+
+	for (size_t i = 0; i < frame->size; i++)
+	{
+		frame->data[i] = frame_byte(index, i);
+	}
+}
+
+
+static bool frame_check(const uint8_t *data, size_t size, uint32_t expected_index, bool index_in_data)
+{
+	uint32_t index = expected_index;
+
+	if (index_in_data)
+	{
+		if (size < 4)
+		{
+			return false;
+		}
+
+		index = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+
+		if (index >= FRAME_COUNT_MAX)
+		{
+			return false;
+		}
+	}
+
+	if (size != frame_size_get(index))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (data[i] != frame_byte(index, i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static bool write_start(const uint8_t *header, size_t header_size, const uint8_t *payload, size_t payload_size,
+                        void *client_reference)
+{
+	side_t *side = client_reference;
+
+	if (side->write_pending || header_size != ACC_TRANSPORT_HEADER_SIZE)
+	{
+		side->zero_copy_errors++;
+		return false;
+	}
+
+	if (payload_size > 0)
+	{
+		bool in_frame = false;
+
+		for (size_t i = 0; i < ACC_TRANSPORT_SEND_QUEUE_LENGTH; i++)
+		{
+			const frame_t *frame = &side->frames[i];
+
+			if (frame->queued && payload >= frame->data && payload + payload_size <= frame->data + frame->size)
+			{
+				in_frame = true;
+			}
+		}
+
+		if (!in_frame)
+		{
+			side->zero_copy_errors++;
+		}
+	}
+
+	side->write_header       = header;
+	side->write_payload      = payload;
+	side->write_payload_size = payload_size;
+	side->write_pending      = true;
+	side->writes++;
+
+	return true;
+}
+
+
+static void frame_sent(const void *data, void *client_reference)
+{
+	side_t  *side  = client_reference;
+	frame_t *frame = NULL;
+
+	for (size_t i = 0; i < ACC_TRANSPORT_SEND_QUEUE_LENGTH; i++)
+	{
+		if (side->frames[i].queued && side->frames[i].data == data)
+		{
+			frame = &side->frames[i];
+		}
+	}
+
+	if (frame == NULL || side->write_pending)
+	{
+		side->zero_copy_errors++;
+		return;
+	}
+
+	// Any later read of the frame gives wrong data
+	memset(frame->data, 0xee, sizeof(frame->data));
+	frame->queued = false;
+	side->frames_sent++;
+}
+
+
+static void packet_received(const uint8_t *payload, size_t payload_size, uint8_t flags, void *client_reference)
+{
+	side_t *side          = client_reference;
+	bool   index_in_data  = side->peer->transport.config.use_crc;
+
+	if (!side->auto_release)
+	{
+		side->packets_held++;
+
+		if (side->packets_held > side->packets_held_max)
+		{
+			side->packets_held_max = side->packets_held;
+		}
+	}
+
+	if ((flags & ACC_TRANSPORT_FLAG_LOST) != 0 && side->in_frame)
+	{
+		side->in_frame = false;
+		side->frames_broken++;
+	}
+
+	if ((flags & ACC_TRANSPORT_FLAG_FIRST) != 0)
+	{
+		if (side->in_frame)
+		{
+			side->frame_errors++;
+		}
+
+		side->in_frame     = true;
+		side->frame_length = 0;
+	}
+
+	if (!side->in_frame)
+	{
+		return;
+	}
+
+	if (side->frame_length + payload_size > sizeof(side->frame))
+	{
+		side->frame_errors++;
+		side->in_frame = false;
+		return;
+	}
+
+	memcpy(&side->frame[side->frame_length], payload, payload_size);
+	side->frame_length += payload_size;
+
+	if ((flags & ACC_TRANSPORT_FLAG_LAST) != 0)
+	{
+		if (!frame_check(side->frame, side->frame_length, side->frames_received, index_in_data))
+		{
+			side->frame_errors++;
+		}
+
+		side->in_frame = false;
+		side->frames_received++;
+	}
+}
+
+
+static bool side_init(side_t *side, const char *name, side_t *peer, uint16_t receive_credits, bool auto_release,
+                      bool use_crc)
+{
+	memset(side, 0, sizeof(*side));
+
+	side->name            = name;
+	side->peer            = peer;
+	side->receive_credits = receive_credits;
+	side->auto_release    = auto_release;
+	side->wire            = malloc(WIRE_SIZE);
+
+	acc_transport_config_t config = {
+		.write            = write_start,
+		.packet_received  = packet_received,
+		.frame_sent       = frame_sent,
+		.client_reference = side,
+		.receive_buffer   = side->receive_buffer,
+		.max_payload_size = MAX_PAYLOAD_SIZE,
+		.receive_credits  = receive_credits,
+		.auto_release     = auto_release,
+		.use_crc          = use_crc,
+	};
+
+	return side->wire != NULL && acc_transport_init(&side->transport, &config);
+}
+
+
+/**
+ * @brief Queue as many frames as the transport takes
+ */
+static void side_queue_frames(side_t *side)
+{
+	for (size_t i = 0; i < ACC_TRANSPORT_SEND_QUEUE_LENGTH && side->frames_queued < side->frames_to_send; i++)
+	{
+		frame_t *frame = &side->frames[i];
+
+		if (frame->queued)
+		{
+			continue;
+		}
+
+		frame_fill(frame, side->frames_queued);
+		frame->queued = true;
+
+		if (!acc_transport_send(&side->transport, frame->data, frame->size))
+		{
+			frame->queued = false;
+			return;
+		}
+
+		side->frames_queued++;
+	}
+}
+
+
+/**
+ * @brief Finish the pending write by moving the packet to the wire, possibly with faults
+ */
+static bool side_write_complete(side_t *side, const wire_faults_t *faults)
+{
+	if (!side->write_pending)
+	{
+		return false;
+	}
+
+	size_t packet_size = ACC_TRANSPORT_HEADER_SIZE + side->write_payload_size;
+
+	if (side->wire_length + packet_size + 16U > WIRE_SIZE)
+	{
+		return false;
+	}
+
+	uint8_t *packet = &side->wire[side->wire_length];
+
+	if (faults != NULL && faults->noise_every > 0 && random_next() % faults->noise_every == 0)
+	{
+		// Noise may contain the sync bytes
+		static const uint8_t noise[] = {0xac, 0x00, 0xac, 0xc0, 0x05, 0x00, 0xff, 0xff, 0xac};
+		size_t               length  = 1U + random_next() % sizeof(noise);
+
+		memcpy(packet, noise, length);
+		side->wire_length += length;
+		packet            += length;
+	}
+
+	memcpy(packet, side->write_header, ACC_TRANSPORT_HEADER_SIZE);
+	if (side->write_payload_size > 0)
+	{
+		memcpy(packet + ACC_TRANSPORT_HEADER_SIZE, side->write_payload, side->write_payload_size);
+	}
+
+	if (faults != NULL && faults->corrupt_every > 0 && side->writes < faults->corrupt_until &&
+	    random_next() % faults->corrupt_every == 0)
+	{
+		packet[random_next() % packet_size] ^= (uint8_t)(1U << (random_next() % 8U));
+	}
+
+	side->wire_length  += packet_size;
+	side->write_pending = false;
+
+	acc_transport_write_done(&side->transport);
+	acc_transport_process(&side->transport);
+
+	return true;
+}
+
+
+static bool side_deliver(side_t *side)
+{
+	size_t available = side->wire_length - side->wire_position;
+
+	if (available == 0)
+	{
+		return false;
+	}
+
+	size_t chunk = 1U + random_next() % 700U;
+
+	if (chunk > available)
+	{
+		chunk = available;
+	}
+
+	acc_transport_receive(&side->peer->transport, &side->wire[side->wire_position], chunk);
+	side->wire_position += chunk;
+
+	if (side->wire_position == side->wire_length)
+	{
+		side->wire_position = 0;
+		side->wire_length   = 0;
+	}
+
+	return true;
+}
+
+
+static bool side_release(side_t *side)
+{
+	if (side->auto_release || side->packets_held == 0)
+	{
+		return false;
+	}
+
+	if (side->release_countdown > 0)
+	{
+		side->release_countdown--;
+		return true;
+	}
+
+	side->release_countdown = side->release_delay;
+	side->packets_held--;
+	acc_transport_release(&side->transport, 1);
+
+	return true;
+}
+
+
+static bool side_step(side_t *side, const wire_faults_t *faults)
+{
+	bool progress = false;
+
+	side_queue_frames(side);
+
+	if (side->transport.send_queue_count > 0 && acc_transport_get_send_credits(&side->transport) == 0)
+	{
+		side->credit_stalls++;
+	}
+
+	progress = side_write_complete(side, faults) || progress;
+	progress = side_deliver(side) || progress;
+	progress = side_release(side) || progress;
+
+	return progress;
+}
+
+
+static bool side_waiting(const side_t *side)
+{
+	return side->frames_sent < side->frames_to_send;
+}
+
+
+/**
+ * @brief Run until all frames have been sent, a side that waits when the link is idle announces itself
+ */
+static void link_run(side_t *a, side_t *b, const wire_faults_t *faults)
+{
+	uint32_t idle_steps    = 0;
+	uint32_t announcements = 0;
+
+	while (announcements < ANNOUNCEMENTS_MAX)
+	{
+		uint32_t frames_sent = a->frames_sent + b->frames_sent;
+		bool     progress    = side_step(a, faults);
+
+		progress   = side_step(b, faults) || progress;
+		idle_steps = progress ? 0 : idle_steps + 1U;
+
+		if (a->frames_sent + b->frames_sent != frames_sent)
+		{
+			announcements = 0;
+		}
+
+		if (idle_steps < IDLE_STEPS)
+		{
+			continue;
+		}
+
+		if (!side_waiting(a) && !side_waiting(b))
+		{
+			break;
+		}
+
+		side_t *sides[] = {a, b};
+
+		for (size_t i = 0; i < 2; i++)
+		{
+			if (side_waiting(sides[i]))
+			{
+				sides[i]->announcements++;
+				acc_transport_announce(&sides[i]->transport);
+			}
+		}
+
+		announcements++;
+		idle_steps = 0;
+	}
+}
+
+
+static bool side_report(const char *test, side_t *side, uint32_t frames_expected, bool lossy)
+{
+	const acc_transport_stats_t *stats = acc_transport_get_stats(&side->peer->transport);
+	bool                        passed = side->frames_sent == side->frames_to_send && side->zero_copy_errors == 0 &&
+	                                     side->peer->frame_errors == 0 && side->peer->packets_held_max <=
+	                                     side->peer->receive_credits;
+
+	if (lossy)
+	{
+		passed = passed && side->peer->frames_received > 0 && stats->crc_errors > 0;
+	}
+	else
+	{
+		passed = passed && side->peer->frames_received == frames_expected && side->announcements == 0 &&
+		         stats->lost_packets == 0 && stats->crc_errors == 0 && stats->skipped_bytes == 0;
+	}
+
+	printf("%-6s %-9s %s->%s: %3u/%3u frames, %3u broken, %4u packets, %3u credit stalls, %2u announcements, "
+	       "%2u crc errors, %2u lost, %3u skipped\n", passed ? "PASS" : "FAIL", test, side->name, side->peer->name,
+	       (unsigned int)side->peer->frames_received, (unsigned int)frames_expected,
+	       (unsigned int)side->peer->frames_broken, (unsigned int)stats->packets_received,
+	       (unsigned int)side->credit_stalls, (unsigned int)side->announcements, (unsigned int)stats->crc_errors,
+	       (unsigned int)stats->lost_packets, (unsigned int)stats->skipped_bytes);
+
+	return passed;
+}
+
+
+static void link_close(side_t *a, side_t *b)
+{
+	free(a->wire);
+	free(b->wire);
+}
+
+
+/**
+ * @brief Frames in both directions at the same time, packets released as they arrive
+ */
+static bool test_ordering(void)
+{
+	side_t a;
+	side_t b;
+
+	if (!side_init(&a, "A", &b, 4, true, false) || !side_init(&b, "B", &a, 4, true, false))
+	{
+		return false;
+	}
+
+	a.frames_to_send = 60;
+	b.frames_to_send = 45;
+	link_run(&a, &b, NULL);
+
+	bool passed = side_report("ordering", &a, a.frames_to_send, false);
+
+	passed = side_report("ordering", &b, b.frames_to_send, false) && passed;
+
+	link_close(&a, &b);
+
+	return passed;
+}
+
+
+/**
+ * @brief A slow receiver that releases packets late, the sender must never exceed the credits
+ */
+static bool test_credits(void)
+{
+	side_t a;
+	side_t b;
+
+	if (!side_init(&a, "A", &b, 4, true, false) || !side_init(&b, "B", &a, 3, false, false))
+	{
+		return false;
+	}
+
+	a.frames_to_send = 40;
+	b.release_delay  = 5;
+	link_run(&a, &b, NULL);
+
+	bool passed = side_report("credits", &a, a.frames_to_send, false) && a.credit_stalls > 0 &&
+	              b.packets_held_max == b.receive_credits;
+
+	link_close(&a, &b);
+
+	return passed;
+}
+
+
+/**
+ * @brief Noise and bit errors on the wire, broken packets must be dropped and the link must not lock up
+ */
+static bool test_crc(void)
+{
+	side_t        a;
+	side_t        b;
+	wire_faults_t faults = {
+		.noise_every   = 7,
+		.corrupt_every = 9,
+		.corrupt_until = 600,
+	};
+
+	frame_size_min = 4;
+
+	if (!side_init(&a, "A", &b, 8, true, true) || !side_init(&b, "B", &a, 8, true, true))
+	{
+		return false;
+	}
+
+	a.frames_to_send = FRAME_COUNT_MAX;
+	b.frames_to_send = 20;
+	link_run(&a, &b, &faults);
+
+	bool passed = side_report("crc", &a, a.frames_to_send, true) && b.frames_broken > 0;
+
+	passed = side_report("crc", &b, b.frames_to_send, true) && passed;
+
+	link_close(&a, &b);
+	frame_size_min = 0;
+
+	return passed;
+}
+
+
+int main(void)
+{
+	bool passed = true;
+
+	passed = test_ordering() && passed;
+	passed = test_credits() && passed;
+	passed = test_crc() && passed;
+
+	printf("%s\n", passed ? "All tests passed" : "Tests failed");
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -18,8 +18,12 @@
 #include "acc_version.h"
 #include "acc_device_gpio.h"
 
+#include "acc_baud_negotiation.h"
+#include "acc_command.h"
+#include "acc_device_os.h"
 #include "acc_device_uart.h"
 #include "acc_driver_gpio_same70.h"
+#include "acc_uart_rx.h"
 #include "acc_app_integration.h"
 
 /** \example example_detector_presence.c
@@ -45,11 +49,73 @@
 //extern void set_led(bool enable);
 extern bool acc_device_gpio_write(uint_fast8_t pin, uint_fast8_t level);
 static bool detect_presence(void);
-static void uart_read_callback(uint_fast8_t port, uint8_t data, uint32_t status);// UART readback
+static void uart_rx_handler(uint_fast8_t port, const uint8_t *data, size_t length, void *client_reference);// UART readback
 //static bool acc_example_detector_presence(void);
 static void update_configuration(acc_detector_presence_configuration_t presence_configuration);
 //static void print_result(acc_detector_presence_result_t result);
-static void uart_read_callback(uint_fast8_t port, uint8_t data, uint32_t status);
+static void command_callback(char *command, size_t length, void *client_reference);
+
+#define MAX_INPUT_LENGTH    64
+#define UART_PORT           0
+#define UART_BAUDRATE       115200
+// Large enough to be polled at the highest baudrate
+#define UART_RX_BUFFER_SIZE 2048
+
+static char input_string[MAX_INPUT_LENGTH];
+static acc_command_tokenizer_t tokenizer;
+
+// The host can raise the baudrate of the command UART, see acc_baud_negotiation.h
+static acc_baud_negotiation_t baud_negotiation;
+static acc_app_integration_mutex_t baud_negotiation_mutex;
+
+static bool baud_negotiation_write(const char *line, size_t length, void *client_reference)
+{
+	(void)client_reference;
+
+	return acc_device_uart_write_buffer(UART_PORT, line, length);
+}
+
+static bool baud_negotiation_baudrate_set(uint32_t baudrate, void *client_reference)
+{
+	(void)client_reference;
+
+	return acc_uart_rx_baudrate_set(UART_PORT, baudrate) &&
+	       acc_device_uart_init(UART_PORT, baudrate, ACC_DEVICE_UART_OPTIONS_ALT_PINS_1);
+}
+
+static uint32_t baud_negotiation_time_get(void *client_reference)
+{
+	(void)client_reference;
+
+	return acc_os_get_time();
+}
+
+static bool baud_negotiation_start(void)
+{
+	acc_baud_negotiation_port_t port = {
+		.write            = baud_negotiation_write,
+		.baudrate_set     = baud_negotiation_baudrate_set,
+		.time_get         = baud_negotiation_time_get,
+		.client_reference = NULL,
+	};
+
+	baud_negotiation_mutex = acc_os_mutex_create();
+	if (baud_negotiation_mutex == NULL)
+	{
+		return false;
+	}
+
+	acc_baud_negotiation_device_init(&baud_negotiation, &port, acc_device_uart_get_max_baudrate(UART_PORT), UART_BAUDRATE);
+
+	return true;
+}
+
+static void baud_negotiation_poll(void)
+{
+	acc_os_mutex_lock(baud_negotiation_mutex);
+	acc_baud_negotiation_poll(&baud_negotiation);
+	acc_os_mutex_unlock(baud_negotiation_mutex);
+}
 
 static void configure_presence(acc_detector_presence_configuration_t presence_configuration)
 {
@@ -73,7 +139,12 @@ int main(void)
 		return EXIT_FAILURE;
 	}
 
-	acc_device_uart_register_read_callback(0, uart_read_callback);
+	acc_command_tokenizer_init(&tokenizer, input_string, sizeof(input_string), ";\r\n", command_callback, NULL);
+
+	if (!baud_negotiation_start() || !acc_uart_rx_start(UART_PORT, UART_BAUDRATE, UART_RX_BUFFER_SIZE, uart_rx_handler, NULL))
+	{
+		return EXIT_FAILURE;
+	}
 
 	if (!detect_presence())
 	{
@@ -87,33 +158,52 @@ int main(void)
 static volatile int profile = 3;
 static volatile int threshold = DEFAULT_DETECTION_THRESHOLD;
 static volatile bool restart = false;
-volatile int buffer_pos = 0;
-#define MAX_INPUT_LENGTH  32
-
-char input_string[MAX_INPUT_LENGTH];
 
 //To set the profile to 2 and the threshold to 10000 send the string  "P2;T10000;R;" to the application.
-void uart_read_callback(uint_fast8_t port, uint8_t data, uint32_t status)
+void uart_rx_handler(uint_fast8_t port, const uint8_t *data, size_t length, void *client_reference)
 {
-	if (data == ';' && buffer_pos > 0) {
-		switch(input_string[0])
-		{
-			case 'P' : profile = atoi(&input_string[1]); break;//Parses the C-string str interpreting its content as an integral number, which is returned as a value of type int.
-			case 'T' : threshold = atoi(&input_string[1]); break;
-			case 'R' : restart = true; break;
-		}
+	(void)port;
+	(void)client_reference;
 
-		buffer_pos=0;
+	// Runs in the UART receive task, not in the interrupt
+	acc_command_tokenizer_feed(&tokenizer, data, length);
+}
 
-	} else if (data >= '0' && data <= 'Z')
+void command_callback(char *command, size_t length, void *client_reference)
+{
+	(void)length;
+	(void)client_reference;
+
+	int32_t value;
+
+	acc_os_mutex_lock(baud_negotiation_mutex);
+	bool handled = acc_baud_negotiation_command(&baud_negotiation, command);
+	acc_os_mutex_unlock(baud_negotiation_mutex);
+
+	if (handled)
 	{
-		input_string[buffer_pos] = data;
-		if (buffer_pos < MAX_INPUT_LENGTH-1)
-			buffer_pos++;
+		return;
 	}
 
-	input_string[buffer_pos] = '\0';
-
+	switch(command[0])
+	{
+		case 'P' :
+			if (acc_command_parse_int32(&command[1], &value))
+			{
+				profile = value;
+			}
+			break;
+		case 'T' :
+			if (acc_command_parse_int32(&command[1], &value))
+			{
+				threshold = value;
+			}
+			break;
+		case 'R' : restart = true; break;
+		default :
+			printf("Unknown command '%s'\n", command);
+			break;
+	}
 }
 
 bool detect_presence(void)
@@ -247,6 +337,8 @@ bool detect_presence(void)
 			}
 			printf("Score: %5d, Distance: %4d\n", (int)(result.presence_score * 1000.0f), (int)(result.presence_distance * 1000.0f));
 
+			baud_negotiation_poll();
+
 			//acc_app_integration_sleep_us(1000000 / DEFAULT_UPDATE_RATE);
 			acc_app_integration_sleep_ms(1000 / DEFAULT_UPDATE_RATE);
 		}